@@ -0,0 +1,212 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+// System includes
+#include <cstdio>
+#include <cstring>
+
+// Teuchos includes
+#include "Teuchos_Assert.hpp"
+#ifdef HAVE_MPI
+#include "Teuchos_DefaultMpiComm.hpp"
+#endif
+
+// Domi includes
+#include "Domi_AsyncWrite.hpp"
+#include "Domi_Exceptions.hpp"
+
+// Non-blocking collective file I/O was introduced in MPI 3.1
+#ifdef HAVE_MPI
+#if MPI_VERSION > 3 || (MPI_VERSION == 3 && MPI_SUBVERSION >= 1)
+#define DOMI_HAVE_MPI_IWRITE_ALL
+#endif
+#endif
+
+namespace Domi
+{
+
+////////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_MPI
+
+AsyncWrite::
+AsyncWrite(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+           const std::string & filename,
+           const Teuchos::ArrayRCP< const char > & buffer,
+           int count,
+           MPI_Datatype etype,
+           MPI_Datatype filetype,
+           MPI_Info info) :
+  _filename(filename),
+  _buffer(buffer),
+  _complete(false),
+  _file(MPI_FILE_NULL),
+  _request(MPI_REQUEST_NULL),
+  _requestComplete(false)
+{
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+
+  // Open and truncate the file, and set this processor's view of it
+  char * cstr = new char[filename.size()+1];
+  std::strcpy(cstr, filename.c_str());
+  char datarep[7] = "native";
+  int error = MPI_File_open(communicator(), cstr,
+                            MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                            info, &_file);
+  delete [] cstr;
+
+  // Agree on whether every processor opened the file, so that all of
+  // them throw together.  Since closing the file is collective, a
+  // file opened by only some of the processors is not closed.
+  int opened = (error == MPI_SUCCESS) ? 1 : 0;
+  int allOpened = 0;
+  MPI_Allreduce(&opened, &allOpened, 1, MPI_INT, MPI_MIN, communicator());
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! allOpened,
+    FileError,
+    "Cannot open file '" << filename << "' for writing");
+  MPI_File_set_size(_file, 0);
+  MPI_File_set_view(_file, 0, etype, filetype, datarep, info);
+
+  // Start the write
+  void * data = (void*) _buffer.getRawPtr();
+#ifdef DOMI_HAVE_MPI_IWRITE_ALL
+  MPI_File_iwrite_all(_file, data, count, etype, &_request);
+#else
+  MPI_File_iwrite(_file, data, count, etype, &_request);
+#endif
+}
+
+#else
+
+AsyncWrite::
+AsyncWrite(const std::string & filename,
+           const Teuchos::ArrayRCP< const char > & buffer) :
+  _filename(filename),
+  _buffer(buffer),
+  _complete(false)
+{
+  FILE * datafile = fopen(filename.c_str(), "w");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    datafile == 0,
+    FileError,
+    "Cannot open file '" << filename << "' for writing");
+  fwrite((const void *) _buffer.getRawPtr(), 1, _buffer.size(), datafile);
+  fclose(datafile);
+  _buffer = Teuchos::null;
+  _complete = true;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+AsyncWrite::~AsyncWrite()
+{
+  wait();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+bool
+AsyncWrite::test()
+{
+#ifdef HAVE_MPI
+  if (! _requestComplete)
+  {
+    int flag = 0;
+    MPI_Test(&_request, &flag, MPI_STATUS_IGNORE);
+    _requestComplete = (flag != 0);
+  }
+  return _requestComplete;
+#else
+  return _complete;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+AsyncWrite::wait()
+{
+  if (_complete) return;
+#ifdef HAVE_MPI
+  if (! _requestComplete)
+  {
+    MPI_Wait(&_request, MPI_STATUS_IGNORE);
+    _requestComplete = true;
+  }
+  MPI_File_close(&_file);
+#endif
+  _buffer = Teuchos::null;
+  _complete = true;
+  _timer = Teuchos::null;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+bool
+AsyncWrite::isComplete() const
+{
+  return _complete;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const std::string &
+AsyncWrite::getFilename() const
+{
+  return _filename;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+AsyncWrite::setTimer(const Teuchos::RCP< IOTimer > & timer)
+{
+  if (! _complete) _timer = timer;
+}
+
+}  // namespace Domi
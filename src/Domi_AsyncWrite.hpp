@@ -0,0 +1,188 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_ASYNCWRITE_HPP
+#define DOMI_ASYNCWRITE_HPP
+
+// System includes
+#include <string>
+
+// Teuchos includes
+#include "Teuchos_RCP.hpp"
+#include "Teuchos_ArrayRCP.hpp"
+#include "Teuchos_Comm.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+#include "Domi_IOConfig.hpp"
+
+namespace Domi
+{
+
+/** \brief A handle to a binary file write that proceeds in the
+ *         background
+ *
+ * An <tt>AsyncWrite</tt> is returned by
+ * <tt>MDVector::startWriteBinary()</tt>.  It owns the staging buffer
+ * that holds a snapshot of the data being written, and, in parallel
+ * builds, the open MPI file and the MPI request of a non-blocking,
+ * collective write.  The write is complete after <tt>wait()</tt>
+ * returns.
+ *
+ * Since closing an MPI file is collective, <tt>wait()</tt> must be
+ * called by every processor of the communicator, in the same order
+ * with respect to other writes.  The destructor calls
+ * <tt>wait()</tt> if it has not been called.
+ *
+ * Non-blocking collective writes (<tt>MPI_File_iwrite_all</tt>)
+ * require MPI 3.1; with older MPI libraries each processor writes its
+ * data with a non-blocking, independent write.  In serial builds,
+ * the data is written when the <tt>AsyncWrite</tt> is constructed.
+ */
+class AsyncWrite
+{
+public:
+
+#ifdef HAVE_MPI
+  /** \brief Constructor, which starts the write
+   *
+   * \param teuchosComm [in] the communicator of the processors that
+   *        write the file
+   *
+   * \param filename [in] name of the file, which is created or
+   *        truncated
+   *
+   * \param buffer [in] the contiguous data to write, which must not
+   *        be changed until the write is complete
+   *
+   * \param count [in] number of elements of type etype in the buffer
+   *
+   * \param etype [in] the MPI data type of the elements
+   *
+   * \param filetype [in] the MPI data type that describes where this
+   *        processor's elements are stored in the file
+   *
+   * \param info [in] the MPI-IO hints for the file
+   */
+  AsyncWrite(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+             const std::string & filename,
+             const Teuchos::ArrayRCP< const char > & buffer,
+             int count,
+             MPI_Datatype etype,
+             MPI_Datatype filetype,
+             MPI_Info info = MPI_INFO_NULL);
+#else
+  /** \brief Constructor, which writes the data
+   *
+   * \param filename [in] name of the file, which is created or
+   *        truncated
+   *
+   * \param buffer [in] the contiguous data to write
+   */
+  AsyncWrite(const std::string & filename,
+             const Teuchos::ArrayRCP< const char > & buffer);
+#endif
+
+  /** \brief Destructor, which waits for the write to complete
+   */
+  ~AsyncWrite();
+
+  /** \brief Return true if this processor's data has been written,
+   *         without blocking
+   *
+   * The file is not closed until <tt>wait()</tt> is called.
+   */
+  bool test();
+
+  /** \brief Wait for the write to complete, and close the file
+   *
+   * This is collective over the communicator given to the
+   * constructor.  Calling it more than once has no effect.
+   */
+  void wait();
+
+  /** \brief Return true if <tt>wait()</tt> has completed the write
+   */
+  bool isComplete() const;
+
+  /** \brief Return the name of the file being written
+   */
+  const std::string & getFilename() const;
+
+  /** \brief Keep a timer until the write is complete
+   *
+   * \param timer [in] the timer of the operation that started the
+   *        write.  It records its timing when <tt>wait()</tt>
+   *        completes the write, so that the timing covers the write
+   *        and not just its start.  If the write is already complete,
+   *        the timer is not kept.
+   */
+  void setTimer(const Teuchos::RCP< IOTimer > & timer);
+
+private:
+
+  std::string _filename;
+
+  // The staging buffer, kept alive until the write is complete
+  Teuchos::ArrayRCP< const char > _buffer;
+
+  bool _complete;
+
+  // The timer of the operation that started the write, released when
+  // the write is complete
+  Teuchos::RCP< IOTimer > _timer;
+
+#ifdef HAVE_MPI
+  MPI_File    _file;
+  MPI_Request _request;
+  bool        _requestComplete;
+#endif
+
+  // Not copyable
+  AsyncWrite(const AsyncWrite & source);
+  AsyncWrite & operator=(const AsyncWrite & source);
+};
+
+}  // namespace Domi
+
+#endif
@@ -0,0 +1,662 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+// System includes
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+// Teuchos includes
+#include "Teuchos_CommHelpers.hpp"
+
+// Domi includes
+#include "Domi_ChunkedFile.hpp"
+#include "Domi_Exceptions.hpp"
+
+namespace Domi
+{
+
+// The chunked file format identifier and version
+static const char      chunkedFileMagic[8]  = { 'D','O','M','I',
+                                                'F','I','L','E' };
+static const int       chunkedFileVersion   = 1;
+static const int       chunkedFileByteOrder = 0x01020304;
+
+// The size of the fixed part of the header: the identifier, eight
+// 32-bit integers and the 64-bit header size
+static const size_type chunkedFileFixedSize = 48;
+
+// The header is padded to a multiple of this many bytes
+static const size_type chunkedFileAlignment = 64;
+
+////////////////////////////////////////////////////////////////////////
+
+// Specializations of fileTypeCode<T> for the built-in types
+
+template<>
+int fileTypeCode< char >()
+{
+  return 1;
+}
+
+template<>
+int fileTypeCode< signed char >()
+{
+  return 2;
+}
+
+template<>
+int fileTypeCode< unsigned char >()
+{
+  return 3;
+}
+
+template<>
+int fileTypeCode< short >()
+{
+  return 4;
+}
+
+template<>
+int fileTypeCode< unsigned short >()
+{
+  return 5;
+}
+
+template<>
+int fileTypeCode< int >()
+{
+  return 6;
+}
+
+template<>
+int fileTypeCode< unsigned int >()
+{
+  return 7;
+}
+
+template<>
+int fileTypeCode< long >()
+{
+  return 8;
+}
+
+template<>
+int fileTypeCode< unsigned long >()
+{
+  return 9;
+}
+
+template<>
+int fileTypeCode< long long >()
+{
+  return 10;
+}
+
+template<>
+int fileTypeCode< unsigned long long >()
+{
+  return 11;
+}
+
+template<>
+int fileTypeCode< float >()
+{
+  return 12;
+}
+
+template<>
+int fileTypeCode< double >()
+{
+  return 13;
+}
+
+template<>
+int fileTypeCode< long double >()
+{
+  return 14;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void swapBytes(void * data,
+               size_type count,
+               int size)
+{
+  char * bytes = static_cast< char* >(data);
+  for (size_type i = 0; i < count; ++i, bytes += size)
+    std::reverse(bytes, bytes + size);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+ChunkedFileHeader::ChunkedFileHeader() :
+  _typeCode(0),
+  _scalarSize(0),
+  _swapBytes(false),
+  _layout(DEFAULT_ORDER),
+  _includesBndryPad(false),
+  _hasIndex(false),
+  _fileDims(),
+  _lowerBndryPad(),
+  _upperBndryPad(),
+  _chunkShape(),
+  _chunkGrid(),
+  _chunkOffsets(),
+  _headerSize(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+ChunkedFileHeader::
+ChunkedFileHeader(int typeCode,
+                  int scalarSize,
+                  Layout layout,
+                  bool includesBndryPad,
+                  const Teuchos::ArrayView< const dim_type > & fileDims,
+                  const Teuchos::ArrayView< const int > & lowerBndryPad,
+                  const Teuchos::ArrayView< const int > & upperBndryPad,
+                  const Teuchos::ArrayView< const dim_type > & chunkShape,
+                  bool writeIndex) :
+  _typeCode(typeCode),
+  _scalarSize(scalarSize),
+  _swapBytes(false),
+  _layout(layout),
+  _includesBndryPad(includesBndryPad),
+  _hasIndex(writeIndex),
+  _fileDims(fileDims.begin(), fileDims.end()),
+  _lowerBndryPad(lowerBndryPad.begin(), lowerBndryPad.end()),
+  _upperBndryPad(upperBndryPad.begin(), upperBndryPad.end()),
+  _chunkShape(chunkShape.begin(), chunkShape.end()),
+  _chunkGrid(),
+  _chunkOffsets(),
+  _headerSize(0)
+{
+  int numDims = fileDims.size();
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    lowerBndryPad.size() != numDims ||
+    upperBndryPad.size() != numDims ||
+    chunkShape.size()    != numDims,
+    InvalidArgument,
+    "The boundary pads and chunk shape must have " << numDims
+    << " dimensions");
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      chunkShape[axis] < 1,
+      InvalidArgument,
+      "Chunk shape " << chunkShape << " must be positive");
+  }
+
+  // Compute the size of the header, padded to the alignment
+  _headerSize = chunkedFileFixedSize + 4 * numDims * sizeof(long long);
+  if (_hasIndex)
+  {
+    size_type numChunks = 1;
+    for (int axis = 0; axis < numDims; ++axis)
+      numChunks *= (fileDims[axis] + chunkShape[axis] - 1) / chunkShape[axis];
+    _headerSize += numChunks * sizeof(long long);
+  }
+  _headerSize = ((_headerSize + chunkedFileAlignment - 1) /
+                 chunkedFileAlignment) * chunkedFileAlignment;
+  computeChunks();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+ChunkedFileHeader
+ChunkedFileHeader::
+read(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+     const std::string & filename)
+{
+  // The first processor reads the fixed part of the header, which
+  // gives the size of the whole header, and then the rest of it
+  Teuchos::Array< char > buffer;
+  int size = 0;
+  if (teuchosComm->getRank() == 0)
+  {
+    FILE * datafile = fopen(filename.c_str(), "r");
+    if (datafile)
+    {
+      buffer.resize(chunkedFileFixedSize);
+      if (fread(buffer.getRawPtr(), 1, chunkedFileFixedSize, datafile) ==
+          (std::size_t) chunkedFileFixedSize &&
+          std::memcmp(buffer.getRawPtr(), chunkedFileMagic, 8) == 0)
+      {
+        size_type position = 8 + sizeof(int);
+        bool swap = (extractBytes< int >(buffer(), position, false) !=
+                     chunkedFileByteOrder);
+        position = chunkedFileFixedSize - sizeof(long long);
+        size_type headerSize =
+          extractBytes< long long >(buffer(), position, swap);
+        if (headerSize >= chunkedFileFixedSize)
+        {
+          buffer.resize(headerSize);
+          if (fread(buffer.getRawPtr() + chunkedFileFixedSize, 1,
+                    headerSize - chunkedFileFixedSize, datafile) ==
+              (std::size_t) (headerSize - chunkedFileFixedSize))
+            size = headerSize;
+        }
+      }
+      fclose(datafile);
+    }
+  }
+
+  // Broadcast the header to the other processors
+  Teuchos::broadcast(*teuchosComm, 0, 1, &size);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    size == 0,
+    FileError,
+    "File '" << filename << "' cannot be read or is not a Domi chunked "
+    "file");
+  buffer.resize(size);
+  Teuchos::broadcast(*teuchosComm, 0, size, buffer.getRawPtr());
+
+  ChunkedFileHeader result;
+  result.unpack(buffer(), filename);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+ChunkedFileHeader::write(const std::string & filename) const
+{
+  Teuchos::Array< char > buffer = pack();
+  FILE * datafile = fopen(filename.c_str(), "w");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    datafile == 0,
+    FileError,
+    "Cannot open file '" << filename << "' for writing");
+  size_type count = fwrite(buffer.getRawPtr(), 1, buffer.size(), datafile);
+  fclose(datafile);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    count != buffer.size(),
+    FileError,
+    "Incomplete write of header to file '" << filename << "'");
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+ChunkedFileHeader::typeCode() const
+{
+  return _typeCode;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+ChunkedFileHeader::scalarSize() const
+{
+  return _scalarSize;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+bool
+ChunkedFileHeader::swapBytes() const
+{
+  return _swapBytes;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+ChunkedFileHeader::numDims() const
+{
+  return _fileDims.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Layout
+ChunkedFileHeader::layout() const
+{
+  return _layout;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+bool
+ChunkedFileHeader::includesBndryPad() const
+{
+  return _includesBndryPad;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const Teuchos::Array< dim_type > &
+ChunkedFileHeader::fileDims() const
+{
+  return _fileDims;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const Teuchos::Array< int > &
+ChunkedFileHeader::lowerBndryPad() const
+{
+  return _lowerBndryPad;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const Teuchos::Array< int > &
+ChunkedFileHeader::upperBndryPad() const
+{
+  return _upperBndryPad;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const Teuchos::Array< dim_type > &
+ChunkedFileHeader::chunkShape() const
+{
+  return _chunkShape;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_type
+ChunkedFileHeader::headerSize() const
+{
+  return _headerSize;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_type
+ChunkedFileHeader::numChunks() const
+{
+  return _chunkOffsets.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_type
+ChunkedFileHeader::chunkOffset(size_type chunk) const
+{
+  return _chunkOffsets[chunk];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+ChunkedFileHeader::chunkBounds(size_type chunk,
+                               Teuchos::Array< dim_type > & start,
+                               Teuchos::Array< dim_type > & shape) const
+{
+  int numDims = _fileDims.size();
+  start.resize(numDims);
+  shape.resize(numDims);
+  int first = (_layout == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+  int step  = (_layout == LAST_INDEX_FASTEST) ? -1 : 1;
+  for (int i = 0, axis = first; i < numDims; ++i, axis += step)
+  {
+    dim_type index = chunk % _chunkGrid[axis];
+    chunk /= _chunkGrid[axis];
+    start[axis] = index * _chunkShape[axis];
+    shape[axis] = std::min(_chunkShape[axis], _fileDims[axis] - start[axis]);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Line functor for walkLines() that appends the indexes of the chunks
+// along a line of the chunk grid
+struct ChunkLineFunctor
+{
+  ChunkLineFunctor(size_type firstChunk,
+                   size_type stride,
+                   size_type length,
+                   Teuchos::Array< size_type > & chunks) :
+    _firstChunk(firstChunk), _stride(stride), _length(length),
+    _chunks(chunks) { }
+  void operator()(const dim_type *, const size_type * offsets)
+  {
+    for (size_type i = 0; i < _length; ++i)
+      _chunks.push_back(_firstChunk + offsets[0] + i*_stride);
+  }
+  size_type _firstChunk;
+  size_type _stride;
+  size_type _length;
+  Teuchos::Array< size_type > & _chunks;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+Teuchos::Array< size_type >
+ChunkedFileHeader::
+intersectingChunks(const Teuchos::ArrayView< const dim_type > & start,
+                   const Teuchos::ArrayView< const dim_type > & shape) const
+{
+  Teuchos::Array< size_type > result;
+  int numDims = _fileDims.size();
+  if (numDims == 0 || computeSize(shape) == 0) return result;
+
+  // Compute the range of the chunk grid along each axis, and the
+  // stride of each axis of the chunk grid
+  Teuchos::Array< dim_type > lower(numDims);
+  Teuchos::Array< dim_type > upper(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    lower[axis] = start[axis] / _chunkShape[axis];
+    upper[axis] = (start[axis] + shape[axis] - 1) / _chunkShape[axis] + 1;
+  }
+  Teuchos::Array< size_type > gridStrides =
+    computeStrides< size_type, dim_type >(_chunkGrid, _layout);
+
+  // Walk the range of the chunk grid in layout order, which visits
+  // the chunk indexes in increasing order
+  Teuchos::Array< dim_type > range(numDims);
+  size_type firstChunk = 0;
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    range[axis] = upper[axis] - lower[axis];
+    firstChunk += lower[axis] * gridStrides[axis];
+  }
+  int first = (_layout == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+  ChunkLineFunctor functor(firstChunk, gridStrides[first], range[first],
+                           result);
+  const size_type * stridePtr = gridStrides.getRawPtr();
+  walkLines(numDims, lower.getRawPtr(), range.getRawPtr(), _layout, 1,
+            &stridePtr, functor);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+ChunkedFileHeader::computeChunks()
+{
+  int numDims = _fileDims.size();
+  _chunkGrid.resize(numDims);
+  size_type numChunks = 1;
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    _chunkGrid[axis] = (_fileDims[axis] + _chunkShape[axis] - 1) /
+                       _chunkShape[axis];
+    numChunks *= _chunkGrid[axis];
+  }
+
+  // The chunks are stored consecutively after the header, unless an
+  // index gives their offsets
+  if (_hasIndex && _chunkOffsets.size() == numChunks) return;
+  _chunkOffsets.resize(numChunks);
+  Teuchos::Array< dim_type > start;
+  Teuchos::Array< dim_type > shape;
+  size_type offset = _headerSize;
+  for (size_type chunk = 0; chunk < numChunks; ++chunk)
+  {
+    _chunkOffsets[chunk] = offset;
+    chunkBounds(chunk, start, shape);
+    offset += computeSize(shape) * _scalarSize;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Teuchos::Array< char >
+ChunkedFileHeader::pack() const
+{
+  Teuchos::Array< char > buffer(chunkedFileMagic, chunkedFileMagic + 8);
+  int numDims = _fileDims.size();
+  appendBytes< int >(buffer, chunkedFileVersion);
+  appendBytes< int >(buffer, chunkedFileByteOrder);
+  appendBytes< int >(buffer, _typeCode);
+  appendBytes< int >(buffer, _scalarSize);
+  appendBytes< int >(buffer, numDims);
+  appendBytes< int >(buffer, _layout);
+  appendBytes< int >(buffer, _includesBndryPad ? 1 : 0);
+  appendBytes< int >(buffer, _hasIndex ? 1 : 0);
+  appendBytes< long long >(buffer, _headerSize);
+  for (int axis = 0; axis < numDims; ++axis)
+    appendBytes< long long >(buffer, _fileDims[axis]);
+  for (int axis = 0; axis < numDims; ++axis)
+    appendBytes< long long >(buffer, _lowerBndryPad[axis]);
+  for (int axis = 0; axis < numDims; ++axis)
+    appendBytes< long long >(buffer, _upperBndryPad[axis]);
+  for (int axis = 0; axis < numDims; ++axis)
+    appendBytes< long long >(buffer, _chunkShape[axis]);
+  if (_hasIndex)
+    for (size_type chunk = 0; chunk < _chunkOffsets.size(); ++chunk)
+      appendBytes< long long >(buffer, _chunkOffsets[chunk]);
+  buffer.resize(_headerSize, 0);
+  return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+ChunkedFileHeader::unpack(const Teuchos::ArrayView< const char > & buffer,
+                          const std::string & filename)
+{
+  size_type position = 8;
+  int version = extractBytes< int >(buffer, position, false);
+  int byteOrder = extractBytes< int >(buffer, position, false);
+  _swapBytes = (byteOrder != chunkedFileByteOrder);
+  if (_swapBytes) Domi::swapBytes(&version, 1, sizeof(int));
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    version > chunkedFileVersion,
+    FileError,
+    "File '" << filename << "' has chunked file format version " << version
+    << ", but only versions up to " << chunkedFileVersion
+    << " are supported");
+
+  _typeCode         = extractBytes< int >(buffer, position, _swapBytes);
+  _scalarSize       = extractBytes< int >(buffer, position, _swapBytes);
+  int numDims       = extractBytes< int >(buffer, position, _swapBytes);
+  _layout           = (Layout) extractBytes< int >(buffer, position,
+                                                   _swapBytes);
+  _includesBndryPad = extractBytes< int >(buffer, position, _swapBytes);
+  _hasIndex         = extractBytes< int >(buffer, position, _swapBytes);
+  _headerSize       = extractBytes< long long >(buffer, position,
+                                                _swapBytes);
+
+  _fileDims.resize(numDims);
+  _lowerBndryPad.resize(numDims);
+  _upperBndryPad.resize(numDims);
+  _chunkShape.resize(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    _fileDims[axis] = extractBytes< long long >(buffer, position, _swapBytes);
+  for (int axis = 0; axis < numDims; ++axis)
+    _lowerBndryPad[axis] = extractBytes< long long >(buffer, position,
+                                                     _swapBytes);
+  for (int axis = 0; axis < numDims; ++axis)
+    _upperBndryPad[axis] = extractBytes< long long >(buffer, position,
+                                                     _swapBytes);
+  for (int axis = 0; axis < numDims; ++axis)
+    _chunkShape[axis] = extractBytes< long long >(buffer, position,
+                                                  _swapBytes);
+  if (_hasIndex)
+  {
+    size_type numChunks = 1;
+    for (int axis = 0; axis < numDims; ++axis)
+      numChunks *= (_fileDims[axis] + _chunkShape[axis] - 1) /
+                   _chunkShape[axis];
+    _chunkOffsets.resize(numChunks);
+    for (size_type chunk = 0; chunk < numChunks; ++chunk)
+      _chunkOffsets[chunk] = extractBytes< long long >(buffer, position,
+                                                       _swapBytes);
+  }
+  computeChunks();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Teuchos::RCP< MDMap >
+readMDMap(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+          const std::string & filename,
+          Teuchos::ParameterList & plist)
+{
+  ChunkedFileHeader header = ChunkedFileHeader::read(teuchosComm, filename);
+
+  // The boundary pad sizes of an MDMap constructed from a
+  // ParameterList are the same at both ends of an axis, so files
+  // written with different lower and upper boundary pads cannot be
+  // represented
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    header.lowerBndryPad() != header.upperBndryPad(),
+    MDMapError,
+    "File '" << filename << "' has lower boundary pad sizes "
+    << header.lowerBndryPad() << " and upper boundary pad sizes "
+    << header.upperBndryPad() << ", which must be the same");
+
+  // Set the dimensions, boundary padding and layout from the header
+  int numDims = header.numDims();
+  Teuchos::Array< dim_type > dims(header.fileDims());
+  Teuchos::Array< int > bndryPad(header.lowerBndryPad());
+  if (header.includesBndryPad())
+    for (int axis = 0; axis < numDims; ++axis)
+      dims[axis] -= header.lowerBndryPad()[axis] +
+                    header.upperBndryPad()[axis];
+  plist.set("dimensions", dims);
+  plist.set("boundary pad sizes", bndryPad);
+  plist.set("layout", std::string(header.layout() == C_ORDER ?
+                                   "C Order" : "Fortran Order"));
+
+  return Teuchos::rcp(new MDMap(teuchosComm, plist));
+}
+
+}  // namespace Domi
@@ -0,0 +1,355 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_CHUNKEDFILE_HPP
+#define DOMI_CHUNKEDFILE_HPP
+
+// System includes
+#include <cstring>
+#include <string>
+
+// Teuchos includes
+#include "Teuchos_Array.hpp"
+#include "Teuchos_Comm.hpp"
+#include "Teuchos_ParameterList.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+#include "Domi_MDMap.hpp"
+
+namespace Domi
+{
+
+/** \brief Return the code that identifies a scalar type in the header
+ *         of a chunked file, given the type as template parameter T
+ *
+ * The built-in types have distinct codes, and any other type has
+ * code zero, in which case only its size is checked when a file is
+ * read.
+ */
+template< class T > int fileTypeCode() { return 0; }
+
+/** \cond */
+template<> int fileTypeCode< char >();
+template<> int fileTypeCode< signed char >();
+template<> int fileTypeCode< unsigned char >();
+template<> int fileTypeCode< short >();
+template<> int fileTypeCode< unsigned short >();
+template<> int fileTypeCode< int >();
+template<> int fileTypeCode< unsigned int >();
+template<> int fileTypeCode< long >();
+template<> int fileTypeCode< unsigned long >();
+template<> int fileTypeCode< long long >();
+template<> int fileTypeCode< unsigned long long >();
+template<> int fileTypeCode< float >();
+template<> int fileTypeCode< double >();
+template<> int fileTypeCode< long double >();
+/** \endcond */
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Reverse the byte order of an array of values
+ *
+ * \param data [in/out] pointer to the first value
+ *
+ * \param count [in] the number of values
+ *
+ * \param size [in] the size, in bytes, of each value
+ */
+void swapBytes(void * data,
+               size_type count,
+               int size);
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Append the bytes of a value to a buffer
+ *
+ * \param buffer [in/out] the buffer
+ *
+ * \param value [in] the value
+ */
+template< class T >
+void appendBytes(Teuchos::Array< char > & buffer,
+                 T value)
+{
+  const char * bytes = reinterpret_cast< const char* >(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Extract a value from a buffer
+ *
+ * \param buffer [in] the buffer
+ *
+ * \param position [in/out] the position of the value in the buffer,
+ *        which is advanced past it
+ *
+ * \param swap [in] if true, reverse the bytes of the value
+ */
+template< class T >
+T extractBytes(const Teuchos::ArrayView< const char > & buffer,
+               size_type & position,
+               bool swap)
+{
+  T value;
+  std::memcpy(&value, &buffer[position], sizeof(T));
+  if (swap) swapBytes(&value, 1, sizeof(T));
+  position += sizeof(T);
+  return value;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief The header of a self-describing, chunked binary file
+ *
+ * A chunked file stores a global array, such as an
+ * <tt>MDVector</tt>, in a form that can be read without knowing its
+ * type or shape in advance.  It consists of a header, followed by a
+ * body in which the global array is divided into a regular grid of
+ * chunks.  Each chunk is stored contiguously, in the layout of the
+ * array, and the chunks are stored in the same layout order over the
+ * chunk grid.  Chunks at the upper end of an axis are truncated to
+ * the global dimensions.  This allows a subset of the array to be
+ * read by reading only the chunks that it intersects.
+ *
+ * The header contains, in this order and in the byte order of the
+ * writer:
+ *
+ * - the eight characters "DOMIFILE"
+ * - eight 32-bit integers: the format version, the value 0x01020304
+ *   (from which the reader determines the byte order), the scalar
+ *   type code given by <tt>fileTypeCode()</tt>, the scalar size in
+ *   bytes, the number of dimensions, the layout, a flag indicating
+ *   whether the boundary padding is included in the array, and a
+ *   flag indicating whether the chunk index is present
+ * - a 64-bit integer: the size of the header, in bytes
+ * - 64-bit integer arrays of length equal to the number of
+ *   dimensions: the dimensions of the array in the file, the lower
+ *   boundary pad sizes, the upper boundary pad sizes and the chunk
+ *   shape
+ * - if the chunk index is present, a 64-bit integer array of the
+ *   byte offset of each chunk in the file
+ *
+ * The header is padded to a multiple of 64 bytes, so that the body is
+ * aligned for any scalar type.
+ */
+class ChunkedFileHeader
+{
+public:
+
+  /** \brief Default constructor
+   */
+  ChunkedFileHeader();
+
+  /** \brief Constructor for writing a file
+   *
+   * \param typeCode [in] the scalar type code
+   *
+   * \param scalarSize [in] the size of the scalar type, in bytes
+   *
+   * \param layout [in] the layout of the array and of the chunks
+   *
+   * \param includesBndryPad [in] whether the array includes the
+   *        boundary padding
+   *
+   * \param fileDims [in] the dimensions of the array in the file
+   *
+   * \param lowerBndryPad [in] the lower boundary pad sizes
+   *
+   * \param upperBndryPad [in] the upper boundary pad sizes
+   *
+   * \param chunkShape [in] the shape of the chunks
+   *
+   * \param writeIndex [in] whether to store the chunk index
+   */
+  ChunkedFileHeader(int typeCode,
+                    int scalarSize,
+                    Layout layout,
+                    bool includesBndryPad,
+                    const Teuchos::ArrayView< const dim_type > & fileDims,
+                    const Teuchos::ArrayView< const int > & lowerBndryPad,
+                    const Teuchos::ArrayView< const int > & upperBndryPad,
+                    const Teuchos::ArrayView< const dim_type > & chunkShape,
+                    bool writeIndex = true);
+
+  /** \brief Read the header of a file
+   *
+   * \param teuchosComm [in] the communicator of the processors that
+   *        read the header.  The header is read by the first
+   *        processor and broadcast to the others.
+   *
+   * \param filename [in] name of the file
+   */
+  static ChunkedFileHeader
+  read(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+       const std::string & filename);
+
+  /** \brief Write the header to the start of a file, truncating it
+   *
+   * \param filename [in] name of the file
+   */
+  void write(const std::string & filename) const;
+
+  /** \brief Return the scalar type code */
+  int typeCode() const;
+
+  /** \brief Return the scalar size, in bytes */
+  int scalarSize() const;
+
+  /** \brief Return true if the file was written with the opposite
+   *         byte order
+   */
+  bool swapBytes() const;
+
+  /** \brief Return the number of dimensions */
+  int numDims() const;
+
+  /** \brief Return the layout */
+  Layout layout() const;
+
+  /** \brief Return true if the array includes the boundary padding */
+  bool includesBndryPad() const;
+
+  /** \brief Return the dimensions of the array in the file */
+  const Teuchos::Array< dim_type > & fileDims() const;
+
+  /** \brief Return the lower boundary pad sizes */
+  const Teuchos::Array< int > & lowerBndryPad() const;
+
+  /** \brief Return the upper boundary pad sizes */
+  const Teuchos::Array< int > & upperBndryPad() const;
+
+  /** \brief Return the chunk shape */
+  const Teuchos::Array< dim_type > & chunkShape() const;
+
+  /** \brief Return the size of the header, in bytes, which is the
+   *         offset of the first chunk
+   */
+  size_type headerSize() const;
+
+  /** \brief Return the number of chunks */
+  size_type numChunks() const;
+
+  /** \brief Return the byte offset of a chunk in the file
+   *
+   * \param chunk [in] the index of the chunk
+   */
+  size_type chunkOffset(size_type chunk) const;
+
+  /** \brief Compute the position and shape of a chunk in the array
+   *
+   * \param chunk [in] the index of the chunk
+   *
+   * \param start [out] the index of the first element of the chunk
+   *
+   * \param shape [out] the shape of the chunk
+   */
+  void chunkBounds(size_type chunk,
+                   Teuchos::Array< dim_type > & start,
+                   Teuchos::Array< dim_type > & shape) const;
+
+  /** \brief Return the indexes, in increasing order, of the chunks
+   *         that intersect a region of the array
+   *
+   * \param start [in] the index of the first element of the region
+   *
+   * \param shape [in] the shape of the region
+   */
+  Teuchos::Array< size_type >
+  intersectingChunks(const Teuchos::ArrayView< const dim_type > & start,
+                     const Teuchos::ArrayView< const dim_type > & shape) const;
+
+private:
+
+  // Compute the chunk grid and the chunk offsets
+  void computeChunks();
+
+  // Serialize the header
+  Teuchos::Array< char > pack() const;
+
+  // Deserialize the header
+  void unpack(const Teuchos::ArrayView< const char > & buffer,
+              const std::string & filename);
+
+  int                         _typeCode;
+  int                         _scalarSize;
+  bool                        _swapBytes;
+  Layout                      _layout;
+  bool                        _includesBndryPad;
+  bool                        _hasIndex;
+  Teuchos::Array< dim_type >  _fileDims;
+  Teuchos::Array< int >       _lowerBndryPad;
+  Teuchos::Array< int >       _upperBndryPad;
+  Teuchos::Array< dim_type >  _chunkShape;
+  Teuchos::Array< dim_type >  _chunkGrid;
+  Teuchos::Array< size_type > _chunkOffsets;
+  size_type                   _headerSize;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Construct an MDMap for the array stored in a chunked file
+ *
+ * \param teuchosComm [in] the communicator for the MDMap
+ *
+ * \param filename [in] name of the file
+ *
+ * \param plist [in] ParameterList with the parameters of the MDMap
+ *        that are not stored in the file, such as "comm dimensions",
+ *        "periodic" and "communication pad sizes".  The
+ *        "dimensions", "boundary pad sizes" and "layout" parameters
+ *        are set from the file.
+ *
+ * An <tt>MDMapError</tt> is thrown if the lower and upper boundary
+ * pad sizes stored in the file differ, since a ParameterList can only
+ * specify the same boundary pad size at both ends of an axis.
+ */
+Teuchos::RCP< MDMap >
+readMDMap(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+          const std::string & filename,
+          Teuchos::ParameterList & plist);
+
+}  // namespace Domi
+
+#endif
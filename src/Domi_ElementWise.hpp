@@ -0,0 +1,764 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_ELEMENTWISE_HPP
+#define DOMI_ELEMENTWISE_HPP
+
+// Standard includes
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+// Teuchos includes
+#include "Teuchos_Array.hpp"
+#include "Teuchos_ArrayView.hpp"
+#include "Teuchos_ScalarTraits.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+#include "Domi_Exceptions.hpp"
+#include "Domi_Threads.hpp"
+#include "Domi_MDArrayView.hpp"
+
+namespace Domi
+{
+
+/** \file Domi_ElementWise.hpp
+ *
+ * \brief Expression templates and an evaluation engine for
+ *        element-wise operations on MDVectors
+ *
+ * Arithmetic operators applied to <tt>MDVector</tt>s do not compute
+ * anything.  Instead, they build a lightweight expression object
+ * whose type describes the computation, so that an expression such
+ * as
+ *
+ * \code
+ * z.assign(a*x + b*y + c*w);
+ * \endcode
+ *
+ * is evaluated by <tt>MDVector::assign()</tt> in a single pass over
+ * the data, without temporary MDVectors.  The supported operators
+ * are binary <tt>+</tt>, <tt>-</tt>, <tt>*</tt> and <tt>/</tt>
+ * between MDVectors and expressions (element-wise), <tt>*</tt> and
+ * <tt>/</tt> between expressions and scalars, and unary <tt>-</tt>.
+ *
+ * The engine, <tt>evaluateElementWise()</tt>, evaluates an expression
+ * one line at a time along the fastest axis, so that the inner loops
+ * can be vectorized, and partitions the data among threads in the
+ * same way as the other local kernels (see Domi_Threads.hpp).  If the
+ * target and all operands are contiguous, each partition is a single
+ * line.
+ */
+
+template< class Scalar > class MDVector;
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Binary operator that adds its arguments */
+template< class Scalar >
+struct PlusOp
+{
+  static inline Scalar apply(const Scalar & a,
+                             const Scalar & b) { return a + b; }
+};
+
+/** \brief Binary operator that subtracts its arguments */
+template< class Scalar >
+struct MinusOp
+{
+  static inline Scalar apply(const Scalar & a,
+                             const Scalar & b) { return a - b; }
+};
+
+/** \brief Binary operator that multiplies its arguments */
+template< class Scalar >
+struct TimesOp
+{
+  static inline Scalar apply(const Scalar & a,
+                             const Scalar & b) { return a * b; }
+};
+
+/** \brief Binary operator that divides its arguments */
+template< class Scalar >
+struct DivideOp
+{
+  static inline Scalar apply(const Scalar & a,
+                             const Scalar & b) { return a / b; }
+};
+
+/** \brief Unary operator that negates its argument */
+template< class Scalar >
+struct NegateOp
+{
+  static inline Scalar apply(const Scalar & a) { return -a; }
+};
+
+/** \brief Unary operator that returns the absolute value of its
+ *         argument
+ */
+template< class Scalar >
+struct AbsValueOp
+{
+  static inline Scalar apply(const Scalar & a) { return Scalar(std::abs(a)); }
+};
+
+/** \brief Unary operator that returns the reciprocal of its argument
+ */
+template< class Scalar >
+struct ReciprocalOp
+{
+  static inline Scalar apply(const Scalar & a)
+  {
+    return Teuchos::ScalarTraits< Scalar >::one() / a;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Expression that refers to the data of an MDVector
+ *
+ * Before evaluation, <tt>bind()</tt> extracts the raw pointer and
+ * strides of the MDVector data.  The strides are stored in a
+ * <tt>std::vector</tt> rather than a <tt>Teuchos::Array</tt>, so that
+ * a bound terminal can be copied concurrently by each thread.
+ */
+template< class Scalar >
+class ElementWiseTerminal
+{
+public:
+
+  /** \brief The scalar type of the expression */
+  typedef Scalar scalar_type;
+
+  /** \brief Constructor
+   *
+   * \param mdVector [in] the MDVector, which must outlive this
+   *        expression
+   */
+  ElementWiseTerminal(const MDVector< Scalar > & mdVector) :
+    _mdVector(&mdVector),
+    _base(0),
+    _strides(),
+    _line(0),
+    _stride(0)
+  {
+  }
+
+  /** \brief Bind the expression to the MDVector data
+   *
+   * \param includePadding [in] whether the data includes padding
+   *
+   * \param dims [in] the dimensions of the target data, which the
+   *        MDVector data must match
+   *
+   * \param layout [in] the layout of the target data
+   *
+   * \param contiguous [in/out] set to false if the MDVector data is
+   *        not contiguous
+   */
+  void bind(bool includePadding,
+            const Teuchos::ArrayView< const dim_type > & dims,
+            Layout layout,
+            bool & contiguous)
+  {
+    MDArrayView< const Scalar > data = _mdVector->getData(includePadding);
+    bool match = (data.numDims() == dims.size()) && (data.layout() == layout);
+    for (int axis = 0; match && axis < dims.size(); ++axis)
+      if (data.dimension(axis) != dims[axis]) match = false;
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      ! match,
+      InvalidArgument,
+      "MDVector operand has different local dimensions or layout than "
+      "the target MDVector");
+    _base = data.getRawPtr();
+    _strides.assign(data.strides().begin(), data.strides().end());
+    if (! isContiguous(dims, data.strides()(), layout)) contiguous = false;
+  }
+
+  /** \brief Start a line at the given index along the fastest axis
+   */
+  inline void start(const dim_type * index,
+                    int fastest)
+  {
+    size_type offset = 0;
+    for (int axis = 0; axis < int(_strides.size()); ++axis)
+      offset += index[axis] * _strides[axis];
+    _line   = _base + offset;
+    _stride = _strides[fastest];
+  }
+
+  /** \brief Start a line of contiguous data at the given offset
+   */
+  inline void start(size_type offset)
+  {
+    _line   = _base + offset;
+    _stride = 1;
+  }
+
+  /** \brief Return true if the current line has unit stride
+   */
+  inline bool unitStride() const { return _stride == 1; }
+
+  /** \brief Return the value of element i of the current line
+   */
+  inline Scalar operator[](size_type i) const { return _line[i*_stride]; }
+
+  /** \brief Return the value of element i of the current line,
+   *         assuming unit stride
+   */
+  inline Scalar unit(size_type i) const { return _line[i]; }
+
+private:
+
+  // The MDVector
+  const MDVector< Scalar > * _mdVector;
+
+  // Pointer to the first element of the bound data
+  const Scalar * _base;
+
+  // The strides of the bound data
+  std::vector< size_type > _strides;
+
+  // Pointer to the first element of the current line
+  const Scalar * _line;
+
+  // The stride of the current line
+  size_type _stride;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Expression that is a constant scalar
+ */
+template< class Scalar >
+class ElementWiseConstant
+{
+public:
+
+  /** \brief The scalar type of the expression */
+  typedef Scalar scalar_type;
+
+  /** \brief Constructor */
+  ElementWiseConstant(const Scalar & value) : _value(value) { }
+
+  /** \brief Bind the expression: there is nothing to bind */
+  void bind(bool includePadding,
+            const Teuchos::ArrayView< const dim_type > & dims,
+            Layout layout,
+            bool & contiguous) { }
+
+  /** \brief Start a line: there is nothing to start */
+  inline void start(const dim_type * index, int fastest) { }
+
+  /** \brief Start a contiguous line: there is nothing to start */
+  inline void start(size_type offset) { }
+
+  /** \brief A constant has unit stride */
+  inline bool unitStride() const { return true; }
+
+  /** \brief Return the constant */
+  inline Scalar operator[](size_type i) const { return _value; }
+
+  /** \brief Return the constant */
+  inline Scalar unit(size_type i) const { return _value; }
+
+private:
+
+  // The constant value
+  Scalar _value;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Expression that applies a binary operator to two
+ *         expressions
+ */
+template< class L, class R, class OP >
+class ElementWiseBinary
+{
+public:
+
+  /** \brief The scalar type of the expression */
+  typedef typename L::scalar_type scalar_type;
+
+  /** \brief Constructor */
+  ElementWiseBinary(const L & left, const R & right) :
+    _left(left),
+    _right(right)
+  {
+  }
+
+  /** \brief Bind both operands */
+  void bind(bool includePadding,
+            const Teuchos::ArrayView< const dim_type > & dims,
+            Layout layout,
+            bool & contiguous)
+  {
+    _left.bind(includePadding, dims, layout, contiguous);
+    _right.bind(includePadding, dims, layout, contiguous);
+  }
+
+  /** \brief Start a line in both operands */
+  inline void start(const dim_type * index, int fastest)
+  {
+    _left.start(index, fastest);
+    _right.start(index, fastest);
+  }
+
+  /** \brief Start a contiguous line in both operands */
+  inline void start(size_type offset)
+  {
+    _left.start(offset);
+    _right.start(offset);
+  }
+
+  /** \brief Return true if both operands have unit stride */
+  inline bool unitStride() const
+  {
+    return _left.unitStride() && _right.unitStride();
+  }
+
+  /** \brief Return the value of element i of the current line */
+  inline scalar_type operator[](size_type i) const
+  {
+    return OP::apply(_left[i], _right[i]);
+  }
+
+  /** \brief Return the value of element i of the current line,
+   *         assuming unit stride
+   */
+  inline scalar_type unit(size_type i) const
+  {
+    return OP::apply(_left.unit(i), _right.unit(i));
+  }
+
+private:
+
+  // The operands
+  L _left;
+  R _right;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Expression that applies a unary operator to an expression
+ */
+template< class E, class OP >
+class ElementWiseUnary
+{
+public:
+
+  /** \brief The scalar type of the expression */
+  typedef typename E::scalar_type scalar_type;
+
+  /** \brief Constructor */
+  ElementWiseUnary(const E & operand) : _operand(operand) { }
+
+  /** \brief Bind the operand */
+  void bind(bool includePadding,
+            const Teuchos::ArrayView< const dim_type > & dims,
+            Layout layout,
+            bool & contiguous)
+  {
+    _operand.bind(includePadding, dims, layout, contiguous);
+  }
+
+  /** \brief Start a line in the operand */
+  inline void start(const dim_type * index, int fastest)
+  {
+    _operand.start(index, fastest);
+  }
+
+  /** \brief Start a contiguous line in the operand */
+  inline void start(size_type offset) { _operand.start(offset); }
+
+  /** \brief Return true if the operand has unit stride */
+  inline bool unitStride() const { return _operand.unitStride(); }
+
+  /** \brief Return the value of element i of the current line */
+  inline scalar_type operator[](size_type i) const
+  {
+    return OP::apply(_operand[i]);
+  }
+
+  /** \brief Return the value of element i of the current line,
+   *         assuming unit stride
+   */
+  inline scalar_type unit(size_type i) const
+  {
+    return OP::apply(_operand.unit(i));
+  }
+
+private:
+
+  // The operand
+  E _operand;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Traits that convert MDVectors and expressions to expression
+ *         objects
+ *
+ * The primary template is empty, so that the operators below do not
+ * apply to types that are neither MDVectors nor expressions.
+ */
+template< class T >
+struct ElementWiseTraits
+{
+};
+
+/** \brief Traits of an MDVector operand */
+template< class Scalar >
+struct ElementWiseTraits< MDVector< Scalar > >
+{
+  typedef Scalar                        scalar_type;
+  typedef ElementWiseTerminal< Scalar > type;
+  static inline type convert(const MDVector< Scalar > & v) { return type(v); }
+};
+
+/** \brief Traits of a binary expression operand */
+template< class L, class R, class OP >
+struct ElementWiseTraits< ElementWiseBinary< L, R, OP > >
+{
+  typedef typename L::scalar_type        scalar_type;
+  typedef ElementWiseBinary< L, R, OP >  type;
+  static inline const type & convert(const type & e) { return e; }
+};
+
+/** \brief Traits of a unary expression operand */
+template< class E, class OP >
+struct ElementWiseTraits< ElementWiseUnary< E, OP > >
+{
+  typedef typename E::scalar_type     scalar_type;
+  typedef ElementWiseUnary< E, OP >   type;
+  static inline const type & convert(const type & e) { return e; }
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Element-wise sum of two MDVectors or expressions */
+template< class L, class R >
+inline
+ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                   typename ElementWiseTraits< R >::type,
+                   PlusOp< typename ElementWiseTraits< L >::scalar_type > >
+operator+(const L & left, const R & right)
+{
+  return ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                            typename ElementWiseTraits< R >::type,
+                            PlusOp< typename ElementWiseTraits< L >::scalar_type > >
+    (ElementWiseTraits< L >::convert(left),
+     ElementWiseTraits< R >::convert(right));
+}
+
+/** \brief Element-wise difference of two MDVectors or expressions */
+template< class L, class R >
+inline
+ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                   typename ElementWiseTraits< R >::type,
+                   MinusOp< typename ElementWiseTraits< L >::scalar_type > >
+operator-(const L & left, const R & right)
+{
+  return ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                            typename ElementWiseTraits< R >::type,
+                            MinusOp< typename ElementWiseTraits< L >::scalar_type > >
+    (ElementWiseTraits< L >::convert(left),
+     ElementWiseTraits< R >::convert(right));
+}
+
+/** \brief Element-wise product of two MDVectors or expressions */
+template< class L, class R >
+inline
+ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                   typename ElementWiseTraits< R >::type,
+                   TimesOp< typename ElementWiseTraits< L >::scalar_type > >
+operator*(const L & left, const R & right)
+{
+  return ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                            typename ElementWiseTraits< R >::type,
+                            TimesOp< typename ElementWiseTraits< L >::scalar_type > >
+    (ElementWiseTraits< L >::convert(left),
+     ElementWiseTraits< R >::convert(right));
+}
+
+/** \brief Element-wise quotient of two MDVectors or expressions */
+template< class L, class R >
+inline
+ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                   typename ElementWiseTraits< R >::type,
+                   DivideOp< typename ElementWiseTraits< L >::scalar_type > >
+operator/(const L & left, const R & right)
+{
+  return ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                            typename ElementWiseTraits< R >::type,
+                            DivideOp< typename ElementWiseTraits< L >::scalar_type > >
+    (ElementWiseTraits< L >::convert(left),
+     ElementWiseTraits< R >::convert(right));
+}
+
+/** \brief Product of a scalar and an MDVector or expression */
+template< class R >
+inline
+ElementWiseBinary< ElementWiseConstant< typename ElementWiseTraits< R >::scalar_type >,
+                   typename ElementWiseTraits< R >::type,
+                   TimesOp< typename ElementWiseTraits< R >::scalar_type > >
+operator*(const typename ElementWiseTraits< R >::scalar_type & left,
+          const R & right)
+{
+  typedef typename ElementWiseTraits< R >::scalar_type scalar_type;
+  return ElementWiseBinary< ElementWiseConstant< scalar_type >,
+                            typename ElementWiseTraits< R >::type,
+                            TimesOp< scalar_type > >
+    (ElementWiseConstant< scalar_type >(left),
+     ElementWiseTraits< R >::convert(right));
+}
+
+/** \brief Product of an MDVector or expression and a scalar */
+template< class L >
+inline
+ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                   ElementWiseConstant< typename ElementWiseTraits< L >::scalar_type >,
+                   TimesOp< typename ElementWiseTraits< L >::scalar_type > >
+operator*(const L & left,
+          const typename ElementWiseTraits< L >::scalar_type & right)
+{
+  typedef typename ElementWiseTraits< L >::scalar_type scalar_type;
+  return ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                            ElementWiseConstant< scalar_type >,
+                            TimesOp< scalar_type > >
+    (ElementWiseTraits< L >::convert(left),
+     ElementWiseConstant< scalar_type >(right));
+}
+
+/** \brief Quotient of an MDVector or expression and a scalar */
+template< class L >
+inline
+ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                   ElementWiseConstant< typename ElementWiseTraits< L >::scalar_type >,
+                   DivideOp< typename ElementWiseTraits< L >::scalar_type > >
+operator/(const L & left,
+          const typename ElementWiseTraits< L >::scalar_type & right)
+{
+  typedef typename ElementWiseTraits< L >::scalar_type scalar_type;
+  return ElementWiseBinary< typename ElementWiseTraits< L >::type,
+                            ElementWiseConstant< scalar_type >,
+                            DivideOp< scalar_type > >
+    (ElementWiseTraits< L >::convert(left),
+     ElementWiseConstant< scalar_type >(right));
+}
+
+/** \brief Negation of an MDVector or expression */
+template< class E >
+inline
+ElementWiseUnary< typename ElementWiseTraits< E >::type,
+                  NegateOp< typename ElementWiseTraits< E >::scalar_type > >
+operator-(const E & operand)
+{
+  return ElementWiseUnary< typename ElementWiseTraits< E >::type,
+                           NegateOp< typename ElementWiseTraits< E >::scalar_type > >
+    (ElementWiseTraits< E >::convert(operand));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line functor for <tt>walkLines()</tt> that evaluates a bound
+ *         expression along a line of strided data
+ */
+template< class T, class EXPR >
+struct EvaluateLineFunctor
+{
+  EvaluateLineFunctor(T * ptr,
+                      size_type stride,
+                      size_type length,
+                      int fast,
+                      EXPR & expr) :
+    _ptr(ptr), _stride(stride), _length(length), _fast(fast), _expr(expr) { }
+  void operator()(const dim_type * index, const size_type * offsets)
+  {
+    _expr.start(index, _fast);
+    T * a = _ptr + offsets[0];
+    if (_stride == 1 && _expr.unitStride())
+      for (size_type i = 0; i < _length; ++i)
+        a[i] = _expr.unit(i);
+    else
+      for (size_type i = 0; i < _length; ++i)
+        a[i*_stride] = _expr[i];
+  }
+  T *       _ptr;
+  size_type _stride;
+  size_type _length;
+  int       _fast;
+  EXPR &    _expr;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Evaluate a bound expression over a box of strided data,
+ *         using a single thread
+ *
+ * \param ptr [in] pointer to the first element of the target data
+ *
+ * \param strides [in] pointer to the strides of the target data
+ *
+ * \param numDims [in] the number of dimensions of the data
+ *
+ * \param start [in] pointer to the index of the first element of the
+ *        box
+ *
+ * \param dims [in] pointer to the dimensions of the box
+ *
+ * \param layout [in] the memory layout of the data
+ *
+ * \param contiguous [in] true if the target data and all of the
+ *        operands are contiguous, and the box is a contiguous range
+ *
+ * \param expr [in/out] the bound expression
+ */
+template< class T, class EXPR >
+void evaluateElementWiseLocal(T * ptr,
+                              const size_type * strides,
+                              int numDims,
+                              const dim_type * start,
+                              const dim_type * dims,
+                              Layout layout,
+                              bool contiguous,
+                              EXPR & expr)
+{
+  if (numDims == 0) return;
+  size_type size = 1;
+  for (int axis = 0; axis < numDims; ++axis) size *= dims[axis];
+  if (size == 0) return;
+
+  // Contiguous data is a single line
+  if (contiguous)
+  {
+    size_type offset = 0;
+    for (int axis = 0; axis < numDims; ++axis)
+      offset += start[axis] * strides[axis];
+    expr.start(offset);
+    T * a = ptr + offset;
+    for (size_type i = 0; i < size; ++i)
+      a[i] = expr.unit(i);
+    return;
+  }
+
+  // Evaluate the expression along each line of the box along the
+  // fastest axis
+  size_type offset = 0;
+  for (int axis = 0; axis < numDims; ++axis)
+    offset += start[axis] * strides[axis];
+  int first = (layout == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+  EvaluateLineFunctor< T, EXPR > functor(ptr + offset, strides[first],
+                                         dims[first], first, expr);
+  walkLines(numDims, start, dims, layout, 1, &strides, functor);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Evaluate a bound expression over strided data, using
+ *         multiple threads if available
+ *
+ * \param ptr [in] pointer to the first element of the target data
+ *
+ * \param strides [in] the strides of the target data
+ *
+ * \param dims [in] the dimensions of the target data
+ *
+ * \param layout [in] the memory layout of the data
+ *
+ * \param contiguous [in] true if the target data and all of the
+ *        operands are contiguous
+ *
+ * \param expr [in] the bound expression, which is copied for each
+ *        partition
+ */
+template< class T, class EXPR >
+void evaluateElementWise(T * ptr,
+                         const Teuchos::ArrayView< const size_type > & strides,
+                         const Teuchos::ArrayView< const dim_type > & dims,
+                         Layout layout,
+                         bool contiguous,
+                         const EXPR & expr)
+{
+  int numDims = dims.size();
+  const size_type * stridePtr = strides.getRawPtr();
+  int axis     = getPartitionAxis(dims, layout);
+  int numParts = getNumPartitions(dims, axis);
+  if (numParts == 1)
+  {
+    std::vector< dim_type > start(numDims, 0);
+    EXPR local(expr);
+    evaluateElementWiseLocal(ptr, stridePtr, numDims,
+                             numDims ? &start[0] : 0, dims.getRawPtr(),
+                             layout, contiguous, local);
+    return;
+  }
+
+  // Compute the starting index and dimensions of every partition
+  // before entering the parallel region
+  Teuchos::Array< dim_type > partDims;
+  Teuchos::Array< dim_type > partStarts;
+  getPartitions(dims, axis, numParts, partDims, partStarts);
+  Teuchos::Array< dim_type > starts(numParts * numDims, 0);
+  for (int part = 0; part < numParts; ++part)
+    starts[part*numDims+axis] = partStarts[part];
+  const dim_type * partDimPtr = partDims.getRawPtr();
+  const dim_type * startPtr   = starts.getRawPtr();
+#ifdef HAVE_DOMI_OPENMP
+#pragma omp parallel for schedule(static) num_threads(numParts)
+#endif
+  for (int part = 0; part < numParts; ++part)
+  {
+    EXPR local(expr);
+    evaluateElementWiseLocal(ptr, stridePtr, numDims,
+                             startPtr + part * numDims,
+                             partDimPtr + part * numDims,
+                             layout, contiguous, local);
+  }
+}
+
+}  // namespace Domi
+
+#endif
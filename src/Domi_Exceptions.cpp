@@ -102,4 +102,11 @@ BoundsError::BoundsError(std::string msg) :
 {
 }
 
+////////////////////////////////////////////////////////////////////////
+
+FileError::FileError(std::string msg) :
+  std::runtime_error(msg)
+{
+}
+
 }
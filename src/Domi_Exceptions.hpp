@@ -145,6 +145,18 @@ public:
   BoundsError(std::string msg);
 };
 
+/** \brief File Error exception type
+ */
+class FileError : public std::runtime_error
+{
+public:
+  /** \brief Constructor
+   *
+   * \param msg [in] Error message
+   */
+  FileError(std::string msg);
+};
+
 }
 
 #endif
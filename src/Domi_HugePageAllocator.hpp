@@ -0,0 +1,466 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_HUGEPAGEALLOCATOR_HPP
+#define DOMI_HUGEPAGEALLOCATOR_HPP
+
+// System includes
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <string>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Teuchos includes
+#include "Teuchos_ArrayRCP.hpp"
+#include "Teuchos_ParameterList.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+#include "Domi_MemoryPool.hpp"
+
+namespace Domi
+{
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Page type enumeration, used to request and to report the
+ *         kind of memory pages that back a data buffer.
+ */
+enum PageType
+{
+  /** \brief The standard pages of the operating system */
+  STANDARD_PAGES         = 0,
+  /** \brief Transparent huge pages, requested from the kernel with
+   *         <tt>madvise(MADV_HUGEPAGE)</tt> while transparent huge
+   *         pages are enabled */
+  TRANSPARENT_HUGE_PAGES = 1,
+  /** \brief Explicit huge pages from the reserved huge page pool,
+   *         mapped with <tt>MAP_HUGETLB</tt> */
+  EXPLICIT_HUGE_PAGES    = 2
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief The size, in bytes, of a huge page when the system does
+ *         not report one.
+ *
+ * This is the default huge page size on x86-64 and on most aarch64
+ * Linux systems.
+ */
+const size_type DEFAULT_HUGE_PAGE_BYTES = 2097152;
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Return the size, in bytes, of a huge page
+ *
+ * This is the "Hugepagesize" reported by /proc/meminfo, which is the
+ * size of the explicit huge pages mapped with <tt>MAP_HUGETLB</tt>,
+ * or <tt>DEFAULT_HUGE_PAGE_BYTES</tt> if it is not reported.  It is
+ * read once.  Huge page buffers are aligned to, and their lengths
+ * rounded up to, a multiple of this size.
+ */
+inline size_type getHugePageBytes()
+{
+  static size_type hugePageBytes = 0;
+  if (hugePageBytes == 0)
+  {
+    hugePageBytes = DEFAULT_HUGE_PAGE_BYTES;
+    std::ifstream meminfo("/proc/meminfo");
+    std::string line;
+    while (std::getline(meminfo, line))
+    {
+      if (line.compare(0, 13, "Hugepagesize:") != 0) continue;
+      std::istringstream fields(line.substr(13));
+      size_type kiloBytes = 0;
+      if ((fields >> kiloBytes) && kiloBytes > 0)
+        hugePageBytes = kiloBytes * 1024;
+      break;
+    }
+  }
+  return hugePageBytes;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Return true if the kernel backs memory advised with
+ *         <tt>madvise(MADV_HUGEPAGE)</tt> with transparent huge pages
+ *
+ * This is the case unless the mode selected in
+ * /sys/kernel/mm/transparent_hugepage/enabled is "never", or the
+ * kernel does not support transparent huge pages.
+ */
+inline bool transparentHugePagesEnabled()
+{
+  std::ifstream enabled("/sys/kernel/mm/transparent_hugepage/enabled");
+  std::string mode;
+  while (enabled >> mode)
+    if (mode[0] == '[') return (mode != "[never]");
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief An allocator of data buffers backed by huge pages
+ *
+ * Large local blocks that are accessed with large strides, along the
+ * slow axes of an <tt>MDArrayView</tt>, can spend a measurable amount
+ * of time on TLB misses when they are backed by standard pages.  A
+ * <tt>HugePageAllocator</tt> maps its buffers directly from the
+ * kernel and requests huge pages for them, either explicit huge pages
+ * from the reserved pool (<tt>EXPLICIT_HUGE_PAGES</tt>) or
+ * transparent huge pages (<tt>TRANSPARENT_HUGE_PAGES</tt>).  If
+ * explicit huge pages are not available, it falls back to transparent
+ * huge pages, and if those are not available, to standard pages.  The
+ * page type obtained for a buffer is returned by
+ * <tt>getPageType()</tt>.  Transparent huge pages are reported when
+ * the kernel accepted the advice to use them and they are enabled;
+ * the kernel may still back parts of the buffer with standard pages
+ * if it cannot find free huge pages when they are first touched.
+ *
+ * Buffers smaller than a minimum size are allocated with standard
+ * pages, since huge pages would waste most of their memory.  On
+ * systems other than Linux, all buffers use standard pages.
+ *
+ * The mapped memory is not touched when it is allocated, so the
+ * first write still determines its NUMA placement.  It is not
+ * constructed either, so T should be a type whose objects may be
+ * used without construction, such as the built-in scalar types.
+ *
+ * A <tt>HugePageAllocator</tt> is used like any other
+ * <tt>Allocator</tt>, within a <tt>MemoryArena</tt>, or directly, in
+ * which case its buffers may be handed to the non-owning view
+ * constructors of <tt>MDArrayRCP</tt>.  <tt>MDVector</tt> uses one
+ * when its "huge pages" parameter is given.
+ */
+template< class T >
+class HugePageAllocator : public Allocator< T >
+{
+public:
+
+  /** \brief Constructor
+   *
+   * \param pageType [in] the page type requested for new buffers
+   *
+   * \param minBytes [in] the size, in bytes, of the smallest buffer
+   *        for which huge pages are requested
+   */
+  HugePageAllocator(PageType pageType = TRANSPARENT_HUGE_PAGES,
+                    size_type minBytes = getHugePageBytes());
+
+  /** \brief Allocate a data buffer, backed by the requested page type
+   *         if it is available
+   *
+   * \param size [in] the number of elements in the buffer
+   */
+  Teuchos::ArrayRCP< T > allocate(size_type size);
+
+  /** \brief Return the page type requested for new buffers
+   */
+  PageType requestedPageType() const;
+
+  /** \brief Return the page type obtained for the most recent buffer
+   */
+  PageType lastPageType() const;
+
+  /** \brief Return the number of buffers allocated with the given
+   *         page type
+   *
+   * \param pageType [in] the page type
+   */
+  size_type numAllocations(PageType pageType) const;
+
+  /** \brief A one-line summary of the page types obtained
+   */
+  std::string description() const;
+
+  /** \brief Return the page type that backs a data buffer
+   *
+   * \param buffer [in] a buffer, or a view of a buffer, allocated by
+   *        a <tt>HugePageAllocator</tt>.  Any other buffer is
+   *        reported as using standard pages.
+   */
+  static PageType getPageType(const Teuchos::ArrayRCP< T > & buffer);
+
+private:
+
+  // The Teuchos::ArrayRCP deallocation policy for mapped buffers,
+  // which also records their page type
+  class Unmap
+  {
+  public:
+    typedef T ptr_t;
+    Unmap(size_type length, PageType pageType) :
+      _length(length), _pageType(pageType) { }
+    void free(T * ptr);
+    PageType pageType() const { return _pageType; }
+  private:
+    size_type _length;
+    PageType  _pageType;
+  };
+
+  // Map length bytes of explicit huge pages.  Return null on failure.
+  static void * mapExplicit(size_type length);
+
+  // Map length bytes aligned to a huge page, and advise the kernel
+  // to back them with transparent huge pages.  Set advised to true
+  // if the advice was accepted.  Return null on failure.
+  static void * mapTransparent(size_type length, bool & advised);
+
+  PageType  _requested;
+  size_type _minBytes;
+  PageType  _last;
+  size_type _numAllocations[3];
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Return the page type given by the "huge pages" parameter
+ *
+ * \param plist [in] a ParameterList that may contain "huge pages",
+ *        with value "None" (the default), "Transparent" or "Explicit"
+ */
+inline PageType getHugePagesParameter(Teuchos::ParameterList & plist)
+{
+  std::string hugePages = plist.get("huge pages", "None");
+  std::transform(hugePages.begin(), hugePages.end(), hugePages.begin(),
+                 ::toupper);
+  if (hugePages == "TRANSPARENT")
+    return TRANSPARENT_HUGE_PAGES;
+  else if (hugePages == "EXPLICIT")
+    return EXPLICIT_HUGE_PAGES;
+  return STANDARD_PAGES;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Return a new <tt>MemoryArena</tt> on a
+ *         <tt>HugePageAllocator</tt> for the given page type, or null
+ *         for standard pages
+ *
+ * \param pageType [in] the requested page type
+ */
+template< class T >
+Teuchos::RCP< MemoryArena< T > > createHugePageArena(PageType pageType)
+{
+  if (pageType == STANDARD_PAGES) return Teuchos::null;
+  Teuchos::RCP< Allocator< T > > allocator =
+    Teuchos::rcp(new HugePageAllocator< T >(pageType));
+  return Teuchos::rcp(new MemoryArena< T >(allocator));
+}
+
+/////////////////////
+// Implementations //
+/////////////////////
+
+template< class T >
+HugePageAllocator< T >::HugePageAllocator(PageType pageType,
+                                          size_type minBytes) :
+  _requested(pageType),
+  _minBytes(minBytes),
+  _last(STANDARD_PAGES)
+{
+  for (int i = 0; i < 3; ++i) _numAllocations[i] = 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+Teuchos::ArrayRCP< T >
+HugePageAllocator< T >::allocate(size_type size)
+{
+  if (size == 0) return Teuchos::ArrayRCP< T >();
+
+  size_type bytes = size * sizeof(T);
+  if (_requested != STANDARD_PAGES && bytes >= _minBytes)
+  {
+    // Round the length up to a whole number of huge pages, and try
+    // each page type in turn, starting with the one requested
+    size_type hugePageBytes = getHugePageBytes();
+    size_type length =
+      ((bytes + hugePageBytes - 1) / hugePageBytes) * hugePageBytes;
+    void * buffer = 0;
+    PageType obtained = STANDARD_PAGES;
+    if (_requested == EXPLICIT_HUGE_PAGES)
+    {
+      buffer = mapExplicit(length);
+      if (buffer) obtained = EXPLICIT_HUGE_PAGES;
+    }
+    if (buffer == 0)
+    {
+      bool advised = false;
+      buffer = mapTransparent(length, advised);
+      if (advised && transparentHugePagesEnabled())
+        obtained = TRANSPARENT_HUGE_PAGES;
+    }
+    if (buffer)
+    {
+      _last = obtained;
+      ++_numAllocations[obtained];
+      return Teuchos::arcp(static_cast< T* >(buffer), 0, size,
+                           Unmap(length, obtained), true);
+    }
+  }
+
+  _last = STANDARD_PAGES;
+  ++_numAllocations[STANDARD_PAGES];
+  return Teuchos::arcp< T >(size);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+PageType
+HugePageAllocator< T >::requestedPageType() const
+{
+  return _requested;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+PageType
+HugePageAllocator< T >::lastPageType() const
+{
+  return _last;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+size_type
+HugePageAllocator< T >::numAllocations(PageType pageType) const
+{
+  return _numAllocations[pageType];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+std::string
+HugePageAllocator< T >::description() const
+{
+  const char * names[3] = { "standard", "transparent", "explicit" };
+  std::stringstream result;
+  result << "Domi::HugePageAllocator: requested = " << names[_requested]
+         << ", standard = " << _numAllocations[STANDARD_PAGES]
+         << ", transparent = " << _numAllocations[TRANSPARENT_HUGE_PAGES]
+         << ", explicit = " << _numAllocations[EXPLICIT_HUGE_PAGES];
+  return result.str();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+PageType
+HugePageAllocator< T >::getPageType(const Teuchos::ArrayRCP< T > & buffer)
+{
+  Teuchos::Ptr< const Unmap > dealloc =
+    Teuchos::get_optional_dealloc< Unmap >(buffer);
+  if (dealloc.is_null()) return STANDARD_PAGES;
+  return dealloc->pageType();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+void *
+HugePageAllocator< T >::mapExplicit(size_type length)
+{
+#if defined(__linux__) && defined(MAP_HUGETLB)
+  void * buffer = mmap(0, length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (buffer != MAP_FAILED) return buffer;
+#endif
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+void *
+HugePageAllocator< T >::mapTransparent(size_type length,
+                                       bool & advised)
+{
+  advised = false;
+#if defined(__linux__)
+  // The kernel only backs huge page aligned regions with huge pages,
+  // so map an extra huge page and unmap the excess at either end
+  size_type hugePageBytes = getHugePageBytes();
+  size_type mapLength = length + hugePageBytes;
+  void * base = mmap(0, mapLength, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) return 0;
+  size_type head = (hugePageBytes -
+                    reinterpret_cast< std::size_t >(base) % hugePageBytes)
+                   % hugePageBytes;
+  size_type tail = mapLength - head - length;
+  char * buffer = static_cast< char* >(base) + head;
+  if (head > 0) munmap(base, head);
+  if (tail > 0) munmap(buffer + length, tail);
+#ifdef MADV_HUGEPAGE
+  advised = (madvise(buffer, length, MADV_HUGEPAGE) == 0);
+#endif
+  return buffer;
+#else
+  return 0;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+void
+HugePageAllocator< T >::Unmap::free(T * ptr)
+{
+#if defined(__linux__)
+  munmap(ptr, _length);
+#endif
+}
+
+}  // namespace Domi
+
+#endif
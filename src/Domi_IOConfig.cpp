@@ -0,0 +1,325 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+// System includes
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+
+// Teuchos includes
+#include "Teuchos_Time.hpp"
+
+// Domi includes
+#include "Domi_IOConfig.hpp"
+
+namespace Domi
+{
+
+////////////////////////////////////////////////////////////////////////
+
+// Set an integer hint from a parameter, if it is present and nonzero
+static void setIntHint(IOConfig & ioConfig,
+                       Teuchos::ParameterList & plist,
+                       const std::string & name,
+                       const std::string & key)
+{
+  int value = plist.get(name, int(0));
+  if (value == 0) return;
+  std::ostringstream os;
+  os << value;
+  ioConfig.setHint(key, os.str());
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Set a pair of ROMIO read and write hints from an "Automatic",
+// "Enable" or "Disable" parameter, if it is present and not
+// "Automatic"
+static void setSwitchHints(IOConfig & ioConfig,
+                           Teuchos::ParameterList & plist,
+                           const std::string & name,
+                           const std::string & prefix)
+{
+  std::string value = plist.get(name, "Automatic");
+  std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+  if (value == "automatic") return;
+  ioConfig.setHint(prefix + "_read" , value);
+  ioConfig.setHint(prefix + "_write", value);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+IOConfig::IOConfig() :
+  _hints(),
+  _timings()
+#ifdef HAVE_MPI
+  , _info(MPI_INFO_NULL),
+  _infoValid(false)
+#endif
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+IOConfig::IOConfig(Teuchos::ParameterList & plist) :
+  _hints(),
+  _timings()
+#ifdef HAVE_MPI
+  , _info(MPI_INFO_NULL),
+  _infoValid(false)
+#endif
+{
+  setIntHint(*this, plist, "striping factor"           , "striping_factor");
+  setIntHint(*this, plist, "striping unit"             , "striping_unit"  );
+  setIntHint(*this, plist, "collective buffering nodes", "cb_nodes"       );
+  setIntHint(*this, plist, "collective buffer size"    , "cb_buffer_size" );
+  setSwitchHints(*this, plist, "collective buffering", "romio_cb");
+  setSwitchHints(*this, plist, "data sieving"        , "romio_ds");
+
+  // Pass any other hints verbatim
+  if (plist.isSublist("hints"))
+  {
+    const Teuchos::ParameterList & hints = plist.sublist("hints");
+    for (Teuchos::ParameterList::ConstIterator it = hints.begin();
+         it != hints.end(); ++it)
+    {
+      std::ostringstream os;
+      os << hints.entry(it).getAny(false);
+      setHint(hints.name(it), os.str());
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+IOConfig::~IOConfig()
+{
+#ifdef HAVE_MPI
+  freeInfo();
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// The default configuration, constructed on first use
+static Teuchos::RCP< IOConfig > & defaultIOConfig()
+{
+  static Teuchos::RCP< IOConfig > ioConfig = Teuchos::rcp(new IOConfig);
+  return ioConfig;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Teuchos::RCP< IOConfig >
+IOConfig::getDefault()
+{
+  return defaultIOConfig();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+IOConfig::setDefault(const Teuchos::RCP< IOConfig > & ioConfig)
+{
+  defaultIOConfig() = ioConfig.is_null() ? Teuchos::rcp(new IOConfig) :
+                                           ioConfig;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+IOConfig::setHint(const std::string & key,
+                  const std::string & value)
+{
+  if (value.empty())
+    _hints.erase(key);
+  else
+    _hints[key] = value;
+#ifdef HAVE_MPI
+  freeInfo();
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+std::string
+IOConfig::getHint(const std::string & key) const
+{
+  std::map< std::string, std::string >::const_iterator it = _hints.find(key);
+  if (it == _hints.end()) return std::string();
+  return it->second;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const std::map< std::string, std::string > &
+IOConfig::getHints() const
+{
+  return _hints;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_MPI
+
+MPI_Info
+IOConfig::getInfo() const
+{
+  if (! _infoValid)
+  {
+    if (! _hints.empty())
+    {
+      MPI_Info_create(&_info);
+      for (std::map< std::string, std::string >::const_iterator it =
+             _hints.begin(); it != _hints.end(); ++it)
+      {
+        // MPI_Info_set() takes (incorrectly) non-const char*
+        // arguments in older MPI implementations
+        MPI_Info_set(_info, const_cast< char* >(it->first.c_str()),
+                     const_cast< char* >(it->second.c_str()));
+      }
+    }
+    _infoValid = true;
+  }
+  return _info;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+IOConfig::freeInfo() const
+{
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (_info != MPI_INFO_NULL && ! finalized) MPI_Info_free(&_info);
+  _info      = MPI_INFO_NULL;
+  _infoValid = false;
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+void
+IOConfig::recordTiming(const std::string & operation,
+                       double seconds,
+                       size_type bytes)
+{
+  Timing & timing = _timings[operation];
+  timing.calls   += 1;
+  timing.seconds += seconds;
+  timing.bytes   += bytes;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+IOConfig::Timing
+IOConfig::getTiming(const std::string & operation) const
+{
+  std::map< std::string, Timing >::const_iterator it =
+    _timings.find(operation);
+  if (it == _timings.end())
+  {
+    Timing timing = { 0, 0.0, 0 };
+    return timing;
+  }
+  return it->second;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const std::map< std::string, IOConfig::Timing > &
+IOConfig::getTimings() const
+{
+  return _timings;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+IOConfig::resetTimings()
+{
+  _timings.clear();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+IOConfig::printTimings(std::ostream & os) const
+{
+  for (std::map< std::string, Timing >::const_iterator it =
+         _timings.begin(); it != _timings.end(); ++it)
+  {
+    const Timing & timing = it->second;
+    double bandwidth = (timing.seconds > 0.0) ?
+      timing.bytes / timing.seconds * 1.0e-6 : 0.0;
+    os << std::setw(24) << std::left  << it->first
+       << std::setw(8)  << std::right << timing.calls << " calls "
+       << std::setw(12) << timing.seconds << " s "
+       << std::setw(14) << timing.bytes << " bytes "
+       << std::setw(12) << bandwidth << " MB/s" << std::endl;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+IOTimer::IOTimer(const Teuchos::RCP< IOConfig > & ioConfig,
+                 const std::string & operation,
+                 size_type bytes) :
+  _ioConfig(ioConfig),
+  _operation(operation),
+  _bytes(bytes),
+  _start(Teuchos::Time::wallTime())
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+IOTimer::~IOTimer()
+{
+  _ioConfig->recordTiming(_operation,
+                          Teuchos::Time::wallTime() - _start,
+                          _bytes);
+}
+
+}  // namespace Domi
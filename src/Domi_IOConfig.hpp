@@ -0,0 +1,257 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_IOCONFIG_HPP
+#define DOMI_IOCONFIG_HPP
+
+// System includes
+#include <map>
+#include <ostream>
+#include <string>
+
+// Teuchos includes
+#include "Teuchos_RCP.hpp"
+#include "Teuchos_ParameterList.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+
+namespace Domi
+{
+
+/** \brief Configuration and timing of Domi file input and output
+ *
+ * An <tt>IOConfig</tt> holds the MPI-IO hints that are passed, as an
+ * <tt>MPI_Info</tt> object, to every MPI file that Domi opens, and
+ * accumulates the number of calls, the time and the number of bytes
+ * of each kind of file operation, so that the hints can be tuned on
+ * real workloads.
+ *
+ * The hints can be set individually with <tt>setHint()</tt>, or from
+ * a ParameterList with the following parameters, which is the "I/O"
+ * sublist of the ParameterList of an <tt>MDVector</tt>:
+ *
+ * - "striping factor": the number of storage targets a new file is
+ *   striped over (hint "striping_factor")
+ * - "striping unit": the stripe size of a new file, in bytes (hint
+ *   "striping_unit")
+ * - "collective buffering nodes": the number of aggregators of
+ *   collective operations (hint "cb_nodes")
+ * - "collective buffer size": the buffer size of each aggregator, in
+ *   bytes (hint "cb_buffer_size")
+ * - "collective buffering": "Automatic", "Enable" or "Disable" (hints
+ *   "romio_cb_read" and "romio_cb_write")
+ * - "data sieving": "Automatic", "Enable" or "Disable" (hints
+ *   "romio_ds_read" and "romio_ds_write")
+ * - "hints": a sublist of any other hints, whose names and values are
+ *   passed to MPI verbatim
+ *
+ * Integer parameters with a value of zero are not passed to MPI, nor
+ * are string parameters with the value "Automatic".  Hints have no
+ * effect in serial builds, but the timings are recorded.
+ *
+ * MDVectors use the default <tt>IOConfig</tt>, returned by
+ * <tt>getDefault()</tt>, unless they are given their own.
+ */
+class IOConfig
+{
+public:
+
+  /** \brief The accumulated timing of one kind of file operation
+   */
+  struct Timing
+  {
+    /** \brief The number of calls */
+    int       calls;
+    /** \brief The total time, in seconds */
+    double    seconds;
+    /** \brief The total number of bytes transferred by this processor */
+    size_type bytes;
+  };
+
+  /** \brief Default constructor, with no hints
+   */
+  IOConfig();
+
+  /** \brief Constructor with ParameterList
+   *
+   * \param plist [in] ParameterList with the parameters described
+   *        above
+   */
+  IOConfig(Teuchos::ParameterList & plist);
+
+  /** \brief Destructor
+   */
+  ~IOConfig();
+
+  /** \brief Return the default configuration, used by MDVectors that
+   *         are not given their own
+   */
+  static Teuchos::RCP< IOConfig > getDefault();
+
+  /** \brief Replace the default configuration
+   *
+   * \param ioConfig [in] the new default configuration
+   */
+  static void setDefault(const Teuchos::RCP< IOConfig > & ioConfig);
+
+  /** \brief Set an MPI-IO hint
+   *
+   * \param key [in] the name of the hint
+   *
+   * \param value [in] the value of the hint.  If empty, the hint is
+   *        removed.
+   */
+  void setHint(const std::string & key,
+               const std::string & value);
+
+  /** \brief Return the value of an MPI-IO hint, or an empty string if
+   *         it is not set
+   *
+   * \param key [in] the name of the hint
+   */
+  std::string getHint(const std::string & key) const;
+
+  /** \brief Return all of the MPI-IO hints
+   */
+  const std::map< std::string, std::string > & getHints() const;
+
+#ifdef HAVE_MPI
+  /** \brief Return the MPI_Info object that holds the hints, or
+   *         MPI_INFO_NULL if there are none
+   *
+   * The MPI_Info object is owned by this <tt>IOConfig</tt>.
+   */
+  MPI_Info getInfo() const;
+#endif
+
+  /** \brief Add a call to the timing of a kind of file operation
+   *
+   * \param operation [in] the name of the operation
+   *
+   * \param seconds [in] the duration of the call
+   *
+   * \param bytes [in] the number of bytes transferred by this
+   *        processor
+   */
+  void recordTiming(const std::string & operation,
+                    double seconds,
+                    size_type bytes);
+
+  /** \brief Return the timing of a kind of file operation, which is
+   *         zero if there have been no calls
+   *
+   * \param operation [in] the name of the operation
+   */
+  Timing getTiming(const std::string & operation) const;
+
+  /** \brief Return the timings of all the kinds of file operation
+   */
+  const std::map< std::string, Timing > & getTimings() const;
+
+  /** \brief Clear the timings
+   */
+  void resetTimings();
+
+  /** \brief Print the timings, with the bandwidth of each kind of
+   *         operation, one per line
+   *
+   * \param os [in] the output stream
+   */
+  void printTimings(std::ostream & os) const;
+
+private:
+
+  std::map< std::string, std::string > _hints;
+  std::map< std::string, Timing >      _timings;
+
+#ifdef HAVE_MPI
+  // The MPI_Info object is built when it is first requested after the
+  // hints change
+  mutable MPI_Info _info;
+  mutable bool     _infoValid;
+  void freeInfo() const;
+#endif
+
+  // Not copyable
+  IOConfig(const IOConfig & source);
+  IOConfig & operator=(const IOConfig & source);
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Record the duration of a file operation in an
+ *         <tt>IOConfig</tt> when it goes out of scope
+ */
+class IOTimer
+{
+public:
+
+  /** \brief Constructor, which starts the timer
+   *
+   * \param ioConfig [in] the configuration to record the timing in
+   *
+   * \param operation [in] the name of the operation
+   *
+   * \param bytes [in] the number of bytes transferred by this
+   *        processor
+   */
+  IOTimer(const Teuchos::RCP< IOConfig > & ioConfig,
+          const std::string & operation,
+          size_type bytes);
+
+  /** \brief Destructor, which records the timing
+   */
+  ~IOTimer();
+
+private:
+
+  Teuchos::RCP< IOConfig > _ioConfig;
+  std::string              _operation;
+  size_type                _bytes;
+  double                   _start;
+};
+
+}  // namespace Domi
+
+#endif
@@ -0,0 +1,807 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_LOCALREDUCTIONS_HPP
+#define DOMI_LOCALREDUCTIONS_HPP
+
+// Standard includes
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+// Teuchos includes
+#include "Teuchos_ScalarTraitsDecl.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+#include "Domi_Threads.hpp"
+#include "Domi_MDArrayView.hpp"
+
+namespace Domi
+{
+
+/** \file Domi_LocalReductions.hpp
+ *
+ * \brief Kernels and an iteration engine for computing reductions of
+ *        the local data of multi-dimensional arrays
+ *
+ * The reductions in this file are structured as line kernels and an
+ * engine that applies them.  A line kernel is a class with an
+ * <tt>operator()</tt> that accumulates its reduction over a single
+ * line of data, given a pointer to its first element, a stride and a
+ * length.  The engine, <tt>applyLineKernel()</tt>, breaks an
+ * <tt>MDArrayView</tt> into lines along its fastest axis and calls
+ * the kernel on each line, walking the remaining (potentially
+ * strided) axes with nested loops.  If the <tt>MDArrayView</tt> is
+ * contiguous, the kernel is called once on the entire data buffer.
+ *
+ * The line kernels use multiple independent accumulators, so that the
+ * inner loops are free of loop-carried dependencies and can be
+ * vectorized by the compiler.  The summation kernels can optionally
+ * use compensated (Kahan-Babuska-Neumaier) summation to reduce
+ * round-off error, at the cost of additional floating point
+ * operations.
+ */
+
+/** \brief Add a value to a sum using compensated summation
+ *
+ * \param sum [in/out] the running sum
+ *
+ * \param compensation [in/out] the running compensation term, which
+ *        should be added to the sum when summation is complete
+ *
+ * \param value [in] the value to be added to the sum
+ */
+template< class T >
+inline void compensatedAdd(T & sum,
+                           T & compensation,
+                           const T & value)
+{
+  T t = sum + value;
+  if (std::abs(sum) >= std::abs(value))
+    compensation += (sum - t) + value;
+  else
+    compensation += (value - t) + sum;
+  sum = t;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Unary operator that returns its argument, for computing sums
+ */
+template< class Scalar >
+struct IdentityOp
+{
+  typedef Scalar result_type;
+  static inline result_type apply(const Scalar & a) { return a; }
+};
+
+/** \brief Unary operator that returns the magnitude of its argument,
+ *         for computing 1-norms
+ */
+template< class Scalar >
+struct AbsOp
+{
+  typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType result_type;
+  static inline result_type apply(const Scalar & a) { return std::abs(a); }
+};
+
+/** \brief Unary operator that returns the square of the magnitude of
+ *         its argument, for computing 2-norms
+ */
+template< class Scalar >
+struct AbsSquareOp
+{
+  typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType result_type;
+  static inline result_type apply(const Scalar & a)
+  {
+    result_type m = std::abs(a);
+    return m * m;
+  }
+};
+
+/** \brief Binary operator that returns the product of its arguments,
+ *         for computing dot products
+ */
+template< class Scalar >
+struct ProductOp
+{
+  typedef Scalar result_type;
+  static inline result_type apply(const Scalar & a,
+                                  const Scalar & b) { return a * b; }
+};
+
+/** \brief Binary operator that returns the square of its first
+ *         argument times its second argument, for computing weighted
+ *         norms
+ */
+template< class Scalar >
+struct WeightedSquareOp
+{
+  typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType result_type;
+  static inline result_type apply(const Scalar & a,
+                                  const Scalar & w) { return a * a * w; }
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line kernel that sums the result of an operator applied to
+ *         one or two lines of data
+ *
+ * The template parameter OP is expected to be one of the operator
+ * classes IdentityOp, AbsOp, AbsSquareOp (unary) or ProductOp,
+ * WeightedSquareOp (binary).  The sum is accumulated in four
+ * independent accumulators, which are combined by
+ * <tt>result()</tt>.
+ */
+template< class Scalar, class OP >
+class SumLineKernel
+{
+public:
+
+  /** \brief The type of the computed sum */
+  typedef typename OP::result_type result_type;
+
+  /** \brief Constructor
+   *
+   * \param compensated [in] if true, use compensated summation
+   */
+  SumLineKernel(bool compensated = false) :
+    _compensated(compensated)
+  {
+    for (int k = 0; k < 4; ++k)
+      _sum[k] = _comp[k] = 0;
+  }
+
+  /** \brief Accumulate the sum over a single line of data
+   *
+   * \param a [in] pointer to the first element of the line
+   *
+   * \param stride [in] stride between elements of the line
+   *
+   * \param n [in] number of elements in the line
+   */
+  inline void operator()(const Scalar * a,
+                         size_type stride,
+                         size_type n)
+  {
+    size_type i = 0;
+    if (_compensated)
+    {
+      for (; i + 3 < n; i += 4)
+        for (int k = 0; k < 4; ++k)
+          compensatedAdd(_sum[k], _comp[k], OP::apply(a[(i+k)*stride]));
+      for (; i < n; ++i)
+        compensatedAdd(_sum[0], _comp[0], OP::apply(a[i*stride]));
+    }
+    else if (stride == 1)
+    {
+      for (; i + 3 < n; i += 4)
+      {
+        _sum[0] += OP::apply(a[i  ]);
+        _sum[1] += OP::apply(a[i+1]);
+        _sum[2] += OP::apply(a[i+2]);
+        _sum[3] += OP::apply(a[i+3]);
+      }
+      for (; i < n; ++i)
+        _sum[0] += OP::apply(a[i]);
+    }
+    else
+    {
+      for (; i + 3 < n; i += 4)
+      {
+        _sum[0] += OP::apply(a[(i  )*stride]);
+        _sum[1] += OP::apply(a[(i+1)*stride]);
+        _sum[2] += OP::apply(a[(i+2)*stride]);
+        _sum[3] += OP::apply(a[(i+3)*stride]);
+      }
+      for (; i < n; ++i)
+        _sum[0] += OP::apply(a[i*stride]);
+    }
+  }
+
+  /** \brief Accumulate the sum over a pair of lines of data
+   *
+   * \param a [in] pointer to the first element of the first line
+   *
+   * \param aStride [in] stride between elements of the first line
+   *
+   * \param b [in] pointer to the first element of the second line
+   *
+   * \param bStride [in] stride between elements of the second line
+   *
+   * \param n [in] number of elements in each line
+   */
+  inline void operator()(const Scalar * a,
+                         size_type aStride,
+                         const Scalar * b,
+                         size_type bStride,
+                         size_type n)
+  {
+    size_type i = 0;
+    if (_compensated)
+    {
+      for (; i + 3 < n; i += 4)
+        for (int k = 0; k < 4; ++k)
+          compensatedAdd(_sum[k], _comp[k],
+                         OP::apply(a[(i+k)*aStride], b[(i+k)*bStride]));
+      for (; i < n; ++i)
+        compensatedAdd(_sum[0], _comp[0],
+                       OP::apply(a[i*aStride], b[i*bStride]));
+    }
+    else if (aStride == 1 && bStride == 1)
+    {
+      for (; i + 3 < n; i += 4)
+      {
+        _sum[0] += OP::apply(a[i  ], b[i  ]);
+        _sum[1] += OP::apply(a[i+1], b[i+1]);
+        _sum[2] += OP::apply(a[i+2], b[i+2]);
+        _sum[3] += OP::apply(a[i+3], b[i+3]);
+      }
+      for (; i < n; ++i)
+        _sum[0] += OP::apply(a[i], b[i]);
+    }
+    else
+    {
+      for (; i + 3 < n; i += 4)
+      {
+        _sum[0] += OP::apply(a[(i  )*aStride], b[(i  )*bStride]);
+        _sum[1] += OP::apply(a[(i+1)*aStride], b[(i+1)*bStride]);
+        _sum[2] += OP::apply(a[(i+2)*aStride], b[(i+2)*bStride]);
+        _sum[3] += OP::apply(a[(i+3)*aStride], b[(i+3)*bStride]);
+      }
+      for (; i < n; ++i)
+        _sum[0] += OP::apply(a[i*aStride], b[i*bStride]);
+    }
+  }
+
+  /** \brief Return the accumulated sum
+   */
+  inline result_type result() const
+  {
+    return ((_sum[0] + _comp[0]) + (_sum[1] + _comp[1])) +
+           ((_sum[2] + _comp[2]) + (_sum[3] + _comp[3]));
+  }
+
+  /** \brief Reset the accumulated sum to zero
+   */
+  inline void clear()
+  {
+    for (int k = 0; k < 4; ++k)
+      _sum[k] = _comp[k] = 0;
+  }
+
+  /** \brief Add the sum accumulated by another kernel to this sum
+   *
+   * \param other [in] the other kernel
+   */
+  inline void join(const SumLineKernel & other)
+  {
+    for (int k = 0; k < 4; ++k)
+    {
+      if (_compensated)
+        compensatedAdd(_sum[k], _comp[k], other._sum[k]);
+      else
+        _sum[k] += other._sum[k];
+      _comp[k] += other._comp[k];
+    }
+  }
+
+private:
+
+  // Flag for compensated summation
+  bool _compensated;
+
+  // Independent partial sums
+  result_type _sum[4];
+
+  // Compensation terms for each partial sum
+  result_type _comp[4];
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line kernel that computes the maximum magnitude of a line
+ *         of data
+ */
+template< class Scalar >
+class MaxAbsLineKernel
+{
+public:
+
+  /** \brief The type of the computed maximum */
+  typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType result_type;
+
+  /** \brief Constructor
+   */
+  MaxAbsLineKernel()
+  {
+    for (int k = 0; k < 4; ++k)
+      _max[k] = 0;
+  }
+
+  /** \brief Accumulate the maximum over a single line of data
+   *
+   * \param a [in] pointer to the first element of the line
+   *
+   * \param stride [in] stride between elements of the line
+   *
+   * \param n [in] number of elements in the line
+   */
+  inline void operator()(const Scalar * a,
+                         size_type stride,
+                         size_type n)
+  {
+    size_type i = 0;
+    for (; i + 3 < n; i += 4)
+    {
+      _max[0] = std::max(_max[0], result_type(std::abs(a[(i  )*stride])));
+      _max[1] = std::max(_max[1], result_type(std::abs(a[(i+1)*stride])));
+      _max[2] = std::max(_max[2], result_type(std::abs(a[(i+2)*stride])));
+      _max[3] = std::max(_max[3], result_type(std::abs(a[(i+3)*stride])));
+    }
+    for (; i < n; ++i)
+      _max[0] = std::max(_max[0], result_type(std::abs(a[i*stride])));
+  }
+
+  /** \brief Return the accumulated maximum
+   */
+  inline result_type result() const
+  {
+    return std::max(std::max(_max[0], _max[1]), std::max(_max[2], _max[3]));
+  }
+
+  /** \brief Reset the accumulated maximum to zero
+   */
+  inline void clear()
+  {
+    for (int k = 0; k < 4; ++k)
+      _max[k] = 0;
+  }
+
+  /** \brief Combine the maximum accumulated by another kernel with
+   *         this maximum
+   *
+   * \param other [in] the other kernel
+   */
+  inline void join(const MaxAbsLineKernel & other)
+  {
+    for (int k = 0; k < 4; ++k)
+      _max[k] = std::max(_max[k], other._max[k]);
+  }
+
+private:
+
+  // Independent partial maxima
+  result_type _max[4];
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line kernel that computes the sum, the sum of magnitudes,
+ *         the sum of squared magnitudes and the maximum magnitude of
+ *         a line of data in a single pass
+ *
+ * Local reductions are bound by memory bandwidth, so computing
+ * several of them in a single pass over the data costs little more
+ * than computing one.  This kernel provides the local contributions
+ * to the mean value, 1-norm, 2-norm and infinity-norm.
+ */
+template< class Scalar >
+class MultiLineKernel
+{
+public:
+
+  /** \brief The magnitude type */
+  typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType
+    magnitudeType;
+
+  /** \brief Constructor
+   *
+   * \param compensated [in] if true, use compensated summation
+   */
+  MultiLineKernel(bool compensated = false) :
+    _sum(compensated),
+    _absSum(compensated),
+    _absSquareSum(compensated),
+    _maxAbs()
+  {
+  }
+
+  /** \brief Accumulate the reductions over a single line of data
+   *
+   * \param a [in] pointer to the first element of the line
+   *
+   * \param stride [in] stride between elements of the line
+   *
+   * \param n [in] number of elements in the line
+   *
+   * The line is processed in blocks that fit in the L1 cache, and
+   * each block is passed to each of the component kernels in turn,
+   * so that the data is read from main memory only once.
+   */
+  inline void operator()(const Scalar * a,
+                         size_type stride,
+                         size_type n)
+  {
+    const size_type blockSize = 1024;
+    for (size_type start = 0; start < n; start += blockSize)
+    {
+      size_type length = std::min(blockSize, n - start);
+      const Scalar * block = a + start * stride;
+      _sum(block, stride, length);
+      _absSum(block, stride, length);
+      _absSquareSum(block, stride, length);
+      _maxAbs(block, stride, length);
+    }
+  }
+
+  /** \brief Return the sum of the values */
+  inline Scalar sum() const { return _sum.result(); }
+
+  /** \brief Return the sum of the magnitudes of the values */
+  inline magnitudeType absSum() const { return _absSum.result(); }
+
+  /** \brief Return the sum of the squared magnitudes of the values */
+  inline magnitudeType absSquareSum() const { return _absSquareSum.result(); }
+
+  /** \brief Return the maximum magnitude of the values */
+  inline magnitudeType maxAbs() const { return _maxAbs.result(); }
+
+  /** \brief Reset all of the reductions */
+  inline void clear()
+  {
+    _sum.clear();
+    _absSum.clear();
+    _absSquareSum.clear();
+    _maxAbs.clear();
+  }
+
+  /** \brief Join the reductions accumulated by another kernel with
+   *         these reductions
+   *
+   * \param other [in] the other kernel
+   */
+  inline void join(const MultiLineKernel & other)
+  {
+    _sum.join(other._sum);
+    _absSum.join(other._absSum);
+    _absSquareSum.join(other._absSquareSum);
+    _maxAbs.join(other._maxAbs);
+  }
+
+private:
+
+  // The component kernels
+  SumLineKernel< Scalar, IdentityOp< Scalar > >  _sum;
+  SumLineKernel< Scalar, AbsOp< Scalar > >       _absSum;
+  SumLineKernel< Scalar, AbsSquareOp< Scalar > > _absSquareSum;
+  MaxAbsLineKernel< Scalar >                     _maxAbs;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line functor for <tt>walkLines()</tt> that applies a line
+ *         kernel to each line of strided data
+ */
+template< class T, class KERNEL >
+struct KernelLineFunctor
+{
+  KernelLineFunctor(const T * ptr,
+                    size_type stride,
+                    size_type length,
+                    KERNEL & kernel) :
+    _ptr(ptr), _stride(stride), _length(length), _kernel(kernel) { }
+  void operator()(const dim_type *, const size_type * offsets)
+  {
+    _kernel(_ptr + offsets[0], _stride, _length);
+  }
+  const T * _ptr;
+  size_type _stride;
+  size_type _length;
+  KERNEL &  _kernel;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line functor for <tt>walkLines()</tt> that applies a binary
+ *         line kernel to each pair of lines of two sets of strided
+ *         data
+ */
+template< class T, class KERNEL >
+struct BinaryKernelLineFunctor
+{
+  BinaryKernelLineFunctor(const T * a,
+                          size_type aStride,
+                          const T * b,
+                          size_type bStride,
+                          size_type length,
+                          KERNEL & kernel) :
+    _a(a), _aStride(aStride), _b(b), _bStride(bStride), _length(length),
+    _kernel(kernel) { }
+  void operator()(const dim_type *, const size_type * offsets)
+  {
+    _kernel(_a + offsets[0], _aStride, _b + offsets[1], _bStride, _length);
+  }
+  const T * _a;
+  size_type _aStride;
+  const T * _b;
+  size_type _bStride;
+  size_type _length;
+  KERNEL &  _kernel;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Apply a line kernel to every line of strided data along its
+ *         fastest axis, using a single thread
+ *
+ * \param ptr [in] pointer to the first element of the data
+ *
+ * \param numDims [in] the number of dimensions of the data
+ *
+ * \param dims [in] pointer to the dimensions of the data
+ *
+ * \param strides [in] pointer to the strides of the data
+ *
+ * \param layout [in] the memory layout of the data
+ *
+ * \param kernel [in/out] the line kernel, which must provide
+ *        <tt>operator()(const T *, size_type, size_type)</tt>
+ */
+template< class T, class KERNEL >
+void applyLineKernelLocal(const T * ptr,
+                          int numDims,
+                          const dim_type * dims,
+                          const size_type * strides,
+                          Layout layout,
+                          KERNEL & kernel)
+{
+  if (numDims == 0) return;
+  size_type size = 1;
+  for (int axis = 0; axis < numDims; ++axis) size *= dims[axis];
+  if (size == 0) return;
+
+  // Contiguous data is a single line
+  if (isContiguous(numDims, dims, strides, layout))
+  {
+    kernel(ptr, 1, size);
+    return;
+  }
+
+  // Apply the kernel to each line along the fastest axis
+  int first = (layout == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+  KernelLineFunctor< T, KERNEL > functor(ptr, strides[first], dims[first],
+                                         kernel);
+  walkLines(numDims, 0, dims, layout, 1, &strides, functor);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Apply a binary line kernel to every pair of lines of two sets
+ *         of strided data along their fastest axis, using a single
+ *         thread
+ *
+ * \param a [in] pointer to the first element of the first data set
+ *
+ * \param aStrides [in] pointer to the strides of the first data set
+ *
+ * \param b [in] pointer to the first element of the second data set
+ *
+ * \param bStrides [in] pointer to the strides of the second data set
+ *
+ * \param numDims [in] the number of dimensions of both data sets
+ *
+ * \param dims [in] pointer to the dimensions of both data sets
+ *
+ * \param layout [in] the memory layout of both data sets
+ *
+ * \param kernel [in/out] the line kernel, which must provide
+ *        <tt>operator()(const T *, size_type, const T *, size_type,
+ *        size_type)</tt>
+ */
+template< class T, class KERNEL >
+void applyLineKernelLocal(const T * a,
+                          const size_type * aStrides,
+                          const T * b,
+                          const size_type * bStrides,
+                          int numDims,
+                          const dim_type * dims,
+                          Layout layout,
+                          KERNEL & kernel)
+{
+  if (numDims == 0) return;
+  size_type size = 1;
+  for (int axis = 0; axis < numDims; ++axis) size *= dims[axis];
+  if (size == 0) return;
+
+  // Contiguous data is a single line
+  if (isContiguous(numDims, dims, aStrides, layout) &&
+      isContiguous(numDims, dims, bStrides, layout))
+  {
+    kernel(a, 1, b, 1, size);
+    return;
+  }
+
+  // Apply the kernel to each pair of lines along the fastest axis
+  int first = (layout == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+  BinaryKernelLineFunctor< T, KERNEL > functor(a, aStrides[first],
+                                               b, bStrides[first],
+                                               dims[first], kernel);
+  const size_type * strides[2] = { aStrides, bStrides };
+  walkLines(numDims, 0, dims, layout, 2, strides, functor);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Apply a line kernel to every line of an MDArrayView along
+ *         its fastest axis
+ *
+ * \param a [in] the MDArrayView
+ *
+ * \param kernel [in/out] the line kernel, which must provide
+ *        <tt>operator()(const T *, size_type, size_type)</tt>,
+ *        <tt>clear()</tt> and <tt>join(const KERNEL &)</tt>
+ *
+ * If the data is large enough, or if deterministic reductions have
+ * been requested, it is partitioned along its outermost axis (see
+ * Domi_Threads.hpp).  Each partition is reduced by its own copy of
+ * the kernel, in parallel if threads are available, and the partial
+ * results are joined into the kernel in partition order.
+ */
+template< class T, class KERNEL >
+void applyLineKernel(const MDArrayView< T > & a,
+                     KERNEL & kernel)
+{
+  Teuchos::ArrayView< const dim_type > dims    = a.dimensions()();
+  Teuchos::ArrayView< const size_type > strides = a.strides()();
+  Layout layout = a.layout();
+  const T * ptr = a.getRawPtr();
+  int numDims = dims.size();
+  const size_type * stridePtr = strides.getRawPtr();
+
+  int axis     = getPartitionAxis(dims, layout);
+  int numParts = getNumPartitions(dims, axis, true);
+  if (numParts == 1)
+  {
+    applyLineKernelLocal(ptr, numDims, dims.getRawPtr(), stridePtr, layout,
+                         kernel);
+    return;
+  }
+
+  Teuchos::Array< dim_type > partDims;
+  Teuchos::Array< dim_type > partStarts;
+  getPartitions(dims, axis, numParts, partDims, partStarts);
+  const dim_type * partDimPtr   = partDims.getRawPtr();
+  const dim_type * partStartPtr = partStarts.getRawPtr();
+  Teuchos::Array< KERNEL > partials(numParts, kernel);
+  KERNEL * partialPtr = partials.getRawPtr();
+#ifdef HAVE_DOMI_OPENMP
+#pragma omp parallel for schedule(static) num_threads(std::min(numParts, getNumThreads()))
+#endif
+  for (int part = 0; part < numParts; ++part)
+  {
+    partialPtr[part].clear();
+    applyLineKernelLocal(ptr + partStartPtr[part] * stridePtr[axis], numDims,
+                         partDimPtr + part * numDims, stridePtr, layout,
+                         partialPtr[part]);
+  }
+  for (int part = 0; part < numParts; ++part)
+    kernel.join(partials[part]);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Apply a binary line kernel to every pair of lines of two
+ *         MDArrayViews along their fastest axis
+ *
+ * \param a [in] the first MDArrayView
+ *
+ * \param b [in] the second MDArrayView, which must have the same
+ *        dimensions and layout as the first
+ *
+ * \param kernel [in/out] the line kernel, which must provide
+ *        <tt>operator()(const T *, size_type, const T *, size_type,
+ *        size_type)</tt>, <tt>clear()</tt> and <tt>join(const KERNEL
+ *        &)</tt>
+ *
+ * The data is partitioned in the same way as for the unary version of
+ * <tt>applyLineKernel()</tt>.
+ */
+template< class T, class KERNEL >
+void applyLineKernel(const MDArrayView< T > & a,
+                     const MDArrayView< T > & b,
+                     KERNEL & kernel)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (a.dimensions() != b.dimensions()) || (a.layout() != b.layout()),
+    InvalidArgument,
+    "MDArrayViews a and b have different dimensions or layouts");
+  Teuchos::ArrayView< const dim_type > dims     = a.dimensions()();
+  Teuchos::ArrayView< const size_type > aStrides = a.strides()();
+  Teuchos::ArrayView< const size_type > bStrides = b.strides()();
+  Layout layout = a.layout();
+  const T * aPtr = a.getRawPtr();
+  const T * bPtr = b.getRawPtr();
+  int numDims = dims.size();
+  const size_type * aStridePtr = aStrides.getRawPtr();
+  const size_type * bStridePtr = bStrides.getRawPtr();
+
+  int axis     = getPartitionAxis(dims, layout);
+  int numParts = getNumPartitions(dims, axis, true);
+  if (numParts == 1)
+  {
+    applyLineKernelLocal(aPtr, aStridePtr, bPtr, bStridePtr, numDims,
+                         dims.getRawPtr(), layout, kernel);
+    return;
+  }
+
+  Teuchos::Array< dim_type > partDims;
+  Teuchos::Array< dim_type > partStarts;
+  getPartitions(dims, axis, numParts, partDims, partStarts);
+  const dim_type * partDimPtr   = partDims.getRawPtr();
+  const dim_type * partStartPtr = partStarts.getRawPtr();
+  Teuchos::Array< KERNEL > partials(numParts, kernel);
+  KERNEL * partialPtr = partials.getRawPtr();
+#ifdef HAVE_DOMI_OPENMP
+#pragma omp parallel for schedule(static) num_threads(std::min(numParts, getNumThreads()))
+#endif
+  for (int part = 0; part < numParts; ++part)
+  {
+    partialPtr[part].clear();
+    applyLineKernelLocal(aPtr + partStartPtr[part] * aStridePtr[axis],
+                         aStridePtr,
+                         bPtr + partStartPtr[part] * bStridePtr[axis],
+                         bStridePtr,
+                         numDims,
+                         partDimPtr + part * numDims,
+                         layout,
+                         partialPtr[part]);
+  }
+  for (int part = 0; part < numParts; ++part)
+    kernel.join(partials[part]);
+}
+
+}  // namespace Domi
+
+#endif
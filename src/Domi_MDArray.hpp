@@ -52,6 +52,7 @@
 // Domi includes
 #include "Domi_ConfigDefs.hpp"
 #include "Domi_Utils.hpp"
+#include "Domi_Threads.hpp"
 #include "Domi_MDIterator.hpp"
 #include "Domi_MDRevIterator.hpp"
 #include "Domi_MDArrayView.hpp"
@@ -985,12 +986,8 @@ MDArray< T >::MDArray(const MDArrayView< T > & source) :
   _ptr(_array.getRawPtr())
 {
   // Copy the values from the MDArrayView to the MDArray
-  iterator thisit = begin();
-  typename MDArrayView< T >::const_iterator srcit = source.cbegin();
-  for ( ; srcit != source.cend(); ++thisit, ++srcit)
-  {
-    *thisit = *srcit;
-  }
+  threadedCopy(source.getRawPtr(), source.strides()(), _ptr, _strides(),
+               source.dimensions()(), _layout);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1568,8 +1565,7 @@ template< typename T >
 void
 MDArray< T >::assign(const T & value)
 {
-  for (iterator it = begin(); it != end(); ++it)
-    *it = value;
+  threadedAssign(_ptr, _dimensions(), _strides(), _layout, value);
 }
 
 ////////////////////////////////////////////////////////////////////////
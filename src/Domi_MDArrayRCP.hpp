@@ -52,6 +52,8 @@
 // Domi includes
 #include "Domi_ConfigDefs.hpp"
 #include "Domi_Utils.hpp"
+#include "Domi_Threads.hpp"
+#include "Domi_MemoryPool.hpp"
 #include "Domi_MDArrayView.hpp"
 
 namespace Domi
@@ -242,6 +244,41 @@ public:
   MDArrayRCP(const Teuchos::ArrayView< dim_type > & dims,
              Layout layout);
 
+  /** \brief Constructor with dimensions, default value, storage
+   *  order flag and aligned storage flag.
+   *
+   * \param dims [in] An array that defines the lengths of each
+   *        dimension.  The most convenient way to specify dimensions
+   *        is with a Tuple returned by the non-member
+   *        <tt>Teuchos::tuple<T>()</tt> function.
+   *
+   * \param val [in] Default array fill value
+   *
+   * \param layout [in] Specifies the order data elements are stored
+   *        in memory
+   *
+   * \param aligned [in] If true, the base pointer of the data is
+   *        aligned to <tt>ALIGNED_STORAGE_BYTES</tt> and the stride
+   *        of the fastest-varying dimension is padded so that every
+   *        line of data along that dimension is aligned as well
+   *
+   * \param initialize [in] If false, the data is left
+   *        uninitialized, and val is ignored.  This allows the first
+   *        write to the memory to be made by the caller, for example
+   *        with <tt>threadedInitialize()</tt>.
+   *
+   * This constructor allocates new memory and takes ownership of it.
+   * The alignment padding is not part of the data: it is not visited
+   * by iterators or views, and <tt>dimensions()</tt> does not include
+   * it.  Use <tt>allocatedDimension()</tt> to obtain the padded
+   * length of the fastest-varying dimension.
+   */
+  MDArrayRCP(const Teuchos::ArrayView< dim_type > & dims,
+             const_reference val,
+             Layout layout,
+             bool aligned,
+             bool initialize = true);
+
   /** \brief Low-level view constructor
    *
    * \param dims [in] An array that defines the lengths of each
@@ -268,6 +305,32 @@ public:
              T * data,
              Layout layout = DEFAULT_ORDER);
 
+  /** \brief Low-level constructor with <tt>Teuchos::ArrayRCP</tt>
+   *  source, dimensions and strides
+   *
+   * \param array [in] <tt>Teuchos::ArrayRCP</tt> of the data buffer,
+   *        whose first element is the first element of the
+   *        MDArrayRCP
+   *
+   * \param dims [in] An array that defines the lengths of each
+   *        dimension.
+   *
+   * \param strides [in] An array that defines the data strides of
+   *        each dimension.
+   *
+   * \param layout [in] Specifies the order data elements are stored
+   *        in memory
+   *
+   * The <tt>MDArrayRCP</tt> shares ownership of the data buffer with
+   * the source.  This allows an <tt>MDArrayRCP</tt> to own a buffer
+   * with a custom deallocation policy, such as a memory mapped file,
+   * in which the data is embedded with larger strides.
+   */
+  MDArrayRCP(const Teuchos::ArrayRCP< T > & array,
+             const Teuchos::ArrayView< dim_type > & dims,
+             const Teuchos::ArrayView< size_type > & strides,
+             Layout layout = DEFAULT_ORDER);
+
   /** \brief Shallow copy constructor
    *
    * \param r_ptr [in] Source reference counted pointer
@@ -311,7 +374,28 @@ public:
    */
   inline dim_type dimension(int axis) const;
 
+  /** \brief Return the allocated length of the given axis
+   *
+   * \param axis [in] The axis being queried (0 for the first axis,
+   *        1 for the second axis, and so forth)
+   *
+   * This is the length of the given axis in the array that the data
+   * is embedded in, as given by the strides.  It is the same as
+   * <tt>dimension(axis)</tt>, except for the fastest-varying axis of
+   * aligned storage, where it includes the alignment padding, and for
+   * data embedded with larger strides.
+   */
+  inline dim_type allocatedDimension(int axis) const;
+
+  /** \brief Return true if this <tt>MDArrayRCP</tt> uses aligned
+   *  storage
+   */
+  inline bool isAligned() const;
+
   /** \brief Return the total size of the <tt>MDArrayRCP</tt>
+   *
+   * This is the number of data elements, which does not include the
+   * alignment padding of aligned storage.
    */
   inline size_type size() const;
 
@@ -750,6 +834,10 @@ public:
    *        dimension.  The most convenient way to specify dimensions
    *        is with a Tuple returned by the non-member
    *        <tt>Teuchos::tuple<T>()</tt> function.
+   *
+   * If the <tt>MDArrayRCP</tt> uses aligned storage, then new
+   * aligned storage is allocated and the existing data is not
+   * preserved.
    */
   void resize(const Teuchos::ArrayView< dim_type > & dims);
 
@@ -855,6 +943,19 @@ private:
   Teuchos::ArrayRCP< T >      _array;
   Layout                      _layout;
   pointer                     _ptr;
+  bool                        _aligned;
+
+  // Allocate, without initializing, aligned storage for the current
+  // dimensions and layout
+  void allocateAligned();
+
+  // Allocate, without initializing, a buffer using the current
+  // Allocator if there is one
+  static Teuchos::ArrayRCP< T > allocate(size_type size);
+
+  // Fill the data, including any alignment padding, with the given
+  // value using multiple threads if available
+  void initializeData(const_reference val);
 
   // Used for array bounds checking
   void assertAxis(int axis) const;
@@ -875,7 +976,8 @@ MDArrayRCP< T >::MDArrayRCP(Teuchos::ENull null_arg) :
   _strides(Teuchos::tuple< size_type >(1)), 
   _array(),
   _layout(DEFAULT_ORDER),
-  _ptr()
+  _ptr(),
+  _aligned(false)
 {
 }
 
@@ -889,7 +991,8 @@ MDArrayRCP< T >::MDArrayRCP(const Teuchos::ArrayView< T > & array,
   _strides(computeStrides< size_type, dim_type >(dims, layout)),
   _array(array.getRawPtr(), 0, array.size(), false),
   _layout(layout),
-  _ptr(_array.getRawPtr())
+  _ptr(_array.getRawPtr()),
+  _aligned(false)
 {
   TEUCHOS_TEST_FOR_EXCEPTION(array.size() < computeSize(dims),
 			     RangeError,
@@ -905,10 +1008,12 @@ MDArrayRCP< T >::MDArrayRCP(const Teuchos::ArrayView< dim_type > & dims,
 			    Layout layout) :
   _dimensions(dims),
   _strides(computeStrides< size_type, dim_type >(dims, layout)),
-  _array(computeSize(dims), val),
+  _array(allocate(computeSize(dims))),
   _layout(layout),
-  _ptr(_array.getRawPtr())
+  _ptr(_array.getRawPtr()),
+  _aligned(false)
 {
+  initializeData(val);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -918,10 +1023,37 @@ MDArrayRCP< T >::MDArrayRCP(const Teuchos::ArrayView< dim_type > & dims,
 			    Layout layout) :
   _dimensions(dims),
   _strides(computeStrides< size_type, dim_type >(dims, layout)),
-  _array(computeSize(dims)),
+  _array(allocate(computeSize(dims))),
   _layout(layout),
-  _ptr(_array.getRawPtr())
+  _ptr(_array.getRawPtr()),
+  _aligned(false)
 {
+  initializeData(T());
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< typename T >
+MDArrayRCP< T >::MDArrayRCP(const Teuchos::ArrayView< dim_type > & dims,
+			    const T & val,
+			    Layout layout,
+                            bool aligned,
+                            bool initialize) :
+  _dimensions(dims),
+  _strides(computeStrides< size_type, dim_type >(dims, layout)),
+  _array(),
+  _layout(layout),
+  _ptr(),
+  _aligned(aligned)
+{
+  if (_aligned)
+    allocateAligned();
+  else
+  {
+    _array = allocate(computeSize(dims));
+    _ptr   = _array.getRawPtr();
+  }
+  if (initialize) initializeData(val);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -935,8 +1067,30 @@ MDArrayRCP< T >::MDArrayRCP(const Teuchos::ArrayView< dim_type > & dims,
   _strides(strides),
   _array(data, 0, computeSize(dims, strides), false),
   _layout(layout),
-  _ptr(data)
+  _ptr(data),
+  _aligned(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< typename T >
+MDArrayRCP< T >::MDArrayRCP(const Teuchos::ArrayRCP< T > & array,
+                            const Teuchos::ArrayView< dim_type > & dims,
+                            const Teuchos::ArrayView< size_type > & strides,
+                            Layout layout) :
+  _dimensions(dims),
+  _strides(strides),
+  _array(array),
+  _layout(layout),
+  _ptr(array.getRawPtr()),
+  _aligned(false)
 {
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    computeSize(dims, strides) > array.size(),
+    RangeError,
+    "Teuchos::ArrayRCP size " << array.size() << " is too small for "
+    "dimensions " << dims << " and strides " << strides);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -947,7 +1101,8 @@ MDArrayRCP< T >::MDArrayRCP(const MDArrayRCP< T > & r_ptr) :
   _strides(r_ptr._strides),
   _array(r_ptr._array),
   _layout(r_ptr._layout),
-  _ptr(_array.getRawPtr())
+  _ptr(_array.getRawPtr()),
+  _aligned(r_ptr._aligned)
 {
 }
 
@@ -958,17 +1113,15 @@ MDArrayRCP< T >::MDArrayRCP(const MDArrayView< T > & source) :
   _dimensions(source.dimensions()),
   _strides(computeStrides< size_type, dim_type >(source.dimensions(),
                                                  source.layout())),
-  _array(computeSize(source.dimensions())),
+  _array(allocate(computeSize(source.dimensions()))),
   _layout(source.layout()),
-  _ptr(_array.getRawPtr())
+  _ptr(_array.getRawPtr()),
+  _aligned(false)
 {
-  // Copy the values from the MDArrayView to the MDArrayRCP
-  iterator thisit = begin();
-  typename MDArrayView< T >::const_iterator srcit = source.cbegin();
-  for ( ; srcit != source.cend(); ++thisit, ++srcit)
-  {
-    *thisit = *srcit;
-  }
+  // Copy the values from the MDArrayView to the MDArrayRCP, which is
+  // also the first touch of the new memory
+  threadedCopy(source.getRawPtr(), source.strides()(), _ptr, _strides(),
+               source.dimensions()(), _layout);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -989,6 +1142,7 @@ MDArrayRCP< T >::operator=(const MDArrayRCP< T > & r_ptr)
   _array      = r_ptr._array;
   _layout     = r_ptr._layout;
   _ptr        = r_ptr._ptr;
+  _aligned    = r_ptr._aligned;
   return *this;
 }
 
@@ -1024,11 +1178,39 @@ MDArrayRCP< T >::dimension(int axis) const
 
 ////////////////////////////////////////////////////////////////////////
 
+template< typename T >
+dim_type
+MDArrayRCP< T >::allocatedDimension(int axis) const
+{
+#ifdef HAVE_DOMI_ARRAY_BOUNDSCHECK
+  assertAxis(axis);
+#endif
+  // Every axis but the slowest has the length given by the ratio of
+  // the stride of the next slower axis to its own stride
+  int slower = (_layout == FIRST_INDEX_FASTEST) ? axis+1 : axis-1;
+  if (slower < 0 || slower >= numDims() || _strides[axis] == 0 ||
+      _strides[slower] % _strides[axis] != 0 ||
+      _strides[slower] / _strides[axis] < _dimensions[axis])
+    return _dimensions[axis];
+  return _strides[slower] / _strides[axis];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< typename T >
+bool
+MDArrayRCP< T >::isAligned() const
+{
+  return _aligned;
+}
+
+////////////////////////////////////////////////////////////////////////
+
 template< typename T >
 size_type
 MDArrayRCP< T >::size() const
 {
-  return _array.size();
+  return computeSize(_dimensions());
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1195,7 +1377,7 @@ template< typename T >
 MDArrayView< T >
 MDArrayRCP< T >::mdArrayView()
 {
-  return MDArrayView< T >(_array(), _dimensions, _layout);
+  return MDArrayView< T >(_array(), _dimensions, _strides, _layout);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1204,8 +1386,7 @@ template< typename T >
 const MDArrayView< T >
 MDArrayRCP< T >::mdArrayView() const
 {
-  Teuchos::Array< dim_type > dims(_dimensions);
-  return MDArrayView< T >(_array(), dims(), _layout);
+  return MDArrayView< T >(_array(), _dimensions, _strides, _layout);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1214,7 +1395,7 @@ template< typename T >
 MDArrayView< const T >
 MDArrayRCP< T >::mdArrayViewConst()
 {
-  return MDArrayView< const T >(_array(), _dimensions, _layout);
+  return MDArrayView< const T >(_array(), _dimensions, _strides, _layout);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1223,7 +1404,7 @@ template< typename T >
 const MDArrayView< const T >
 MDArrayRCP< T >::mdArrayViewConst() const
 {
-  return MDArrayView< const T >(_array(), _dimensions, _layout);
+  return MDArrayView< const T >(_array(), _dimensions, _strides, _layout);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1592,8 +1773,7 @@ template< typename T >
 void
 MDArrayRCP< T >::assign(const_reference value)
 {
-  for (iterator it = begin(); it != end(); ++it)
-    *it = value;
+  threadedAssign(_ptr, _dimensions(), _strides(), _layout, value);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1684,9 +1864,87 @@ void
 MDArrayRCP< T >::resize(const Teuchos::ArrayView< dim_type > & dims)
 {
   _dimensions.assign(dims.begin(), dims.end());
-  _strides = computeStrides< size_type, dim_type >(dims, _layout);
-  _array.resize(computeSize(dims));
-  _ptr = _array.getRawPtr();
+  Teuchos::ArrayRCP< T > oldArray = _array;
+  if (_aligned)
+    allocateAligned();
+  else
+  {
+    _strides = computeStrides< size_type, dim_type >(dims, _layout);
+    _array   = allocate(computeSize(dims));
+    _ptr     = _array.getRawPtr();
+  }
+  initializeData(T());
+
+  // Preserve the leading data of unaligned storage, as
+  // Teuchos::ArrayRCP::resize() does
+  if (! _aligned)
+  {
+    size_type common = std::min(_array.size(), oldArray.size());
+    for (size_type i = 0; i < common; ++i)
+      _ptr[i] = oldArray[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< typename T >
+void
+MDArrayRCP< T >::allocateAligned()
+{
+  _strides = computeAlignedStrides< size_type, dim_type >(_dimensions(),
+                                                          _layout,
+                                                          sizeof(T));
+  size_type size = 1;
+  for (int axis = 0; axis < _dimensions.size(); ++axis)
+    size *= allocatedDimension(axis);
+
+  // Over-allocate by enough elements to be able to shift the start of
+  // the data to an aligned address
+  size_type extra = ALIGNED_STORAGE_BYTES / sizeof(T);
+  Teuchos::ArrayRCP< T > buffer = allocate(size + extra);
+
+  // Compute the offset, in elements, of the first aligned address.
+  // If no element of the buffer falls on an aligned address, which
+  // can only happen for unusually sized types, the data is left
+  // unshifted.
+  std::size_t address = reinterpret_cast< std::size_t >(buffer.getRawPtr());
+  std::size_t misalignment = address % ALIGNED_STORAGE_BYTES;
+  size_type offset = 0;
+  if (misalignment && (ALIGNED_STORAGE_BYTES - misalignment) % sizeof(T) == 0)
+    offset = (ALIGNED_STORAGE_BYTES - misalignment) / sizeof(T);
+
+  _array = buffer.persistingView(offset, size);
+  _ptr   = _array.getRawPtr();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< typename T >
+Teuchos::ArrayRCP< T >
+MDArrayRCP< T >::allocate(size_type size)
+{
+  // The memory is not written here, so that it can be first touched
+  // by initializeData() or by a threaded copy
+  Teuchos::RCP< Allocator< T > > allocator = Allocator< T >::getCurrent();
+  if (allocator.is_null())
+    return Teuchos::arcp< T >(size);
+  return allocator->allocate(size);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< typename T >
+void
+MDArrayRCP< T >::initializeData(const_reference val)
+{
+  // Fill the allocated extents, including any alignment padding, with
+  // the same thread partitioning as the other local kernels, so that
+  // on a NUMA node each page is first touched by the thread that will
+  // later process it
+  Teuchos::Array< dim_type > allocDims(_dimensions.size());
+  for (int axis = 0; axis < _dimensions.size(); ++axis)
+    allocDims[axis] = allocatedDimension(axis);
+  threadedAssign(_ptr, allocDims(), _strides(), _layout, val);
 }
 
 ////////////////////////////////////////////////////////////////////////
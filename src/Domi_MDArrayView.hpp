@@ -56,6 +56,7 @@
 #include "Domi_ConfigDefs.hpp"
 #include "Domi_Exceptions.hpp"
 #include "Domi_Utils.hpp"
+#include "Domi_Threads.hpp"
 #include "Domi_Slice.hpp"
 #include "Domi_MDIterator.hpp"
 #include "Domi_MDRevIterator.hpp"
@@ -1412,8 +1413,7 @@ template< typename T >
 void
 MDArrayView< T >::assign(const T & value)
 {
-  for (iterator it = begin(); it != end(); ++it)
-    *it = value;
+  threadedAssign(_ptr, _dimensions(), _strides(), _layout, value);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -64,6 +64,15 @@ namespace Domi
  * those stride gaps by keeping an internal record of the multi-
  * dimensional index, and only iterating over valid indexes.
  *
+ * The iterator also maintains the offset of the current iterate
+ * into the data buffer, updating it incrementally as the index is
+ * incremented or decremented, so that dereferencing does not
+ * require a sum over all axes.  If the strides of the array indicate
+ * that its data is contiguous, the iterator does not update the
+ * multi-dimensional index at all and simply walks the offset
+ * linearly through the data buffer, which is equivalent to
+ * iterating with a raw pointer.
+ *
  * To apply MDIterator to all three multi-dimensional array types
  * (MDArray, MDArrayView and MDArrayRCP), the class is templated on
  * parameter class MDARRAY, which is intended to be any one of the
@@ -214,11 +223,11 @@ private:
 
   // A copy of the dimensions of the multi-dimensional array being
   // iterated
-  const Teuchos::Array< dim_type > _dimensions;
+  Teuchos::Array< dim_type > _dimensions;
 
   // A copy of the strides of the multi-dimensional array being
   // iterated
-  const Teuchos::Array< size_type > _strides;
+  Teuchos::Array< size_type > _strides;
 
   // A pointer to the data buffer of the multi-dimensional array
   // being iterated
@@ -228,6 +237,18 @@ private:
   // iterated
   Layout _layout;
 
+  // The total number of elements in the multi-dimensional array
+  // being iterated
+  size_type _size;
+
+  // Flag indicating that the multi-dimensional array being iterated
+  // is contiguous in memory, in which case only the offset is updated
+  // and the index is computed on demand
+  bool _contiguous;
+
+  // The offset of the current iterate into the data buffer
+  size_type _offset;
+
   // The multi-dimensional index of the current iterate
   Teuchos::Array< dim_type > _index;
 
@@ -246,6 +267,13 @@ private:
   // iterator.
   void assign_end_index();
 
+  // Initialize the _size and _contiguous attributes from the
+  // dimensions, strides and layout
+  void initialize_contiguity();
+
+  // Compute the offset of the current index from scratch
+  size_type compute_offset() const;
+
   // Assert that the given index is valid for the given axis
   void assert_index(dim_type i, int axis) const;
 
@@ -262,13 +290,15 @@ MDIterator< MDARRAY >::MDIterator(const MDARRAY & mdarray,
   _strides(mdarray._strides),
   _ptr(mdarray._ptr),
   _layout(mdarray._layout),
+  _offset(0),
   _index(mdarray.numDims())
 {
+  initialize_contiguity();
   if (end_index)
     assign_end_index();
   else
   {
-    if (computeSize(_dimensions) == 0)
+    if (_size == 0)
       assign_end_index();
     else
       _index.assign(_dimensions.size(), 0);
@@ -295,6 +325,8 @@ MDIterator(const MDARRAY & mdarray,
   for (_axis = 0; _axis < _index.size(); ++_axis)
     assert_index(_index[_axis], _axis);
 #endif
+  initialize_contiguity();
+  _offset = compute_offset();
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -305,6 +337,9 @@ MDIterator< MDARRAY >::MDIterator(const MDIterator< MDARRAY > & source) :
   _strides(source._strides),
   _ptr(source._ptr),
   _layout(source._layout),
+  _size(source._size),
+  _contiguous(source._contiguous),
+  _offset(source._offset),
   _index(source._index)
 {
 }
@@ -327,6 +362,9 @@ MDIterator< MDARRAY >::operator=(const MDIterator< MDARRAY > & source)
   _ptr        = source._ptr;
   _layout     = source._layout;
   _index      = source._index;
+  _size       = source._size;
+  _contiguous = source._contiguous;
+  _offset     = source._offset;
   return *this;
 }
 
@@ -338,6 +376,8 @@ MDIterator< MDARRAY >::operator==(const MDIterator< MDARRAY > & other) const
 {
   // If underlying MDARRAYs are different, then return not equal
   if (_ptr != other._ptr) return false;
+  // For contiguous data, the offset uniquely determines the iterate
+  if (_contiguous) return (_offset == other._offset);
   // If any of the current index values differ, then return not equal 
   for (_axis = 0; _axis < _index.size(); _axis++)
     if (_index[_axis] != other._index[_axis]) return false;
@@ -360,10 +400,7 @@ template< class MDARRAY >
 typename MDIterator< MDARRAY >::value_type &
 MDIterator< MDARRAY >::operator*()
 {
-  size_type offset = 0;
-  for (_axis=0; _axis < _index.size(); ++_axis)
-    offset += _index[_axis] * _strides[_axis];
-  return _ptr[offset];
+  return _ptr[_offset];
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -381,6 +418,13 @@ template< class MDARRAY >
 MDIterator< MDARRAY > &
 MDIterator< MDARRAY >::operator++()
 {
+  // Contiguous data: walk the offset linearly, stopping at the end
+  // offset
+  if (_contiguous)
+  {
+    if (_offset < _size) ++_offset;
+    return *this;
+  }
   if (_layout == FIRST_INDEX_FASTEST)
   {
     _axis = 0;
@@ -388,9 +432,11 @@ MDIterator< MDARRAY >::operator++()
     while (not _done)
     {
       _index[_axis]++;
+      _offset += _strides[_axis];
       _done = (_index[_axis] < _dimensions[_axis]);
       if (not _done)
       {
+        _offset -= _index[_axis] * _strides[_axis];
         _index[_axis] = 0;
         _axis++;
         if (_axis >= _index.size())
@@ -408,9 +454,11 @@ MDIterator< MDARRAY >::operator++()
     while (not _done)
     {
       _index[_axis]++;
+      _offset += _strides[_axis];
       _done = (_index[_axis] < _dimensions[_axis]);
       if (not _done)
       {
+        _offset -= _index[_axis] * _strides[_axis];
         _index[_axis] = 0;
         _axis--;
         if (_axis < 0)
@@ -441,6 +489,16 @@ template< class MDARRAY >
 MDIterator< MDARRAY > &
 MDIterator< MDARRAY >::operator--()
 {
+  // Contiguous data: walk the offset linearly, wrapping to the end
+  // offset when decrementing past the first element
+  if (_contiguous)
+  {
+    if (_offset == 0)
+      assign_end_index();
+    else
+      --_offset;
+    return *this;
+  }
   if (_layout == FIRST_INDEX_FASTEST)
   {
     _axis = 0;
@@ -448,10 +506,12 @@ MDIterator< MDARRAY >::operator--()
     while (not _done)
     {
       _index[_axis]--;
+      _offset -= _strides[_axis];
       _done = (_index[_axis] >= 0);
       if (not _done)
       {
         _index[_axis] = _dimensions[_axis] - 1;
+        _offset += _dimensions[_axis] * _strides[_axis];
         _axis++;
         if (_axis >= _index.size())
         {
@@ -468,10 +528,12 @@ MDIterator< MDARRAY >::operator--()
     while (not _done)
     {
       _index[_axis]--;
+      _offset -= _strides[_axis];
       _done = (_index[_axis] >= 0);
       if (not _done)
       {
         _index[_axis] = _dimensions[_axis] - 1;
+        _offset += _dimensions[_axis] * _strides[_axis];
         _axis--;
         if (_axis < 0)
         {
@@ -502,6 +564,13 @@ dim_type
 MDIterator< MDARRAY >::
 index(int axis) const
 {
+  // For contiguous data, the index is not maintained and must be
+  // computed from the offset
+  if (_contiguous)
+  {
+    if (_offset >= _size) return _dimensions[axis];
+    return (_offset / _strides[axis]) % _dimensions[axis];
+  }
   return _index[axis];
 }
 
@@ -527,6 +596,31 @@ MDIterator< MDARRAY >::assign_end_index()
   // index for that axis.
   for (int axis = 0; axis < _index.size(); ++axis)
     _index[axis] = _dimensions[axis];
+  // The end offset of contiguous data is one past the last element
+  _offset = _contiguous ? _size : compute_offset();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class MDARRAY >
+void
+MDIterator< MDARRAY >::initialize_contiguity()
+{
+  _size = computeSize(_dimensions);
+  _contiguous =
+    (_strides == computeStrides< size_type, dim_type >(_dimensions, _layout));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class MDARRAY >
+size_type
+MDIterator< MDARRAY >::compute_offset() const
+{
+  size_type offset = 0;
+  for (int axis = 0; axis < _index.size(); ++axis)
+    offset += _index[axis] * _strides[axis];
+  return offset;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -71,7 +71,8 @@ MDMap(const Teuchos::RCP< const MDComm > mdComm,
   _bndryPad(),
   _replicatedBoundary(createArrayOfInts(mdComm->numDims(),
                                         replicatedBoundary)),
-  _layout(layout)
+  _layout(layout),
+  _fingerprint(0)
 {
   // Temporarily store the number of dimensions
   int numDims = mdComm->numDims();
@@ -143,7 +144,8 @@ MDMap(Teuchos::ParameterList & plist) :
   _bndryPadSizes(),
   _bndryPad(),
   _replicatedBoundary(),
-  _layout()
+  _layout(),
+  _fingerprint(0)
 {
   // Note that the call to the MDComm constructor in the constructor
   // initialization list will validate the ParameterList, so we don't
@@ -261,7 +263,8 @@ MDMap(Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
   _bndryPadSizes(),
   _bndryPad(),
   _replicatedBoundary(),
-  _layout()
+  _layout(),
+  _fingerprint(0)
 {
   // Note that the call to the MDComm constructor in the constructor
   // initialization list will validate the ParameterList, so we don't
@@ -384,7 +387,8 @@ MDMap(Teuchos::RCP< const MDComm > mdComm,
   _bndryPadSizes(mdComm->numDims(), 0),
   _bndryPad(),
   _replicatedBoundary(),
-  _layout()
+  _layout(),
+  _fingerprint(0)
 {
   // Validate the ParameterList
   plist.validateParameters(*getValidParameters());
@@ -505,7 +509,8 @@ MDMap(const Teuchos::RCP< const MDComm > mdComm,
   _bndryPad(mdComm->numDims()),
   _replicatedBoundary(createArrayOfInts(mdComm->numDims(),
                                         replicatedBoundary)),
-  _layout(layout)
+  _layout(layout),
+  _fingerprint(0)
 {
   // Check that myGlobalBounds is the correct size
   int numDims = _mdComm->numDims();
@@ -670,7 +675,10 @@ MDMap(const MDMap & source) :
   _bndryPadSizes(source._bndryPadSizes),
   _bndryPad(source._bndryPad),
   _replicatedBoundary(source._replicatedBoundary),
-  _layout(source._layout)
+  _layout(source._layout),
+  _fingerprint(source._fingerprint),
+  _compatibleComms(source._compatibleComms),
+  _compatibleResults(source._compatibleResults)
 {
 }
 
@@ -697,7 +705,8 @@ MDMap(const MDMap & parent,
   _bndryPadSizes(),
   _bndryPad(),
   _replicatedBoundary(),
-  _layout(parent._layout)
+  _layout(parent._layout),
+  _fingerprint(0)
 {
   if (parent.onSubcommunicator())
   {
@@ -822,7 +831,8 @@ MDMap(const MDMap & parent,
   _bndryPadSizes(parent._bndryPadSizes),
   _bndryPad(parent._bndryPad),
   _replicatedBoundary(parent._replicatedBoundary),
-  _layout(parent._layout)
+  _layout(parent._layout),
+  _fingerprint(0)
 {
   if (parent.onSubcommunicator())
   {
@@ -1037,6 +1047,9 @@ MDMap::operator=(const MDMap & source)
   _bndryPadSizes    = source._bndryPadSizes;
   _bndryPad         = source._bndryPad;
   _layout           = source._layout;
+  _fingerprint      = source._fingerprint;
+  _compatibleComms  = source._compatibleComms;
+  _compatibleResults = source._compatibleResults;
   return *this;
 }
 
@@ -1197,6 +1210,59 @@ getLocalInteriorBounds(int axis) const
 
 ////////////////////////////////////////////////////////////////////////
 
+Slice
+MDMap::
+getLocalInteriorBounds(int axis,
+                       int width) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (width < 0),
+    InvalidArgument,
+    "width = " << width << " must be non-negative");
+  Slice interior = getLocalInteriorBounds(axis);
+  dim_type start = interior.start();
+  dim_type stop  = interior.stop();
+  if (_mdComm->getLowerNeighbor(axis) != -1)
+    start -= std::min(width, _pad[axis][0]);
+  if (_mdComm->getUpperNeighbor(axis) != -1)
+    stop  += std::min(width, _pad[axis][1]);
+  return ConcreteSlice(start, stop);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Slice
+MDMap::
+getLocalDeepInteriorBounds(int axis) const
+{
+  Slice interior = getLocalInteriorBounds(axis);
+  dim_type start = interior.start();
+  dim_type stop  = interior.stop();
+  if (_mdComm->getLowerNeighbor(axis) != -1) start += _commPadSizes[axis];
+  if (_mdComm->getUpperNeighbor(axis) != -1) stop  -= _commPadSizes[axis];
+  if (start > interior.stop() ) start = interior.stop();
+  if (stop  < start           ) stop  = start;
+  return ConcreteSlice(start, stop);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Teuchos::Array< Teuchos::Array< Slice > >
+MDMap::
+getLocalBoundaryShellBounds() const
+{
+  Teuchos::Array< Slice > interior(numDims());
+  Teuchos::Array< Slice > deepInterior(numDims());
+  for (int axis = 0; axis < numDims(); ++axis)
+  {
+    interior[axis]     = getLocalInteriorBounds(axis);
+    deepInterior[axis] = getLocalDeepInteriorBounds(axis);
+  }
+  return computeShellBounds(interior(), deepInterior());
+}
+
+////////////////////////////////////////////////////////////////////////
+
 bool
 MDMap::hasPadding() const
 {
@@ -1889,19 +1955,38 @@ MDMap::isCompatible(const MDMap & mdMap) const
   // on this processor, then they match on all processors
   if (this == &mdMap) return true;
 
-  // Check the number of dimensions.  Assume this check produces the
-  // same result on all processors
+  // Check the fingerprints.  These are the same on all processors
+  if (getFingerprint() != mdMap.getFingerprint()) return false;
+
+  // Guard against fingerprint collisions by checking the global
+  // structure directly.  These checks produce the same result on all
+  // processors
   int num_dims = numDims();
   if (num_dims != mdMap.numDims()) return false;
-
-  // Check the commDims.  Assume this check produces the same result
-  // on all processes
   for (int axis = 0; axis < num_dims; ++axis)
     if (getCommDim(axis) != mdMap.getCommDim(axis)) return false;
-
-  // Check the global dimensions.  Assume this check produces the same
-  // result on all processes
   if (_globalDims != mdMap._globalDims) return false;
+  for (int axis = 0; axis < num_dims; ++axis)
+    for (int index = 0; index < _globalRankBounds[axis].size(); ++index)
+    {
+      const Slice & bounds      = _globalRankBounds[axis][index];
+      const Slice & otherBounds = mdMap._globalRankBounds[axis][index];
+      if (bounds.stop() - bounds.start() !=
+          otherBounds.stop() - otherBounds.start()) return false;
+    }
+
+  // The local dimensions on each processor are determined by its axis
+  // processor indexes.  If both MDMaps share an MDComm, these are the
+  // same, and so the local dimensions match on all processors.
+  if (_mdComm.get() == mdMap._mdComm.get()) return true;
+
+  // Check for a cached result for the other MDComm.  The cache holds
+  // weak pointers, so an entry whose MDComm has been destroyed never
+  // matches, even if a new MDComm reuses its address.
+  for (int i = 0; i < _compatibleComms.size(); ++i)
+    if (_compatibleComms[i].is_valid_ptr() &&
+        _compatibleComms[i].get() == mdMap._mdComm.get())
+      return bool(_compatibleResults[i]);
 
   // Check the local dimensions.  This needs to be checked locally on
   // each processor and then the results communicated to obtain global
@@ -1917,12 +2002,65 @@ MDMap::isCompatible(const MDMap & mdMap) const
                      &localResult,
                      &globalResult);
 
-  // Return the result
+  // Drop the entries whose MDComm has been destroyed, and then cache
+  // and return the result
+  int numValid = 0;
+  for (int i = 0; i < _compatibleComms.size(); ++i)
+    if (_compatibleComms[i].is_valid_ptr())
+    {
+      _compatibleComms[numValid]   = _compatibleComms[i];
+      _compatibleResults[numValid] = _compatibleResults[i];
+      ++numValid;
+    }
+  _compatibleComms.resize(numValid);
+  _compatibleResults.resize(numValid);
+  _compatibleComms.push_back(mdMap._mdComm.create_weak());
+  _compatibleResults.push_back(globalResult);
   return bool(globalResult);
 }
 
 ////////////////////////////////////////////////////////////////////////
 
+size_type
+MDMap::
+getFingerprint() const
+{
+  if (_fingerprint == 0)
+  {
+    // Gather the global structure, which is the same on all
+    // processors
+    Teuchos::Array< dim_type > structure;
+    structure.push_back(numDims());
+    for (int axis = 0; axis < numDims(); ++axis)
+    {
+      structure.push_back(getCommDim(axis));
+      structure.push_back(_globalDims[axis]);
+    }
+    for (int axis = 0; axis < numDims(); ++axis)
+      for (int index = 0; index < _globalRankBounds[axis].size(); ++index)
+        structure.push_back(_globalRankBounds[axis][index].stop() -
+                            _globalRankBounds[axis][index].start());
+
+    // Compute an FNV-1a hash of the structure, reserving zero to
+    // indicate that the fingerprint has not been computed
+    unsigned long long hash = 14695981039346656037ULL;
+    for (int i = 0; i < structure.size(); ++i)
+    {
+      unsigned long long value = structure[i];
+      for (int byte = 0; byte < 8; ++byte)
+      {
+        hash ^= (value >> (8 * byte)) & 0xff;
+        hash *= 1099511628211ULL;
+      }
+    }
+    _fingerprint = size_type(hash);
+    if (_fingerprint == 0) _fingerprint = 1;
+  }
+  return _fingerprint;
+}
+
+////////////////////////////////////////////////////////////////////////
+
 bool
 MDMap::isSameAs(const MDMap & mdMap,
                         const int verbose) const
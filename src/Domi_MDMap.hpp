@@ -575,6 +575,57 @@ public:
    */
   Slice getLocalInteriorBounds(int axis) const;
 
+  /** \brief Get the local interior loop bounds along the specified
+   *         axis, extended into the communication padding
+   *
+   * \param axis [in] the index of the axis (from zero to the number
+   *        of dimensions - 1)
+   *
+   * \param width [in] the number of points by which the local
+   *        interior is extended into the communication padding on
+   *        each side that has a neighboring processor.  It is clipped
+   *        to the communication pad size.
+   *
+   * These bounds support temporal blocking: if the communication
+   * padding is updated to a width of k*r, then k sweeps of a stencil
+   * of radius r can be performed before the next update, with sweep s
+   * (from 1 to k) computed over the local interior extended by
+   * (k-s)*r.
+   */
+  Slice getLocalInteriorBounds(int axis,
+                               int width) const;
+
+  /** \brief Get the local deep interior loop bounds along the
+   *         specified axis
+   *
+   * \param axis [in] the index of the axis (from zero to the number
+   *        of dimensions - 1)
+   *
+   * The local deep interior loop bounds are the local interior loop
+   * bounds, shrunk by the communication pad size on each side that
+   * has a neighboring processor.  A stencil whose radius does not
+   * exceed the communication pad size can therefore be applied over
+   * the deep interior without reading the communication padding, and
+   * thus before the communication padding is updated.
+   *
+   * The loop bounds are returned in the form of a <tt>Slice</tt>, in
+   * which the <tt>start()</tt> method returns the loop begin value,
+   * and the <tt>stop()</tt> method returns the non-inclusive end
+   * value.
+   */
+  Slice getLocalDeepInteriorBounds(int axis) const;
+
+  /** \brief Get the local loop bounds of the boundary shell
+   *
+   * The boundary shell is the local interior minus the local deep
+   * interior.  It is returned as an array of disjoint boxes, each of
+   * which is an array of <tt>Slice</tt>s, one per axis, giving the
+   * loop bounds of the box.  Together with the local deep interior
+   * bounds, these boxes exactly cover the local interior.
+   */
+  Teuchos::Array< Teuchos::Array< Slice > >
+  getLocalBoundaryShellBounds() const;
+
   //@}
 
   /** \name Storage order, communication and boundary padding */
@@ -860,9 +911,28 @@ public:
    *   <li> Their local dimensions, not including padding, are
    *        identical.</li>
    * <ol>
+   *
+   * This method does not communicate when the MDMaps share an MDComm
+   * or differ in their global structure, as given by
+   * <tt>getFingerprint()</tt>.  Otherwise, the local dimensions are
+   * compared with a reduction, whose result is cached for the other
+   * MDMap's MDComm.  It must therefore be called on all processors.
    */
   bool isCompatible(const MDMap & mdMap) const;
 
+  /** \brief Return a fingerprint of the global structure of this
+   *         MDMap
+   *
+   * The fingerprint is a hash of the number of dimensions, the
+   * commDims, the global dimensions and the bounds of every axis
+   * processor along every axis.  Since all of these are known on
+   * every processor, the fingerprint is the same on every processor
+   * and is computed without communication, the first time it is
+   * requested.  MDMaps with different fingerprints are not
+   * compatible.
+   */
+  size_type getFingerprint() const;
+
   /** \brief True if two MDMaps are "identical"
    *
    * \param mdMap [in] MDMap to compare against
@@ -999,6 +1069,22 @@ private:
   // requested by the user.
   mutable Teuchos::Array< Teuchos::RCP< const MDMap > > _axisMaps;
 
+  // A hash of the global structure of this MDMap, or zero if it has
+  // not been computed yet.  It is mutable because it is logically
+  // const but does not get computed until requested.
+  mutable size_type _fingerprint;
+
+  // The MDComms of other MDMaps with the same global structure, for
+  // which compatibility has been determined by communication, and
+  // the results.  Since the global structure is the same, the result
+  // depends only on the two MDComms, so it can be reused without
+  // communication.  The MDComms are held by weak pointers, so that
+  // the cache does not keep them alive.  These members are mutable
+  // because they are a cache for the logically const isCompatible()
+  // method.
+  mutable Teuchos::Array< Teuchos::RCP< const MDComm > > _compatibleComms;
+  mutable Teuchos::Array< int > _compatibleResults;
+
 #ifdef HAVE_EPETRA
   // An RCP pointing to an Epetra_Map that is equivalent to this
   // MDMap, including communication padding.  It is mutable because we
@@ -65,6 +65,15 @@ namespace Domi
  * record of the multi- dimensional index, and only iterating over
  * valid indexes.
  *
+ * The iterator also maintains the offset of the current iterate
+ * into the data buffer, updating it incrementally as the index is
+ * incremented or decremented, so that dereferencing does not
+ * require a sum over all axes.  If the strides of the array indicate
+ * that its data is contiguous, the iterator does not update the
+ * multi-dimensional index at all and simply walks the offset
+ * linearly through the data buffer, which is equivalent to
+ * iterating with a raw pointer.
+ *
  * To apply MDRevIterator to all three multi-dimensional array types
  * (MDArray, MDArrayView and MDArrayRCP), the class is templated on
  * parameter class MDARRAY, which is intended to be any one of the
@@ -213,11 +222,11 @@ private:
 
   // A copy of the dimensions of the multi-dimensional array being
   // reverse iterated
-  const Teuchos::Array< dim_type > _dimensions;
+  Teuchos::Array< dim_type > _dimensions;
 
   // A copy of the strides of the multi-dimensional array being
   // reverse iterated
-  const Teuchos::Array< size_type > _strides;
+  Teuchos::Array< size_type > _strides;
 
   // A pointer to the data buffer of the multi-dimensional array
   // being reverse iterated
@@ -227,6 +236,18 @@ private:
   // reverse iterated
   Layout _layout;
 
+  // The total number of elements in the multi-dimensional array
+  // being reverse iterated
+  size_type _size;
+
+  // Flag indicating that the multi-dimensional array being reverse
+  // iterated is contiguous in memory, in which case only the offset
+  // is updated and the index is computed on demand
+  bool _contiguous;
+
+  // The offset of the current reverse iterate into the data buffer
+  size_type _offset;
+
   // The multi-dimensional index of the current reverse iterate
   Teuchos::Array< dim_type > _index;
 
@@ -248,6 +269,13 @@ private:
   // reverse iterator.
   void assign_end_index();
 
+  // Initialize the _size and _contiguous attributes from the
+  // dimensions, strides and layout
+  void initialize_contiguity();
+
+  // Compute the offset of the current index from scratch
+  size_type compute_offset() const;
+
   // Assert that the given index is valid for the given axis
   void assert_index(dim_type i, int axis) const;
 
@@ -264,13 +292,15 @@ MDRevIterator< MDARRAY >::MDRevIterator(const MDARRAY & mdarray,
   _strides(mdarray._strides),
   _ptr(mdarray._ptr),
   _layout(mdarray._layout),
+  _offset(0),
   _index(mdarray.numDims())
 {
+  initialize_contiguity();
   if (end_index)
     assign_end_index();
   else
   {
-    if (computeSize(_dimensions) == 0)
+    if (_size == 0)
       assign_end_index();
     else
       assign_begin_index();
@@ -297,6 +327,8 @@ MDRevIterator(const MDARRAY & mdarray,
   for (_axis = 0; _axis < _index.size(); ++_axis)
     assert_index(_index[_axis], _axis);
 #endif
+  initialize_contiguity();
+  _offset = compute_offset();
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -308,6 +340,9 @@ MDRevIterator(const MDRevIterator< MDARRAY > & source) :
   _strides(source._strides),
   _ptr(source._ptr),
   _layout(source._layout),
+  _size(source._size),
+  _contiguous(source._contiguous),
+  _offset(source._offset),
   _index(source._index)
 {
 }
@@ -330,6 +365,9 @@ MDRevIterator< MDARRAY >::operator=(const MDRevIterator< MDARRAY > & source)
   _ptr        = source._ptr;
   _layout     = source._layout;
   _index      = source._index;
+  _size       = source._size;
+  _contiguous = source._contiguous;
+  _offset     = source._offset;
   return *this;
 }
 
@@ -342,6 +380,8 @@ operator==(const MDRevIterator< MDARRAY > & other) const
 {
   // If underlying MDARRAYs are different, then return not equal
   if (_ptr != other._ptr) return false;
+  // For contiguous data, the offset uniquely determines the iterate
+  if (_contiguous) return (_offset == other._offset);
   // If any of the current index values differ, then return not equal 
   for (_axis = 0; _axis < _index.size(); _axis++)
     if (_index[_axis] != other._index[_axis]) return false;
@@ -365,10 +405,7 @@ template< class MDARRAY >
 typename MDRevIterator< MDARRAY >::value_type &
 MDRevIterator< MDARRAY >::operator*()
 {
-  size_type offset = 0;
-  for (_axis=0; _axis < _index.size(); ++_axis)
-    offset += _index[_axis] * _strides[_axis];
-  return _ptr[offset];
+  return _ptr[_offset];
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -386,6 +423,13 @@ template< class MDARRAY >
 MDRevIterator< MDARRAY > &
 MDRevIterator< MDARRAY >::operator++()
 {
+  // Contiguous data: walk the offset linearly backwards, stopping at
+  // the end offset
+  if (_contiguous)
+  {
+    if (_offset >= 0) --_offset;
+    return *this;
+  }
   if (_layout == FIRST_INDEX_FASTEST)
   {
     _axis = 0;
@@ -393,10 +437,12 @@ MDRevIterator< MDARRAY >::operator++()
     while (not _done)
     {
       _index[_axis]--;
+      _offset -= _strides[_axis];
       _done = (_index[_axis] >= 0);
       if (not _done)
       {
         _index[_axis] = _dimensions[_axis] - 1;
+        _offset += _dimensions[_axis] * _strides[_axis];
         _axis++;
         if (_axis >= _index.size())
         {
@@ -413,10 +459,12 @@ MDRevIterator< MDARRAY >::operator++()
     while (not _done)
     {
       _index[_axis]--;
+      _offset -= _strides[_axis];
       _done = (_index[_axis] >= 0);
       if (not _done)
       {
         _index[_axis] = _dimensions[_axis] - 1;
+        _offset += _dimensions[_axis] * _strides[_axis];
         _axis--;
         if (_axis < 0)
         {
@@ -446,6 +494,13 @@ template< class MDARRAY >
 MDRevIterator< MDARRAY > &
 MDRevIterator< MDARRAY >::operator--()
 {
+  // Contiguous data: walk the offset linearly forwards, wrapping to
+  // the end offset when decrementing past the last element
+  if (_contiguous)
+  {
+    if (++_offset >= _size) assign_end_index();
+    return *this;
+  }
   if (_layout == FIRST_INDEX_FASTEST)
   {
     _axis = 0;
@@ -453,9 +508,11 @@ MDRevIterator< MDARRAY >::operator--()
     while (not _done)
     {
       _index[_axis]++;
+      _offset += _strides[_axis];
       _done = (_index[_axis] < _dimensions[_axis]);
       if (not _done)
       {
+        _offset -= _index[_axis] * _strides[_axis];
         _index[_axis] = 0;
         _axis++;
         if (_axis >= _index.size())
@@ -473,9 +530,11 @@ MDRevIterator< MDARRAY >::operator--()
     while (not _done)
     {
       _index[_axis]++;
+      _offset += _strides[_axis];
       _done = (_index[_axis] < _dimensions[_axis]);
       if (not _done)
       {
+        _offset -= _index[_axis] * _strides[_axis];
         _index[_axis] = 0;
         _axis--;
         if (_axis < 0)
@@ -507,6 +566,13 @@ dim_type
 MDRevIterator< MDARRAY >::
 index(int axis) const
 {
+  // For contiguous data, the index is not maintained and must be
+  // computed from the offset
+  if (_contiguous)
+  {
+    if (_offset < 0) return -1;
+    return (_offset / _strides[axis]) % _dimensions[axis];
+  }
   return _index[axis];
 }
 
@@ -530,6 +596,7 @@ MDRevIterator< MDARRAY >::assign_begin_index()
   for (int axis = 0;
        axis < _index.size(); ++axis)
     _index[axis] = _dimensions[axis] - 1;
+  _offset = compute_offset();
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -542,6 +609,31 @@ MDRevIterator< MDARRAY >::assign_end_index()
   for (int axis = 0;
        axis < _index.size(); ++axis)
     _index[axis] = -1;
+  // The end offset of contiguous data is one before the first element
+  _offset = _contiguous ? -1 : compute_offset();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class MDARRAY >
+void
+MDRevIterator< MDARRAY >::initialize_contiguity()
+{
+  _size = computeSize(_dimensions);
+  _contiguous =
+    (_strides == computeStrides< size_type, dim_type >(_dimensions, _layout));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class MDARRAY >
+size_type
+MDRevIterator< MDARRAY >::compute_offset() const
+{
+  size_type offset = 0;
+  for (int axis = 0; axis < _index.size(); ++axis)
+    offset += _index[axis] * _strides[axis];
+  return offset;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -47,11 +47,23 @@
 
 // Standard includes
 #include <ctime>
+#include <algorithm>
+#include <limits>
+#include <utility>
 
 // Domi includes
 #include "Domi_ConfigDefs.hpp"
 #include "Domi_MDMap.hpp"
 #include "Domi_MDArrayRCP.hpp"
+#include "Domi_HugePageAllocator.hpp"
+#include "Domi_MappedFile.hpp"
+#include "Domi_AsyncWrite.hpp"
+#include "Domi_IOConfig.hpp"
+#include "Domi_ChunkedFile.hpp"
+#include "Domi_Subfiling.hpp"
+#include "Domi_LocalReductions.hpp"
+#include "Domi_PackUnpack.hpp"
+#include "Domi_ElementWise.hpp"
 
 // Teuchos includes
 #include "Teuchos_DataAccess.hpp"
@@ -89,6 +101,11 @@ using std::endl;
 namespace Domi
 {
 
+// Forward declarations of the time-series classes, which write and
+// read MDVectors with their cached file data types
+template< class Scalar > class TimeSeriesWriter;
+template< class Scalar > class TimeSeriesReader;
+
 /** \brief Multi-dimensional distributed vector
  *
  * The <tt>MDVector</tt> class is intended to perform the functions of
@@ -170,6 +187,109 @@ namespace Domi
  * axis)</tt> methods can be called.  Note that the message data
  * structures needed to coordinate these methods are stored
  * internally.
+ *
+ * Since the pattern of communication padding messages for a given
+ * <tt>MDVector</tt> never changes, the user may call
+ * <tt>setPersistentCommPad(true)</tt> to have the messages set up
+ * once as persistent MPI requests, which are then simply restarted
+ * each time the communication padding is updated.  This reduces the
+ * per-update overhead, which can be significant for small local
+ * domains.
+ *
+ * Communication padding messages are normally sent and received in
+ * place, described by MPI subarray data types.  Since some MPI
+ * implementations handle such data types poorly, especially for
+ * regions with large strides, <tt>setPackedCommPad()</tt> can be used
+ * to instead pack the messages along a given axis into pre-allocated
+ * contiguous buffers.
+ *
+ * By default, <tt>updateCommPad()</tt> updates one axis at a time,
+ * which requires one round of message latency per axis.  The
+ * <tt>setCommPadStrategy()</tt> method can be used to instead update
+ * all axes at once, either for faces only (<tt>ALL_FACES</tt>), or
+ * for faces, edges and corners (<tt>ALL_NEIGHBORS</tt>), the latter
+ * of which uses messages to and from diagonal neighbors and is
+ * suitable for stencils that access corner points.  The
+ * <tt>startUpdateCommPad()</tt> and <tt>endUpdateCommPad()</tt>
+ * methods provide asynchronous versions of these all-axes updates.
+ *
+ * The local interior can be split into a deep interior, which does
+ * not depend on the communication padding for stencils no wider than
+ * the communication pad, and a boundary shell, given by
+ * <tt>getLocalDeepInteriorBounds()</tt> and
+ * <tt>getLocalBoundaryShellBounds()</tt>.  The
+ * <tt>updateCommPadAndApply()</tt> method uses these regions to apply
+ * a user kernel to the deep interior while the communication padding
+ * is being updated.
+ *
+ * The local data may be kept in aligned storage, either with the
+ * "aligned storage" parameter or the <tt>setAlignedStorage()</tt>
+ * method.  The data buffer is then aligned to
+ * <tt>ALIGNED_STORAGE_BYTES</tt>, and the stride of the
+ * fastest-varying dimension is padded so that every line of the
+ * buffer, including its padding, starts on an aligned address.  The
+ * lines of owned data along the fastest-varying dimension start at
+ * the lower pad, so they are aligned only when the lower pad of that
+ * dimension is a multiple of the vector width,
+ * <tt>ALIGNED_STORAGE_BYTES / sizeof(Scalar)</tt> elements.  Only
+ * then can compilers use aligned vector loads on the owned data in
+ * stencil loops.  The alignment padding is excluded from the
+ * communication padding messages and from binary I/O.
+ *
+ * The data buffer of a new MDVector is obtained from the current
+ * <tt>Allocator</tt>, if there is one.  Work vectors that are
+ * constructed and destroyed repeatedly on the same MDMap can recycle
+ * their buffers by being constructed within a <tt>MemoryArena</tt> on
+ * a <tt>MemoryPool</tt>; see Domi_MemoryPool.hpp.
+ *
+ * Large local blocks may be backed by huge pages, which reduces the
+ * TLB misses of strided access along the slow axes, with the "huge
+ * pages" parameter ("Transparent" or "Explicit").  If the requested
+ * pages are not available, the data falls back to the next kind, and
+ * <tt>getPageType()</tt> reports the kind obtained; see
+ * Domi_HugePageAllocator.hpp.
+ *
+ * The data may also be backed by a memory mapping of a file written
+ * by <tt>writeBinary()</tt>, with <tt>mapBinary()</tt>, so that only
+ * the pages of the file that are accessed are read.  This allows
+ * analysis tools to open large fields without reading them in full.
+ *
+ * Output with <tt>writeBinary()</tt> blocks until the data is
+ * written.  <tt>startWriteBinary()</tt> instead copies the local data
+ * to a staging buffer and returns an <tt>AsyncWrite</tt> handle while
+ * the write proceeds in the background, so that computation can
+ * continue during the output of a checkpoint.
+ *
+ * Successive snapshots of one or more MDVectors can be written to a
+ * single file, which is kept open between snapshots, with a
+ * <tt>TimeSeriesWriter</tt>, and read back at any step with a
+ * <tt>TimeSeriesReader</tt>; see Domi_TimeSeries.hpp.
+ *
+ * Besides the raw format of <tt>writeBinary()</tt>, an MDVector can
+ * be written to a self-describing, chunked format with
+ * <tt>writeChunked()</tt>, whose header records the scalar type,
+ * dimensions and layout, and from which a new MDVector can be
+ * constructed with <tt>readMDVector()</tt>; see
+ * Domi_ChunkedFile.hpp.
+ *
+ * At large processor counts, where writing a single shared file is
+ * limited by lock contention in the file system, an MDVector can
+ * instead be written with <tt>writeSubfiles()</tt> to one subfile
+ * per node, aggregated by one processor of each node, and a small
+ * manifest.  <tt>readSubfiles()</tt> reads them back for any
+ * decomposition; see Domi_Subfiling.hpp.
+ *
+ * The data of an MDVector can be moved to an MDVector on an MDMap
+ * with a different decomposition or padding, without writing it to
+ * a file, with a reusable <tt>Redistributor</tt>; see
+ * Domi_Redistributor.hpp.
+ *
+ * The MPI-IO hints used by all of the binary I/O methods, such as the
+ * file striping and collective buffering, can be given with the
+ * "I/O" sublist of the ParameterList constructors or with
+ * <tt>setIOConfig()</tt>.  The same <tt>IOConfig</tt> records the
+ * number of calls, time and bytes of each I/O operation, so that the
+ * effect of the hints can be measured; see Domi_IOConfig.hpp.
  */
 template< class Scalar >
 class MDVector : public Teuchos::Describable
@@ -184,7 +304,10 @@ public:
    * \param mdMap [in] MDMap that describes the domain decomposition
    *        of this MDVector
    *
-   * \param zeroOut [in] flag to initialize all data to zero
+   * \param zeroOut [in] flag to initialize all data to zero.  If
+   *        false, the data is left uninitialized, so that it can be
+   *        first touched by a threaded initialization such as
+   *        <tt>initialize()</tt> or <tt>putScalar()</tt>.
    */
   MDVector(const Teuchos::RCP< const MDMap > & mdMap,
            bool zeroOut = true);
@@ -202,7 +325,8 @@ public:
    *        used to provide additional degrees of freedom at each
    *        index defined by the MDMap
    *
-   * \param zeroOut [in] flag to initialize all data to zero
+   * \param zeroOut [in] flag to initialize all data to zero.  If
+   *        false, the data is left uninitialized.
    *
    * If leadingDim or trailingDim is less than 2, then the MDMap will
    * not be augmented with a leading dimension or trailing dimension,
@@ -536,6 +660,47 @@ public:
    */
   inline Slice getLocalInteriorBounds(int axis) const;
 
+  /** \brief Get the local interior looping bounds along the specified
+   *         axis, extended into the communication padding
+   *
+   * \param axis [in] the index of the axis (from zero to the number
+   *        of dimensions - 1)
+   *
+   * \param width [in] the number of points by which the local
+   *        interior is extended into the communication padding on
+   *        each side that has a neighboring processor, clipped to the
+   *        communication pad size
+   *
+   * After <tt>updateCommPadWidth(k*r)</tt>, sweep s (from 1 to k) of
+   * a stencil of radius r can be computed over
+   * <tt>getLocalInteriorBounds(axis, (k-s)*r)</tt>.
+   */
+  inline Slice getLocalInteriorBounds(int axis,
+                                      int width) const;
+
+  /** \brief Get the local deep interior looping bounds along the
+   *         specified axis
+   *
+   * \param axis [in] the index of the axis (from zero to the number
+   *        of dimensions - 1)
+   *
+   * Local deep interior loop bounds are the local interior loop
+   * bounds, shrunk by the communication pad size on each side that
+   * has a neighboring processor.  A stencil whose radius does not
+   * exceed the communication pad size does not read the communication
+   * padding when applied over the local deep interior.
+   */
+  inline Slice getLocalDeepInteriorBounds(int axis) const;
+
+  /** \brief Get the local looping bounds of the boundary shell
+   *
+   * The boundary shell is the local interior minus the local deep
+   * interior, returned as an array of disjoint boxes, each of which
+   * is an array of <tt>Slice</tt>s, one per axis.
+   */
+  inline Teuchos::Array< Teuchos::Array< Slice > >
+  getLocalBoundaryShellBounds() const;
+
   /** \brief Return true if there is any padding stored locally
    *
    * Note that it is not as simple as whether there were communication
@@ -639,7 +804,8 @@ public:
    * MDMVector will generally be non-contiguous, with some exceptions.
    * There are cases where some local data is contiguous and some is
    * not, but this method returns True only if all processes' local
-   * data is contiguous.
+   * data is contiguous.  An MDVector that uses aligned storage is
+   * always considered non-contiguous.
    */
   inline bool isContiguous() const;
 
@@ -867,6 +1033,36 @@ public:
    */
   MDArrayView< const Scalar > getUpperPadData(int axis) const;
 
+  /** \brief Set whether the data is stored in aligned storage
+   *
+   * \param aligned [in] if true, the local data buffer is reallocated
+   *        so that its base pointer is aligned to
+   *        <tt>ALIGNED_STORAGE_BYTES</tt> and the stride of the
+   *        fastest-varying dimension is padded to a multiple of the
+   *        vector width.  If false, the data is stored contiguously.
+   *
+   * The data values are preserved.  The alignment padding is not part
+   * of the data: it is ignored by the communication padding updates
+   * and by <tt>writeBinary()</tt> and <tt>readBinary()</tt>.  Because
+   * the data is reallocated, this method cannot be called on a
+   * sub-vector, and existing sub-vectors and views of this MDVector
+   * will no longer refer to its data.  The same setting should be
+   * used on all processors.
+   */
+  void setAlignedStorage(bool aligned);
+
+  /** \brief Return true if the data is stored in aligned storage
+   */
+  inline bool getAlignedStorage() const;
+
+  /** \brief Return the type of the memory pages that back the data
+   *
+   * This is the page type actually obtained, which may differ from
+   * the one requested with the "huge pages" parameter if huge pages
+   * were not available, or if the data is too small to use them.
+   */
+  PageType getPageType() const;
+
   //@}
 
   /** \name Mathematical methods */
@@ -875,17 +1071,29 @@ public:
   /** \brief Compute the dot product of this MDVector and MDVector a
    *
    * \param a [in] partner MDVector for performing dot product
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contribution to the dot product
    */
   Scalar
-  dot(const MDVector< Scalar > & a) const;
+  dot(const MDVector< Scalar > & a,
+      bool compensated = false) const;
 
   /** \brief Compute the 1-norm of this MDVector
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contribution to the norm
    */
-  typename Teuchos::ScalarTraits< Scalar >::magnitudeType norm1() const;
+  typename Teuchos::ScalarTraits< Scalar >::magnitudeType
+  norm1(bool compensated = false) const;
 
   /** \brief Compute the 2-norm of this MDVector
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contribution to the norm
    */
-  typename Teuchos::ScalarTraits< Scalar >::magnitudeType norm2() const;
+  typename Teuchos::ScalarTraits< Scalar >::magnitudeType
+  norm2(bool compensated = false) const;
 
   /** \brief Compute the infinity-norm of this MDVector
    */
@@ -894,13 +1102,43 @@ public:
   /** \brief Compute the weighted norm of this
    *
    * \param weights [in] MDVector of weights for weighted norm
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contribution to the norm
    */
   typename Teuchos::ScalarTraits< Scalar >::magnitudeType
-  normWeighted(const MDVector< Scalar > & weights) const;
+  normWeighted(const MDVector< Scalar > & weights,
+               bool compensated = false) const;
 
   /** \brief Compute the mean (average) value of this MDVector
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contribution to the sum
+   */
+  Scalar meanValue(bool compensated = false) const;
+
+  /** \brief Compute the 1-norm, 2-norm and infinity-norm of this
+   *         MDVector with a single pass over the local data
+   *
+   * \param norm1 [out] the 1-norm
+   *
+   * \param norm2 [out] the 2-norm
+   *
+   * \param normInf [out] the infinity-norm
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contributions to the 1-norm and 2-norm
+   *
+   * This is equivalent to, but less expensive than, calling
+   * <tt>norm1()</tt>, <tt>norm2()</tt> and <tt>normInf()</tt>
+   * separately.  The global sums are computed with a single
+   * reduction.
    */
-  Scalar meanValue() const;
+  void
+  norms(typename Teuchos::ScalarTraits< Scalar >::magnitudeType & norm1,
+        typename Teuchos::ScalarTraits< Scalar >::magnitudeType & norm2,
+        typename Teuchos::ScalarTraits< Scalar >::magnitudeType & normInf,
+        bool compensated = false) const;
 
   //@}
 
@@ -938,12 +1176,154 @@ public:
   void putScalar(const Scalar & value,
                  bool includePadding = true);
 
+  /** \brief Set every value to the value of a functor of its local
+   *         index, using multiple threads if available
+   *
+   * \param init [in] a functor with the signature <tt>Scalar
+   *        operator()(const Teuchos::ArrayView< const dim_type > &
+   *        index) const</tt>.  The index is relative to the data
+   *        returned by <tt>getData(includePadding)</tt>.  The functor
+   *        is called concurrently from multiple threads, and must not
+   *        copy the index.
+   *
+   * \param includePadding [in] if true, assign values to the boundary
+   *        and communication padding as well
+   *
+   * The data is partitioned among threads in the same way as for the
+   * other local kernels.  Called on an MDVector constructed with
+   * <tt>zeroOut = false</tt>, this is the first touch of its memory,
+   * which places each page on the NUMA node of the thread that will
+   * later process it.
+   */
+  template< class FUNCTOR >
+  void initialize(const FUNCTOR & init,
+                  bool includePadding = true);
+
   /** \brief Set all values in the multivector to pseudorandom numbers.
    */
   void randomize();
 
   //@}
 
+  /** \name Element-wise methods */
+  //@{
+
+  /** \brief Assign the result of an element-wise expression to this
+   *         MDVector
+   *
+   * \param expr [in] an MDVector, or an expression built from
+   *        MDVectors with the arithmetic operators of
+   *        Domi_ElementWise.hpp, such as <tt>a*x + b*y + c*w</tt>
+   *
+   * \param includePadding [in] if true, assign values to the boundary
+   *        and communication padding as well, in which case the
+   *        operands must have the same padding as this MDVector
+   *
+   * The expression is evaluated in a single pass over the data,
+   * without temporaries, and may refer to this MDVector.  All of the
+   * operands must have the same local dimensions as this MDVector.
+   */
+  template< class EXPR >
+  void assign(const EXPR & expr,
+              bool includePadding = false);
+
+  /** \brief Multiply this MDVector by a scalar: this = alpha * this
+   *
+   * \param alpha [in] the scalar
+   *
+   * \param includePadding [in] if true, scale the padding as well
+   *
+   * If alpha is zero, this MDVector is set to zero without being
+   * read, so that any NaN or Inf it holds is not propagated.
+   */
+  void scale(const Scalar & alpha,
+             bool includePadding = false);
+
+  /** \brief Update this MDVector: this = alpha * a + gamma * this
+   *
+   * \param alpha [in] the scalar multiplying a
+   *
+   * \param a [in] an MDVector compatible with this MDVector
+   *
+   * \param gamma [in] the scalar multiplying this MDVector
+   *
+   * \param includePadding [in] if true, update the padding as well
+   *
+   * If gamma is zero, this MDVector is not read.
+   */
+  void update(const Scalar & alpha,
+              const MDVector< Scalar > & a,
+              const Scalar & gamma,
+              bool includePadding = false);
+
+  /** \brief Update this MDVector: this = alpha * a + beta * b + gamma
+   *         * this
+   *
+   * \param alpha [in] the scalar multiplying a
+   *
+   * \param a [in] an MDVector compatible with this MDVector
+   *
+   * \param beta [in] the scalar multiplying b
+   *
+   * \param b [in] an MDVector compatible with this MDVector
+   *
+   * \param gamma [in] the scalar multiplying this MDVector
+   *
+   * \param includePadding [in] if true, update the padding as well
+   *
+   * If gamma is zero, this MDVector is not read.
+   */
+  void update(const Scalar & alpha,
+              const MDVector< Scalar > & a,
+              const Scalar & beta,
+              const MDVector< Scalar > & b,
+              const Scalar & gamma,
+              bool includePadding = false);
+
+  /** \brief Multiply two MDVectors element-wise: this = scalarAB * a
+   *         * b + scalarThis * this
+   *
+   * \param scalarAB [in] the scalar multiplying the element-wise
+   *        product of a and b
+   *
+   * \param a [in] an MDVector compatible with this MDVector
+   *
+   * \param b [in] an MDVector compatible with this MDVector
+   *
+   * \param scalarThis [in] the scalar multiplying this MDVector
+   *
+   * \param includePadding [in] if true, update the padding as well
+   *
+   * If scalarThis is zero, this MDVector is not read.
+   */
+  void elementWiseMultiply(const Scalar & scalarAB,
+                           const MDVector< Scalar > & a,
+                           const MDVector< Scalar > & b,
+                           const Scalar & scalarThis,
+                           bool includePadding = false);
+
+  /** \brief Assign the element-wise reciprocal of an MDVector to
+   *         this MDVector
+   *
+   * \param a [in] an MDVector compatible with this MDVector
+   *
+   * \param includePadding [in] if true, assign to the padding as well
+   */
+  void reciprocal(const MDVector< Scalar > & a,
+                  bool includePadding = false);
+
+  /** \brief Assign the element-wise absolute value of an MDVector to
+   *         this MDVector
+   *
+   * \param a [in] an MDVector compatible with this MDVector
+   *
+   * \param includePadding [in] if true, assign to the padding as well
+   */
+  void abs(const MDVector< Scalar > & a,
+           bool includePadding = false);
+
+  //@}
+
   /** \name Global communication methods */
   //@{
 
@@ -986,6 +1366,132 @@ public:
    */
   void endUpdateCommPad(int axis);
 
+  /** \brief Start an asyncronous update of the communication padding
+   *         along all axes at once
+   *
+   * Post the non-blocking sends and receives for the communication
+   * padding of all faces, and unless the communication padding
+   * strategy is <tt>ALL_FACES</tt>, of all edges and corners as well.
+   */
+  void startUpdateCommPad();
+
+  /** \brief Complete an asyncronous update of the communication
+   *         padding along all axes at once
+   *
+   * Wait for all of the non-blocking updates posted by
+   * <tt>startUpdateCommPad()</tt> to complete
+   */
+  void endUpdateCommPad();
+
+  /** \brief Update the communication padding while applying a kernel
+   *         to the local interior
+   *
+   * \param kernel [in] a functor providing <tt>void operator()(const
+   *        Teuchos::ArrayView< const Slice > & bounds) const</tt>,
+   *        which computes over the box given by the local loop bounds
+   *        along each axis
+   *
+   * The communication padding update along all axes is started, the
+   * kernel is applied to the local deep interior, the update is
+   * completed, and the kernel is then applied to each box of the
+   * boundary shell.  The kernel must not read the communication
+   * padding farther than the communication pad size from the points
+   * it computes.  This hides the latency of the communication behind
+   * the computation of the deep interior.
+   */
+  template< class FUNCTOR >
+  void updateCommPadAndApply(const FUNCTOR & kernel);
+
+  /** \brief Update the communication padding along all axes, up to
+   *         the given width
+   *
+   * \param width [in] the number of layers of the communication
+   *        padding nearest to the local interior to update, which is
+   *        clipped to the communication pad size
+   *
+   * The axes are updated one at a time, as with the
+   * <tt>AXIS_BY_AXIS</tt> strategy, and the messages are packed into
+   * contiguous buffers.  This supports temporal blocking, in which
+   * the communication padding is made k*r wide, and k sweeps of a
+   * stencil of radius r are performed between updates: see
+   * <tt>getLocalInteriorBounds(int axis, int width)</tt>.  This method
+   * must not be called while an asynchronous update of the
+   * communication padding is in progress.
+   */
+  void updateCommPadWidth(int width);
+
+  /** \brief Set the strategy used by <tt>updateCommPad()</tt> to
+   *         update the communication padding
+   *
+   * \param strategy [in] <tt>AXIS_BY_AXIS</tt> (the default),
+   *        <tt>ALL_FACES</tt> or <tt>ALL_NEIGHBORS</tt>
+   *
+   * Note that persistent communication requests, if enabled, are
+   * only used by the <tt>AXIS_BY_AXIS</tt> strategy.
+   */
+  void setCommPadStrategy(CommPadStrategy strategy);
+
+  /** \brief Return the strategy used by <tt>updateCommPad()</tt> to
+   *         update the communication padding
+   */
+  inline CommPadStrategy getCommPadStrategy() const;
+
+  /** \brief Set whether persistent communication requests are used
+   *         to update the communication padding
+   *
+   * \param persistent [in] if true, the sends and receives for each
+   *        axis are created once, with <tt>MPI_Send_init()</tt> and
+   *        <tt>MPI_Recv_init()</tt>, and restarted with
+   *        <tt>MPI_Startall()</tt> on each update.  If false (the
+   *        default), new non-blocking sends and receives are posted
+   *        on each update.
+   *
+   * This method should not be called while an update of the
+   * communication padding is in progress.  It has no effect in a
+   * serial build.
+   */
+  void setPersistentCommPad(bool persistent);
+
+  /** \brief Return true if persistent communication requests are
+   *         used to update the communication padding
+   */
+  inline bool getPersistentCommPad() const;
+
+  /** \brief Set whether the communication padding messages along the
+   *         given axis are packed into contiguous buffers
+   *
+   * \param axis [in] the axis along which messages are packed
+   *
+   * \param packed [in] if true, the send regions along the given axis
+   *        are copied into pre-allocated contiguous buffers, which are
+   *        sent as contiguous MPI messages and copied into the
+   *        communication padding upon receipt.  If false (the
+   *        default), MPI subarray data types are used to send and
+   *        receive the regions in place.
+   *
+   * Packing can be faster than MPI subarray data types for regions
+   * with large strides, such as the faces normal to the fastest axis,
+   * depending on the MPI implementation.  This method should not be
+   * called while an update of the communication padding is in
+   * progress.  It applies to the <tt>AXIS_BY_AXIS</tt> strategy and
+   * has no effect in a serial build.
+   */
+  void setPackedCommPad(int axis, bool packed);
+
+  /** \brief Set whether the communication padding messages along all
+   *         axes are packed into contiguous buffers
+   *
+   * \param packed [in] if true, messages along all axes are packed
+   */
+  void setPackedCommPad(bool packed);
+
+  /** \brief Return true if the communication padding messages along
+   *         the given axis are packed into contiguous buffers
+   *
+   * \param axis [in] the axis being queried
+   */
+  inline bool getPackedCommPad(int axis) const;
+
   //@}
 
   /** \name Sub-MDVector operators */
@@ -1038,6 +1544,40 @@ public:
   void writeBinary(const std::string & filename,
                    bool includeBndryPad = false) const;
 
+  /** \brief Start writing the MDVector to a binary file, and return
+   *         without waiting for the write to complete
+   *
+   * \param filename [in] name of the output file
+   *
+   * \param includeBndryPad [in] if true, include the boundary pad
+   *        with the output data
+   *
+   * The local data is copied to a staging buffer before this method
+   * returns, so the MDVector may be changed while the write proceeds.
+   * The file has the same format as one written by
+   * <tt>writeBinary()</tt>.  Two staging buffers are used
+   * alternately, so that one write may proceed while the next is
+   * started; starting a third write waits for the first one to
+   * complete.  Starting a write to a file that an earlier write of
+   * this MDVector has not finished waits for that write first.  Wait
+   * for the write with the <tt>wait()</tt> method of the returned
+   * <tt>AsyncWrite</tt>, or for all of the writes of this MDVector
+   * with <tt>endWriteBinary()</tt>.  The timing of the
+   * "startWriteBinary" operation covers the staging copy and the
+   * write, and is recorded when the write is waited for.
+   */
+  Teuchos::RCP< AsyncWrite >
+  startWriteBinary(const std::string & filename,
+                   bool includeBndryPad = false) const;
+
+  /** \brief Wait for all the writes started by
+   *         <tt>startWriteBinary()</tt> to complete
+   *
+   * The writes are completed in the order they were started.  Like
+   * <tt>AsyncWrite::wait()</tt>, this is collective.
+   */
+  void endWriteBinary() const;
+
   /** \brief Read the MDVector from a binary file
    *
    * \param filename [in] name of the input file
@@ -1048,10 +1588,204 @@ public:
   void readBinary(const std::string & filename,
                   bool includeBndryPad = false);
 
+  /** \brief Write a region of the MDVector to a binary file
+   *
+   * \param filename [in] name of the output file
+   *
+   * \param region [in] an array of Slices, one for each axis, that
+   *        specify the global region of the file to write.  The
+   *        Slices must have a step of one.
+   *
+   * \param includeBndryPad [in] if true, the file includes the
+   *        boundary pad, and the region is specified in terms of
+   *        indexes that include the boundary pad
+   *
+   * The file has the format written by <tt>writeBinary()</tt>, and
+   * only the data within the region is written to it.  An existing
+   * file is not truncated, so that a file can be written one region
+   * at a time.  Processors whose data does not intersect the region
+   * take part in the collective write without writing any data.
+   */
+  void writeBinary(const std::string & filename,
+                   const Teuchos::ArrayView< const Slice > & region,
+                   bool includeBndryPad = false) const;
+
+  /** \brief Read a region of the MDVector from a binary file
+   *
+   * \param filename [in] name of the input file
+   *
+   * \param region [in] an array of Slices, one for each axis, that
+   *        specify the global region of the file to read.  The
+   *        Slices must have a step of one.
+   *
+   * \param includeBndryPad [in] if true, the file includes the
+   *        boundary pad, and the region is specified in terms of
+   *        indexes that include the boundary pad
+   *
+   * The file has the format written by <tt>writeBinary()</tt>.  Only
+   * the data within the region is read, and the rest of the MDVector
+   * is unchanged.
+   */
+  void readBinary(const std::string & filename,
+                  const Teuchos::ArrayView< const Slice > & region,
+                  bool includeBndryPad = false);
+
+  /** \brief Write the MDVector to a self-describing, chunked binary
+   *         file
+   *
+   * \param filename [in] name of the output file
+   *
+   * \param includeBndryPad [in] if true, include the boundary pad
+   *        with the output data
+   *
+   * \param chunkShape [in] the shape of the chunks that the global
+   *        data is divided into.  By default, the chunks have the
+   *        shape of the largest local data block, so that each
+   *        processor of a regular decomposition writes a single
+   *        contiguous chunk.
+   *
+   * The file has a header that describes the scalar type, byte
+   * order, dimensions, layout and boundary padding of the data, and
+   * the offsets of the chunks; see <tt>ChunkedFileHeader</tt>.  It
+   * can be read with <tt>readChunked()</tt>, or used to construct a
+   * new MDVector with <tt>readMDVector()</tt>.  If the first
+   * processor cannot write the header, every processor throws a
+   * <tt>FileError</tt>.
+   */
+  void writeChunked(const std::string & filename,
+                    bool includeBndryPad = false,
+                    const Teuchos::ArrayView< const dim_type > & chunkShape =
+                      Teuchos::null) const;
+
+  /** \brief Read the MDVector from a self-describing, chunked binary
+   *         file
+   *
+   * \param filename [in] name of the input file
+   *
+   * The scalar type, dimensions and layout of the file are checked
+   * against the MDVector, and data written with the opposite byte
+   * order is converted.  The boundary pad is read if the file
+   * includes it.  Only the chunks that intersect each processor's
+   * data are read by that processor.
+   */
+  void readChunked(const std::string & filename);
+
+  /** \brief Write the MDVector to one subfile per node and a manifest
+   *
+   * \param filename [in] name of the manifest.  The subfiles are
+   *        named after it; see <tt>SubfileManifest::subfileName()</tt>.
+   *
+   * \param includeBndryPad [in] if true, include the boundary pad
+   *        with the output data
+   *
+   * The processors that share a node send their local data to the
+   * first processor of the node, which writes it to the subfile of
+   * the node, so that the number of processors writing to the file
+   * system is the number of nodes, and none of them share a file.
+   * The first processor then writes the manifest, which describes
+   * the block of each processor; see <tt>SubfileManifest</tt>.  If
+   * any subfile or the manifest cannot be written, every processor
+   * throws a <tt>FileError</tt>.
+   */
+  void writeSubfiles(const std::string & filename,
+                     bool includeBndryPad = false) const;
+
+  /** \brief Read the MDVector from subfiles written by
+   *         <tt>writeSubfiles()</tt>
+   *
+   * \param filename [in] name of the manifest
+   *
+   * The MDVector may have any decomposition, as each processor reads
+   * the parts of the blocks in the subfiles that intersect its data.
+   * The scalar type, dimensions and layout of the manifest are
+   * checked against the MDVector, and data written with the opposite
+   * byte order is converted.  The boundary pad is read if the
+   * subfiles include it.
+   */
+  void readSubfiles(const std::string & filename);
+
+  /** \brief Set the configuration of the file input and output of
+   *         this MDVector
+   *
+   * \param ioConfig [in] the configuration, whose MPI-IO hints are
+   *        used and in which the timings are recorded.  If null, the
+   *        default configuration is used.
+   */
+  void setIOConfig(const Teuchos::RCP< IOConfig > & ioConfig);
+
+  /** \brief Return the configuration of the file input and output of
+   *         this MDVector
+   *
+   * This is the configuration given by the "I/O" sublist of the
+   * ParameterList constructors or by <tt>setIOConfig()</tt>, or
+   * otherwise the default <tt>IOConfig</tt>.
+   */
+  Teuchos::RCP< IOConfig > getIOConfig() const;
+
+  /** \brief Back the MDVector data with a memory mapping of a binary
+   *         file
+   *
+   * \param filename [in] name of a file in the format written by
+   *        <tt>writeBinary()</tt>
+   *
+   * \param includeBndryPad [in] if true, the file includes the
+   *        boundary pad
+   *
+   * \param writable [in] if true, changes to the data are written to
+   *        the file.  If false, changes are private to this MDVector.
+   *
+   * The existing data is discarded, and the data is then read from
+   * the file only as it is accessed.  If the local buffer, including
+   * its padding, lies entirely within the file, then each processor
+   * maps its hyperslab of the file directly, with the strides of the
+   * file.  This is the case for local buffers whose communication
+   * padding is interior to the global domain and whose boundary
+   * padding, if any, is included in the file.  Otherwise, and for
+   * writable mappings of local buffers with communication padding
+   * (which would write to the file regions of neighboring
+   * processors), the local data is staged: it is copied into
+   * ordinary memory from a mapping of the processor's hyperslab, and
+   * written back by <tt>syncBinary()</tt>.
+   *
+   * Writable mappings write whole pages back to the file, and
+   * neighboring processors may map the same pages.  They are
+   * therefore only supported when all of the processors run on a
+   * single node, or otherwise share a page cache for the file; on a
+   * distributed file system, use <tt>writeBinary()</tt> instead.
+   * <tt>syncBinary()</tt> throws a <tt>FileError</tt> if the changes
+   * cannot be written to the file.
+   *
+   * Directly mapped data is not contiguous.  Communication padding
+   * updates and all other operations work as usual.  Changing the
+   * storage again, with <tt>setAlignedStorage()</tt> or another call
+   * to this method, detaches the MDVector from the file.
+   */
+  void mapBinary(const std::string & filename,
+                 bool includeBndryPad = false,
+                 bool writable = false);
+
+  /** \brief Write changes to the data of a writable file mapping to
+   *         the file
+   */
+  void syncBinary();
+
+  /** \brief Return true if the data is backed by a file mapping
+   */
+  bool isFileMapped() const;
+
+  /** \brief Return true if the data is backed directly by a file
+   *         mapping, rather than staged from one
+   */
+  bool isDirectlyMapped() const;
+
   //@}
 
 private:
 
+  // The time-series classes use the file data types of computeFileInfo()
+  friend class TimeSeriesWriter< Scalar >;
+  friend class TimeSeriesReader< Scalar >;
+
   // The Teuchos communicator.  Note that this is always a reference
   // to the communicator of the _mdMap, and is stored only for
   // convenience
@@ -1094,10 +1828,13 @@ private:
 #ifdef HAVE_MPI
     // MPI data type (strided vector)
     Teuchos::RCP< MPI_Datatype > datatype;
-#else
-    // Teuchos ArrayView for periodic domains
-    MDArrayView< Scalar > dataview;
+    // Contiguous buffer for packed messages, which is only allocated
+    // when the communication padding along this axis is packed
+    Teuchos::ArrayRCP< Scalar > packBuffer;
 #endif
+    // MDArrayView of the message data, for periodic domains and
+    // packed messages
+    MDArrayView< Scalar > dataview;
     // Processor rank for communication partner
     int proc;
     // Communication is along this axis
@@ -1118,6 +1855,78 @@ private:
   // _recvMessages arrays.
   void initializeMessages();
 
+  // A private method to return the view of the send or receive region
+  // at the given boundary along the given axis, for a communication
+  // padding update up to the given width
+  MDArrayView< Scalar > getCommPadWidthView(int msgAxis,
+                                            int boundary,
+                                            bool send,
+                                            int width);
+
+#ifdef HAVE_MPI
+  // Define a struct for storing the persistent MPI requests for the
+  // communication padding messages, one array of requests per axis.
+  // The requests are freed when the last reference to the struct is
+  // released.
+  struct PersistentRequests
+  {
+    Teuchos::Array< Teuchos::Array< MPI_Request > > requests;
+    ~PersistentRequests()
+    {
+      int finalized = 0;
+      MPI_Finalized(&finalized);
+      if (finalized) return;
+      for (int axis = 0; axis < requests.size(); ++axis)
+        for (int i = 0; i < requests[axis].size(); ++i)
+          if (requests[axis][i] != MPI_REQUEST_NULL)
+            MPI_Request_free(&(requests[axis][i]));
+    }
+  };
+
+  // The persistent requests, which are only allocated when
+  // _persistentCommPad is true
+  Teuchos::RCP< PersistentRequests > _persistentRequests;
+
+  // A private method to initialize the _persistentRequests from the
+  // _sendMessages and _recvMessages arrays
+  void initializePersistentRequests();
+#endif
+
+  // Flag indicating whether persistent requests are used to update
+  // the communication padding
+  bool _persistentCommPad;
+
+  // Flags, indexed by axis, indicating whether the communication
+  // padding messages along each axis are packed into contiguous
+  // buffers.  Axes beyond the end of the array are not packed.
+  Teuchos::Array< int > _packedCommPad;
+
+#ifdef HAVE_MPI
+  // A private method to allocate the packed message buffers along the
+  // given axis, if they have not been allocated already
+  void initializePackBuffers(int axis);
+#endif
+
+  // The strategy used by updateCommPad()
+  CommPadStrategy _commPadStrategy;
+
+  // Arrays of MessageInfo objects for updating the communication
+  // padding along all axes at once.  These arrays are indexed by
+  // neighbor direction: a direction is a vector d with components
+  // -1, 0 or 1 along each axis, and its index is the sum over axes of
+  // (d[axis]+1)*3**axis.  The index of the opposite direction of
+  // index k is 3**numDims-1-k.
+  Teuchos::Array< MessageInfo > _neighborSendMessages;
+  Teuchos::Array< MessageInfo > _neighborRecvMessages;
+
+  // A private method to initialize the _neighborSendMessages and
+  // _neighborRecvMessages arrays.
+  void initializeNeighborMessages();
+
+  // Return true if the message for the given neighbor direction index
+  // is used by the current communication padding strategy
+  bool useNeighborMessage(int direction) const;
+
   //////////////////////////////////
   // *** Input/Output Support *** //
   //////////////////////////////////
@@ -1159,13 +1968,165 @@ private:
   // mutable data members.
   Teuchos::RCP< FileInfo > & computeFileInfo(bool includeBndryPad) const;
 
-};
+  // Write or read a run of elements to or from a file, and return
+  // the number of elements transferred
+  static size_type writeRun(FILE * datafile,
+                            const Scalar * ptr,
+                            size_type count);
+  static size_type readRun(FILE * datafile,
+                           Scalar * ptr,
+                           size_type count);
+
+  // Write or read the elements of a local view to or from a file in
+  // layout order, one contiguous run at a time, or all at once if the
+  // view is contiguous.  If fileStrides is given, the elements are
+  // not stored consecutively in the file, and each run is preceded by
+  // a seek to its position, computed from fileOffset and fileStrides
+  // in units of elements.  Return false if the transfer is
+  // incomplete, so that the caller can close the file before
+  // throwing a FileError.
+  static bool writeLocal(FILE * datafile,
+                         const MDArrayView< const Scalar > & data,
+                         const Teuchos::ArrayView< const size_type > &
+                           fileStrides = Teuchos::null,
+                         size_type fileOffset = 0);
+  static bool readLocal(FILE * datafile,
+                        const MDArrayView< Scalar > & data,
+                        const Teuchos::ArrayView< const size_type > &
+                          fileStrides = Teuchos::null,
+                        size_type fileOffset = 0);
+
+  // Line functor for walkLines() that transfers each run of a local
+  // view with the given run function, preceded by a seek if the file
+  // offsets are strided.  Once a transfer is incomplete, the
+  // remaining runs are skipped.
+  template< class T >
+  struct TransferLineFunctor
+  {
+    TransferLineFunctor(FILE * datafile,
+                        T * base,
+                        size_type stride,
+                        size_type length,
+                        bool seek,
+                        size_type fileOffset,
+                        size_type (*transferRun)(FILE *, T *, size_type),
+                        bool & complete) :
+      _datafile(datafile), _base(base), _stride(stride), _length(length),
+      _seek(seek), _fileOffset(fileOffset), _transferRun(transferRun),
+      _complete(complete) { }
+    void operator()(const dim_type *, const size_type * offsets)
+    {
+      if (! _complete) return;
+      T * ptr = _base + offsets[0];
+      if (_seek)
+        fseek(_datafile, (_fileOffset + offsets[1]) * sizeof(T), SEEK_SET);
+      if (_stride == 1)
+        _complete = (_transferRun(_datafile, ptr, _length) == _length);
+      else
+        for (size_type i = 0; i < _length && _complete; ++i)
+          _complete = (_transferRun(_datafile, ptr + i*_stride, 1) == 1);
+    }
+    FILE *    _datafile;
+    T *       _base;
+    size_type _stride;
+    size_type _length;
+    bool      _seek;
+    size_type _fileOffset;
+    size_type (*_transferRun)(FILE *, T *, size_type);
+    bool &    _complete;
+  };
 
-/////////////////////////////
-// *** Implementations *** //
-/////////////////////////////
+  // The implementation of writeLocal() and readLocal(), which
+  // transfers each run with the given run function
+  template< class T >
+  static bool transferLocal(FILE * datafile,
+                            const MDArrayView< T > & data,
+                            const Teuchos::ArrayView< const size_type > &
+                              fileStrides,
+                            size_type fileOffset,
+                            size_type (*transferRun)(FILE *,
+                                                     T *,
+                                                     size_type));
+
+  // Compute the intersection of a region of a file with the local
+  // data described by fileInfo: the start of the intersection within
+  // the file, its start within the local buffer, and its shape.
+  // Return false if the intersection is empty.
+  bool computeRegionIntersection(const std::string & filename,
+                                 const Teuchos::ArrayView< const Slice > &
+                                   region,
+                                 const FileInfo & fileInfo,
+                                 Teuchos::Array< dim_type > & fileStart,
+                                 Teuchos::Array< dim_type > & dataStart,
+                                 Teuchos::Array< dim_type > & shape) const;
+
+  // Transfer a region of a binary file to or from the local data, one
+  // contiguous run of elements at a time
+  void transferRegion(const std::string & filename,
+                      const Teuchos::ArrayView< const Slice > & region,
+                      bool includeBndryPad,
+                      bool write) const;
 
-////////////////////////////////////////////////////////////////////////
+#ifdef HAVE_MPI
+  // Compute the MPI data types that map the local data described by
+  // fileInfo to and from the chunks of a chunked file with the given
+  // header.  Return the number of chunks that intersect the local
+  // data, and if it is zero, leave the data types unset.
+  int computeChunkedTypes(const ChunkedFileHeader & header,
+                          const FileInfo & fileInfo,
+                          MPI_Datatype & filetype,
+                          MPI_Datatype & datatype) const;
+#endif
+
+  // Define a struct for storing the state of asynchronous writes:
+  // two staging buffers, used alternately, the writes that use them,
+  // and the index of the buffer to use next
+  struct AsyncWriteState
+  {
+    Teuchos::ArrayRCP< Scalar > buffers[2];
+    Teuchos::RCP< AsyncWrite >  writes[2];
+    int                         next;
+    AsyncWriteState() : next(0) { }
+  };
+
+  // The state of asynchronous writes.  This is mutable because the
+  // startWriteBinary() method should logically be const.
+  mutable Teuchos::RCP< AsyncWriteState > _asyncWrites;
+
+  // Define a struct for storing the state of a file mapping: the
+  // mapped file, and for staged mappings, the data region of the
+  // mapping and the data region of the local buffer it was copied to
+  struct FileMapping
+  {
+    Teuchos::RCP< MappedFile > mappedFile;
+    MDArrayRCP< Scalar >       fileData;
+    MDArrayView< Scalar >      localData;
+    bool                       direct;
+  };
+
+  // The file mapping that backs the data, if any
+  Teuchos::RCP< FileMapping > _fileMapping;
+
+  // The configuration of file input and output, if not the default
+  Teuchos::RCP< IOConfig > _ioConfig;
+
+  // Return true if this MDVector spans its entire MDArrayRCP, so
+  // that its storage can be replaced
+  bool spansStorage() const;
+
+  // Discard the communication padding messages, the I/O data types
+  // and the file mapping, which refer to the old buffer and strides
+  // when the storage is replaced.  They are recomputed when they are
+  // next needed.
+  void storageChanged();
+
+};
+
+/////////////////////////////
+// *** Implementations *** //
+/////////////////////////////
+
+////////////////////////////////////////////////////////////////////////
 
 template< class Scalar >
 MDVector< Scalar >::
@@ -1180,7 +2141,15 @@ MDVector(const Teuchos::RCP< const MDMap > & mdMap,
   _requests(),
 #endif
   _sendMessages(),
-  _recvMessages()
+  _recvMessages(),
+#ifdef HAVE_MPI
+  _persistentRequests(),
+#endif
+  _persistentCommPad(false),
+  _packedCommPad(),
+  _commPadStrategy(AXIS_BY_AXIS),
+  _neighborSendMessages(),
+  _neighborRecvMessages()
 {
   setObjectLabel("Domi::MDVector");
 
@@ -1190,8 +2159,11 @@ MDVector(const Teuchos::RCP< const MDMap > & mdMap,
   for (int axis = 0; axis < numDims; ++axis)
     dims[axis] = _mdMap->getLocalDim(axis,true);
 
-  // Resize the MDArrayRCP and set the MDArrayView
-  _mdArrayRcp.resize(dims);
+  // Allocate the MDArrayRCP, in the layout of the MDMap, and set the
+  // MDArrayView.  If zeroOut is false, the memory is left untouched
+  // for the user's first write.
+  _mdArrayRcp = MDArrayRCP< Scalar >(dims, Scalar(), _mdMap->getLayout(),
+                                     false, zeroOut);
   _mdArrayView = _mdArrayRcp();
 }
 
@@ -1212,7 +2184,15 @@ MDVector(const Teuchos::RCP< const MDMap > & mdMap,
   _requests(),
 #endif
   _sendMessages(),
-  _recvMessages()
+  _recvMessages(),
+#ifdef HAVE_MPI
+  _persistentRequests(),
+#endif
+  _persistentCommPad(false),
+  _packedCommPad(),
+  _commPadStrategy(AXIS_BY_AXIS),
+  _neighborSendMessages(),
+  _neighborRecvMessages()
 {
   setObjectLabel("Domi::MDVector");
 
@@ -1222,8 +2202,11 @@ MDVector(const Teuchos::RCP< const MDMap > & mdMap,
   for (int axis = 0; axis < numDims; ++axis)
     dims[axis] = _mdMap->getLocalDim(axis,true);
 
-  // Resize the MDArrayRCP and set the MDArrayView
-  _mdArrayRcp.resize(dims);
+  // Allocate the MDArrayRCP, in the layout of the MDMap, and set the
+  // MDArrayView.  If zeroOut is false, the memory is left untouched
+  // for the user's first write.
+  _mdArrayRcp = MDArrayRCP< Scalar >(dims, Scalar(), _mdMap->getLayout(),
+                                     false, zeroOut);
   _mdArrayView = _mdArrayRcp();
 }
 
@@ -1241,7 +2224,15 @@ MDVector(const Teuchos::RCP< const MDMap > & mdMap,
   _requests(),
 #endif
   _sendMessages(),
-  _recvMessages()
+  _recvMessages(),
+#ifdef HAVE_MPI
+  _persistentRequests(),
+#endif
+  _persistentCommPad(false),
+  _packedCommPad(),
+  _commPadStrategy(AXIS_BY_AXIS),
+  _neighborSendMessages(),
+  _neighborRecvMessages()
 {
   setObjectLabel("Domi::MDVector");
   int numDims = _mdMap->numDims();
@@ -1274,7 +2265,15 @@ MDVector(const Teuchos::RCP< const MDMap > & mdMap,
   _requests(),
 #endif
   _sendMessages(),
-  _recvMessages()
+  _recvMessages(),
+#ifdef HAVE_MPI
+  _persistentRequests(),
+#endif
+  _persistentCommPad(false),
+  _packedCommPad(),
+  _commPadStrategy(AXIS_BY_AXIS),
+  _neighborSendMessages(),
+  _neighborRecvMessages()
 {
 #ifdef DOMI_MDVECTOR_VERBOSE
   cout << "_mdArrayRcp  = " << _mdArrayRcp  << endl;
@@ -1314,9 +2313,18 @@ MDVector(const MDVector< Scalar > & source,
   _requests(),
 #endif
   _sendMessages(),
-  _recvMessages()
+  _recvMessages(),
+#ifdef HAVE_MPI
+  _persistentRequests(),
+#endif
+  _persistentCommPad(source._persistentCommPad),
+  _packedCommPad(source._packedCommPad),
+  _commPadStrategy(source._commPadStrategy),
+  _neighborSendMessages(),
+  _neighborRecvMessages()
 {
   setObjectLabel("Domi::MDVector");
+  _ioConfig = source._ioConfig;
 
   if (access == Teuchos::Copy)
   {
@@ -1330,18 +2338,15 @@ MDVector(const MDVector< Scalar > & source,
       dims[axis] = _mdMap->getLocalDim(axis,true);
 
     // Reset the MDArrayRCP and set the MDArrayView
-    _mdArrayRcp  = MDArrayRCP< Scalar >(dims, 0, source.getLayout());
+    _mdArrayRcp  = MDArrayRCP< Scalar >(dims, 0, source.getLayout(),
+                                        source._mdArrayRcp.isAligned());
     _mdArrayView = _mdArrayRcp();
 
     // Copy the source data to the new MDVector
-    typedef typename MDArrayView< Scalar >::iterator iterator;
-    typedef typename MDArrayView< Scalar >::const_iterator const_iterator;
-    const_iterator src = source.getData().begin();
-    for (iterator trg = _mdArrayView.begin(); trg != _mdArrayView.end(); ++trg)
-    {
-      *trg = *src;
-      ++src;
-    }
+    MDArrayView< const Scalar > src = source.getData();
+    threadedCopy(src.getRawPtr(), src.strides()(), _mdArrayView.getRawPtr(),
+                 _mdArrayView.strides()(), src.dimensions()(),
+                 source.getLayout());
   }
 #ifdef DOMI_MDVECTOR_VERBOSE
   else
@@ -1367,7 +2372,15 @@ MDVector(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
   _requests(),
 #endif
   _sendMessages(),
-  _recvMessages()
+  _recvMessages(),
+#ifdef HAVE_MPI
+  _persistentRequests(),
+#endif
+  _persistentCommPad(false),
+  _packedCommPad(),
+  _commPadStrategy(AXIS_BY_AXIS),
+  _neighborSendMessages(),
+  _neighborRecvMessages()
 {
   setObjectLabel("Domi::MDVector");
 
@@ -1389,9 +2402,22 @@ MDVector(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
   for (int axis = 0; axis < numDims; ++axis)
     dims[axis] = _mdMap->getLocalDim(axis,true);
 
-  // Resize the MDArrayRCP and set the MDArrayView
-  _mdArrayRcp.resize(dims);
+  // Allocate the MDArrayRCP, in the layout of the MDMap, and set the
+  // MDArrayView, within an arena on a HugePageAllocator if huge pages
+  // are requested
+  Teuchos::RCP< MemoryArena< Scalar > > arena =
+    createHugePageArena< Scalar >(getHugePagesParameter(plist));
+  if (plist.get("aligned storage", false))
+    _mdArrayRcp = MDArrayRCP< Scalar >(dims, Scalar(), _mdMap->getLayout(),
+                                       true);
+  else
+    _mdArrayRcp = MDArrayRCP< Scalar >(dims, Scalar(), _mdMap->getLayout());
   _mdArrayView = _mdArrayRcp();
+
+  // Use the file input and output configuration of the "I/O"
+  // sublist, if given
+  if (plist.isSublist("I/O"))
+    _ioConfig = Teuchos::rcp(new IOConfig(plist.sublist("I/O")));
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1409,7 +2435,15 @@ MDVector(const Teuchos::RCP< const MDComm > mdComm,
   _requests(),
 #endif
   _sendMessages(),
-  _recvMessages()
+  _recvMessages(),
+#ifdef HAVE_MPI
+  _persistentRequests(),
+#endif
+  _persistentCommPad(false),
+  _packedCommPad(),
+  _commPadStrategy(AXIS_BY_AXIS),
+  _neighborSendMessages(),
+  _neighborRecvMessages()
 {
   setObjectLabel("Domi::MDVector");
 
@@ -1431,9 +2465,22 @@ MDVector(const Teuchos::RCP< const MDComm > mdComm,
   for (int axis = 0; axis < numDims; ++axis)
     dims[axis] = _mdMap->getLocalDim(axis,true);
 
-  // Resize the MDArrayRCP and set the MDArrayView
-  _mdArrayRcp.resize(dims);
+  // Allocate the MDArrayRCP, in the layout of the MDMap, and set the
+  // MDArrayView, within an arena on a HugePageAllocator if huge pages
+  // are requested
+  Teuchos::RCP< MemoryArena< Scalar > > arena =
+    createHugePageArena< Scalar >(getHugePagesParameter(plist));
+  if (plist.get("aligned storage", false))
+    _mdArrayRcp = MDArrayRCP< Scalar >(dims, Scalar(), _mdMap->getLayout(),
+                                       true);
+  else
+    _mdArrayRcp = MDArrayRCP< Scalar >(dims, Scalar(), _mdMap->getLayout());
   _mdArrayView = _mdArrayRcp();
+
+  // Use the file input and output configuration of the "I/O"
+  // sublist, if given
+  if (plist.isSublist("I/O"))
+    _ioConfig = Teuchos::rcp(new IOConfig(plist.sublist("I/O")));
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -1452,9 +2499,18 @@ MDVector(const MDVector< Scalar > & parent,
   _requests(),
 #endif
   _sendMessages(),
-  _recvMessages()
+  _recvMessages(),
+#ifdef HAVE_MPI
+  _persistentRequests(),
+#endif
+  _persistentCommPad(parent._persistentCommPad),
+  _packedCommPad(parent._packedCommPad),
+  _commPadStrategy(parent._commPadStrategy),
+  _neighborSendMessages(),
+  _neighborRecvMessages()
 {
   setObjectLabel("Domi::MDVector");
+  _ioConfig = parent._ioConfig;
 
   // Obtain the parent MDMap
   Teuchos::RCP< const MDMap > parentMdMap = parent.getMDMap();
@@ -1464,6 +2520,11 @@ MDVector(const MDVector< Scalar > & parent,
                                           axis,
                                           globalIndex));
 
+  // The given axis is removed from sub-vectors of more than one
+  // dimension, so remove its packing flag as well
+  if (parentMdMap->numDims() > 1 && axis < _packedCommPad.size())
+    _packedCommPad.erase(_packedCommPad.begin() + axis);
+
   // Check that we are on the new sub-communicator
   if (_mdMap->onSubcommunicator())
   {
@@ -1510,7 +2571,15 @@ MDVector(const MDVector< Scalar > & parent,
   _requests(),
 #endif
   _sendMessages(),
-  _recvMessages()
+  _recvMessages(),
+#ifdef HAVE_MPI
+  _persistentRequests(),
+#endif
+  _persistentCommPad(parent._persistentCommPad),
+  _packedCommPad(parent._packedCommPad),
+  _commPadStrategy(parent._commPadStrategy),
+  _neighborSendMessages(),
+  _neighborRecvMessages()
 {
 #ifdef DOMI_MDVECTOR_VERBOSE
   cout << "slice axis " << axis << endl;
@@ -1519,6 +2588,7 @@ MDVector(const MDVector< Scalar > & parent,
 #endif
 
   setObjectLabel("Domi::MDVector");
+  _ioConfig = parent._ioConfig;
 
   // Obtain the parent MDMap
   Teuchos::RCP< const MDMap > parentMdMap = parent.getMDMap();
@@ -1586,6 +2656,7 @@ MDVector(const MDVector< Scalar > & parent,
          const Teuchos::ArrayView< int > & bndryPad)
 {
   setObjectLabel("Domi::MDVector");
+  _ioConfig = parent._ioConfig;
 
   // Temporarily store the number of dimensions
   int numDims = parent.numDims();
@@ -1628,6 +2699,16 @@ operator=(const MDVector< Scalar > & source)
 #endif
   _sendMessages = source._sendMessages;
   _recvMessages = source._recvMessages;
+#ifdef HAVE_MPI
+  _persistentRequests = source._persistentRequests;
+#endif
+  _persistentCommPad  = source._persistentCommPad;
+  _packedCommPad      = source._packedCommPad;
+  _commPadStrategy    = source._commPadStrategy;
+  _neighborSendMessages = source._neighborSendMessages;
+  _neighborRecvMessages = source._neighborRecvMessages;
+  _fileMapping          = source._fileMapping;
+  _ioConfig             = source._ioConfig;
   return *this;
 }
 
@@ -1800,6 +2881,37 @@ getLocalInteriorBounds(int axis) const
 
 ////////////////////////////////////////////////////////////////////////
 
+template< class Scalar >
+Slice
+MDVector< Scalar >::
+getLocalInteriorBounds(int axis,
+                       int width) const
+{
+  return _mdMap->getLocalInteriorBounds(axis, width);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Slice
+MDVector< Scalar >::
+getLocalDeepInteriorBounds(int axis) const
+{
+  return _mdMap->getLocalDeepInteriorBounds(axis);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Teuchos::Array< Teuchos::Array< Slice > >
+MDVector< Scalar >::
+getLocalBoundaryShellBounds() const
+{
+  return _mdMap->getLocalBoundaryShellBounds();
+}
+
+////////////////////////////////////////////////////////////////////////
+
 template< class Scalar >
 bool
 MDVector< Scalar >::
@@ -1919,7 +3031,7 @@ bool
 MDVector< Scalar >::
 isContiguous() const
 {
-  return _mdMap->isContiguous();
+  return _mdMap->isContiguous() && _mdArrayRcp().contiguous();
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -2041,10 +3153,11 @@ getEpetraMultiVectorView() const
     numVectors = 1;
   }
   TEUCHOS_TEST_FOR_EXCEPTION(
-    ! newMdMap->isContiguous(),
+    ! newMdMap->isContiguous() || ! _mdArrayRcp().contiguous(),
     MDMapNoncontiguousError,
     "This MDVector's MDMap is non-contiguous.  This can happen when you take "
-    "a slice of a parent MDVector.");
+    "a slice of a parent MDVector, or when the MDVector uses aligned or "
+    "file mapped storage.");
 
   // Get the stride between vectors.  The MDMap strides are private,
   // but we know the new MDMap is contiguous, so we can calculate it
@@ -2275,10 +3388,11 @@ getTpetraMultiVectorView() const
     numVectors = 1;
   }
   TEUCHOS_TEST_FOR_EXCEPTION(
-    ! newMdMap->isContiguous(),
+    ! newMdMap->isContiguous() || ! _mdArrayRcp().contiguous(),
     MDMapNoncontiguousError,
     "This MDVector's MDMap is non-contiguous.  This can happen when you take "
-    "a slice of a parent MDVector.");
+    "a slice of a parent MDVector, or when the MDVector uses aligned or "
+    "file mapped storage.");
 
   // Get the stride between vectors.  The MDMap strides are private,
   // but we know the new MDMap is contiguous, so we can calculate it
@@ -2486,23 +3600,72 @@ getUpperPadData(int axis) const
 ////////////////////////////////////////////////////////////////////////
 
 template< class Scalar >
-Scalar
+void
 MDVector< Scalar >::
-dot(const MDVector< Scalar > & a) const
+setAlignedStorage(bool aligned)
 {
-  typedef typename MDArrayView< const Scalar >::iterator iterator;
+  if (aligned == _mdArrayRcp.isAligned()) return;
+
+  // Only an MDVector that spans its entire MDArrayRCP can reallocate
+  // its data
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! spansStorage(),
+    MDMapNoncontiguousError,
+    "The storage of a sub-vector cannot be changed");
+
+  // Allocate the new storage, with the same page type as the old, and
+  // copy the data, including padding
+  Teuchos::RCP< MemoryArena< Scalar > > arena =
+    createHugePageArena< Scalar >(getPageType());
+  Teuchos::Array< dim_type > dims(_mdArrayView.dimensions());
+  MDArrayRCP< Scalar > newArrayRcp(dims(),
+                                   Scalar(),
+                                   getLayout(),
+                                   aligned);
+  threadedCopy(_mdArrayView.getRawPtr(), _mdArrayView.strides()(),
+               newArrayRcp.getRawPtr(), newArrayRcp.strides()(),
+               _mdArrayView.dimensions()(), getLayout());
+  _mdArrayRcp  = newArrayRcp;
+  _mdArrayView = _mdArrayRcp();
+  storageChanged();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+MDVector< Scalar >::
+getAlignedStorage() const
+{
+  return _mdArrayRcp.isAligned();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+PageType
+MDVector< Scalar >::
+getPageType() const
+{
+  return HugePageAllocator< Scalar >::getPageType(_mdArrayRcp.arrayRCP());
+}
+
+////////////////////////////////////////////////////////////////////////
 
+template< class Scalar >
+Scalar
+MDVector< Scalar >::
+dot(const MDVector< Scalar > & a,
+    bool compensated) const
+{
   TEUCHOS_TEST_FOR_EXCEPTION(
     ! _mdMap->isCompatible(*(a._mdMap)),
     MDMapError,
     "MDMap of calling MDVector and argument 'a' are incompatible");
 
-  MDArrayView< const Scalar > aView = a.getData();
-  Scalar local_dot = 0;
-  iterator a_it = aView.begin();
-  for (iterator it = _mdArrayView.begin(); it != _mdArrayView.end();
-       ++it, ++a_it)
-    local_dot += *it * *a_it;
+  SumLineKernel< Scalar, ProductOp< Scalar > > kernel(compensated);
+  applyLineKernel(getData(), a.getData(), kernel);
+  Scalar local_dot = kernel.result();
   Scalar global_dot = 0;
   Teuchos::reduceAll(*_teuchosComm,
                      Teuchos::REDUCE_SUM,
@@ -2517,14 +3680,13 @@ dot(const MDVector< Scalar > & a) const
 template< class Scalar >
 typename Teuchos::ScalarTraits< Scalar >::magnitudeType
 MDVector< Scalar >::
-norm1() const
+norm1(bool compensated) const
 {
   typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType mag;
-  typedef typename MDArrayView< const Scalar >::iterator iterator;
 
-  mag local_norm1 = 0;
-  for (iterator it = _mdArrayView.begin(); it != _mdArrayView.end(); ++it)
-    local_norm1 += std::abs(*it);
+  SumLineKernel< Scalar, AbsOp< Scalar > > kernel(compensated);
+  applyLineKernel(getData(), kernel);
+  mag local_norm1 = kernel.result();
   mag global_norm1 = 0;
   Teuchos::reduceAll(*_teuchosComm,
                      Teuchos::REDUCE_SUM,
@@ -2539,11 +3701,20 @@ norm1() const
 template< class Scalar >
 typename Teuchos::ScalarTraits< Scalar >::magnitudeType
 MDVector< Scalar >::
-norm2() const
+norm2(bool compensated) const
 {
   typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType mag;
-  mag norm2 = dot(*this);
-  return Teuchos::ScalarTraits<mag>::squareroot(norm2);
+
+  SumLineKernel< Scalar, AbsSquareOp< Scalar > > kernel(compensated);
+  applyLineKernel(getData(), kernel);
+  mag local_norm2 = kernel.result();
+  mag global_norm2 = 0;
+  Teuchos::reduceAll(*_teuchosComm,
+                     Teuchos::REDUCE_SUM,
+                     1,
+                     &local_norm2,
+                     &global_norm2);
+  return Teuchos::ScalarTraits<mag>::squareroot(global_norm2);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -2554,11 +3725,10 @@ MDVector< Scalar >::
 normInf() const
 {
   typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType mag;
-  typedef typename MDArrayView< const Scalar >::iterator iterator;
 
-  mag local_normInf = 0;
-  for (iterator it = _mdArrayView.begin(); it != _mdArrayView.end(); ++it)
-    local_normInf = std::max(local_normInf, std::abs(*it));
+  MaxAbsLineKernel< Scalar > kernel;
+  applyLineKernel(getData(), kernel);
+  mag local_normInf = kernel.result();
   mag global_normInf = 0;
   Teuchos::reduceAll(*_teuchosComm,
                      Teuchos::REDUCE_MAX,
@@ -2573,22 +3743,19 @@ normInf() const
 template< class Scalar >
 typename Teuchos::ScalarTraits< Scalar >::magnitudeType
 MDVector< Scalar >::
-normWeighted(const MDVector< Scalar > & weights) const
+normWeighted(const MDVector< Scalar > & weights,
+             bool compensated) const
 {
   typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType mag;
-  typedef typename MDArrayView< const Scalar >::iterator iterator;
 
   TEUCHOS_TEST_FOR_EXCEPTION(
     ! _mdMap->isCompatible(*(weights._mdMap)),
     MDMapError,
     "MDMap of calling MDVector and argument 'weights' are incompatible");
 
-  MDArrayView< const Scalar > wView = weights.getData();
-  mag local_wNorm = 0;
-  iterator w_it = wView.begin();
-  for (iterator it = _mdArrayView.begin(); it != _mdArrayView.end();
-       ++it, ++w_it)
-    local_wNorm += *it * *it * *w_it;
+  SumLineKernel< Scalar, WeightedSquareOp< Scalar > > kernel(compensated);
+  applyLineKernel(getData(), weights.getData(), kernel);
+  mag local_wNorm = kernel.result();
   mag global_wNorm = 0;
   Teuchos::reduceAll(*_teuchosComm,
                      Teuchos::REDUCE_SUM,
@@ -2608,14 +3775,13 @@ normWeighted(const MDVector< Scalar > & weights) const
 template< class Scalar >
 Scalar
 MDVector< Scalar >::
-meanValue() const
+meanValue(bool compensated) const
 {
   typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType mag;
-  typedef typename MDArrayView< const Scalar >::iterator iterator;
 
-  mag local_sum = 0;
-  for (iterator it = _mdArrayView.begin(); it != _mdArrayView.end(); ++it)
-    local_sum += *it;
+  SumLineKernel< Scalar, IdentityOp< Scalar > > kernel(compensated);
+  applyLineKernel(getData(), kernel);
+  mag local_sum = kernel.result();
   mag global_sum = 0;
   Teuchos::reduceAll(*_teuchosComm,
                      Teuchos::REDUCE_SUM,
@@ -2632,6 +3798,42 @@ meanValue() const
 
 ////////////////////////////////////////////////////////////////////////
 
+template< class Scalar >
+void
+MDVector< Scalar >::
+norms(typename Teuchos::ScalarTraits< Scalar >::magnitudeType & norm1,
+      typename Teuchos::ScalarTraits< Scalar >::magnitudeType & norm2,
+      typename Teuchos::ScalarTraits< Scalar >::magnitudeType & normInf,
+      bool compensated) const
+{
+  typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType mag;
+
+  MultiLineKernel< Scalar > kernel(compensated);
+  applyLineKernel(getData(), kernel);
+
+  // Reduce the 1-norm and squared 2-norm contributions together, and
+  // the infinity-norm contribution separately
+  mag local_sums[2];
+  mag global_sums[2];
+  local_sums[0] = kernel.absSum();
+  local_sums[1] = kernel.absSquareSum();
+  Teuchos::reduceAll(*_teuchosComm,
+                     Teuchos::REDUCE_SUM,
+                     2,
+                     local_sums,
+                     global_sums);
+  mag local_normInf = kernel.maxAbs();
+  Teuchos::reduceAll(*_teuchosComm,
+                     Teuchos::REDUCE_MAX,
+                     1,
+                     &local_normInf,
+                     &normInf);
+  norm1 = global_sums[0];
+  norm2 = Teuchos::ScalarTraits<mag>::squareroot(global_sums[1]);
+}
+
+////////////////////////////////////////////////////////////////////////
+
 template< class Scalar >
 std::string
 MDVector< Scalar >::
@@ -2737,11 +3939,22 @@ MDVector< Scalar >::
 putScalar(const Scalar & value,
           bool includePadding)
 {
-  typedef typename MDArrayView< Scalar >::iterator iterator;
+  MDArrayView< Scalar > newArray = getDataNonConst(includePadding);
+  newArray.assign(value);
+}
 
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+template< class FUNCTOR >
+void
+MDVector< Scalar >::
+initialize(const FUNCTOR & init,
+           bool includePadding)
+{
   MDArrayView< Scalar > newArray = getDataNonConst(includePadding);
-  for (iterator it = newArray.begin(); it != newArray.end(); ++it)
-    *it = value;
+  threadedInitialize(newArray.getRawPtr(), newArray.dimensions()(),
+                     newArray.strides()(), getLayout(), init);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -2760,14 +3973,141 @@ randomize()
 
 ////////////////////////////////////////////////////////////////////////
 
+template< class Scalar >
+template< class EXPR >
+void
+MDVector< Scalar >::
+assign(const EXPR & expr,
+       bool includePadding)
+{
+  typedef typename ElementWiseTraits< EXPR >::type expr_type;
+  MDArrayView< Scalar > target = getDataNonConst(includePadding);
+  bool contiguous = Domi::isContiguous(target.dimensions()(),
+                                       target.strides()(),
+                                       target.layout());
+  expr_type bound(ElementWiseTraits< EXPR >::convert(expr));
+  bound.bind(includePadding, target.dimensions()(), target.layout(),
+             contiguous);
+  evaluateElementWise(target.getRawPtr(),
+                      target.strides()(),
+                      target.dimensions()(),
+                      target.layout(),
+                      contiguous,
+                      bound);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+scale(const Scalar & alpha,
+      bool includePadding)
+{
+  if (alpha == Teuchos::ScalarTraits< Scalar >::zero())
+    putScalar(alpha, includePadding);
+  else
+    assign(alpha * (*this), includePadding);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+update(const Scalar & alpha,
+       const MDVector< Scalar > & a,
+       const Scalar & gamma,
+       bool includePadding)
+{
+  // As in the BLAS, this MDVector is not read if gamma is zero
+  if (gamma == Teuchos::ScalarTraits< Scalar >::zero())
+    assign(alpha * a, includePadding);
+  else
+    assign(alpha * a + gamma * (*this), includePadding);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+update(const Scalar & alpha,
+       const MDVector< Scalar > & a,
+       const Scalar & beta,
+       const MDVector< Scalar > & b,
+       const Scalar & gamma,
+       bool includePadding)
+{
+  // As in the BLAS, this MDVector is not read if gamma is zero
+  if (gamma == Teuchos::ScalarTraits< Scalar >::zero())
+    assign(alpha * a + beta * b, includePadding);
+  else
+    assign(alpha * a + beta * b + gamma * (*this), includePadding);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+elementWiseMultiply(const Scalar & scalarAB,
+                    const MDVector< Scalar > & a,
+                    const MDVector< Scalar > & b,
+                    const Scalar & scalarThis,
+                    bool includePadding)
+{
+  // As in the BLAS, this MDVector is not read if scalarThis is zero
+  if (scalarThis == Teuchos::ScalarTraits< Scalar >::zero())
+    assign(scalarAB * (a * b), includePadding);
+  else
+    assign(scalarAB * (a * b) + scalarThis * (*this), includePadding);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+reciprocal(const MDVector< Scalar > & a,
+           bool includePadding)
+{
+  typedef ElementWiseUnary< ElementWiseTerminal< Scalar >,
+                            ReciprocalOp< Scalar > > expr_type;
+  assign(expr_type(ElementWiseTerminal< Scalar >(a)), includePadding);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+abs(const MDVector< Scalar > & a,
+    bool includePadding)
+{
+  typedef ElementWiseUnary< ElementWiseTerminal< Scalar >,
+                            AbsValueOp< Scalar > > expr_type;
+  assign(expr_type(ElementWiseTerminal< Scalar >(a)), includePadding);
+}
+
+////////////////////////////////////////////////////////////////////////
+
 template< class Scalar >
 void
 MDVector< Scalar >::
 updateCommPad()
 {
-  for (int axis = 0; axis < numDims(); ++axis)
+  if (_commPadStrategy == AXIS_BY_AXIS)
+  {
+    for (int axis = 0; axis < numDims(); ++axis)
+    {
+      updateCommPad(axis);
+    }
+  }
+  else
   {
-    updateCommPad(axis);
+    startUpdateCommPad();
+    endUpdateCommPad();
   }
 }
 
@@ -2796,6 +4136,32 @@ startUpdateCommPad(int axis)
   if (_sendMessages.empty()) initializeMessages();
 
 #ifdef HAVE_MPI
+  // If the messages along this axis are packed, copy the send regions
+  // into their contiguous buffers
+  bool packed = getPackedCommPad(axis);
+  if (packed)
+  {
+    initializePackBuffers(axis);
+    for (int boundary = 0; boundary < 2; ++boundary)
+    {
+      MessageInfo message = _sendMessages[axis][boundary];
+      if (message.proc >= 0)
+        packMDArrayView(message.dataview, message.packBuffer.getRawPtr());
+    }
+  }
+
+  // If persistent requests are being used, simply start them
+  if (_persistentCommPad)
+  {
+    if (_persistentRequests.is_null()) initializePersistentRequests();
+    Teuchos::Array< MPI_Request > & requests =
+      _persistentRequests->requests[axis];
+    if (requests.size() > 0)
+      if (MPI_Startall(requests.size(), requests.getRawPtr()))
+        throw std::runtime_error("Domi::MDVector: Error in MPI_Startall");
+    return;
+  }
+
   int rank    = _teuchosComm->getRank();
   int numProc = _teuchosComm->getSize();
   int tag;
@@ -2823,13 +4189,24 @@ startUpdateCommPad(int axis)
            << message.proc << ", tag = " << tag << endl;
 #endif
 
-      if (MPI_Isend(message.buffer,
-                    1,
-                    *(message.datatype),
-                    message.proc,
-                    tag,
-                    communicator(),
-                    &request))
+      int ierr;
+      if (packed)
+        ierr = MPI_Isend(message.packBuffer.getRawPtr(),
+                         message.packBuffer.size(),
+                         mpiType< Scalar >(),
+                         message.proc,
+                         tag,
+                         communicator(),
+                         &request);
+      else
+        ierr = MPI_Isend(message.buffer,
+                         1,
+                         *(message.datatype),
+                         message.proc,
+                         tag,
+                         communicator(),
+                         &request);
+      if (ierr)
         throw std::runtime_error("Domi::MDVector: Error in MPI_Isend");
       _requests.push_back(request);
     }
@@ -2849,13 +4226,24 @@ startUpdateCommPad(int axis)
            << message.proc << ", tag = " << tag << endl;
 #endif
 
-      if (MPI_Irecv(message.buffer,
-                    1,
-                    *(message.datatype),
-                    message.proc,
-                    tag,
-                    communicator(),
-                    &request))
+      int ierr;
+      if (packed)
+        ierr = MPI_Irecv(message.packBuffer.getRawPtr(),
+                         message.packBuffer.size(),
+                         mpiType< Scalar >(),
+                         message.proc,
+                         tag,
+                         communicator(),
+                         &request);
+      else
+        ierr = MPI_Irecv(message.buffer,
+                         1,
+                         *(message.datatype),
+                         message.proc,
+                         tag,
+                         communicator(),
+                         &request);
+      if (ierr)
         throw std::runtime_error("Domi::MDVector: Error in MPI_Irecv");
       _requests.push_back(request);
     }
@@ -2893,7 +4281,19 @@ MDVector< Scalar >::
 endUpdateCommPad(int axis)
 {
 #ifdef HAVE_MPI
-  if (_requests.size() > 0)
+  // If persistent requests are being used, wait on the requests for
+  // this axis.  The requests are inactive, not freed, upon completion.
+  if (_persistentCommPad && ! _persistentRequests.is_null())
+  {
+    Teuchos::Array< MPI_Request > & requests =
+      _persistentRequests->requests[axis];
+    if (requests.size() > 0)
+      if (MPI_Waitall(requests.size(),
+                      requests.getRawPtr(),
+                      MPI_STATUSES_IGNORE))
+        throw std::runtime_error("Domi::MDVector: Error in MPI_Waitall");
+  }
+  else if (_requests.size() > 0)
   {
     Teuchos::Array< MPI_Status > status(_requests.size());
     if (MPI_Waitall(_requests.size(),
@@ -2902,26 +4302,442 @@ endUpdateCommPad(int axis)
       throw std::runtime_error("Domi::MDVector: Error in MPI_Waitall");
     _requests.clear();
   }
+
+  // If the messages along this axis are packed, copy the received
+  // buffers into the communication padding
+  if (getPackedCommPad(axis))
+  {
+    for (int boundary = 0; boundary < 2; ++boundary)
+    {
+      MessageInfo message = _recvMessages[axis][boundary];
+      if (message.proc >= 0)
+        unpackMDArrayView(message.packBuffer.getRawPtr(), message.dataview);
+    }
+  }
 #endif
 }
 
 ////////////////////////////////////////////////////////////////////////
 
 template< class Scalar >
-MDVector< Scalar >
+void
 MDVector< Scalar >::
-operator[](dim_type index) const
+startUpdateCommPad()
 {
-  MDVector< Scalar > result(*this,
-                                  _nextAxis,
-                                  index);
-  int newAxis = _nextAxis + 1;
-  if (newAxis >= result.numDims()) newAxis = 0;
-  result._nextAxis = newAxis;
-  return result;
-}
+  // Initialize the _neighborSendMessages and _neighborRecvMessages
+  // members on the first call to startUpdateCommPad().
+  if (_neighborSendMessages.empty()) initializeNeighborMessages();
+  int numDirections = _neighborSendMessages.size();
 
-////////////////////////////////////////////////////////////////////////
+#ifdef HAVE_MPI
+  int tag;
+  // Since HAVE_MPI is defined, we know that _teuchosComm points to a
+  // const Teuchos::MpiComm< int >.  We downcast, extract and
+  // dereference so that we can get access to the MPI_Comm used to
+  // construct it.
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+
+  // Post the non-blocking receives.  Each message is tagged with the
+  // direction in which it is sent, which distinguishes messages
+  // between the same pair of processors along periodic axes.  The
+  // message received from the neighbor in direction k was sent by
+  // that neighbor in the opposite direction.
+  MPI_Request request;
+  for (int k = 0; k < numDirections; ++k)
+  {
+    MessageInfo message = _neighborRecvMessages[k];
+    if (message.proc >= 0 && useNeighborMessage(k))
+    {
+      tag = numDirections - 1 - k;
+      if (MPI_Irecv(message.buffer,
+                    1,
+                    *(message.datatype),
+                    message.proc,
+                    tag,
+                    communicator(),
+                    &request))
+        throw std::runtime_error("Domi::MDVector: Error in MPI_Irecv");
+      _requests.push_back(request);
+    }
+  }
+
+  // Post the non-blocking sends
+  for (int k = 0; k < numDirections; ++k)
+  {
+    MessageInfo message = _neighborSendMessages[k];
+    if (message.proc >= 0 && useNeighborMessage(k))
+    {
+      tag = k;
+      if (MPI_Isend(message.buffer,
+                    1,
+                    *(message.datatype),
+                    message.proc,
+                    tag,
+                    communicator(),
+                    &request))
+        throw std::runtime_error("Domi::MDVector: Error in MPI_Isend");
+      _requests.push_back(request);
+    }
+  }
+#else
+  // HAVE_MPI is not defined, so we are on a single processor, and any
+  // valid message is to and from ourselves along periodic axes.  The
+  // receive buffer for direction k is filled from the send buffer for
+  // the opposite direction.
+  for (int k = 0; k < numDirections; ++k)
+  {
+    if (_neighborRecvMessages[k].proc >= 0 && useNeighborMessage(k))
+    {
+      MDArrayView< Scalar > recvView = _neighborRecvMessages[k].dataview;
+      MDArrayView< Scalar > sendView =
+        _neighborSendMessages[numDirections - 1 - k].dataview;
+      typename MDArrayView< Scalar >::iterator it_recv = recvView.begin();
+      typename MDArrayView< Scalar >::iterator it_send = sendView.begin();
+      for ( ; it_recv != recvView.end(); ++it_recv, ++it_send)
+        *it_recv = *it_send;
+    }
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+endUpdateCommPad()
+{
+#ifdef HAVE_MPI
+  if (_requests.size() > 0)
+  {
+    if (MPI_Waitall(_requests.size(),
+                    _requests.getRawPtr(),
+                    MPI_STATUSES_IGNORE))
+      throw std::runtime_error("Domi::MDVector: Error in MPI_Waitall");
+    _requests.clear();
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+template< class FUNCTOR >
+void
+MDVector< Scalar >::
+updateCommPadAndApply(const FUNCTOR & kernel)
+{
+  startUpdateCommPad();
+
+  // Compute the deep interior while the messages are in flight
+  Teuchos::Array< Slice > deepInterior(numDims());
+  bool empty = false;
+  for (int axis = 0; axis < numDims(); ++axis)
+  {
+    deepInterior[axis] = getLocalDeepInteriorBounds(axis);
+    if (deepInterior[axis].stop() <= deepInterior[axis].start())
+      empty = true;
+  }
+  if (! empty) kernel(deepInterior());
+
+  endUpdateCommPad();
+
+  // Compute the boundary shell
+  Teuchos::Array< Teuchos::Array< Slice > > shell =
+    getLocalBoundaryShellBounds();
+  for (int box = 0; box < shell.size(); ++box)
+    kernel(shell[box]());
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+updateCommPadWidth(int width)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (width < 0),
+    InvalidArgument,
+    "width = " << width << " must be non-negative");
+
+#ifdef HAVE_MPI
+  int rank    = _teuchosComm->getRank();
+  int numProc = _teuchosComm->getSize();
+  int tag;
+  // Since HAVE_MPI is defined, we know that _teuchosComm points to a
+  // const Teuchos::MpiComm< int >.  We downcast, extract and
+  // dereference so that we can get access to the MPI_Comm used to
+  // construct it.
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+#endif
+
+  for (int axis = 0; axis < numDims(); ++axis)
+  {
+    Teuchos::Tuple< int, 2 > procs =
+      Teuchos::tuple(getLowerNeighbor(axis), getUpperNeighbor(axis));
+    Teuchos::Tuple< int, 2 > widths =
+      Teuchos::tuple(std::min(width, getLowerPadSize(axis)),
+                     std::min(width, getUpperPadSize(axis)));
+
+#ifdef HAVE_MPI
+    Teuchos::Tuple< MDArrayView< Scalar >, 2 > recvViews;
+    Teuchos::Tuple< Teuchos::Array< Scalar >, 2 > sendBuffers;
+    Teuchos::Tuple< Teuchos::Array< Scalar >, 2 > recvBuffers;
+    Teuchos::Array< MPI_Request > requests;
+    MPI_Request request;
+
+    // Post the non-blocking receives
+    for (int boundary = 0; boundary < 2; ++boundary)
+    {
+      if (procs[boundary] < 0 || widths[boundary] == 0) continue;
+      recvViews[boundary] = getCommPadWidthView(axis, boundary, false,
+                                                width);
+      recvBuffers[boundary].resize(
+        computeSize(recvViews[boundary].dimensions()));
+      tag = 2 * (procs[boundary] * numProc + rank) + (1-boundary);
+      if (MPI_Irecv(recvBuffers[boundary].getRawPtr(),
+                    recvBuffers[boundary].size(),
+                    mpiType< Scalar >(),
+                    procs[boundary],
+                    tag,
+                    communicator(),
+                    &request))
+        throw std::runtime_error("Domi::MDVector: Error in MPI_Irecv");
+      requests.push_back(request);
+    }
+
+    // Pack and post the non-blocking sends
+    for (int boundary = 0; boundary < 2; ++boundary)
+    {
+      if (procs[boundary] < 0 || widths[boundary] == 0) continue;
+      MDArrayView< Scalar > sendView =
+        getCommPadWidthView(axis, boundary, true, width);
+      sendBuffers[boundary].resize(computeSize(sendView.dimensions()));
+      packMDArrayView(sendView, sendBuffers[boundary].getRawPtr());
+      tag = 2 * (rank * numProc + procs[boundary]) + boundary;
+      if (MPI_Isend(sendBuffers[boundary].getRawPtr(),
+                    sendBuffers[boundary].size(),
+                    mpiType< Scalar >(),
+                    procs[boundary],
+                    tag,
+                    communicator(),
+                    &request))
+        throw std::runtime_error("Domi::MDVector: Error in MPI_Isend");
+      requests.push_back(request);
+    }
+
+    // Wait for the messages and unpack the receive buffers
+    if (requests.size() > 0)
+      if (MPI_Waitall(requests.size(),
+                      requests.getRawPtr(),
+                      MPI_STATUSES_IGNORE))
+        throw std::runtime_error("Domi::MDVector: Error in MPI_Waitall");
+    for (int boundary = 0; boundary < 2; ++boundary)
+      if (recvBuffers[boundary].size() > 0)
+        unpackMDArrayView(recvBuffers[boundary].getRawPtr(),
+                          recvViews[boundary]);
+#else
+    // HAVE_MPI is not defined, so we are on a single processor.
+    // However, if the axis is periodic, we need to copy the
+    // appropriate data to the communication padding.
+    if (isPeriodic(axis))
+    {
+      for (int sendBndry = 0; sendBndry < 2; ++sendBndry)
+      {
+        int recvBndry = 1 - sendBndry;
+        if (widths[recvBndry] == 0) continue;
+        MDArrayView< Scalar > recvView =
+          getCommPadWidthView(axis, recvBndry, false, width);
+        MDArrayView< Scalar > sendView =
+          getCommPadWidthView(axis, sendBndry, true, width);
+        typename MDArrayView< Scalar >::iterator it_recv = recvView.begin();
+        typename MDArrayView< Scalar >::iterator it_send = sendView.begin();
+        for ( ; it_recv != recvView.end(); ++it_recv, ++it_send)
+          *it_recv = *it_send;
+      }
+    }
+#endif
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+MDArrayView< Scalar >
+MDVector< Scalar >::
+getCommPadWidthView(int msgAxis,
+                    int boundary,
+                    bool send,
+                    int width)
+{
+  MDArrayView< Scalar > view = _mdArrayView;
+  for (int axis = 0; axis < numDims(); ++axis)
+  {
+    dim_type dim      = _mdArrayView.dimension(axis);
+    int      lowerPad = getLowerPadSize(axis);
+    int      upperPad = getUpperPadSize(axis);
+    dim_type start    = 0;
+    dim_type stop     = dim;
+    if (axis == msgAxis)
+    {
+      // Along the message axis, the region is the given width of the
+      // communication padding, or of the data adjacent to it
+      int msgWidth = std::min(width, (boundary == 0) ? lowerPad : upperPad);
+      if (boundary == 0)
+      {
+        start = send ? lowerPad : lowerPad - msgWidth;
+        if (send && isReplicatedBoundary(axis) && getCommIndex(axis) == 0)
+          start += 1;
+      }
+      else
+      {
+        start = send ? dim - upperPad - msgWidth : dim - upperPad;
+        if (send && isReplicatedBoundary(axis) &&
+            getCommIndex(axis) == getCommDim(axis)-1)
+          start -= 1;
+      }
+      stop = start + msgWidth;
+    }
+    else
+    {
+      // Along the other axes, the region includes the boundary
+      // padding and the given width of the communication padding, so
+      // that edges and corners are updated by successive axes
+      if (getLowerNeighbor(axis) >= 0)
+        start = lowerPad - std::min(width, lowerPad);
+      if (getUpperNeighbor(axis) >= 0)
+        stop  = dim - upperPad + std::min(width, upperPad);
+    }
+    view = MDArrayView< Scalar >(view, axis, Slice(start, stop));
+  }
+  return view;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+setCommPadStrategy(CommPadStrategy strategy)
+{
+  _commPadStrategy = strategy;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+CommPadStrategy
+MDVector< Scalar >::
+getCommPadStrategy() const
+{
+  return _commPadStrategy;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+setPersistentCommPad(bool persistent)
+{
+  _persistentCommPad = persistent;
+#ifdef HAVE_MPI
+  // Release any existing persistent requests.  If persistent requests
+  // are requested, they will be created on the next update.
+  _persistentRequests = Teuchos::null;
+  if (_persistentCommPad && ! _sendMessages.empty())
+    initializePersistentRequests();
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+MDVector< Scalar >::
+getPersistentCommPad() const
+{
+  return _persistentCommPad;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+setPackedCommPad(int axis,
+                 bool packed)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ((axis < 0) || (axis >= numDims())),
+    RangeError,
+    "axis = " << axis << " is invalid for MDVector with " << numDims()
+    << " dimensions");
+  if (_packedCommPad.size() < numDims()) _packedCommPad.resize(numDims(), 0);
+  _packedCommPad[axis] = packed ? 1 : 0;
+#ifdef HAVE_MPI
+  // The persistent requests depend on whether messages are packed, so
+  // release and recreate them
+  if (! _persistentRequests.is_null())
+  {
+    _persistentRequests = Teuchos::null;
+    initializePersistentRequests();
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+setPackedCommPad(bool packed)
+{
+  _packedCommPad.assign(numDims(), packed ? 1 : 0);
+#ifdef HAVE_MPI
+  if (! _persistentRequests.is_null())
+  {
+    _persistentRequests = Teuchos::null;
+    initializePersistentRequests();
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+MDVector< Scalar >::
+getPackedCommPad(int axis) const
+{
+  if (axis < 0 || axis >= _packedCommPad.size()) return false;
+  return (_packedCommPad[axis] != 0);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+MDVector< Scalar >
+MDVector< Scalar >::
+operator[](dim_type index) const
+{
+  MDVector< Scalar > result(*this,
+                                  _nextAxis,
+                                  index);
+  int newAxis = _nextAxis + 1;
+  if (newAxis >= result.numDims()) newAxis = 0;
+  result._nextAxis = newAxis;
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
 
 template< class Scalar >
 MDVector< Scalar >
@@ -2971,7 +4787,7 @@ initializeMessages()
     // Set the initial values for sizes, subsizes and starts
     for (int axis = 0; axis < ndims; ++axis)
     {
-      sizes[axis]    = _mdArrayRcp.dimension(axis);
+      sizes[axis]    = _mdArrayRcp.allocatedDimension(axis);
       subsizes[axis] = _mdArrayView.dimension(axis);
       starts[axis]   = 0;
     }
@@ -3021,7 +4837,7 @@ initializeMessages()
                                commPad.get());
       MPI_Type_commit(commPad.get());
       messageInfo.datatype = commPad;
-#else
+#endif
       messageInfo.dataview = _mdArrayView;
       for (int axis = 0; axis < numDims(); ++axis)
       {
@@ -3030,7 +4846,6 @@ initializeMessages()
                                                      axis,
                                                      slice);
       }
-#endif
 
     }
     _recvMessages[msgAxis][0] = messageInfo;
@@ -3064,7 +4879,7 @@ initializeMessages()
                                commPad.get());
       MPI_Type_commit(commPad.get());
       messageInfo.datatype = commPad;
-#else
+#endif
       messageInfo.dataview = _mdArrayView;
       for (int axis = 0; axis < numDims(); ++axis)
       {
@@ -3073,7 +4888,6 @@ initializeMessages()
                                                      axis,
                                                      slice);
       }
-#endif
 
     }
     _sendMessages[msgAxis][0] = messageInfo;
@@ -3119,7 +4933,7 @@ initializeMessages()
                                commPad.get());
       MPI_Type_commit(commPad.get());
       messageInfo.datatype = commPad;
-#else
+#endif
       messageInfo.dataview = _mdArrayView;
       for (int axis = 0; axis < numDims(); ++axis)
       {
@@ -3128,7 +4942,6 @@ initializeMessages()
                                                      axis,
                                                      slice);
       }
-#endif
     }
     _recvMessages[msgAxis][1] = messageInfo;
 
@@ -3162,7 +4975,7 @@ initializeMessages()
                                commPad.get());
       MPI_Type_commit(commPad.get());
       messageInfo.datatype = commPad;
-#else
+#endif
       messageInfo.dataview = _mdArrayView;
       for (int axis = 0; axis < numDims(); ++axis)
       {
@@ -3171,7 +4984,6 @@ initializeMessages()
                                                      axis,
                                                      slice);
       }
-#endif
 
     }
     _sendMessages[msgAxis][1] = messageInfo;
@@ -3189,35 +5001,309 @@ initializeMessages()
   }
 #endif
 
+#ifdef HAVE_MPI
+  // Now that the messages are defined, create the persistent requests
+  // if they have been requested
+  if (_persistentCommPad) initializePersistentRequests();
+#endif
 }
 
 ////////////////////////////////////////////////////////////////////////
 
+#ifdef HAVE_MPI
+
 template< class Scalar >
 void
 MDVector< Scalar >::
-writeBinary(const std::string & filename,
-            bool includeBndryPad) const
+initializePackBuffers(int axis)
 {
-  FILE * datafile;
-  // If we are using MPI and overwriting an existing file, and the new
-  // file is shorter than the old file, it appears that the new file
-  // will retain the old file's length and trailing data.  To prevent
-  // this behavior, we open and close the file to give it zero length.
-  int pid = _teuchosComm->getRank();
-  if (pid == 0)
+  if (_sendMessages.empty()) initializeMessages();
+  for (int boundary = 0; boundary < 2; ++boundary)
   {
-    datafile = fopen(filename.c_str(), "w");
-    fclose(datafile);
+    MessageInfo & sendMessage = _sendMessages[axis][boundary];
+    if (sendMessage.proc >= 0 && sendMessage.packBuffer.is_null())
+      sendMessage.packBuffer = Teuchos::arcp< Scalar >(
+        computeSize(sendMessage.dataview.dimensions()));
+    MessageInfo & recvMessage = _recvMessages[axis][boundary];
+    if (recvMessage.proc >= 0 && recvMessage.packBuffer.is_null())
+      recvMessage.packBuffer = Teuchos::arcp< Scalar >(
+        computeSize(recvMessage.dataview.dimensions()));
   }
-  _teuchosComm->barrier();
+}
 
-  // Get the pointer to this MDVector's MDArray, including all padding
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+initializePersistentRequests()
+{
+  int rank    = _teuchosComm->getRank();
+  int numProc = _teuchosComm->getSize();
+  int tag;
+  // Since HAVE_MPI is defined, we know that _teuchosComm points to a
+  // const Teuchos::MpiComm< int >.  We downcast, extract and
+  // dereference so that we can get access to the MPI_Comm used to
+  // construct it.
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+
+  // Create the persistent sends and receives for each axis, using the
+  // same tags as startUpdateCommPad()
+  _persistentRequests = Teuchos::rcp(new PersistentRequests);
+  _persistentRequests->requests.resize(numDims());
+  MPI_Request request;
+  for (int axis = 0; axis < numDims(); ++axis)
+  {
+    // Packed messages are sent from and received into their contiguous
+    // buffers, which must be allocated before the requests are created
+    bool packed = getPackedCommPad(axis);
+    if (packed) initializePackBuffers(axis);
+    for (int boundary = 0; boundary < 2; ++boundary)
+    {
+      MessageInfo message = _sendMessages[axis][boundary];
+      if (message.proc >= 0)
+      {
+        tag = 2 * (rank * numProc + message.proc) + boundary;
+        int ierr;
+        if (packed)
+          ierr = MPI_Send_init(message.packBuffer.getRawPtr(),
+                               message.packBuffer.size(),
+                               mpiType< Scalar >(),
+                               message.proc,
+                               tag,
+                               communicator(),
+                               &request);
+        else
+          ierr = MPI_Send_init(message.buffer,
+                               1,
+                               *(message.datatype),
+                               message.proc,
+                               tag,
+                               communicator(),
+                               &request);
+        if (ierr)
+          throw std::runtime_error("Domi::MDVector: Error in MPI_Send_init");
+        _persistentRequests->requests[axis].push_back(request);
+      }
+    }
+    for (int boundary = 0; boundary < 2; ++boundary)
+    {
+      MessageInfo message = _recvMessages[axis][boundary];
+      if (message.proc >= 0)
+      {
+        tag = 2 * (message.proc * numProc + rank) + (1-boundary);
+        int ierr;
+        if (packed)
+          ierr = MPI_Recv_init(message.packBuffer.getRawPtr(),
+                               message.packBuffer.size(),
+                               mpiType< Scalar >(),
+                               message.proc,
+                               tag,
+                               communicator(),
+                               &request);
+        else
+          ierr = MPI_Recv_init(message.buffer,
+                               1,
+                               *(message.datatype),
+                               message.proc,
+                               tag,
+                               communicator(),
+                               &request);
+        if (ierr)
+          throw std::runtime_error("Domi::MDVector: Error in MPI_Recv_init");
+        _persistentRequests->requests[axis].push_back(request);
+      }
+    }
+  }
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+initializeNeighborMessages()
+{
+  int ndims = numDims();
+  int rank  = _teuchosComm->getRank();
+  int numDirections = 1;
+  for (int axis = 0; axis < ndims; ++axis)
+    numDirections *= 3;
+
+  Teuchos::Array<int> sizes(ndims);
+  Teuchos::Array<int> subsizes(ndims);
+  Teuchos::Array<int> sendStarts(ndims);
+  Teuchos::Array<int> recvStarts(ndims);
+  MessageInfo sendInfo;
+  MessageInfo recvInfo;
+
+  _neighborSendMessages.resize(numDirections);
+  _neighborRecvMessages.resize(numDirections);
+
+#ifdef HAVE_MPI
+  int order = mpiOrder(getLayout());
+  MPI_Datatype datatype = mpiType< Scalar >();
+#endif
+
+  for (int k = 0; k < numDirections; ++k)
+  {
+    // Decode the direction, compute the rank of the neighbor in that
+    // direction, and compute the send and receive regions.  Along an
+    // axis with a zero direction component, the regions span the
+    // local dimension, excluding any communication padding, so that
+    // they match the regions of the neighbor, which has the same
+    // decomposition along that axis.
+    int proc = rank;
+    int kk   = k;
+    bool center = true;
+    for (int axis = 0; axis < ndims; ++axis)
+    {
+      int direction = (kk % 3) - 1;
+      kk /= 3;
+      int dim      = _mdArrayView.dimension(axis);
+      int lowerPad = getLowerPadSize(axis);
+      int upperPad = getUpperPadSize(axis);
+      int lowerNeighbor = getLowerNeighbor(axis);
+      int upperNeighbor = getUpperNeighbor(axis);
+      sizes[axis] = _mdArrayRcp.allocatedDimension(axis);
+      if (direction == 0)
+      {
+        int start = (lowerNeighbor >= 0) ? lowerPad : 0;
+        int stop  = dim - ((upperNeighbor >= 0) ? upperPad : 0);
+        subsizes[axis]   = stop - start;
+        sendStarts[axis] = start;
+        recvStarts[axis] = start;
+      }
+      else if (direction < 0)
+      {
+        center = false;
+        if (lowerNeighbor < 0 || lowerPad == 0) proc = -1;
+        if (proc >= 0) proc += lowerNeighbor - rank;
+        subsizes[axis]   = lowerPad;
+        recvStarts[axis] = 0;
+        sendStarts[axis] = lowerPad;
+        if (isReplicatedBoundary(axis) && getCommIndex(axis) == 0)
+          sendStarts[axis] += 1;
+      }
+      else
+      {
+        center = false;
+        if (upperNeighbor < 0 || upperPad == 0) proc = -1;
+        if (proc >= 0) proc += upperNeighbor - rank;
+        subsizes[axis]   = upperPad;
+        recvStarts[axis] = dim - upperPad;
+        sendStarts[axis] = dim - 2 * upperPad;
+        if (isReplicatedBoundary(axis) &&
+            getCommIndex(axis) == getCommDim(axis)-1)
+          sendStarts[axis] -= 1;
+      }
+    }
+    if (center) proc = -1;
+
+    sendInfo.buffer = (void*) getData().getRawPtr();
+    sendInfo.proc   = proc;
+    sendInfo.axis   = -1;
+    recvInfo.buffer = sendInfo.buffer;
+    recvInfo.proc   = proc;
+    recvInfo.axis   = -1;
+
+    if (proc >= 0)
+    {
+#ifdef HAVE_MPI
+      Teuchos::RCP< MPI_Datatype > sendType = Teuchos::rcp(new MPI_Datatype);
+      MPI_Type_create_subarray(ndims,
+                               &sizes[0],
+                               &subsizes[0],
+                               &sendStarts[0],
+                               order,
+                               datatype,
+                               sendType.get());
+      MPI_Type_commit(sendType.get());
+      sendInfo.datatype = sendType;
+      Teuchos::RCP< MPI_Datatype > recvType = Teuchos::rcp(new MPI_Datatype);
+      MPI_Type_create_subarray(ndims,
+                               &sizes[0],
+                               &subsizes[0],
+                               &recvStarts[0],
+                               order,
+                               datatype,
+                               recvType.get());
+      MPI_Type_commit(recvType.get());
+      recvInfo.datatype = recvType;
+#else
+      sendInfo.dataview = _mdArrayView;
+      recvInfo.dataview = _mdArrayView;
+      for (int axis = 0; axis < ndims; ++axis)
+      {
+        Slice sendSlice(sendStarts[axis], sendStarts[axis] + subsizes[axis]);
+        sendInfo.dataview = MDArrayView< Scalar >(sendInfo.dataview,
+                                                  axis,
+                                                  sendSlice);
+        Slice recvSlice(recvStarts[axis], recvStarts[axis] + subsizes[axis]);
+        recvInfo.dataview = MDArrayView< Scalar >(recvInfo.dataview,
+                                                  axis,
+                                                  recvSlice);
+      }
+#endif
+    }
+    _neighborSendMessages[k] = sendInfo;
+    _neighborRecvMessages[k] = recvInfo;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+MDVector< Scalar >::
+useNeighborMessage(int direction) const
+{
+  if (_commPadStrategy != ALL_FACES) return true;
+  // Count the number of axes along which the direction is non-zero.
+  // Faces have exactly one.
+  int count = 0;
+  for (int axis = 0; axis < numDims(); ++axis)
+  {
+    if (direction % 3 != 1) ++count;
+    direction /= 3;
+  }
+  return (count == 1);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+writeBinary(const std::string & filename,
+            bool includeBndryPad) const
+{
+  FILE * datafile;
+  // If we are using MPI and overwriting an existing file, and the new
+  // file is shorter than the old file, it appears that the new file
+  // will retain the old file's length and trailing data.  To prevent
+  // this behavior, we open and close the file to give it zero length.
+  int pid = _teuchosComm->getRank();
+  if (pid == 0)
+  {
+    datafile = fopen(filename.c_str(), "w");
+    fclose(datafile);
+  }
+  _teuchosComm->barrier();
+
+  // Get the pointer to this MDVector's MDArray, including all padding
   const Scalar * buffer = getData(true).getRawPtr();
 
   // Compute either _fileInfo or _fileInfoWithBndry, whichever is
   // appropriate, and return a reference to that fileInfo object
   Teuchos::RCP< FileInfo > & fileInfo = computeFileInfo(includeBndryPad);
+  IOTimer timer(getIOConfig(), "writeBinary",
+                computeSize(fileInfo->dataShape) * sizeof(Scalar));
 
   // Parallel output
 #ifdef HAVE_MPI
@@ -3231,53 +5317,775 @@ writeBinary(const std::string & filename,
   const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
     *(mpiComm->getRawMpiComm());
 
-  // Compute the access mode
-  int access = MPI_MODE_WRONLY | MPI_MODE_CREATE;
+  // Compute the access mode
+  int access = MPI_MODE_WRONLY | MPI_MODE_CREATE;
+
+  // I copy the filename C string, because the c_str() method returns
+  // a const char*, and the MPI_File_open() function requires
+  // (incorrectly) a non-const char*.
+  char * cstr = new char[filename.size()+1];
+  std::strcpy(cstr, filename.c_str());
+
+  // Use MPI I/O to write the binary file
+  MPI_File   mpiFile;
+  MPI_Status status;
+  char       datarep[7] = "native";
+  MPI_Info   info = getIOConfig()->getInfo();
+  MPI_File_open(communicator(), cstr, access, info, &mpiFile);
+  MPI_File_set_view(mpiFile, 0, mpiType< Scalar >(),
+                    *(fileInfo->filetype), datarep, info);
+  MPI_File_write_all(mpiFile, (void*)buffer, 1, *(fileInfo->datatype),
+                     &status);
+  MPI_File_close(&mpiFile);
+
+  // Delete the C string
+  delete [] cstr;
+
+  // Serial output
+#else
+
+  // Initialize the data file
+  datafile = fopen(filename.c_str(), "w");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    datafile == 0,
+    FileError,
+    "Cannot open file '" << filename << "' for writing");
+
+  // Obtain the data to write, including the boundary padding if
+  // requested, and write it in contiguous runs
+  MDArrayView< const Scalar > mdArrayView = getData(includeBndryPad);
+  bool complete = writeLocal(datafile, mdArrayView);
+
+  // Close the data file
+  fclose(datafile);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! complete,
+    FileError,
+    "Incomplete write to file '" << filename << "'");
+
+#endif
+
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+writeBinary(const std::string & filename,
+            const Teuchos::ArrayView< const Slice > & region,
+            bool includeBndryPad) const
+{
+  transferRegion(filename, region, includeBndryPad, true);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Teuchos::RCP< AsyncWrite >
+MDVector< Scalar >::
+startWriteBinary(const std::string & filename,
+                 bool includeBndryPad) const
+{
+  int ndims = numDims();
+  Teuchos::RCP< FileInfo > & fileInfo = computeFileInfo(includeBndryPad);
+  if (_asyncWrites.is_null())
+    _asyncWrites = Teuchos::rcp(new AsyncWriteState);
+
+  // Select the next staging buffer, and wait for the write that last
+  // used it to complete.  The other write is also waited for if it
+  // is to the same file, since the new write truncates the file.
+  int next = _asyncWrites->next;
+  _asyncWrites->next = 1 - next;
+  if (! _asyncWrites->writes[next].is_null())
+  {
+    _asyncWrites->writes[next]->wait();
+    _asyncWrites->writes[next] = Teuchos::null;
+  }
+  if (! _asyncWrites->writes[1-next].is_null() &&
+      _asyncWrites->writes[1-next]->getFilename() == filename)
+  {
+    _asyncWrites->writes[1-next]->wait();
+    _asyncWrites->writes[1-next] = Teuchos::null;
+  }
+
+  // Time the write from the staging copy until it is complete.  The
+  // AsyncWrite keeps the timer until it is waited for.
+  size_type size = computeSize(fileInfo->dataShape);
+  Teuchos::RCP< IOTimer > timer =
+    Teuchos::rcp(new IOTimer(getIOConfig(), "startWriteBinary",
+                             size * sizeof(Scalar)));
+
+  // Copy the local data that is written to the file to the staging
+  // buffer, contiguously
+  Teuchos::ArrayRCP< Scalar > & buffer = _asyncWrites->buffers[next];
+  if (buffer.size() != size) buffer = Teuchos::arcp< Scalar >(size);
+  MDArrayView< const Scalar > data = getData(true);
+  for (int axis = 0; axis < ndims; ++axis)
+    data = MDArrayView< const Scalar >(data, axis,
+      Slice(fileInfo->dataStart[axis],
+            fileInfo->dataStart[axis] + fileInfo->dataShape[axis]));
+  Teuchos::Array< size_type > strides =
+    computeStrides< size_type, dim_type >(fileInfo->dataShape, getLayout());
+  threadedCopy(data.getRawPtr(), data.strides()(), buffer.getRawPtr(),
+               strides(), fileInfo->dataShape(), getLayout());
+
+  // Start the write from the staging buffer
+  Teuchos::ArrayRCP< const char > bytes =
+    Teuchos::arcp_reinterpret_cast< const char >(buffer.getConst());
+#ifdef HAVE_MPI
+  _asyncWrites->writes[next] =
+    Teuchos::rcp(new AsyncWrite(_teuchosComm, filename, bytes, (int) size,
+                                mpiType< Scalar >(), *(fileInfo->filetype),
+                                getIOConfig()->getInfo()));
+#else
+  _asyncWrites->writes[next] =
+    Teuchos::rcp(new AsyncWrite(filename, bytes));
+#endif
+  _asyncWrites->writes[next]->setTimer(timer);
+  return _asyncWrites->writes[next];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+endWriteBinary() const
+{
+  if (_asyncWrites.is_null()) return;
+
+  // The next buffer to be used is the one with the older write
+  for (int i = 0; i < 2; ++i)
+  {
+    int index = (_asyncWrites->next + i) % 2;
+    if (! _asyncWrites->writes[index].is_null())
+    {
+      _asyncWrites->writes[index]->wait();
+      _asyncWrites->writes[index] = Teuchos::null;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+readBinary(const std::string & filename,
+           bool includeBndryPad)
+{
+  // Get the pointer to this MDVector's MDArray, including all padding
+  const Scalar * buffer = getDataNonConst(true).getRawPtr();
+
+  // Compute either _fileInfo or _fileInfoWithBndry, whichever is
+  // appropriate, and return a reference to that fileInfo object
+  Teuchos::RCP< FileInfo > & fileInfo = computeFileInfo(includeBndryPad);
+  IOTimer timer(getIOConfig(), "readBinary",
+                computeSize(fileInfo->dataShape) * sizeof(Scalar));
+
+  // Parallel input
+#ifdef HAVE_MPI
+
+  // Since HAVE_MPI is defined, we know that _teuchosComm points to a
+  // const Teuchos::MpiComm< int >.  We downcast, extract and
+  // dereference so that we can get access to the MPI_Comm used to
+  // construct it.
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+
+  // Compute the access mode
+  int access = MPI_MODE_RDONLY;
+
+  // I copy the filename C string, because the c_str() method returns
+  // a const char*, and the MPI_File_open() function requires
+  // (incorrectly) a non-const char*.
+  char * cstr = new char[filename.size()+1];
+  std::strcpy(cstr, filename.c_str());
+
+  // Use MPI I/O to read the binary file
+  MPI_File   mpiFile;
+  MPI_Status status;
+  char       datarep[7] = "native";
+  MPI_Info   info = getIOConfig()->getInfo();
+  MPI_File_open(communicator(), cstr, access, info, &mpiFile);
+  MPI_File_set_view(mpiFile, 0, mpiType< Scalar >(),
+                    *(fileInfo->filetype), datarep, info);
+  MPI_File_read_all(mpiFile, (void*)buffer, 1, *(fileInfo->datatype),
+                    &status);
+  MPI_File_close(&mpiFile);
+
+  // Delete the C string
+  delete [] cstr;
+
+  // Serial output
+#else
+
+  // Initialize the data file
+  FILE * datafile;
+  datafile = fopen(filename.c_str(), "r");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    datafile == 0,
+    FileError,
+    "Cannot open file '" << filename << "' for reading");
+
+  // Obtain the MDArrayView to read into, including the boundary
+  // padding if requested, and read it in contiguous runs
+  MDArrayView< Scalar > mdArrayView = getDataNonConst(includeBndryPad);
+  bool complete = readLocal(datafile, mdArrayView);
+
+  // Close the data file
+  fclose(datafile);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! complete,
+    FileError,
+    "Incomplete read from file '" << filename << "'");
+
+#endif
+
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+readBinary(const std::string & filename,
+           const Teuchos::ArrayView< const Slice > & region,
+           bool includeBndryPad)
+{
+  transferRegion(filename, region, includeBndryPad, false);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+size_type
+MDVector< Scalar >::
+writeRun(FILE * datafile,
+         const Scalar * ptr,
+         size_type count)
+{
+  return fwrite((const void *) ptr, sizeof(Scalar), count, datafile);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+size_type
+MDVector< Scalar >::
+readRun(FILE * datafile,
+        Scalar * ptr,
+        size_type count)
+{
+  return fread((void *) ptr, sizeof(Scalar), count, datafile);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+MDVector< Scalar >::
+writeLocal(FILE * datafile,
+           const MDArrayView< const Scalar > & data,
+           const Teuchos::ArrayView< const size_type > & fileStrides,
+           size_type fileOffset)
+{
+  return transferLocal(datafile, data, fileStrides, fileOffset, &writeRun);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+MDVector< Scalar >::
+readLocal(FILE * datafile,
+          const MDArrayView< Scalar > & data,
+          const Teuchos::ArrayView< const size_type > & fileStrides,
+          size_type fileOffset)
+{
+  return transferLocal(datafile, data, fileStrides, fileOffset, &readRun);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+template< class T >
+bool
+MDVector< Scalar >::
+transferLocal(FILE * datafile,
+              const MDArrayView< T > & data,
+              const Teuchos::ArrayView< const size_type > & fileStrides,
+              size_type fileOffset,
+              size_type (*transferRun)(FILE *, T *, size_type))
+{
+  int ndims = data.numDims();
+  Layout layout = data.layout();
+  const Teuchos::Array< dim_type >  & dims    = data.dimensions();
+  const Teuchos::Array< size_type > & strides = data.strides();
+  size_type size = data.size();
+  if (size == 0) return true;
+  T * base = const_cast< T * >(data.getRawPtr());
+  bool complete = true;
+
+  // Contiguous data that is consecutive in the file is transferred
+  // with a single call
+  if (fileStrides.size() == 0 && Domi::isContiguous(dims(), strides(), layout))
+  {
+    complete = (transferRun(datafile, base, size) == size);
+  }
+  else
+  {
+    // Transfer each run along the fastest axis, walking the file
+    // offsets alongside the data offsets if they are strided
+    int fast = (layout == LAST_INDEX_FASTEST) ? ndims - 1 : 0;
+    bool seek = (fileStrides.size() != 0);
+    TransferLineFunctor< T > functor(datafile, base, strides[fast],
+                                     dims[fast], seek, fileOffset,
+                                     transferRun, complete);
+    const size_type * stridePtrs[2] = { strides.getRawPtr(),
+                                        fileStrides.getRawPtr() };
+    walkLines(ndims, 0, dims.getRawPtr(), layout, seek ? 2 : 1, stridePtrs,
+              functor);
+  }
+  return complete;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+MDVector< Scalar >::
+computeRegionIntersection(const std::string & filename,
+                          const Teuchos::ArrayView< const Slice > & region,
+                          const FileInfo & fileInfo,
+                          Teuchos::Array< dim_type > & fileStart,
+                          Teuchos::Array< dim_type > & dataStart,
+                          Teuchos::Array< dim_type > & shape) const
+{
+  int ndims = numDims();
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    region.size() != ndims,
+    InvalidArgument,
+    "Region for file '" << filename << "' has " << region.size()
+    << " Slices, but the MDVector has " << ndims << " dimensions");
+  fileStart.resize(ndims);
+  dataStart.resize(ndims);
+  shape.resize(ndims);
+  bool empty = false;
+  for (int axis = 0; axis < ndims; ++axis)
+  {
+    // Slice::bounds() clips a stop beyond the end, so check explicit
+    // stops first
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      region[axis].stop() != Slice::Default &&
+      region[axis].stop() > fileInfo.fileShape[axis],
+      RangeError,
+      "Region Slice " << region[axis] << " along axis " << axis
+      << " is outside the file dimension " << fileInfo.fileShape[axis]);
+    Slice bounds = region[axis].bounds(fileInfo.fileShape[axis]);
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      bounds.step() != 1,
+      InvalidArgument,
+      "Region Slice " << region[axis] << " along axis " << axis
+      << " does not have a step of one");
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      bounds.start() < 0 || bounds.start() > bounds.stop() ||
+      bounds.stop() > fileInfo.fileShape[axis],
+      RangeError,
+      "Region Slice " << region[axis] << " along axis " << axis
+      << " is outside the file dimension " << fileInfo.fileShape[axis]);
+    dim_type lower = std::max(bounds.start(), fileInfo.fileStart[axis]);
+    dim_type upper = std::min(bounds.stop(), fileInfo.fileStart[axis] +
+                                             fileInfo.dataShape[axis]);
+    if (upper <= lower)
+    {
+      empty = true;
+      upper = lower;
+    }
+    fileStart[axis] = lower;
+    dataStart[axis] = fileInfo.dataStart[axis] + lower -
+                      fileInfo.fileStart[axis];
+    shape[axis]     = upper - lower;
+  }
+  return ! empty;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+transferRegion(const std::string & filename,
+               const Teuchos::ArrayView< const Slice > & region,
+               bool includeBndryPad,
+               bool write) const
+{
+  int ndims = numDims();
+  Teuchos::RCP< FileInfo > & fileInfo = computeFileInfo(includeBndryPad);
+  Teuchos::Array< dim_type > fileStart;
+  Teuchos::Array< dim_type > dataStart;
+  Teuchos::Array< dim_type > shape;
+  bool intersects = computeRegionIntersection(filename, region, *fileInfo,
+                                              fileStart, dataStart, shape);
+  IOTimer timer(getIOConfig(),
+                write ? "writeBinary region" : "readBinary region",
+                computeSize(shape) * sizeof(Scalar));
+
+  // Parallel input/output
+#ifdef HAVE_MPI
+
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+
+  // Build the file and data types for the intersection.  Processors
+  // without an intersection transfer zero elements.
+  int order = mpiOrder(getLayout());
+  MPI_Datatype filetype = mpiType< Scalar >();
+  MPI_Datatype datatype = mpiType< Scalar >();
+  int count = 0;
+  if (intersects)
+  {
+    MPI_Type_create_subarray(ndims,
+                             fileInfo->fileShape.getRawPtr(),
+                             shape.getRawPtr(),
+                             fileStart.getRawPtr(),
+                             order,
+                             mpiType< Scalar >(),
+                             &filetype);
+    MPI_Type_commit(&filetype);
+    MPI_Type_create_subarray(ndims,
+                             fileInfo->bufferShape.getRawPtr(),
+                             shape.getRawPtr(),
+                             dataStart.getRawPtr(),
+                             order,
+                             mpiType< Scalar >(),
+                             &datatype);
+    MPI_Type_commit(&datatype);
+    count = 1;
+  }
+
+  // Use MPI I/O to transfer the region.  The file is not truncated
+  // when writing.
+  char * cstr = new char[filename.size()+1];
+  std::strcpy(cstr, filename.c_str());
+  int access = write ? (MPI_MODE_WRONLY | MPI_MODE_CREATE) : MPI_MODE_RDONLY;
+  MPI_File   mpiFile;
+  MPI_Status status;
+  char       datarep[7] = "native";
+  MPI_Info   info = getIOConfig()->getInfo();
+  void * buffer = (void*) _mdArrayView.getRawPtr();
+  MPI_File_open(communicator(), cstr, access, info, &mpiFile);
+  MPI_File_set_view(mpiFile, 0, mpiType< Scalar >(), filetype, datarep,
+                    info);
+  if (write)
+    MPI_File_write_all(mpiFile, buffer, count, datatype, &status);
+  else
+    MPI_File_read_all(mpiFile, buffer, count, datatype, &status);
+  MPI_File_close(&mpiFile);
+  delete [] cstr;
+  if (intersects)
+  {
+    MPI_Type_free(&filetype);
+    MPI_Type_free(&datatype);
+  }
+
+  // Serial input/output
+#else
+
+  if (! intersects) return;
+
+  // Obtain the view of the local data within the region.  This
+  // method is const so that it can serve writeBinary(), and reading
+  // writes through the view.
+  MDArrayView< Scalar > data(_mdArrayView);
+  for (int axis = 0; axis < ndims; ++axis)
+    data = MDArrayView< Scalar >(data, axis,
+      Slice(dataStart[axis], dataStart[axis] + shape[axis]));
+
+  // Open the file, creating it for writing if it does not exist
+  FILE * datafile = fopen(filename.c_str(), write ? "r+" : "r");
+  if (write && datafile == 0) datafile = fopen(filename.c_str(), "w+");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    datafile == 0,
+    FileError,
+    "Cannot open file '" << filename << "'");
+
+  // Transfer the data one contiguous run at a time, seeking to the
+  // start of each run in the file
+  Teuchos::Array< size_type > fileStrides =
+    computeStrides< size_type, dim_type >(fileInfo->fileShape, getLayout());
+  size_type fileOffset = 0;
+  for (int axis = 0; axis < ndims; ++axis)
+    fileOffset += fileStart[axis] * fileStrides[axis];
+  bool complete;
+  if (write)
+    complete = writeLocal(datafile, data.getConst(), fileStrides(),
+                          fileOffset);
+  else
+    complete = readLocal(datafile, data, fileStrides(), fileOffset);
+  fclose(datafile);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! complete,
+    FileError,
+    "Incomplete transfer of data to or from file '" << filename << "'");
+
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+writeChunked(const std::string & filename,
+             bool includeBndryPad,
+             const Teuchos::ArrayView< const dim_type > & chunkShape) const
+{
+  int ndims = numDims();
+  Teuchos::RCP< FileInfo > & fileInfo = computeFileInfo(includeBndryPad);
+  IOTimer timer(getIOConfig(), "writeChunked",
+                computeSize(fileInfo->dataShape) * sizeof(Scalar));
+
+  // Construct the file header, with the default chunk shape if none
+  // is given
+  Teuchos::Array< dim_type > chunks(chunkShape.begin(), chunkShape.end());
+  if (chunks.size() == 0)
+  {
+    chunks.resize(ndims);
+    for (int axis = 0; axis < ndims; ++axis)
+    {
+      chunks[axis] = (fileInfo->fileShape[axis] + getCommDim(axis) - 1) /
+                     getCommDim(axis);
+      if (chunks[axis] < 1) chunks[axis] = 1;
+    }
+  }
+  Teuchos::Array< int > lowerBndryPad(ndims);
+  Teuchos::Array< int > upperBndryPad(ndims);
+  for (int axis = 0; axis < ndims; ++axis)
+  {
+    lowerBndryPad[axis] = getLowerBndryPad(axis);
+    upperBndryPad[axis] = getUpperBndryPad(axis);
+  }
+  ChunkedFileHeader header(fileTypeCode< Scalar >(),
+                           sizeof(Scalar),
+                           getLayout(),
+                           includeBndryPad,
+                           fileInfo->fileShape(),
+                           lowerBndryPad(),
+                           upperBndryPad(),
+                           chunks());
+
+  // The first processor writes the header, which also truncates any
+  // existing file, and then tells the other processors whether it
+  // succeeded
+  int written = 1;
+  if (_teuchosComm->getRank() == 0)
+  {
+    try
+    {
+      header.write(filename);
+    }
+    catch (FileError &)
+    {
+      written = 0;
+    }
+  }
+  Teuchos::broadcast(*_teuchosComm, 0, 1, &written);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! written,
+    FileError,
+    "Cannot write the header of file '" << filename << "'");
+
+  // Parallel output
+#ifdef HAVE_MPI
+
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+
+  // Compute the data types for the chunks that this processor writes
+  MPI_Datatype filetype;
+  MPI_Datatype datatype;
+  int count = computeChunkedTypes(header, *fileInfo, filetype, datatype);
+
+  // Use MPI I/O to write the chunks collectively
+  char * cstr = new char[filename.size()+1];
+  std::strcpy(cstr, filename.c_str());
+  MPI_File   mpiFile;
+  MPI_Status status;
+  char       datarep[7] = "native";
+  MPI_Info   info = getIOConfig()->getInfo();
+  const Scalar * buffer = getData(true).getRawPtr();
+  MPI_File_open(communicator(), cstr, MPI_MODE_WRONLY, info, &mpiFile);
+  MPI_File_set_view(mpiFile, 0, mpiType< Scalar >(),
+                    count ? filetype : mpiType< Scalar >(), datarep,
+                    info);
+  MPI_File_write_all(mpiFile, (void*)buffer, count ? 1 : 0,
+                     count ? datatype : mpiType< Scalar >(), &status);
+  MPI_File_close(&mpiFile);
+  delete [] cstr;
+  if (count)
+  {
+    MPI_Type_free(&filetype);
+    MPI_Type_free(&datatype);
+  }
+
+  // Serial output
+#else
+
+  // Write each chunk from the corresponding view of the data
+  MDArrayView< const Scalar > data = getData(includeBndryPad);
+  FILE * datafile = fopen(filename.c_str(), "r+");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    datafile == 0,
+    FileError,
+    "Cannot open file '" << filename << "' for writing");
+  Teuchos::Array< dim_type > start;
+  Teuchos::Array< dim_type > shape;
+  for (size_type chunk = 0; chunk < header.numChunks(); ++chunk)
+  {
+    header.chunkBounds(chunk, start, shape);
+    MDArrayView< const Scalar > chunkData = data;
+    for (int axis = 0; axis < ndims; ++axis)
+      chunkData = MDArrayView< const Scalar >(chunkData, axis,
+        Slice(start[axis], start[axis] + shape[axis]));
+    fseek(datafile, header.chunkOffset(chunk), SEEK_SET);
+    if (! writeLocal(datafile, chunkData))
+    {
+      fclose(datafile);
+      TEUCHOS_TEST_FOR_EXCEPTION(
+        true,
+        FileError,
+        "Incomplete write to file '" << filename << "'");
+    }
+  }
+  fclose(datafile);
+
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+readChunked(const std::string & filename)
+{
+  int ndims = numDims();
+  ChunkedFileHeader header = ChunkedFileHeader::read(_teuchosComm, filename);
+  bool includeBndryPad = header.includesBndryPad();
+  Teuchos::RCP< FileInfo > & fileInfo = computeFileInfo(includeBndryPad);
+  IOTimer timer(getIOConfig(), "readChunked",
+                computeSize(fileInfo->dataShape) * sizeof(Scalar));
+
+  // Check that the file matches this MDVector
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    header.scalarSize() != (int) sizeof(Scalar) ||
+    header.typeCode() != fileTypeCode< Scalar >(),
+    TypeError,
+    "File '" << filename << "' has scalar type code " << header.typeCode()
+    << " of size " << header.scalarSize() << ", but this MDVector has "
+    "scalar type code " << fileTypeCode< Scalar >() << " of size "
+    << sizeof(Scalar));
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    header.fileDims() != fileInfo->fileShape,
+    MDMapError,
+    "File '" << filename << "' has dimensions " << header.fileDims()
+    << ", but this MDVector has dimensions " << fileInfo->fileShape);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    header.layout() != getLayout(),
+    MDMapError,
+    "File '" << filename << "' has a different layout than this "
+    "MDVector");
+
+  // Parallel input
+#ifdef HAVE_MPI
+
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+
+  // Compute the data types for the chunks that this processor reads
+  MPI_Datatype filetype;
+  MPI_Datatype datatype;
+  int count = computeChunkedTypes(header, *fileInfo, filetype, datatype);
 
-  // I copy the filename C string, because the c_str() method returns
-  // a const char*, and the MPI_File_open() function requires
-  // (incorrectly) a non-const char*.
+  // Use MPI I/O to read the chunks collectively
   char * cstr = new char[filename.size()+1];
   std::strcpy(cstr, filename.c_str());
-
-  // Use MPI I/O to write the binary file
   MPI_File   mpiFile;
   MPI_Status status;
   char       datarep[7] = "native";
-  MPI_File_open(communicator(), cstr, access, MPI_INFO_NULL, &mpiFile);
+  MPI_Info   info = getIOConfig()->getInfo();
+  Scalar * buffer = getDataNonConst(true).getRawPtr();
+  MPI_File_open(communicator(), cstr, MPI_MODE_RDONLY, info, &mpiFile);
   MPI_File_set_view(mpiFile, 0, mpiType< Scalar >(),
-                    *(fileInfo->filetype), datarep, MPI_INFO_NULL);
-  MPI_File_write_all(mpiFile, (void*)buffer, 1, *(fileInfo->datatype),
-                     &status);
+                    count ? filetype : mpiType< Scalar >(), datarep,
+                    info);
+  MPI_File_read_all(mpiFile, (void*)buffer, count ? 1 : 0,
+                    count ? datatype : mpiType< Scalar >(), &status);
   MPI_File_close(&mpiFile);
-
-  // Delete the C string
   delete [] cstr;
+  if (count)
+  {
+    MPI_Type_free(&filetype);
+    MPI_Type_free(&datatype);
+  }
 
-  // Serial output
+  // Serial input
 #else
 
-  // Get the number of dimensions
-  // int ndims = _mdMap->numDims();
-
-  // Initialize the data file
-  datafile = fopen(filename.c_str(), "w");
-
-  // Obtain the data to write, including the boundary padding if requested
-  MDArrayView< const Scalar > mdArrayView = getData(includeBndryPad);
-
-  // Iterate over the data and write it to the data file
-  typedef typename MDArrayView< Scalar >::const_iterator const_iterator;
-  for (const_iterator it = mdArrayView.begin(); it != mdArrayView.end(); ++it)
+  // Read each chunk into the corresponding view of the data
+  MDArrayView< Scalar > data = getDataNonConst(includeBndryPad);
+  FILE * datafile = fopen(filename.c_str(), "r");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    datafile == 0,
+    FileError,
+    "Cannot open file '" << filename << "' for reading");
+  Teuchos::Array< dim_type > start;
+  Teuchos::Array< dim_type > shape;
+  for (size_type chunk = 0; chunk < header.numChunks(); ++chunk)
   {
-    fwrite((const void *) &(*it), sizeof(Scalar), 1, datafile);
+    header.chunkBounds(chunk, start, shape);
+    MDArrayView< Scalar > chunkData = data;
+    for (int axis = 0; axis < ndims; ++axis)
+      chunkData = MDArrayView< Scalar >(chunkData, axis,
+        Slice(start[axis], start[axis] + shape[axis]));
+    fseek(datafile, header.chunkOffset(chunk), SEEK_SET);
+    if (! readLocal(datafile, chunkData))
+    {
+      fclose(datafile);
+      TEUCHOS_TEST_FOR_EXCEPTION(
+        true,
+        FileError,
+        "Incomplete read from file '" << filename << "'");
+    }
   }
-
-  // Close the data file
   fclose(datafile);
 
 #endif
 
+  // Convert data written with the opposite byte order.  Only the
+  // data read from the file is converted, not the communication
+  // padding or any boundary padding that is not stored in the file.
+  if (header.swapBytes())
+  {
+    MDArrayView< Scalar > data = getDataNonConst(true);
+    for (int axis = 0; axis < ndims; ++axis)
+      data = MDArrayView< Scalar >(data, axis,
+        Slice(fileInfo->dataStart[axis],
+              fileInfo->dataStart[axis] + fileInfo->dataShape[axis]));
+    typedef typename MDArrayView< Scalar >::iterator iterator;
+    for (iterator it = data.begin(); it != data.end(); ++it)
+      Domi::swapBytes(&(*it), 1, sizeof(Scalar));
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -3285,82 +6093,595 @@ writeBinary(const std::string & filename,
 template< class Scalar >
 void
 MDVector< Scalar >::
-readBinary(const std::string & filename,
-           bool includeBndryPad)
+writeSubfiles(const std::string & filename,
+              bool includeBndryPad) const
 {
-  // Get the pointer to this MDVector's MDArray, including all padding
-  const Scalar * buffer = getDataNonConst(true).getRawPtr();
-
-  // Compute either _fileInfo or _fileInfoWithBndry, whichever is
-  // appropriate, and return a reference to that fileInfo object
+  int ndims = numDims();
   Teuchos::RCP< FileInfo > & fileInfo = computeFileInfo(includeBndryPad);
+  size_type size = computeSize(fileInfo->dataShape);
+  IOTimer timer(getIOConfig(), "writeSubfiles", size * sizeof(Scalar));
 
-  // Parallel input
+  // Parallel output
 #ifdef HAVE_MPI
 
-  // Since HAVE_MPI is defined, we know that _teuchosComm points to a
-  // const Teuchos::MpiComm< int >.  We downcast, extract and
-  // dereference so that we can get access to the MPI_Comm used to
-  // construct it.
   Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
     Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
   const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
     *(mpiComm->getRawMpiComm());
 
-  // Compute the access mode
-  int access = MPI_MODE_RDONLY;
-
-  // I copy the filename C string, because the c_str() method returns
-  // a const char*, and the MPI_File_open() function requires
-  // (incorrectly) a non-const char*.
-  char * cstr = new char[filename.size()+1];
-  std::strcpy(cstr, filename.c_str());
+  // Copy the local data that is written to a contiguous buffer
+  Teuchos::Array< Scalar > buffer(size);
+  MDArrayView< const Scalar > data = getData(true);
+  for (int axis = 0; axis < ndims; ++axis)
+    data = MDArrayView< const Scalar >(data, axis,
+      Slice(fileInfo->dataStart[axis],
+            fileInfo->dataStart[axis] + fileInfo->dataShape[axis]));
+  Teuchos::Array< size_type > strides =
+    computeStrides< size_type, dim_type >(fileInfo->dataShape, getLayout());
+  threadedCopy(data.getRawPtr(), data.strides()(), buffer.getRawPtr(),
+               strides(), fileInfo->dataShape(), getLayout());
+
+  // Group the processors by node, and gather the sizes of the blocks
+  // of each node to its aggregator
+  MPI_Comm nodeComm;
+  int      subfile;
+  int      numSubfiles;
+  int      nodeRank;
+  int      nodeSize;
+  splitByNode(communicator(), nodeComm, subfile, numSubfiles);
+  MPI_Comm_rank(nodeComm, &nodeRank);
+  MPI_Comm_size(nodeComm, &nodeSize);
+  long long count = size;
+  Teuchos::Array< long long > counts(nodeSize);
+  MPI_Gather(&count, 1, MPI_LONG_LONG, counts.getRawPtr(), 1, MPI_LONG_LONG,
+             0, nodeComm);
+
+  // The aggregator writes its own block to the subfile, and then
+  // receives and writes the block of each other processor of the
+  // node, in order.  The blocks are received even if the subfile
+  // cannot be opened, so that the other processors do not wait.
+  // Blocks are sent in messages of at most INT_MAX elements, since
+  // MPI counts are ints.
+  size_type maxCount = std::numeric_limits< int >::max();
+  int complete = 1;
+  if (nodeRank == 0)
+  {
+    std::string subfileName = SubfileManifest::subfileName(filename, subfile);
+    FILE * datafile = fopen(subfileName.c_str(), "w");
+    const Scalar * block = buffer.getRawPtr();
+    complete = (datafile != 0) &&
+               (writeRun(datafile, block, size) == size);
+    Teuchos::Array< Scalar > received;
+    for (int source = 1; source < nodeSize; ++source)
+    {
+      received.resize(counts[source]);
+      for (size_type start = 0; start < counts[source]; start += maxCount)
+        MPI_Recv(received.getRawPtr() + start,
+                 (int) std::min(maxCount, size_type(counts[source] - start)),
+                 mpiType< Scalar >(), source, 0, nodeComm,
+                 MPI_STATUS_IGNORE);
+      block = received.getRawPtr();
+      complete = complete &&
+                 (writeRun(datafile, block, counts[source]) ==
+                  counts[source]);
+    }
+    if (datafile) fclose(datafile);
+  }
+  else
+  {
+    for (size_type start = 0; start < size; start += maxCount)
+      MPI_Send(buffer.getRawPtr() + start,
+               (int) std::min(maxCount, size - start),
+               mpiType< Scalar >(), 0, 0, nodeComm);
+  }
 
-  // Use MPI I/O to read the binary file
-  MPI_File   mpiFile;
-  MPI_Status status;
-  char       datarep[7] = "native";
-  MPI_File_open(communicator(), cstr, access, MPI_INFO_NULL, &mpiFile);
-  MPI_File_set_view(mpiFile, 0, mpiType< Scalar >(),
-                    *(fileInfo->filetype), datarep, MPI_INFO_NULL);
-  MPI_File_read_all(mpiFile, (void*)buffer, 1, *(fileInfo->datatype),
-                    &status);
-  MPI_File_close(&mpiFile);
+  // The block of each processor follows those of the processors
+  // before it on the node
+  long long offset = 0;
+  MPI_Exscan(&count, &offset, 1, MPI_LONG_LONG, MPI_SUM, nodeComm);
+  if (nodeRank == 0) offset = 0;
+  MPI_Comm_free(&nodeComm);
+
+  // Every processor throws if any subfile could not be written
+  int allComplete = 0;
+  MPI_Allreduce(&complete, &allComplete, 1, MPI_INT, MPI_MIN,
+                communicator());
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! allComplete,
+    FileError,
+    "Cannot write the subfiles of '" << filename << "'");
 
-  // Delete the C string
-  delete [] cstr;
+  // Gather the description of every block to the first processor,
+  // which writes the manifest, and then tells the other processors
+  // whether it succeeded
+  int rank = _teuchosComm->getRank();
+  int recordSize = 2 + 2 * ndims;
+  int written = 1;
+  Teuchos::Array< long long > record(recordSize);
+  record[0] = subfile;
+  record[1] = offset * sizeof(Scalar);
+  for (int axis = 0; axis < ndims; ++axis)
+  {
+    record[2+axis]       = fileInfo->fileStart[axis];
+    record[2+ndims+axis] = fileInfo->dataShape[axis];
+  }
+  Teuchos::Array< long long >
+    records(rank == 0 ? _teuchosComm->getSize() * recordSize : 0);
+  MPI_Gather(record.getRawPtr(), recordSize, MPI_LONG_LONG,
+             records.getRawPtr(), recordSize, MPI_LONG_LONG, 0,
+             communicator());
+  if (rank == 0)
+  {
+    SubfileManifest manifest(fileTypeCode< Scalar >(),
+                             sizeof(Scalar),
+                             getLayout(),
+                             includeBndryPad,
+                             fileInfo->fileShape(),
+                             numSubfiles);
+    Teuchos::Array< dim_type > start(ndims);
+    Teuchos::Array< dim_type > shape(ndims);
+    for (int proc = 0; proc < _teuchosComm->getSize(); ++proc)
+    {
+      const long long * r = &records[proc * recordSize];
+      for (int axis = 0; axis < ndims; ++axis)
+      {
+        start[axis] = r[2+axis];
+        shape[axis] = r[2+ndims+axis];
+      }
+      if (computeSize(shape) > 0)
+        manifest.addBlock(r[0], r[1], start(), shape());
+    }
+    try
+    {
+      manifest.write(filename);
+    }
+    catch (FileError &)
+    {
+      written = 0;
+    }
+  }
+  Teuchos::broadcast(*_teuchosComm, 0, 1, &written);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! written,
+    FileError,
+    "Cannot open file '" << filename << "' for writing");
 
   // Serial output
 #else
 
-  // Get the number of dimensions
-  int ndims = _mdMap->numDims();
+  // The single processor writes a single subfile
+  std::string subfileName = SubfileManifest::subfileName(filename, 0);
+  FILE * datafile = fopen(subfileName.c_str(), "w");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    datafile == 0,
+    FileError,
+    "Cannot open file '" << subfileName << "' for writing");
+  bool complete = writeLocal(datafile, getData(includeBndryPad));
+  fclose(datafile);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! complete,
+    FileError,
+    "Incomplete write to file '" << subfileName << "'");
+
+  SubfileManifest manifest(fileTypeCode< Scalar >(),
+                           sizeof(Scalar),
+                           getLayout(),
+                           includeBndryPad,
+                           fileInfo->fileShape(),
+                           1);
+  manifest.addBlock(0, 0, fileInfo->fileStart(), fileInfo->dataShape());
+  manifest.write(filename);
 
-  // Initialize the data file
-  FILE * datafile;
-  datafile = fopen(filename.c_str(), "r");
+#endif
+}
 
-  // Obtain the MDArrayView to read into, including the boundary
-  // padding if requested
-  MDArrayView< Scalar > mdArrayView = getDataNonConst(includeBndryPad);
+////////////////////////////////////////////////////////////////////////
 
-  // Initialize the set of indexes
-  Teuchos::Array< Ordinal > index(3);
-  for (int axis = 0; axis < ndims; ++axis)
-    index[axis] = fileInfo->dataStart[axis];
+template< class Scalar >
+void
+MDVector< Scalar >::
+readSubfiles(const std::string & filename)
+{
+  int ndims = numDims();
+  SubfileManifest manifest = SubfileManifest::read(_teuchosComm, filename);
+  bool includeBndryPad = manifest.includesBndryPad();
+  Teuchos::RCP< FileInfo > & fileInfo = computeFileInfo(includeBndryPad);
+  IOTimer timer(getIOConfig(), "readSubfiles",
+                computeSize(fileInfo->dataShape) * sizeof(Scalar));
 
-  // Iterate over the data and read it from the data file
-  typedef typename MDArrayView< Scalar >::iterator iterator;
-  for (iterator it = mdArrayView.begin(); it != mdArrayView.end(); ++it)
+  // Check that the manifest matches this MDVector
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    manifest.scalarSize() != (int) sizeof(Scalar) ||
+    manifest.typeCode() != fileTypeCode< Scalar >(),
+    TypeError,
+    "Subfile manifest '" << filename << "' has scalar type code "
+    << manifest.typeCode() << " of size " << manifest.scalarSize()
+    << ", but this MDVector has scalar type code " << fileTypeCode< Scalar >()
+    << " of size " << sizeof(Scalar));
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    manifest.fileDims() != fileInfo->fileShape,
+    MDMapError,
+    "Subfile manifest '" << filename << "' has dimensions "
+    << manifest.fileDims() << ", but this MDVector has dimensions "
+    << fileInfo->fileShape);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    manifest.layout() != getLayout(),
+    MDMapError,
+    "Subfile manifest '" << filename << "' has a different layout than "
+    "this MDVector");
+
+  // Find the blocks that intersect this processor's data, sorted by
+  // subfile so that each subfile is opened once
+  Teuchos::Array< dim_type > lower(ndims);
+  Teuchos::Array< dim_type > upper(ndims);
+  Teuchos::Array< std::pair< int, size_type > > blocks;
+  for (size_type b = 0; b < manifest.numBlocks(); ++b)
   {
-    fread(&(*it), sizeof(Scalar), 1, datafile);
+    const SubfileManifest::Block & block = manifest.getBlock(b);
+    bool intersects = true;
+    for (int axis = 0; axis < ndims; ++axis)
+      if (block.start[axis] + block.shape[axis] <= fileInfo->fileStart[axis] ||
+          fileInfo->fileStart[axis] + fileInfo->dataShape[axis] <=
+          block.start[axis])
+        intersects = false;
+    if (intersects) blocks.push_back(std::make_pair(block.subfile, b));
   }
+  std::sort(blocks.begin(), blocks.end());
+
+  // Read the part of each block that intersects this processor's
+  // data, seeking to each run of the part in the subfile
+  MDArrayView< Scalar > localData = getDataNonConst(true);
+  FILE * datafile    = 0;
+  int    openSubfile = -1;
+  std::string subfileName;
+  for (size_type i = 0; i < blocks.size(); ++i)
+  {
+    const SubfileManifest::Block & block =
+      manifest.getBlock(blocks[i].second);
+    for (int axis = 0; axis < ndims; ++axis)
+    {
+      lower[axis] = std::max(block.start[axis], fileInfo->fileStart[axis]);
+      upper[axis] = std::min(block.start[axis] + block.shape[axis],
+                             fileInfo->fileStart[axis] +
+                             fileInfo->dataShape[axis]);
+    }
 
-  // Close the data file
-  fclose(datafile);
+    if (block.subfile != openSubfile)
+    {
+      if (datafile) fclose(datafile);
+      subfileName = SubfileManifest::subfileName(filename, block.subfile);
+      datafile = fopen(subfileName.c_str(), "r");
+      TEUCHOS_TEST_FOR_EXCEPTION(
+        datafile == 0,
+        FileError,
+        "Cannot open file '" << subfileName << "' for reading");
+      openSubfile = block.subfile;
+    }
+
+    Teuchos::Array< size_type > fileStrides =
+      computeStrides< size_type, dim_type >(block.shape, getLayout());
+    size_type fileOffset = block.offset / sizeof(Scalar);
+    MDArrayView< Scalar > blockData = localData;
+    for (int axis = 0; axis < ndims; ++axis)
+    {
+      dim_type start = fileInfo->dataStart[axis] + lower[axis] -
+                       fileInfo->fileStart[axis];
+      blockData = MDArrayView< Scalar >(blockData, axis,
+        Slice(start, start + upper[axis] - lower[axis]));
+      fileOffset += (lower[axis] - block.start[axis]) * fileStrides[axis];
+    }
+    if (! readLocal(datafile, blockData, fileStrides(), fileOffset))
+    {
+      fclose(datafile);
+      TEUCHOS_TEST_FOR_EXCEPTION(
+        true,
+        FileError,
+        "Incomplete read from file '" << subfileName << "'");
+    }
+  }
+  if (datafile) fclose(datafile);
+
+  // Convert the data read, if it was written with the opposite byte
+  // order
+  if (manifest.swapBytes())
+  {
+    MDArrayView< Scalar > data = localData;
+    for (int axis = 0; axis < ndims; ++axis)
+      data = MDArrayView< Scalar >(data, axis,
+        Slice(fileInfo->dataStart[axis],
+              fileInfo->dataStart[axis] + fileInfo->dataShape[axis]));
+    typedef typename MDArrayView< Scalar >::iterator iterator;
+    for (iterator it = data.begin(); it != data.end(); ++it)
+      Domi::swapBytes(&(*it), 1, sizeof(Scalar));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_MPI
+
+template< class Scalar >
+int
+MDVector< Scalar >::
+computeChunkedTypes(const ChunkedFileHeader & header,
+                    const FileInfo & fileInfo,
+                    MPI_Datatype & filetype,
+                    MPI_Datatype & datatype) const
+{
+  int ndims = numDims();
+  int order = mpiOrder(getLayout());
+  Teuchos::Array< size_type > chunks =
+    header.intersectingChunks(fileInfo.fileStart(), fileInfo.dataShape());
+  int count = chunks.size();
+  if (count == 0) return 0;
+
+  // Build a pair of subarray data types for the intersection of the
+  // local data with each chunk: one within the chunk, and one within
+  // the local buffer
+  Teuchos::Array< MPI_Datatype > fileTypes(count);
+  Teuchos::Array< MPI_Datatype > dataTypes(count);
+  Teuchos::Array< MPI_Aint >     fileDispls(count);
+  Teuchos::Array< MPI_Aint >     dataDispls(count, 0);
+  Teuchos::Array< int >          blockLengths(count, 1);
+  Teuchos::Array< dim_type >     chunkStart;
+  Teuchos::Array< dim_type >     chunkShape;
+  Teuchos::Array< int >          chunkSizes(ndims);
+  Teuchos::Array< int >          bufferSizes(ndims);
+  Teuchos::Array< int >          subsizes(ndims);
+  Teuchos::Array< int >          fileStarts(ndims);
+  Teuchos::Array< int >          dataStarts(ndims);
+  for (int i = 0; i < count; ++i)
+  {
+    header.chunkBounds(chunks[i], chunkStart, chunkShape);
+    for (int axis = 0; axis < ndims; ++axis)
+    {
+      dim_type lower = std::max(chunkStart[axis], fileInfo.fileStart[axis]);
+      dim_type upper = std::min(chunkStart[axis] + chunkShape[axis],
+                                fileInfo.fileStart[axis] +
+                                fileInfo.dataShape[axis]);
+      chunkSizes[axis]  = chunkShape[axis];
+      bufferSizes[axis] = fileInfo.bufferShape[axis];
+      subsizes[axis]    = upper - lower;
+      fileStarts[axis]  = lower - chunkStart[axis];
+      dataStarts[axis]  = fileInfo.dataStart[axis] + lower -
+                          fileInfo.fileStart[axis];
+    }
+    MPI_Type_create_subarray(ndims,
+                             chunkSizes.getRawPtr(),
+                             subsizes.getRawPtr(),
+                             fileStarts.getRawPtr(),
+                             order,
+                             mpiType< Scalar >(),
+                             &fileTypes[i]);
+    MPI_Type_create_subarray(ndims,
+                             bufferSizes.getRawPtr(),
+                             subsizes.getRawPtr(),
+                             dataStarts.getRawPtr(),
+                             order,
+                             mpiType< Scalar >(),
+                             &dataTypes[i]);
+    fileDispls[i] = header.chunkOffset(chunks[i]);
+  }
+
+  // Combine the chunk data types, which are in increasing file order
+  MPI_Type_create_struct(count,
+                         blockLengths.getRawPtr(),
+                         fileDispls.getRawPtr(),
+                         fileTypes.getRawPtr(),
+                         &filetype);
+  MPI_Type_commit(&filetype);
+  MPI_Type_create_struct(count,
+                         blockLengths.getRawPtr(),
+                         dataDispls.getRawPtr(),
+                         dataTypes.getRawPtr(),
+                         &datatype);
+  MPI_Type_commit(&datatype);
+  for (int i = 0; i < count; ++i)
+  {
+    MPI_Type_free(&fileTypes[i]);
+    MPI_Type_free(&dataTypes[i]);
+  }
+  return count;
+}
 
 #endif
 
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+mapBinary(const std::string & filename,
+          bool includeBndryPad,
+          bool writable)
+{
+  // Only an MDVector that spans its entire MDArrayRCP can replace its
+  // data
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! spansStorage(),
+    MDMapNoncontiguousError,
+    "The storage of a sub-vector cannot be changed");
+
+  // Compute the shapes and starts of the file and the local data, and
+  // the strides of the file
+  Teuchos::RCP< FileInfo > fileInfo = computeFileInfo(includeBndryPad);
+  int ndims = numDims();
+  Layout layout = getLayout();
+  Teuchos::Array< size_type > fileStrides =
+    computeStrides< size_type, dim_type >(fileInfo->fileShape, layout);
+
+  // Compute the position of the local buffer, including all padding,
+  // in the file.  The local buffer can be mapped directly if it lies
+  // entirely within the file, unless the mapping is writable and the
+  // buffer includes the communication padding, which belongs to
+  // neighboring processors.
+  Teuchos::Array< dim_type > bufferShape(ndims);
+  Teuchos::Array< dim_type > bufferStart(ndims);
+  bool direct = true;
+  for (int axis = 0; axis < ndims; ++axis)
+  {
+    bufferShape[axis] = getLocalDim(axis,true);
+    bufferStart[axis] = fileInfo->fileStart[axis] -
+                        fileInfo->dataStart[axis];
+    if (bufferStart[axis] < 0 ||
+        bufferStart[axis] + bufferShape[axis] > fileInfo->fileShape[axis])
+      direct = false;
+    if (writable && bufferShape[axis] != fileInfo->dataShape[axis])
+      direct = false;
+  }
+
+  // Map the hyperslab of the file spanned by either the local buffer
+  // or the local data
+  Teuchos::ArrayView< dim_type > shape =
+    direct ? bufferShape() : fileInfo->dataShape();
+  Teuchos::ArrayView< dim_type > start =
+    direct ? bufferStart() : fileInfo->fileStart();
+  size_type offset = 0;
+  for (int axis = 0; axis < ndims; ++axis)
+    offset += start[axis] * fileStrides[axis];
+  size_type length = 0;
+  if (computeSize(shape) > 0)
+    length = computeSize(shape, fileStrides());
+  Teuchos::RCP< MappedFile > mappedFile =
+    Teuchos::rcp(new MappedFile(filename,
+                                offset * sizeof(Scalar),
+                                length * sizeof(Scalar),
+                                writable));
+  Teuchos::ArrayRCP< Scalar > array =
+    Teuchos::arcp(reinterpret_cast< Scalar* >(mappedFile->getRawPtr()),
+                  0, length, MappedFileDealloc< Scalar >(mappedFile), true);
+  MDArrayRCP< Scalar > fileData(array, shape, fileStrides(), layout);
+
+  Teuchos::RCP< FileMapping > fileMapping = Teuchos::rcp(new FileMapping);
+  fileMapping->mappedFile = mappedFile;
+  fileMapping->direct     = direct;
+  if (direct)
+  {
+    _mdArrayRcp = fileData;
+  }
+  else
+  {
+    // Stage the local data in newly allocated memory, with zeroed
+    // padding
+    _mdArrayRcp = MDArrayRCP< Scalar >(bufferShape(), Scalar(), layout);
+    MDArrayView< Scalar > localData = _mdArrayRcp();
+    for (int axis = 0; axis < ndims; ++axis)
+    {
+      Slice slice(fileInfo->dataStart[axis],
+                  fileInfo->dataStart[axis] + fileInfo->dataShape[axis]);
+      localData = MDArrayView< Scalar >(localData, axis, slice);
+    }
+    threadedCopy(fileData.getRawPtr(), fileData.strides()(),
+                 localData.getRawPtr(), localData.strides()(),
+                 localData.dimensions()(), layout);
+    fileMapping->fileData  = fileData;
+    fileMapping->localData = localData;
+  }
+  _mdArrayView = _mdArrayRcp();
+  storageChanged();
+  _fileMapping = fileMapping;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+syncBinary()
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    _fileMapping.is_null(),
+    FileError,
+    "The MDVector data is not mapped to a file");
+
+  // Copy staged data back to the mapping
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! _fileMapping->mappedFile->isWritable(),
+    FileError,
+    "The MDVector data is mapped to a file read-only");
+  if (! _fileMapping->direct)
+  {
+    MDArrayView< Scalar > & localData = _fileMapping->localData;
+    MDArrayRCP< Scalar >  & fileData  = _fileMapping->fileData;
+    threadedCopy(localData.getRawPtr(), localData.strides()(),
+                 fileData.getRawPtr(), fileData.strides()(),
+                 localData.dimensions()(), getLayout());
+  }
+  _fileMapping->mappedFile->sync();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+setIOConfig(const Teuchos::RCP< IOConfig > & ioConfig)
+{
+  _ioConfig = ioConfig;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Teuchos::RCP< IOConfig >
+MDVector< Scalar >::
+getIOConfig() const
+{
+  if (_ioConfig.is_null()) return IOConfig::getDefault();
+  return _ioConfig;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+MDVector< Scalar >::
+isFileMapped() const
+{
+  return ! _fileMapping.is_null();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+MDVector< Scalar >::
+isDirectlyMapped() const
+{
+  return ! _fileMapping.is_null() && _fileMapping->direct;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+MDVector< Scalar >::
+spansStorage() const
+{
+  if (_mdArrayView.getRawPtr() != _mdArrayRcp.getRawPtr()) return false;
+  for (int axis = 0; axis < numDims(); ++axis)
+    if (_mdArrayView.dimension(axis) != _mdArrayRcp.dimension(axis))
+      return false;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+MDVector< Scalar >::
+storageChanged()
+{
+  _sendMessages.clear();
+  _recvMessages.clear();
+  _neighborSendMessages.clear();
+  _neighborRecvMessages.clear();
+#ifdef HAVE_MPI
+  _persistentRequests = Teuchos::null;
+#endif
+  _fileInfo          = Teuchos::null;
+  _fileInfoWithBndry = Teuchos::null;
+  _fileMapping       = Teuchos::null;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -3394,6 +6715,10 @@ computeFileInfo(bool includeBndryPad) const
     // appropriate
     fileInfo->fileShape[axis]   = getGlobalDim(axis,includeBndryPad);
     fileInfo->bufferShape[axis] = getLocalDim(axis,true );
+    // The buffer also includes the alignment padding, if any, which
+    // is excluded from the data by dataShape
+    fileInfo->bufferShape[axis] += _mdArrayRcp.allocatedDimension(axis) -
+                                   _mdArrayRcp.dimension(axis);
     fileInfo->dataShape[axis]   = getLocalDim(axis,false);
     fileInfo->fileStart[axis]   = getGlobalRankBounds(axis,includeBndryPad).start();
     fileInfo->dataStart[axis]   = getLocalBounds(axis).start();
@@ -3452,6 +6777,35 @@ computeFileInfo(bool includeBndryPad) const
 
 ////////////////////////////////////////////////////////////////////////
 
+/** \brief Construct an MDVector, and its MDMap, from a chunked file
+ *
+ * \param teuchosComm [in] the communicator for the MDVector
+ *
+ * \param filename [in] name of a file written by
+ *        <tt>MDVector::writeChunked()</tt>
+ *
+ * \param plist [in] ParameterList with the parameters of the MDMap
+ *        that are not stored in the file; see <tt>readMDMap()</tt>
+ *
+ * The dimensions, boundary padding and layout of the MDVector are
+ * taken from the file, and its data is read from the file.  Any
+ * padding that is not stored in the file is zeroed.
+ */
+template< class Scalar >
+Teuchos::RCP< MDVector< Scalar > >
+readMDVector(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+             const std::string & filename,
+             Teuchos::ParameterList & plist)
+{
+  Teuchos::RCP< const MDMap > mdMap = readMDMap(teuchosComm, filename, plist);
+  Teuchos::RCP< MDVector< Scalar > > result =
+    Teuchos::rcp(new MDVector< Scalar >(mdMap, true));
+  result->readChunked(filename);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+
 }  // Namespace Domi
 
 #endif
@@ -0,0 +1,187 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+// System includes
+#include <sstream>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Teuchos includes
+#include "Teuchos_Assert.hpp"
+
+// Domi includes
+#include "Domi_MappedFile.hpp"
+#include "Domi_Exceptions.hpp"
+
+namespace Domi
+{
+
+////////////////////////////////////////////////////////////////////////
+
+MappedFile::MappedFile(const std::string & filename,
+                       size_type offset,
+                       size_type length,
+                       bool writable) :
+  _base(0),
+  _mapLength(0),
+  _ptr(0),
+  _length(length),
+  _writable(writable),
+  _filename(filename)
+{
+#if defined(_WIN32)
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    true,
+    FileError,
+    "Memory mapped files are not supported on this platform");
+#else
+  int fd = open(filename.c_str(), writable ? O_RDWR : O_RDONLY);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    fd < 0,
+    FileError,
+    "Cannot open file '" << filename << "'");
+
+  // Check that the file is long enough
+  struct stat status;
+  if (fstat(fd, &status) != 0)
+  {
+    close(fd);
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      true,
+      FileError,
+      "Cannot determine the size of file '" << filename << "'");
+  }
+  if (status.st_size < offset + length)
+  {
+    close(fd);
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      true,
+      FileError,
+      "File '" << filename << "' has " << status.st_size << " bytes, but "
+      << offset + length << " are required");
+  }
+
+  // The offset of a mapping must be a multiple of the page size, so
+  // map from the start of the page that contains the first byte
+  if (length > 0)
+  {
+    size_type pageSize = sysconf(_SC_PAGESIZE);
+    size_type mapOffset = (offset / pageSize) * pageSize;
+    _mapLength = length + (offset - mapOffset);
+    // A shared mapping writes whole pages back to the file, which is
+    // only coherent with other processes that share the page cache
+    int prot  = PROT_READ | PROT_WRITE;
+    int flags = writable ? MAP_SHARED : MAP_PRIVATE;
+    _base = mmap(0, _mapLength, prot, flags, fd, mapOffset);
+    if (_base == MAP_FAILED)
+    {
+      close(fd);
+      _base = 0;
+      TEUCHOS_TEST_FOR_EXCEPTION(
+        true,
+        FileError,
+        "Cannot map " << length << " bytes of file '" << filename << "'");
+    }
+    _ptr = static_cast< char* >(_base) + (offset - mapOffset);
+  }
+
+  // The mapping remains valid after the file is closed
+  close(fd);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+MappedFile::~MappedFile()
+{
+#if !defined(_WIN32)
+  if (_base) munmap(_base, _mapLength);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+char *
+MappedFile::getRawPtr() const
+{
+  return _ptr;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_type
+MappedFile::length() const
+{
+  return _length;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+bool
+MappedFile::isWritable() const
+{
+  return _writable;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+MappedFile::sync()
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! _writable,
+    FileError,
+    "File '" << _filename << "' is mapped read-only");
+#if !defined(_WIN32)
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    _base && msync(_base, _mapLength, MS_SYNC) != 0,
+    FileError,
+    "Cannot write the mapping of file '" << _filename << "' back to the "
+    "file");
+#endif
+}
+
+}  // namespace Domi
@@ -0,0 +1,174 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_MAPPEDFILE_HPP
+#define DOMI_MAPPEDFILE_HPP
+
+// System includes
+#include <string>
+
+// Teuchos includes
+#include "Teuchos_RCP.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+
+namespace Domi
+{
+
+/** \brief A memory mapping of a range of bytes of a file
+ *
+ * A <tt>MappedFile</tt> maps a range of bytes of an existing file
+ * into memory when it is constructed, and unmaps it when it is
+ * destroyed.  Pages of the file are only read when they are first
+ * accessed.  A read-only mapping is private: the mapped memory may
+ * be written, but the changes are never written to the file.  A
+ * writable mapping is shared with the file, and the changes are
+ * written to it by the operating system, or immediately with
+ * <tt>sync()</tt>.
+ *
+ * The operating system writes whole pages.  Writable mappings of
+ * different ranges of the same file by different processes are
+ * therefore only safe when the processes share a page cache, as they
+ * do on a single node.  On a distributed file system, processes on
+ * different nodes that map the same page can overwrite each other's
+ * changes.
+ *
+ * Memory mapping requires a POSIX system.
+ */
+class MappedFile
+{
+public:
+
+  /** \brief Constructor
+   *
+   * \param filename [in] name of an existing file
+   *
+   * \param offset [in] offset, in bytes, of the first byte to map
+   *
+   * \param length [in] number of bytes to map.  The file must be at
+   *        least offset + length bytes long.
+   *
+   * \param writable [in] if true, changes to the mapped memory are
+   *        written to the file
+   */
+  MappedFile(const std::string & filename,
+             size_type offset,
+             size_type length,
+             bool writable = false);
+
+  /** \brief Destructor, which unmaps the file
+   */
+  ~MappedFile();
+
+  /** \brief Return a pointer to the first mapped byte
+   */
+  char * getRawPtr() const;
+
+  /** \brief Return the number of mapped bytes
+   */
+  size_type length() const;
+
+  /** \brief Return true if changes are written to the file
+   */
+  bool isWritable() const;
+
+  /** \brief Write changes to a writable mapping to the file, and wait
+   *         for the writes to complete
+   */
+  void sync();
+
+private:
+
+  // The page aligned start of the mapping and its length
+  void *      _base;
+  size_type   _mapLength;
+
+  // The first requested byte and the requested length
+  char *      _ptr;
+  size_type   _length;
+
+  bool        _writable;
+  std::string _filename;
+
+  // Not copyable
+  MappedFile(const MappedFile & source);
+  MappedFile & operator=(const MappedFile & source);
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief A <tt>Teuchos::ArrayRCP</tt> deallocation policy that keeps
+ *         a <tt>MappedFile</tt> alive for as long as an array that
+ *         points into it
+ */
+template< class T >
+class MappedFileDealloc
+{
+public:
+  /** \brief The pointer type */
+  typedef T ptr_t;
+
+  /** \brief Constructor
+   *
+   * \param mappedFile [in] the mapped file the array points into
+   */
+  MappedFileDealloc(const Teuchos::RCP< MappedFile > & mappedFile) :
+    _mappedFile(mappedFile) { }
+
+  /** \brief Release the array, which releases the mapped file when
+   *         this policy is destroyed along with the array
+   */
+  void free(T *) { }
+
+  /** \brief Return the mapped file */
+  const Teuchos::RCP< MappedFile > & getMappedFile() const
+  { return _mappedFile; }
+
+private:
+  Teuchos::RCP< MappedFile > _mappedFile;
+};
+
+}  // namespace Domi
+
+#endif
@@ -0,0 +1,585 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_MEMORYPOOL_HPP
+#define DOMI_MEMORYPOOL_HPP
+
+// System includes
+#include <map>
+#include <vector>
+#include <sstream>
+
+// Teuchos includes
+#include "Teuchos_ArrayRCP.hpp"
+#include "Teuchos_Describable.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+
+namespace Domi
+{
+
+// Forward declaration
+template< class T > class MemoryArena;
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Abstract base class for allocators of MDArrayRCP data
+ *         buffers
+ *
+ * An <tt>Allocator</tt> provides the data buffers for
+ * <tt>MDArrayRCP</tt> objects, and therefore for <tt>MDVector</tt>s.
+ * The buffer is returned as a <tt>Teuchos::ArrayRCP</tt>, whose
+ * deallocation policy is chosen by the allocator, so that a buffer
+ * can be recycled when the last reference to it is released.
+ *
+ * The allocator used for new buffers of a given type is the one
+ * belonging to the innermost <tt>MemoryArena</tt> in scope, or the
+ * default allocator set with <tt>setDefault()</tt> if there is no
+ * arena.  If neither has been provided, buffers are allocated
+ * directly with <tt>Teuchos::ArrayRCP</tt>.
+ */
+template< class T >
+class Allocator : public Teuchos::Describable
+{
+public:
+
+  /** \brief Destructor
+   */
+  virtual ~Allocator() { }
+
+  /** \brief Allocate a data buffer
+   *
+   * \param size [in] the number of elements in the buffer
+   *
+   * The contents of the returned buffer are unspecified.
+   */
+  virtual Teuchos::ArrayRCP< T > allocate(size_type size) = 0;
+
+  /** \brief Return the allocator used for new buffers, which may be
+   *         null
+   */
+  static Teuchos::RCP< Allocator< T > > getCurrent();
+
+  /** \brief Set the allocator used for new buffers when no
+   *         <tt>MemoryArena</tt> is in scope
+   *
+   * \param allocator [in] the default allocator.  A null allocator
+   *        restores direct allocation.
+   */
+  static void setDefault(const Teuchos::RCP< Allocator< T > > & allocator);
+
+  /** \brief Return the allocator used for new buffers when no
+   *         <tt>MemoryArena</tt> is in scope, which may be null
+   */
+  static Teuchos::RCP< Allocator< T > > getDefault();
+
+private:
+
+  // The default allocator
+  static Teuchos::RCP< Allocator< T > > & defaultAllocator();
+
+  // The allocators of the MemoryArenas currently in scope, innermost
+  // last
+  static std::vector< Teuchos::RCP< Allocator< T > > > & arenaStack();
+
+  friend class MemoryArena< T >;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief A pool of recycled data buffers
+ *
+ * A <tt>MemoryPool</tt> keeps the buffers it has allocated, once they
+ * are released, in free lists keyed by buffer size, and hands them
+ * out again for later requests of the same size.  Since the data
+ * buffer of an <tt>MDVector</tt> has the local size of its MDMap,
+ * including padding, all of the work vectors constructed on the same
+ * MDMap share one free list, and a solver that constructs and
+ * destroys them on every iteration only allocates memory on the
+ * first.
+ *
+ * Buffers may outlive the pool.  Once the pool has been destroyed,
+ * they are simply deleted when they are released.  A
+ * <tt>MemoryPool</tt> is not thread-safe: buffers should be allocated
+ * and released outside of threaded regions.
+ */
+template< class T >
+class MemoryPool : public Allocator< T >
+{
+public:
+
+  /** \brief Constructor
+   *
+   * \param maxCachedBytes [in] the maximum number of bytes held in
+   *        released buffers.  A buffer that is released when the
+   *        limit would be exceeded is deleted instead.  Zero (the
+   *        default) means no limit.
+   */
+  MemoryPool(size_type maxCachedBytes = 0);
+
+  /** \brief Destructor, which deletes all released buffers
+   */
+  ~MemoryPool();
+
+  /** \brief Allocate a data buffer, reusing a released buffer of the
+   *         same size if one is available
+   *
+   * \param size [in] the number of elements in the buffer
+   */
+  Teuchos::ArrayRCP< T > allocate(size_type size);
+
+  /** \brief Delete all released buffers
+   */
+  void clear();
+
+  /** \brief Return the number of buffers requested
+   */
+  size_type numRequests() const;
+
+  /** \brief Return the number of requests satisfied by reusing a
+   *         released buffer
+   */
+  size_type numReuses() const;
+
+  /** \brief Return the number of requests that allocated new memory
+   */
+  size_type numAllocations() const;
+
+  /** \brief Return the number of bytes in buffers that are in use
+   */
+  size_type bytesInUse() const;
+
+  /** \brief Return the largest number of bytes in use at one time
+   */
+  size_type peakBytesInUse() const;
+
+  /** \brief Return the number of bytes held in released buffers
+   */
+  size_type bytesCached() const;
+
+  /** \brief Reset the request counts and the peak number of bytes in
+   *         use
+   */
+  void resetStatistics();
+
+  /** \brief A one-line summary of the allocation statistics
+   */
+  std::string description() const;
+
+  /** \brief Return the default pool for this type
+   *
+   * The default pool is not used unless it is installed, either with
+   * <tt>Allocator< T >::setDefault()</tt> or with a
+   * <tt>MemoryArena</tt>.
+   */
+  static Teuchos::RCP< MemoryPool< T > > getDefault();
+
+private:
+
+  // The pool state is shared with the deallocators of the buffers
+  // handed out, so that released buffers can be returned to the pool
+  struct State
+  {
+    std::map< size_type, std::vector< T* > > freeBuffers;
+    bool      open;
+    size_type maxCachedBytes;
+    size_type numRequests;
+    size_type numReuses;
+    size_type numAllocations;
+    size_type bytesInUse;
+    size_type peakBytesInUse;
+    size_type bytesCached;
+  };
+
+  // The Teuchos::ArrayRCP deallocation policy for pool buffers
+  class ReturnToPool
+  {
+  public:
+    typedef T ptr_t;
+    ReturnToPool(const Teuchos::RCP< State > & state, size_type size) :
+      _state(state), _size(size) { }
+    void free(T * ptr);
+  private:
+    Teuchos::RCP< State > _state;
+    size_type             _size;
+  };
+
+  Teuchos::RCP< State > _state;
+
+  // Not copyable
+  MemoryPool(const MemoryPool< T > & source);
+  MemoryPool< T > & operator=(const MemoryPool< T > & source);
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief A scope in which new data buffers are allocated by a given
+ *         allocator
+ *
+ * While a <tt>MemoryArena</tt> is in scope, all new
+ * <tt>MDArrayRCP</tt> and <tt>MDVector</tt> data buffers of type T
+ * are allocated by its allocator.  Arenas nest, and the innermost
+ * one in scope is used.  A typical use is to hold a pool across the
+ * iterations of a solver, and open an arena on it for the work
+ * vectors of each iteration:
+ *
+ * \code
+ * Teuchos::RCP< MemoryPool< double > > pool =
+ *   Teuchos::rcp(new MemoryPool< double >);
+ * for (int iter = 0; iter < numIters; ++iter)
+ * {
+ *   MemoryArena< double > arena(pool);
+ *   MDVector< double > work(mdMap);
+ *   ...
+ * }
+ * \endcode
+ *
+ * An arena constructed without an allocator creates its own
+ * <tt>MemoryPool</tt>, which is destroyed, along with its released
+ * buffers, when the arena goes out of scope.
+ */
+template< class T >
+class MemoryArena
+{
+public:
+
+  /** \brief Constructor with a new, private <tt>MemoryPool</tt>
+   */
+  MemoryArena();
+
+  /** \brief Constructor with a given allocator
+   *
+   * \param allocator [in] the allocator for new buffers while this
+   *        arena is in scope
+   */
+  MemoryArena(const Teuchos::RCP< Allocator< T > > & allocator);
+
+  /** \brief Destructor, which restores the previous allocator
+   */
+  ~MemoryArena();
+
+  /** \brief Return the allocator of this arena
+   */
+  Teuchos::RCP< Allocator< T > > getAllocator() const;
+
+private:
+
+  Teuchos::RCP< Allocator< T > > _allocator;
+
+  // Not copyable
+  MemoryArena(const MemoryArena< T > & source);
+  MemoryArena< T > & operator=(const MemoryArena< T > & source);
+};
+
+/////////////////////
+// Implementations //
+/////////////////////
+
+template< class T >
+Teuchos::RCP< Allocator< T > >
+Allocator< T >::getCurrent()
+{
+  std::vector< Teuchos::RCP< Allocator< T > > > & stack = arenaStack();
+  if (stack.size() > 0) return stack.back();
+  return defaultAllocator();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+void
+Allocator< T >::setDefault(const Teuchos::RCP< Allocator< T > > & allocator)
+{
+  defaultAllocator() = allocator;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+Teuchos::RCP< Allocator< T > >
+Allocator< T >::getDefault()
+{
+  return defaultAllocator();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+Teuchos::RCP< Allocator< T > > &
+Allocator< T >::defaultAllocator()
+{
+  static Teuchos::RCP< Allocator< T > > allocator;
+  return allocator;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+std::vector< Teuchos::RCP< Allocator< T > > > &
+Allocator< T >::arenaStack()
+{
+  static std::vector< Teuchos::RCP< Allocator< T > > > stack;
+  return stack;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+MemoryPool< T >::MemoryPool(size_type maxCachedBytes) :
+  _state(Teuchos::rcp(new State))
+{
+  _state->open           = true;
+  _state->maxCachedBytes = maxCachedBytes;
+  _state->bytesInUse     = 0;
+  _state->bytesCached    = 0;
+  resetStatistics();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+MemoryPool< T >::~MemoryPool()
+{
+  clear();
+  _state->open = false;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+Teuchos::ArrayRCP< T >
+MemoryPool< T >::allocate(size_type size)
+{
+  if (size == 0) return Teuchos::ArrayRCP< T >();
+
+  ++_state->numRequests;
+  T * buffer = 0;
+  std::vector< T* > & freeList = _state->freeBuffers[size];
+  if (freeList.size() > 0)
+  {
+    buffer = freeList.back();
+    freeList.pop_back();
+    _state->bytesCached -= size * sizeof(T);
+    ++_state->numReuses;
+  }
+  else
+  {
+    buffer = new T[size];
+    ++_state->numAllocations;
+  }
+
+  _state->bytesInUse += size * sizeof(T);
+  if (_state->bytesInUse > _state->peakBytesInUse)
+    _state->peakBytesInUse = _state->bytesInUse;
+
+  return Teuchos::arcp(buffer, 0, size, ReturnToPool(_state, size), true);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+void
+MemoryPool< T >::clear()
+{
+  typedef typename std::map< size_type, std::vector< T* > >::iterator
+    iterator;
+  for (iterator it = _state->freeBuffers.begin();
+       it != _state->freeBuffers.end(); ++it)
+    for (std::size_t i = 0; i < it->second.size(); ++i)
+      delete [] it->second[i];
+  _state->freeBuffers.clear();
+  _state->bytesCached = 0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+size_type
+MemoryPool< T >::numRequests() const
+{
+  return _state->numRequests;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+size_type
+MemoryPool< T >::numReuses() const
+{
+  return _state->numReuses;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+size_type
+MemoryPool< T >::numAllocations() const
+{
+  return _state->numAllocations;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+size_type
+MemoryPool< T >::bytesInUse() const
+{
+  return _state->bytesInUse;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+size_type
+MemoryPool< T >::peakBytesInUse() const
+{
+  return _state->peakBytesInUse;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+size_type
+MemoryPool< T >::bytesCached() const
+{
+  return _state->bytesCached;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+void
+MemoryPool< T >::resetStatistics()
+{
+  _state->numRequests    = 0;
+  _state->numReuses      = 0;
+  _state->numAllocations = 0;
+  _state->peakBytesInUse = _state->bytesInUse;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+std::string
+MemoryPool< T >::description() const
+{
+  std::stringstream result;
+  result << "Domi::MemoryPool: requests = " << numRequests()
+         << ", reuses = " << numReuses()
+         << ", allocations = " << numAllocations()
+         << ", bytes in use = " << bytesInUse()
+         << ", peak bytes in use = " << peakBytesInUse()
+         << ", bytes cached = " << bytesCached();
+  return result.str();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+Teuchos::RCP< MemoryPool< T > >
+MemoryPool< T >::getDefault()
+{
+  static Teuchos::RCP< MemoryPool< T > > pool =
+    Teuchos::rcp(new MemoryPool< T >);
+  return pool;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+void
+MemoryPool< T >::ReturnToPool::free(T * ptr)
+{
+  size_type bytes = _size * sizeof(T);
+  _state->bytesInUse -= bytes;
+  if (_state->open &&
+      (_state->maxCachedBytes == 0 ||
+       _state->bytesCached + bytes <= _state->maxCachedBytes))
+  {
+    _state->freeBuffers[_size].push_back(ptr);
+    _state->bytesCached += bytes;
+  }
+  else
+    delete [] ptr;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+MemoryArena< T >::MemoryArena() :
+  _allocator(Teuchos::rcp(new MemoryPool< T >))
+{
+  Allocator< T >::arenaStack().push_back(_allocator);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+MemoryArena< T >::
+MemoryArena(const Teuchos::RCP< Allocator< T > > & allocator) :
+  _allocator(allocator)
+{
+  Allocator< T >::arenaStack().push_back(_allocator);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+MemoryArena< T >::~MemoryArena()
+{
+  Allocator< T >::arenaStack().pop_back();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class T >
+Teuchos::RCP< Allocator< T > >
+MemoryArena< T >::getAllocator() const
+{
+  return _allocator;
+}
+
+}  // namespace Domi
+
+#endif
@@ -0,0 +1,274 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_PACKUNPACK_HPP
+#define DOMI_PACKUNPACK_HPP
+
+// Standard includes
+#include <algorithm>
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+#include "Domi_MDArrayView.hpp"
+
+namespace Domi
+{
+
+/** \file Domi_PackUnpack.hpp
+ *
+ * \brief Kernels for copying the data of a (potentially strided)
+ *        MDArrayView to and from a contiguous buffer
+ *
+ * These kernels are used to pack communication pad data into
+ * contiguous message buffers before sending, and to unpack received
+ * message buffers into communication pads.  The data is copied one
+ * line at a time along the fastest axis of the MDArrayView.  Lines
+ * with unit stride are copied with <tt>std::copy()</tt>, which the
+ * compiler and standard library reduce to a block memory copy for
+ * plain old data types, and strided lines are copied with an
+ * unrolled loop.  If the MDArrayView is contiguous, its data is
+ * copied with a single block copy.
+ */
+
+/** \brief Copy a single, potentially strided, line of data into a
+ *         contiguous buffer
+ *
+ * \param source [in] pointer to the first element of the line
+ *
+ * \param stride [in] the stride between line elements
+ *
+ * \param n [in] the number of elements in the line
+ *
+ * \param target [out] pointer to the contiguous buffer
+ */
+template< class T >
+inline void packLine(const T * source,
+                     size_type stride,
+                     size_type n,
+                     T * target)
+{
+  if (stride == 1)
+  {
+    std::copy(source, source + n, target);
+    return;
+  }
+  size_type i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    target[i  ] = source[ i   *stride];
+    target[i+1] = source[(i+1)*stride];
+    target[i+2] = source[(i+2)*stride];
+    target[i+3] = source[(i+3)*stride];
+  }
+  for (; i < n; ++i)
+    target[i] = source[i*stride];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Copy a contiguous buffer into a single, potentially
+ *         strided, line of data
+ *
+ * \param source [in] pointer to the contiguous buffer
+ *
+ * \param n [in] the number of elements in the line
+ *
+ * \param target [out] pointer to the first element of the line
+ *
+ * \param stride [in] the stride between line elements
+ */
+template< class T >
+inline void unpackLine(const T * source,
+                       size_type n,
+                       T * target,
+                       size_type stride)
+{
+  if (stride == 1)
+  {
+    std::copy(source, source + n, target);
+    return;
+  }
+  size_type i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    target[ i   *stride] = source[i  ];
+    target[(i+1)*stride] = source[i+1];
+    target[(i+2)*stride] = source[i+2];
+    target[(i+3)*stride] = source[i+3];
+  }
+  for (; i < n; ++i)
+    target[i*stride] = source[i];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line functor for <tt>walkLines()</tt> that packs each line
+ *         into the next position of a contiguous buffer
+ */
+template< class T >
+struct PackLineFunctor
+{
+  PackLineFunctor(const T * source,
+                  size_type stride,
+                  size_type length,
+                  typename remove_const< T >::type * buffer) :
+    _source(source), _stride(stride), _length(length), _buffer(buffer) { }
+  void operator()(const dim_type *, const size_type * offsets)
+  {
+    packLine(_source + offsets[0], _stride, _length, _buffer);
+    _buffer += _length;
+  }
+  const T * _source;
+  size_type _stride;
+  size_type _length;
+  typename remove_const< T >::type * _buffer;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line functor for <tt>walkLines()</tt> that unpacks the next
+ *         position of a contiguous buffer into each line
+ */
+template< class T >
+struct UnpackLineFunctor
+{
+  UnpackLineFunctor(const T * buffer,
+                    T * target,
+                    size_type stride,
+                    size_type length) :
+    _buffer(buffer), _target(target), _stride(stride), _length(length) { }
+  void operator()(const dim_type *, const size_type * offsets)
+  {
+    unpackLine(_buffer, _length, _target + offsets[0], _stride);
+    _buffer += _length;
+  }
+  const T * _buffer;
+  T *       _target;
+  size_type _stride;
+  size_type _length;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Copy the data of an MDArrayView into a contiguous buffer
+ *
+ * \param view [in] the source MDArrayView
+ *
+ * \param buffer [out] the target buffer, which must have room for at
+ *        least <tt>computeSize(view.dimensions())</tt> elements.  The
+ *        data is stored in the layout order of the MDArrayView.
+ *
+ * Returns the number of elements copied.
+ */
+template< class T >
+size_type packMDArrayView(const MDArrayView< T > & view,
+                          typename remove_const< T >::type * buffer)
+{
+  const Teuchos::Array< dim_type > & dims    = view.dimensions();
+  const Teuchos::Array< size_type > & strides = view.strides();
+  int numDims = dims.size();
+  size_type size = computeSize(dims);
+  if (size == 0) return 0;
+  const T * ptr = view.getRawPtr();
+
+  // Contiguous data is a single block
+  if (isContiguous(dims(), strides(), view.layout()))
+  {
+    std::copy(ptr, ptr + size, buffer);
+    return size;
+  }
+
+  // Pack each line along the fastest axis into consecutive positions
+  // of the buffer
+  int first = (view.layout() == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+  PackLineFunctor< T > functor(ptr, strides[first], dims[first], buffer);
+  const size_type * stridePtr = strides.getRawPtr();
+  walkLines(numDims, 0, dims.getRawPtr(), view.layout(), 1, &stridePtr,
+            functor);
+  return size;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Copy a contiguous buffer into the data of an MDArrayView
+ *
+ * \param buffer [in] the source buffer, which must contain at least
+ *        <tt>computeSize(view.dimensions())</tt> elements, stored in
+ *        the layout order of the MDArrayView
+ *
+ * \param view [in] the target MDArrayView.  The MDArrayView itself
+ *        is not changed, but the data it points to is.
+ *
+ * Returns the number of elements copied.
+ */
+template< class T >
+size_type unpackMDArrayView(const T * buffer,
+                            const MDArrayView< T > & view)
+{
+  const Teuchos::Array< dim_type > & dims    = view.dimensions();
+  const Teuchos::Array< size_type > & strides = view.strides();
+  int numDims = dims.size();
+  size_type size = computeSize(dims);
+  if (size == 0) return 0;
+  T * ptr = const_cast< T * >(view.getRawPtr());
+
+  // Contiguous data is a single block
+  if (isContiguous(dims(), strides(), view.layout()))
+  {
+    std::copy(buffer, buffer + size, ptr);
+    return size;
+  }
+
+  // Unpack consecutive positions of the buffer into each line along
+  // the fastest axis
+  int first = (view.layout() == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+  UnpackLineFunctor< T > functor(buffer, ptr, strides[first], dims[first]);
+  const size_type * stridePtr = strides.getRawPtr();
+  walkLines(numDims, 0, dims.getRawPtr(), view.layout(), 1, &stridePtr,
+            functor);
+  return size;
+}
+
+}  // namespace Domi
+
+#endif
@@ -0,0 +1,668 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_REDISTRIBUTOR_HPP
+#define DOMI_REDISTRIBUTOR_HPP
+
+// Standard includes
+#include <algorithm>
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Exceptions.hpp"
+#include "Domi_MDMap.hpp"
+#include "Domi_MDVector.hpp"
+#include "Domi_PackUnpack.hpp"
+#include "Domi_Threads.hpp"
+
+// Teuchos includes
+#include "Teuchos_Comm.hpp"
+#include "Teuchos_CommHelpers.hpp"
+#ifdef HAVE_MPI
+#include "Teuchos_DefaultMpiComm.hpp"
+#endif
+
+namespace Domi
+{
+
+/** \brief Communication plan for moving the data of MDVectors from one
+ *         MDMap to another
+ *
+ * Two MDMaps with the same global dimensions may decompose them
+ * differently, for example over 16x1 and 4x4 processors, or with
+ * different communication padding.  A <tt>Redistributor</tt> copies
+ * the data of an MDVector on a source MDMap to an MDVector on a
+ * target MDMap, without the round trip through a file.
+ *
+ * The constructor computes the overlap of the global rank bounds of
+ * every processor in the source MDMap with those of every processor
+ * in the target MDMap, which requires a single all-gather of the
+ * bounds.  Each processor then communicates only with the processors
+ * whose bounds overlap its own, through contiguous buffers and
+ * persistent MPI requests that are created once, so that the
+ * redistribution can be repeated at the cost of packing, the
+ * messages themselves and unpacking.  The part of the data that
+ * stays on a processor is copied directly.  For example:
+ *
+ *   \code
+ *   Domi::Redistributor< double > redistributor(rowMap, blockMap);
+ *   for (int step = 0; step < numSteps; ++step)
+ *   {
+ *     solveRows(u);
+ *     redistributor.redistribute(u, v);
+ *     v.updateCommPad();
+ *     solveBlocks(v);
+ *   }
+ *   \endcode
+ *
+ * Only the data owned by each processor is redistributed, and the
+ * communication padding of the target is not updated.  Both MDMaps
+ * must be on the same communicator, and must have the same layout.
+ */
+template< class Scalar >
+class Redistributor
+{
+public:
+
+  /** \name Constructor and destructor */
+  //@{
+
+  /** \brief Constructor
+   *
+   * \param source [in] the MDMap of the MDVectors that data is copied
+   *        from
+   *
+   * \param target [in] the MDMap of the MDVectors that data is copied
+   *        to
+   *
+   * \param includeBndryPad [in] if true, the boundary padding is
+   *        redistributed along with the data, in which case the two
+   *        MDMaps must have the same boundary pad sizes
+   *
+   * This is collective over the communicator of the MDMaps.
+   */
+  Redistributor(const Teuchos::RCP< const MDMap > & source,
+                const Teuchos::RCP< const MDMap > & target,
+                bool includeBndryPad = false);
+
+  /** \brief Destructor
+   *
+   * If a redistribution has been started but not ended, the
+   * destructor waits for its messages to complete.
+   */
+  ~Redistributor();
+
+  //@}
+
+  /** \name Redistribution methods */
+  //@{
+
+  /** \brief Copy the data of an MDVector on the source MDMap to an
+   *         MDVector on the target MDMap
+   *
+   * \param source [in] the MDVector on the source MDMap
+   *
+   * \param target [in/out] the MDVector on the target MDMap
+   *
+   * The MDVectors may be on any MDMaps that have the same global
+   * structure, as given by <tt>MDMap::getFingerprint()</tt>, as the
+   * source and target MDMaps of this <tt>Redistributor</tt>, so that
+   * their communication padding may differ.
+   */
+  void redistribute(const MDVector< Scalar > & source,
+                    MDVector< Scalar > & target);
+
+  /** \brief Start a redistribution
+   *
+   * \param source [in] the MDVector on the source MDMap
+   *
+   * \param target [in/out] the MDVector on the target MDMap, into
+   *        which the part of the data that stays on each processor is
+   *        copied immediately
+   *
+   * The source data is packed and sent, so that the source MDVector
+   * may be modified as soon as this method returns.
+   */
+  void startRedistribute(const MDVector< Scalar > & source,
+                         MDVector< Scalar > & target);
+
+  /** \brief End a redistribution, waiting for its messages and
+   *         copying them into the target MDVector
+   *
+   * \param target [in/out] the MDVector that was given to
+   *        <tt>startRedistribute()</tt>
+   */
+  void endRedistribute(MDVector< Scalar > & target);
+
+  //@}
+
+  /** \name Plan information */
+  //@{
+
+  /** \brief Return the number of processors this processor sends to
+   */
+  inline int numSends() const;
+
+  /** \brief Return the number of processors this processor receives
+   *         from
+   */
+  inline int numRecvs() const;
+
+  /** \brief Return the number of elements this processor sends to
+   *         other processors
+   */
+  inline size_type sendSize() const;
+
+  /** \brief Return the number of elements this processor receives
+   *         from other processors
+   */
+  inline size_type recvSize() const;
+
+  //@}
+
+private:
+
+  // A box of data exchanged with one processor.  The start is
+  // relative to the first element of this processor's data in the
+  // source or target MDMap.
+  struct Message
+  {
+    int                        proc;
+    Teuchos::Array< dim_type > start;
+    Teuchos::Array< dim_type > shape;
+    size_type                  offset;
+    size_type                  size;
+  };
+
+  // Compute the overlap of two boxes, each given as the lower bounds
+  // followed by the upper bounds along every axis, relative to an
+  // origin.  Return false if they do not overlap.
+  static bool computeOverlap(const dim_type * a,
+                             const dim_type * b,
+                             const dim_type * origin,
+                             int ndims,
+                             Message & message);
+
+  // Return the view of the box of a message within the data of an
+  // MDVector, including all padding
+  template< class T >
+  MDArrayView< T > getMessageView(MDArrayView< T > data,
+                                  const MDMap & mdMap,
+                                  const Message & message) const;
+
+  // Assert that an MDVector is on an MDMap compatible with the given
+  // MDMap.  This must be called on all processors.
+  void assertMDMap(const MDVector< Scalar > & mdVector,
+                   const MDMap & mdMap,
+                   const char * name) const;
+
+  // The communicator and the MDMaps
+  Teuchos::RCP< const Teuchos::Comm< int > > _teuchosComm;
+  Teuchos::RCP< const MDMap >                _source;
+  Teuchos::RCP< const MDMap >                _target;
+  bool                                       _includeBndryPad;
+
+  // The messages to and from other processors, and the part of the
+  // data that stays on this processor, if any
+  Teuchos::Array< Message > _sends;
+  Teuchos::Array< Message > _recvs;
+  bool                      _hasLocal;
+  Message                   _localSend;
+  Message                   _localRecv;
+
+  // The contiguous message buffers
+  Teuchos::Array< Scalar > _sendBuffer;
+  Teuchos::Array< Scalar > _recvBuffer;
+
+  // Flag indicating whether a redistribution has been started
+  bool _started;
+
+#ifdef HAVE_MPI
+  // The persistent requests for the sends, followed by those for the
+  // receives
+  Teuchos::Array< MPI_Request > _requests;
+#endif
+
+  // Not copyable, since the requests refer to the buffers
+  Redistributor(const Redistributor & source);
+  Redistributor & operator=(const Redistributor & source);
+};
+
+/////////////////////
+// Implementations //
+/////////////////////
+
+template< class Scalar >
+Redistributor< Scalar >::
+Redistributor(const Teuchos::RCP< const MDMap > & source,
+              const Teuchos::RCP< const MDMap > & target,
+              bool includeBndryPad) :
+  _teuchosComm(source->getTeuchosComm()),
+  _source(source),
+  _target(target),
+  _includeBndryPad(includeBndryPad),
+  _sends(),
+  _recvs(),
+  _hasLocal(false),
+  _localSend(),
+  _localRecv(),
+  _sendBuffer(),
+  _recvBuffer(),
+  _started(false)
+#ifdef HAVE_MPI
+  , _requests()
+#endif
+{
+  // Check that the MDMaps are on the same communicator, or on
+  // communicators with the same processors in the same order
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! source->onSubcommunicator() || ! target->onSubcommunicator(),
+    InvalidArgument,
+    "Redistributor: the source and target MDMaps must be on the same "
+    "communicator");
+#ifdef HAVE_MPI
+  Teuchos::RCP< const Teuchos::MpiComm< int > > sourceComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  Teuchos::RCP< const Teuchos::MpiComm< int > > targetComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(
+      target->getTeuchosComm());
+  int comparison = MPI_UNEQUAL;
+  if (MPI_Comm_compare((*(sourceComm->getRawMpiComm()))(),
+                       (*(targetComm->getRawMpiComm()))(),
+                       &comparison))
+    throw std::runtime_error("Domi::Redistributor: Error in "
+                             "MPI_Comm_compare");
+  bool sameComm = (comparison == MPI_IDENT || comparison == MPI_CONGRUENT);
+#else
+  bool sameComm =
+    (_teuchosComm->getSize() == target->getTeuchosComm()->getSize());
+#endif
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! sameComm,
+    InvalidArgument,
+    "Redistributor: the source and target MDMaps must be on the same "
+    "communicator");
+
+  // Check that the MDMaps are compatible
+  int ndims = source->numDims();
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    target->numDims() != ndims,
+    MDMapError,
+    "Redistributor: the source MDMap has " << ndims << " dimensions, but "
+    "the target MDMap has " << target->numDims());
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    source->getLayout() != target->getLayout(),
+    MDMapError,
+    "Redistributor: the source and target MDMaps have different layouts");
+  for (int axis = 0; axis < ndims; ++axis)
+  {
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      source->getGlobalDim(axis,includeBndryPad) !=
+      target->getGlobalDim(axis,includeBndryPad),
+      MDMapError,
+      "Redistributor: along axis " << axis << ", the source MDMap has "
+      "global dimension " << source->getGlobalDim(axis,includeBndryPad)
+      << ", but the target MDMap has global dimension "
+      << target->getGlobalDim(axis,includeBndryPad));
+  }
+
+  // Gather the global rank bounds of every processor in both MDMaps,
+  // relative to the first global index of each MDMap, so that the
+  // MDMaps may have different boundary padding
+  int rank    = _teuchosComm->getRank();
+  int numProc = _teuchosComm->getSize();
+  int boxSize = 2 * ndims;
+  Teuchos::Array< dim_type > myBoxes(2 * boxSize);
+  for (int axis = 0; axis < ndims; ++axis)
+  {
+    dim_type sourceOrigin = source->getGlobalBounds(axis,
+                                                    includeBndryPad).start();
+    dim_type targetOrigin = target->getGlobalBounds(axis,
+                                                    includeBndryPad).start();
+    Slice sourceBounds = source->getGlobalRankBounds(axis,includeBndryPad);
+    Slice targetBounds = target->getGlobalRankBounds(axis,includeBndryPad);
+    myBoxes[axis]                 = sourceBounds.start() - sourceOrigin;
+    myBoxes[ndims+axis]           = sourceBounds.stop()  - sourceOrigin;
+    myBoxes[boxSize+axis]         = targetBounds.start() - targetOrigin;
+    myBoxes[boxSize+ndims+axis]   = targetBounds.stop()  - targetOrigin;
+  }
+  Teuchos::Array< dim_type > boxes(2 * boxSize * numProc);
+  Teuchos::gatherAll(*_teuchosComm,
+                     (int) myBoxes.size(),
+                     myBoxes.getRawPtr(),
+                     (int) boxes.size(),
+                     boxes.getRawPtr());
+
+  // This processor sends the overlap of its source box with the
+  // target box of each processor, and receives the overlap of the
+  // source box of each processor with its target box
+  const dim_type * mySource = &myBoxes[0];
+  const dim_type * myTarget = &myBoxes[boxSize];
+  size_type sendSize = 0;
+  size_type recvSize = 0;
+  for (int proc = 0; proc < numProc; ++proc)
+  {
+    const dim_type * procSource = &boxes[2 * boxSize * proc];
+    const dim_type * procTarget = &boxes[2 * boxSize * proc + boxSize];
+    if (proc == rank)
+    {
+      _hasLocal = computeOverlap(mySource, myTarget, mySource, ndims,
+                                 _localSend);
+      computeOverlap(mySource, myTarget, myTarget, ndims, _localRecv);
+      continue;
+    }
+    Message message;
+    message.proc = proc;
+    if (computeOverlap(mySource, procTarget, mySource, ndims, message))
+    {
+      message.offset = sendSize;
+      sendSize += message.size;
+      _sends.push_back(message);
+    }
+    if (computeOverlap(procSource, myTarget, myTarget, ndims, message))
+    {
+      message.offset = recvSize;
+      recvSize += message.size;
+      _recvs.push_back(message);
+    }
+  }
+  _sendBuffer.resize(sendSize);
+  _recvBuffer.resize(recvSize);
+
+#ifdef HAVE_MPI
+  // Create the persistent sends and receives.  The buffers are not
+  // resized after this point.
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+  MPI_Request request;
+  for (int i = 0; i < _sends.size(); ++i)
+  {
+    const Message & message = _sends[i];
+    if (MPI_Send_init(&_sendBuffer[message.offset],
+                      (int) message.size,
+                      mpiType< Scalar >(),
+                      message.proc,
+                      0,
+                      communicator(),
+                      &request))
+      throw std::runtime_error("Domi::Redistributor: Error in "
+                               "MPI_Send_init");
+    _requests.push_back(request);
+  }
+  for (int i = 0; i < _recvs.size(); ++i)
+  {
+    const Message & message = _recvs[i];
+    if (MPI_Recv_init(&_recvBuffer[message.offset],
+                      (int) message.size,
+                      mpiType< Scalar >(),
+                      message.proc,
+                      0,
+                      communicator(),
+                      &request))
+      throw std::runtime_error("Domi::Redistributor: Error in "
+                               "MPI_Recv_init");
+    _requests.push_back(request);
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Redistributor< Scalar >::
+~Redistributor()
+{
+#ifdef HAVE_MPI
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (finalized) return;
+  if (_started && _requests.size() > 0)
+    MPI_Waitall(_requests.size(), _requests.getRawPtr(),
+                MPI_STATUSES_IGNORE);
+  for (int i = 0; i < _requests.size(); ++i)
+    if (_requests[i] != MPI_REQUEST_NULL)
+      MPI_Request_free(&(_requests[i]));
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+Redistributor< Scalar >::
+redistribute(const MDVector< Scalar > & source,
+             MDVector< Scalar > & target)
+{
+  startRedistribute(source, target);
+  endRedistribute(target);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+Redistributor< Scalar >::
+startRedistribute(const MDVector< Scalar > & source,
+                  MDVector< Scalar > & target)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    _started,
+    InvalidArgument,
+    "Redistributor: a redistribution is in progress");
+  assertMDMap(source, *_source, "source");
+  assertMDMap(target, *_target, "target");
+
+  // Pack the messages to the other processors, and start the sends
+  // and receives
+  const MDMap & sourceMap = *(source.getMDMap());
+  MDArrayView< const Scalar > sourceData = source.getData(true);
+  for (int i = 0; i < _sends.size(); ++i)
+  {
+    const Message & message = _sends[i];
+    packMDArrayView(getMessageView(sourceData, sourceMap, message),
+                    &_sendBuffer[message.offset]);
+  }
+#ifdef HAVE_MPI
+  if (_requests.size() > 0)
+    if (MPI_Startall(_requests.size(), _requests.getRawPtr()))
+      throw std::runtime_error("Domi::Redistributor: Error in MPI_Startall");
+#endif
+  _started = true;
+
+  // Copy the data that stays on this processor while the messages
+  // are in flight
+  if (_hasLocal)
+  {
+    MDArrayView< const Scalar > from =
+      getMessageView(sourceData, sourceMap, _localSend);
+    MDArrayView< Scalar > to =
+      getMessageView(target.getDataNonConst(true), *(target.getMDMap()),
+                     _localRecv);
+    threadedCopy(from.getRawPtr(), from.strides()(), to.getRawPtr(),
+                 to.strides()(), from.dimensions()(), from.layout());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+Redistributor< Scalar >::
+endRedistribute(MDVector< Scalar > & target)
+{
+  if (! _started) return;
+  assertMDMap(target, *_target, "target");
+#ifdef HAVE_MPI
+  if (_requests.size() > 0)
+    if (MPI_Waitall(_requests.size(), _requests.getRawPtr(),
+                    MPI_STATUSES_IGNORE))
+      throw std::runtime_error("Domi::Redistributor: Error in MPI_Waitall");
+#endif
+  _started = false;
+
+  // Unpack the messages from the other processors
+  const MDMap & targetMap = *(target.getMDMap());
+  MDArrayView< Scalar > targetData = target.getDataNonConst(true);
+  for (int i = 0; i < _recvs.size(); ++i)
+  {
+    const Message & message = _recvs[i];
+    unpackMDArrayView(&_recvBuffer[message.offset],
+                      getMessageView(targetData, targetMap, message));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+Redistributor< Scalar >::
+numSends() const
+{
+  return _sends.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+Redistributor< Scalar >::
+numRecvs() const
+{
+  return _recvs.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+size_type
+Redistributor< Scalar >::
+sendSize() const
+{
+  return _sendBuffer.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+size_type
+Redistributor< Scalar >::
+recvSize() const
+{
+  return _recvBuffer.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+Redistributor< Scalar >::
+computeOverlap(const dim_type * a,
+               const dim_type * b,
+               const dim_type * origin,
+               int ndims,
+               Message & message)
+{
+  message.start.resize(ndims);
+  message.shape.resize(ndims);
+  message.size = 1;
+  for (int axis = 0; axis < ndims; ++axis)
+  {
+    dim_type lower = std::max(a[axis], b[axis]);
+    dim_type upper = std::min(a[ndims+axis], b[ndims+axis]);
+    if (upper <= lower) return false;
+    message.start[axis] = lower - origin[axis];
+    message.shape[axis] = upper - lower;
+    message.size       *= upper - lower;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+template< class T >
+MDArrayView< T >
+Redistributor< Scalar >::
+getMessageView(MDArrayView< T > data,
+               const MDMap & mdMap,
+               const Message & message) const
+{
+  // The first element of this processor's data is at the start of
+  // the local bounds without padding, moved down by the lower
+  // boundary pad if it is included
+  for (int axis = 0; axis < mdMap.numDims(); ++axis)
+  {
+    dim_type origin = mdMap.getLocalBounds(axis,false).start() -
+      mdMap.getGlobalRankBounds(axis,false).start() +
+      mdMap.getGlobalRankBounds(axis,_includeBndryPad).start();
+    dim_type start = origin + message.start[axis];
+    data = MDArrayView< T >(data, axis,
+                            Slice(start, start + message.shape[axis]));
+  }
+  return data;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+Redistributor< Scalar >::
+assertMDMap(const MDVector< Scalar > & mdVector,
+            const MDMap & mdMap,
+            const char * name) const
+{
+  // MDMap::isCompatible() compares the fingerprints, guards against
+  // their collisions by comparing the number of dimensions, commDims,
+  // global dimensions and rank bound sizes, and checks the local
+  // dimensions of every processor, caching the result for the MDComm
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! mdVector.getMDMap()->isCompatible(mdMap),
+    MDMapError,
+    "Redistributor: the " << name << " MDVector is not on an MDMap with "
+    "the same global structure as the " << name << " MDMap");
+}
+
+}  // namespace Domi
+
+#endif
@@ -0,0 +1,852 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_REDUCTIONBATCH_HPP
+#define DOMI_REDUCTIONBATCH_HPP
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_MDVector.hpp"
+#include "Domi_LocalReductions.hpp"
+
+// Teuchos includes
+#include "Teuchos_Comm.hpp"
+#include "Teuchos_CommHelpers.hpp"
+#include "Teuchos_ScalarTraitsDecl.hpp"
+
+// Non-blocking collectives were introduced in MPI-3.  With an older
+// MPI, startReduce() falls back to a blocking MPI_Allreduce.
+#ifdef HAVE_MPI
+#if MPI_VERSION >= 3
+#define DOMI_HAVE_MPI_IALLREDUCE
+#endif
+#endif
+
+namespace Domi
+{
+
+/** \brief Batch of global reductions over one or more MDVectors
+ *
+ * Each of the <tt>MDVector</tt> reduction methods (<tt>dot()</tt>,
+ * <tt>norm1()</tt>, etc.) computes its local contribution and then
+ * performs its own global reduction, so that an algorithm that needs
+ * several reductions pays the latency of several global reductions.
+ * The <tt>ReductionBatch</tt> class allows several reductions,
+ * potentially over different <tt>MDVector</tt>s, to be enqueued and
+ * then completed with a single global reduction for all of the sums
+ * and a single global reduction for all of the maxima.
+ *
+ * Each of the <tt>add*()</tt> methods computes the local contribution
+ * of the requested reduction immediately and returns an integer
+ * handle that can later be used to obtain the global result.  For
+ * example:
+ *
+ *   \code
+ *   Domi::ReductionBatch< double > batch(comm);
+ *   int rr = batch.addDot(r, r);
+ *   int pq = batch.addDot(p, q);
+ *   int nx = batch.addNormInf(x);
+ *   batch.reduce();
+ *   double rDotR = batch.getScalar(rr);
+ *   double pDotQ = batch.getScalar(pq);
+ *   double xNorm = batch.getNorm(nx);
+ *   \endcode
+ *
+ * The global reductions may also be performed without blocking, by
+ * calling <tt>startReduce()</tt>, performing unrelated local work, and
+ * then calling <tt>endReduce()</tt>.  This is implemented with
+ * <tt>MPI_Iallreduce</tt>, and so the latency of the global reduction
+ * can be overlapped with local computation.  In a serial build, or
+ * with an MPI older than MPI-3, the reductions are completed
+ * immediately by <tt>startReduce()</tt>.
+ *
+ * All of the MDVectors added to a <tt>ReductionBatch</tt> must have a
+ * communicator congruent with the communicator given to the
+ * <tt>ReductionBatch</tt> constructor, and all processors must add
+ * the same reductions in the same order.
+ */
+template< class Scalar >
+class ReductionBatch
+{
+public:
+
+  /** \brief Magnitude type of the Scalar */
+  typedef typename Teuchos::ScalarTraits< Scalar >::magnitudeType
+    magnitudeType;
+
+  /** \name Constructor and destructor */
+  //@{
+
+  /** \brief Constructor
+   *
+   * \param teuchosComm [in] the communicator over which reductions
+   *        are performed
+   */
+  ReductionBatch(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm);
+
+  /** \brief Destructor
+   *
+   * If a non-blocking reduction has been started but not ended, the
+   * destructor waits for it to complete.  Errors encountered while
+   * waiting are ignored, since a destructor may not throw.
+   */
+  ~ReductionBatch();
+
+  //@}
+
+  /** \name Enqueueing reductions */
+  //@{
+
+  /** \brief Add the dot product of two MDVectors to the batch and
+   *         return its handle
+   *
+   * \param a [in] first MDVector
+   *
+   * \param b [in] second MDVector
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contribution
+   */
+  int addDot(const MDVector< Scalar > & a,
+             const MDVector< Scalar > & b,
+             bool compensated = false);
+
+  /** \brief Add the 1-norm of an MDVector to the batch and return its
+   *         handle
+   *
+   * \param a [in] the MDVector
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contribution
+   */
+  int addNorm1(const MDVector< Scalar > & a,
+               bool compensated = false);
+
+  /** \brief Add the 2-norm of an MDVector to the batch and return its
+   *         handle
+   *
+   * \param a [in] the MDVector
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contribution
+   */
+  int addNorm2(const MDVector< Scalar > & a,
+               bool compensated = false);
+
+  /** \brief Add the infinity-norm of an MDVector to the batch and
+   *         return its handle
+   *
+   * \param a [in] the MDVector
+   */
+  int addNormInf(const MDVector< Scalar > & a);
+
+  /** \brief Add the weighted norm of an MDVector to the batch and
+   *         return its handle
+   *
+   * \param a [in] the MDVector
+   *
+   * \param weights [in] MDVector of weights for weighted norm
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contribution
+   */
+  int addNormWeighted(const MDVector< Scalar > & a,
+                      const MDVector< Scalar > & weights,
+                      bool compensated = false);
+
+  /** \brief Add the mean value of an MDVector to the batch and return
+   *         its handle
+   *
+   * \param a [in] the MDVector
+   *
+   * \param compensated [in] if true, use compensated summation to
+   *        compute the local contribution
+   */
+  int addMeanValue(const MDVector< Scalar > & a,
+                   bool compensated = false);
+
+  /** \brief Return the number of reductions in the batch
+   */
+  inline int size() const;
+
+  /** \brief Remove all reductions from the batch, so that it may be
+   *         reused
+   */
+  void clear();
+
+  //@}
+
+  /** \name Global reduction methods */
+  //@{
+
+  /** \brief Perform the global reductions, blocking until they are
+   *         complete
+   */
+  void reduce();
+
+  /** \brief Start non-blocking global reductions
+   *
+   * No reductions may be added to the batch between a call to
+   * <tt>startReduce()</tt> and the completion of the reductions.
+   */
+  void startReduce();
+
+  /** \brief Return true if the global reductions are complete
+   *
+   * This method does not block.  If it returns true, the results may
+   * be obtained without waiting.
+   */
+  bool isComplete();
+
+  /** \brief Wait for non-blocking global reductions to complete
+   */
+  void endReduce();
+
+  //@}
+
+  /** \name Results */
+  //@{
+
+  /** \brief Return the result of a dot product or mean value
+   *         reduction
+   *
+   * \param handle [in] the handle returned by <tt>addDot()</tt> or
+   *        <tt>addMeanValue()</tt>
+   *
+   * If the global reductions have been started but have not yet
+   * completed, this method waits for them.
+   */
+  Scalar getScalar(int handle);
+
+  /** \brief Return the result of a norm reduction
+   *
+   * \param handle [in] the handle returned by <tt>addNorm1()</tt>,
+   *        <tt>addNorm2()</tt>, <tt>addNormInf()</tt> or
+   *        <tt>addNormWeighted()</tt>
+   *
+   * If the global reductions have been started but have not yet
+   * completed, this method waits for them.
+   */
+  magnitudeType getNorm(int handle);
+
+  //@}
+
+private:
+
+  // The kinds of reductions supported, which determine how the
+  // globally reduced value is post-processed
+  enum Kind
+  {
+    DOT,
+    NORM1,
+    NORM2,
+    NORMINF,
+    NORMWEIGHTED,
+    MEANVALUE
+  };
+
+  // Information about a single reduction in the batch
+  struct Entry
+  {
+    // The kind of reduction
+    Kind kind;
+    // The index of the reduction's value in either the sums or the
+    // maxima buffers
+    int index;
+    // The global size of the MDVector, for reductions that are
+    // normalized by size
+    size_type globalSize;
+  };
+
+  // The communicator over which reductions are performed
+  Teuchos::RCP< const Teuchos::Comm< int > > _teuchosComm;
+
+  // The reductions in the batch
+  Teuchos::Array< Entry > _entries;
+
+  // The local and global sums.  Sums of magnitudes are stored as
+  // Scalars, so that all sums can be reduced together.
+  Teuchos::Array< Scalar > _localSums;
+  Teuchos::Array< Scalar > _globalSums;
+
+  // The local and global maxima
+  Teuchos::Array< magnitudeType > _localMaxima;
+  Teuchos::Array< magnitudeType > _globalMaxima;
+
+  // Flags indicating whether the global reductions have been started
+  // and completed
+  bool _started;
+  bool _complete;
+
+#ifdef HAVE_MPI
+  // The requests for the non-blocking sum and maxima reductions
+  Teuchos::Array< MPI_Request > _requests;
+#endif
+
+  // Add a reduction entry and return its handle
+  int addEntry(Kind kind,
+               Scalar sum,
+               size_type globalSize = 1);
+
+  // Add a maximum reduction entry and return its handle
+  int addMaxEntry(Kind kind,
+                  magnitudeType maximum);
+
+  // Return the global size of an MDVector
+  static size_type globalSize(const MDVector< Scalar > & a);
+
+  // Assert that no global reduction is in progress
+  void assertNotStarted() const;
+
+  // Assert that the communicator of the given MDVector is congruent
+  // with the communicator of the batch
+  void assertComm(const MDVector< Scalar > & a,
+                  const std::string & name) const;
+
+  // Assert that the given handle is valid
+  void assertHandle(int handle) const;
+};
+
+/////////////////////
+// Implementations //
+/////////////////////
+
+template< class Scalar >
+ReductionBatch< Scalar >::
+ReductionBatch(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm) :
+  _teuchosComm(teuchosComm),
+  _entries(),
+  _localSums(),
+  _globalSums(),
+  _localMaxima(),
+  _globalMaxima(),
+  _started(false),
+  _complete(false)
+#ifdef HAVE_MPI
+  , _requests()
+#endif
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+ReductionBatch< Scalar >::
+~ReductionBatch()
+{
+#ifdef HAVE_MPI
+  // Wait for any outstanding requests, so that MPI does not write
+  // into the buffers after they are deallocated.  We call MPI_Waitall
+  // directly rather than endReduce(), which may throw.
+  if (_started && ! _complete && _requests.size() > 0)
+    MPI_Waitall(_requests.size(),
+                _requests.getRawPtr(),
+                MPI_STATUSES_IGNORE);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+ReductionBatch< Scalar >::
+addDot(const MDVector< Scalar > & a,
+       const MDVector< Scalar > & b,
+       bool compensated)
+{
+  assertNotStarted();
+  assertComm(a, "a");
+  assertComm(b, "b");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! a.getMDMap()->isCompatible(*(b.getMDMap())),
+    MDMapError,
+    "MDMaps of MDVectors 'a' and 'b' are incompatible");
+  SumLineKernel< Scalar, ProductOp< Scalar > > kernel(compensated);
+  applyLineKernel(a.getData(), b.getData(), kernel);
+  return addEntry(DOT, kernel.result());
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+ReductionBatch< Scalar >::
+addNorm1(const MDVector< Scalar > & a,
+         bool compensated)
+{
+  assertNotStarted();
+  assertComm(a, "a");
+  SumLineKernel< Scalar, AbsOp< Scalar > > kernel(compensated);
+  applyLineKernel(a.getData(), kernel);
+  return addEntry(NORM1, Scalar(kernel.result()));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+ReductionBatch< Scalar >::
+addNorm2(const MDVector< Scalar > & a,
+         bool compensated)
+{
+  assertNotStarted();
+  assertComm(a, "a");
+  SumLineKernel< Scalar, AbsSquareOp< Scalar > > kernel(compensated);
+  applyLineKernel(a.getData(), kernel);
+  return addEntry(NORM2, Scalar(kernel.result()));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+ReductionBatch< Scalar >::
+addNormInf(const MDVector< Scalar > & a)
+{
+  assertNotStarted();
+  assertComm(a, "a");
+  MaxAbsLineKernel< Scalar > kernel;
+  applyLineKernel(a.getData(), kernel);
+  return addMaxEntry(NORMINF, kernel.result());
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+ReductionBatch< Scalar >::
+addNormWeighted(const MDVector< Scalar > & a,
+                const MDVector< Scalar > & weights,
+                bool compensated)
+{
+  assertNotStarted();
+  assertComm(a, "a");
+  assertComm(weights, "weights");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! a.getMDMap()->isCompatible(*(weights.getMDMap())),
+    MDMapError,
+    "MDMaps of MDVectors 'a' and 'weights' are incompatible");
+  SumLineKernel< Scalar, WeightedSquareOp< Scalar > > kernel(compensated);
+  applyLineKernel(a.getData(), weights.getData(), kernel);
+  return addEntry(NORMWEIGHTED, Scalar(kernel.result()), globalSize(a));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+ReductionBatch< Scalar >::
+addMeanValue(const MDVector< Scalar > & a,
+             bool compensated)
+{
+  assertNotStarted();
+  assertComm(a, "a");
+  SumLineKernel< Scalar, IdentityOp< Scalar > > kernel(compensated);
+  applyLineKernel(a.getData(), kernel);
+  return addEntry(MEANVALUE, kernel.result(), globalSize(a));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+ReductionBatch< Scalar >::
+size() const
+{
+  return _entries.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+ReductionBatch< Scalar >::
+clear()
+{
+  assertNotStarted();
+  _entries.clear();
+  _localSums.clear();
+  _globalSums.clear();
+  _localMaxima.clear();
+  _globalMaxima.clear();
+  _complete = false;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+ReductionBatch< Scalar >::
+reduce()
+{
+  assertNotStarted();
+  _globalSums.resize(_localSums.size());
+  _globalMaxima.resize(_localMaxima.size());
+  if (_localSums.size() > 0)
+    Teuchos::reduceAll(*_teuchosComm,
+                       Teuchos::REDUCE_SUM,
+                       (int) _localSums.size(),
+                       _localSums.getRawPtr(),
+                       _globalSums.getRawPtr());
+  if (_localMaxima.size() > 0)
+    Teuchos::reduceAll(*_teuchosComm,
+                       Teuchos::REDUCE_MAX,
+                       (int) _localMaxima.size(),
+                       _localMaxima.getRawPtr(),
+                       _globalMaxima.getRawPtr());
+  _complete = true;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+ReductionBatch< Scalar >::
+startReduce()
+{
+  assertNotStarted();
+  _globalSums.resize(_localSums.size());
+  _globalMaxima.resize(_localMaxima.size());
+  _started  = true;
+  _complete = false;
+
+#ifdef HAVE_MPI
+  // Since HAVE_MPI is defined, we know that _teuchosComm points to a
+  // const Teuchos::MpiComm< int >.  We downcast, extract and
+  // dereference so that we can get access to the MPI_Comm used to
+  // construct it.
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+
+#ifdef DOMI_HAVE_MPI_IALLREDUCE
+  MPI_Request request;
+  if (_localSums.size() > 0)
+  {
+    if (MPI_Iallreduce(_localSums.getRawPtr(),
+                       _globalSums.getRawPtr(),
+                       (int) _localSums.size(),
+                       mpiType< Scalar >(),
+                       MPI_SUM,
+                       communicator(),
+                       &request))
+      throw std::runtime_error("Domi::ReductionBatch: Error in "
+                               "MPI_Iallreduce");
+    _requests.push_back(request);
+  }
+  if (_localMaxima.size() > 0)
+  {
+    if (MPI_Iallreduce(_localMaxima.getRawPtr(),
+                       _globalMaxima.getRawPtr(),
+                       (int) _localMaxima.size(),
+                       mpiType< magnitudeType >(),
+                       MPI_MAX,
+                       communicator(),
+                       &request))
+      throw std::runtime_error("Domi::ReductionBatch: Error in "
+                               "MPI_Iallreduce");
+    _requests.push_back(request);
+  }
+#else
+  // Without MPI-3 non-blocking collectives, perform blocking
+  // reductions and mark the batch as complete
+  if (_localSums.size() > 0)
+    if (MPI_Allreduce(_localSums.getRawPtr(),
+                      _globalSums.getRawPtr(),
+                      (int) _localSums.size(),
+                      mpiType< Scalar >(),
+                      MPI_SUM,
+                      communicator()))
+      throw std::runtime_error("Domi::ReductionBatch: Error in "
+                               "MPI_Allreduce");
+  if (_localMaxima.size() > 0)
+    if (MPI_Allreduce(_localMaxima.getRawPtr(),
+                      _globalMaxima.getRawPtr(),
+                      (int) _localMaxima.size(),
+                      mpiType< magnitudeType >(),
+                      MPI_MAX,
+                      communicator()))
+      throw std::runtime_error("Domi::ReductionBatch: Error in "
+                               "MPI_Allreduce");
+  _started  = false;
+  _complete = true;
+#endif
+#else
+  // In serial, the global values are the local values
+  _globalSums   = _localSums;
+  _globalMaxima = _localMaxima;
+  _started  = false;
+  _complete = true;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+bool
+ReductionBatch< Scalar >::
+isComplete()
+{
+#ifdef HAVE_MPI
+  if (_started && ! _complete)
+  {
+    int flag = 0;
+    if (_requests.size() == 0)
+      flag = 1;
+    else if (MPI_Testall(_requests.size(),
+                         _requests.getRawPtr(),
+                         &flag,
+                         MPI_STATUSES_IGNORE))
+      throw std::runtime_error("Domi::ReductionBatch: Error in MPI_Testall");
+    if (flag)
+    {
+      _requests.clear();
+      _started  = false;
+      _complete = true;
+    }
+  }
+#endif
+  return _complete;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+ReductionBatch< Scalar >::
+endReduce()
+{
+#ifdef HAVE_MPI
+  if (_started && ! _complete)
+  {
+    if (_requests.size() > 0)
+      if (MPI_Waitall(_requests.size(),
+                      _requests.getRawPtr(),
+                      MPI_STATUSES_IGNORE))
+        throw std::runtime_error("Domi::ReductionBatch: Error in "
+                                 "MPI_Waitall");
+    _requests.clear();
+    _started  = false;
+    _complete = true;
+  }
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Scalar
+ReductionBatch< Scalar >::
+getScalar(int handle)
+{
+  assertHandle(handle);
+  const Entry & entry = _entries[handle];
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (entry.kind != DOT && entry.kind != MEANVALUE),
+    InvalidArgument,
+    "Reduction handle " << handle << " does not refer to a dot product or "
+    "mean value");
+  endReduce();
+  Scalar result = _globalSums[entry.index];
+  if (entry.kind == MEANVALUE)
+  {
+    if (entry.globalSize == 0) return 0;
+    result /= entry.globalSize;
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+typename ReductionBatch< Scalar >::magnitudeType
+ReductionBatch< Scalar >::
+getNorm(int handle)
+{
+  typedef Teuchos::ScalarTraits< Scalar > st;
+  typedef Teuchos::ScalarTraits< magnitudeType > mt;
+
+  assertHandle(handle);
+  const Entry & entry = _entries[handle];
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (entry.kind == DOT || entry.kind == MEANVALUE),
+    InvalidArgument,
+    "Reduction handle " << handle << " does not refer to a norm");
+  endReduce();
+  if (entry.kind == NORMINF) return _globalMaxima[entry.index];
+  magnitudeType result = st::real(_globalSums[entry.index]);
+  if (entry.kind == NORM2) return mt::squareroot(result);
+  if (entry.kind == NORMWEIGHTED)
+  {
+    if (entry.globalSize == 0) return 0;
+    return mt::squareroot(result / entry.globalSize);
+  }
+  return result;
+}
+
+/////////////////////////////
+// Private implementations //
+/////////////////////////////
+
+template< class Scalar >
+int
+ReductionBatch< Scalar >::
+addEntry(Kind kind,
+         Scalar sum,
+         size_type globalSize)
+{
+  Entry entry;
+  entry.kind       = kind;
+  entry.index      = _localSums.size();
+  entry.globalSize = globalSize;
+  _localSums.push_back(sum);
+  _entries.push_back(entry);
+  _complete = false;
+  return _entries.size() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+ReductionBatch< Scalar >::
+addMaxEntry(Kind kind,
+            magnitudeType maximum)
+{
+  Entry entry;
+  entry.kind       = kind;
+  entry.index      = _localMaxima.size();
+  entry.globalSize = 1;
+  _localMaxima.push_back(maximum);
+  _entries.push_back(entry);
+  _complete = false;
+  return _entries.size() - 1;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+size_type
+ReductionBatch< Scalar >::
+globalSize(const MDVector< Scalar > & a)
+{
+  Teuchos::Array< dim_type > dimensions(a.numDims());
+  for (int i = 0; i < a.numDims(); ++i)
+    dimensions[i] = a.getGlobalDim(i);
+  return computeSize(dimensions);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+ReductionBatch< Scalar >::
+assertNotStarted() const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    _started && ! _complete,
+    InvalidArgument,
+    "ReductionBatch: a non-blocking reduction is in progress");
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+ReductionBatch< Scalar >::
+assertComm(const MDVector< Scalar > & a,
+           const std::string & name) const
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm = a.getTeuchosComm();
+  bool congruent = ! comm.is_null();
+#ifdef HAVE_MPI
+  if (congruent)
+  {
+    // Since HAVE_MPI is defined, both communicators are
+    // Teuchos::MpiComm< int > objects, and we compare the underlying
+    // MPI_Comms
+    Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+      Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(comm);
+    Teuchos::RCP< const Teuchos::MpiComm< int > > batchComm =
+      Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+    int result = MPI_UNEQUAL;
+    if (MPI_Comm_compare((*(mpiComm->getRawMpiComm()))(),
+                         (*(batchComm->getRawMpiComm()))(),
+                         &result))
+      throw std::runtime_error("Domi::ReductionBatch: Error in "
+                               "MPI_Comm_compare");
+    congruent = (result == MPI_IDENT || result == MPI_CONGRUENT);
+  }
+#else
+  if (congruent)
+    congruent = (comm->getSize() == _teuchosComm->getSize());
+#endif
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! congruent,
+    MDMapError,
+    "Communicator of MDVector '" << name << "' is not congruent with the "
+    "ReductionBatch communicator");
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+ReductionBatch< Scalar >::
+assertHandle(int handle) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    !(0 <= handle && handle < _entries.size()),
+    RangeError,
+    "Reduction handle " << handle << " is out of range [0, "
+    << _entries.size() << ")");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! (_started || _complete),
+    InvalidArgument,
+    "ReductionBatch: results requested before reduce() or startReduce() "
+    "was called");
+}
+
+}  // namespace Domi
+
+#endif
@@ -139,4 +139,39 @@ ConcreteSlice::ConcreteSlice(Ordinal startVal,
     );
 }
 
+////////////////////////////////////////////////////////////////////////
+
+Teuchos::Array< Teuchos::Array< Slice > >
+computeShellBounds(const Teuchos::ArrayView< const Slice > & outer,
+                   const Teuchos::ArrayView< const Slice > & inner)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (outer.size() != inner.size()), InvalidArgument,
+    "Outer and inner bounds have different numbers of dimensions"
+    );
+  Teuchos::Array< Teuchos::Array< Slice > > result;
+  for (int axis = 0; axis < outer.size(); ++axis)
+  {
+    Teuchos::Array< Slice > lower(outer.begin(), outer.end());
+    Teuchos::Array< Slice > upper(outer.begin(), outer.end());
+    for (int prev = 0; prev < axis; ++prev)
+    {
+      lower[prev] = inner[prev];
+      upper[prev] = inner[prev];
+    }
+    lower[axis] = ConcreteSlice(outer[axis].start(), inner[axis].start());
+    upper[axis] = ConcreteSlice(inner[axis].stop() , outer[axis].stop() );
+    bool lowerEmpty = false;
+    bool upperEmpty = false;
+    for (int other = 0; other < outer.size(); ++other)
+    {
+      if (lower[other].stop() <= lower[other].start()) lowerEmpty = true;
+      if (upper[other].stop() <= upper[other].start()) upperEmpty = true;
+    }
+    if (! lowerEmpty) result.push_back(lower);
+    if (! upperEmpty) result.push_back(upper);
+  }
+  return result;
+}
+
 }  // namespace Domi
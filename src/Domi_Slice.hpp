@@ -50,6 +50,8 @@
 
 // Teuchos includes
 #include "Teuchos_Assert.hpp"
+#include "Teuchos_Array.hpp"
+#include "Teuchos_ArrayView.hpp"
 
 // Domi includes
 #include "Domi_ConfigDefs.hpp"
@@ -376,6 +378,27 @@ private:
   ConcreteSlice();
 };
 
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Decompose the shell between an outer and an inner box into
+ *         disjoint boxes
+ *
+ * \param outer [in] the bounds of the outer box, one
+ *        <tt>ConcreteSlice</tt> per axis
+ *
+ * \param inner [in] the bounds of the inner box, which must be
+ *        contained within the outer box
+ *
+ * The shell is returned as an array of boxes, each of which is an
+ * array of <tt>Slice</tt>s, one per axis.  For each axis, there is a
+ * lower and an upper slab, which span the inner bounds along the
+ * preceding axes and the outer bounds along the following axes, so
+ * that the boxes do not overlap.  Empty boxes are omitted.
+ */
+Teuchos::Array< Teuchos::Array< Slice > >
+computeShellBounds(const Teuchos::ArrayView< const Slice > & outer,
+                   const Teuchos::ArrayView< const Slice > & inner);
+
 /////////////////////////
 // Inline implementations
 /////////////////////////
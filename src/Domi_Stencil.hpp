@@ -0,0 +1,983 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_STENCIL_HPP
+#define DOMI_STENCIL_HPP
+
+// Standard includes
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+// Teuchos includes
+#include "Teuchos_Array.hpp"
+#include "Teuchos_ArrayView.hpp"
+#include "Teuchos_ScalarTraits.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Exceptions.hpp"
+#include "Domi_Utils.hpp"
+#include "Domi_Slice.hpp"
+#include "Domi_Threads.hpp"
+#include "Domi_MDVector.hpp"
+
+namespace Domi
+{
+
+/** \brief Regions of the local interior of an <tt>MDVector</tt> over
+ *         which a <tt>Stencil</tt> can be applied
+ */
+enum StencilRegion
+{
+  /** \brief The entire local interior, as given by
+   *         <tt>getLocalInteriorBounds()</tt>
+   */
+  STENCIL_INTERIOR = 0,
+  /** \brief The part of the local interior whose stencil points do not
+   *         reach into the communication padding, which can be
+   *         computed before the communication padding is updated
+   */
+  STENCIL_INNER    = 1,
+  /** \brief The part of the local interior whose stencil points reach
+   *         into the communication padding, which is the local
+   *         interior minus the inner region
+   */
+  STENCIL_BOUNDARY = 2
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Accessor to the neighborhood of a single point of an
+ *         <tt>MDVector</tt>, passed to user stencil functors
+ *
+ * A <tt>StencilNeighborhood</tt> is constructed by
+ * <tt>Stencil::apply()</tt> for each point to which a stencil functor
+ * is applied.  Its <tt>operator()</tt> methods take offsets relative
+ * to the current point, and its <tt>index()</tt> method returns the
+ * local index of the current point, for accessing other arrays with
+ * the same layout.
+ */
+template< class Scalar >
+class StencilNeighborhood
+{
+public:
+
+  /** \brief Constructor
+   *
+   * \param center [in] pointer to the current point
+   *
+   * \param strides [in] pointer to the strides of the data
+   *
+   * \param index [in] pointer to the local index of the first point
+   *        of the current line
+   *
+   * \param fastest [in] the fastest axis, along which lines run
+   *
+   * \param lineIndex [in] the index of the current point along the
+   *        fastest axis
+   */
+  StencilNeighborhood(const Scalar * center,
+                      const size_type * strides,
+                      const dim_type * index,
+                      int fastest,
+                      dim_type lineIndex) :
+    _center(center),
+    _strides(strides),
+    _index(index),
+    _fastest(fastest),
+    _lineIndex(lineIndex)
+  {
+  }
+
+  /** \brief Return the value at the given offset of a 1D neighborhood
+   */
+  inline const Scalar & operator()(int d0) const
+  {
+    return _center[d0 * _strides[0]];
+  }
+
+  /** \brief Return the value at the given offset of a 2D neighborhood
+   */
+  inline const Scalar & operator()(int d0,
+                                   int d1) const
+  {
+    return _center[d0 * _strides[0] + d1 * _strides[1]];
+  }
+
+  /** \brief Return the value at the given offset of a 3D neighborhood
+   */
+  inline const Scalar & operator()(int d0,
+                                   int d1,
+                                   int d2) const
+  {
+    return _center[d0 * _strides[0] + d1 * _strides[1] + d2 * _strides[2]];
+  }
+
+  /** \brief Return the value at the given offset of a neighborhood of
+   *         any dimension
+   */
+  inline const Scalar &
+  operator()(const Teuchos::ArrayView< const int > & offset) const
+  {
+    size_type shift = 0;
+    for (int axis = 0; axis < offset.size(); ++axis)
+      shift += offset[axis] * _strides[axis];
+    return _center[shift];
+  }
+
+  /** \brief Return the local index of the current point along the
+   *         given axis
+   */
+  inline dim_type index(int axis) const
+  {
+    return (axis == _fastest) ? _lineIndex : _index[axis];
+  }
+
+private:
+
+  // Pointer to the current point
+  const Scalar * _center;
+
+  // Pointer to the strides of the data
+  const size_type * _strides;
+
+  // Pointer to the index of the first point of the current line
+  const dim_type * _index;
+
+  // The fastest axis
+  int _fastest;
+
+  // The index of the current point along the fastest axis
+  dim_type _lineIndex;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Stencil operator over the local interior of an
+ *         <tt>MDVector</tt>
+ *
+ * A <tt>Stencil</tt> is described by a set of points, each given by
+ * an integer offset along every axis and a coefficient.  The
+ * <tt>apply()</tt> method computes, for every point of the local
+ * interior of an input <tt>MDVector</tt>, the sum of the coefficients
+ * times the input values at the offset points, and stores the result
+ * in an output <tt>MDVector</tt> with the same local dimensions and
+ * layout.  Alternatively, <tt>apply()</tt> can be given a user
+ * functor, which is called with a <tt>StencilNeighborhood</tt> for
+ * every point, and whose return value is stored in the output
+ * <tt>MDVector</tt>.  In that case, the stencil points describe only
+ * the footprint of the functor, which can also be set with
+ * <tt>setRadius()</tt>.
+ *
+ * The stencil is applied one line at a time along the fastest axis,
+ * as determined by the <tt>Layout</tt>, so that the inner loops have
+ * unit stride and can be vectorized.  The lines are visited in blocks
+ * along the second fastest axis, so that the input lines reused by
+ * neighboring output lines stay in cache, and the blocks are
+ * distributed among threads when Domi is built with OpenMP.  A user
+ * functor must therefore be safe to call concurrently.  Because the
+ * output is written while the input is still being read, the input
+ * and output <tt>MDVector</tt>s may not share data.
+ *
+ * The local interior can be split into an inner region, whose stencil
+ * points do not reach into the communication padding, and a boundary
+ * region.  The inner region can be computed between
+ * <tt>startUpdateCommPad()</tt> and <tt>endUpdateCommPad()</tt>, and
+ * the boundary region after:
+ *
+ * \code
+ * u.startUpdateCommPad();
+ * stencil.apply(u, u_new, STENCIL_INNER);
+ * u.endUpdateCommPad();
+ * stencil.apply(u, u_new, STENCIL_BOUNDARY);
+ * \endcode
+ */
+template< class Scalar >
+class Stencil
+{
+public:
+
+  /** \name Constructors and destructor */
+  //@{
+
+  /** \brief Constructor
+   *
+   * \param numDims [in] the number of dimensions of the stencil
+   */
+  Stencil(int numDims);
+
+  /** \brief Destructor
+   */
+  ~Stencil();
+
+  //@}
+
+  /** \name Stencil description */
+  //@{
+
+  /** \brief Return the number of dimensions
+   */
+  inline int numDims() const;
+
+  /** \brief Add a point to the stencil
+   *
+   * \param offset [in] the offset of the point along each axis
+   *
+   * \param coefficient [in] the coefficient of the point
+   */
+  void addPoint(const Teuchos::ArrayView< const int > & offset,
+                const Scalar & coefficient = Teuchos::ScalarTraits< Scalar >::one());
+
+  /** \brief Return the number of points in the stencil
+   */
+  inline int numPoints() const;
+
+  /** \brief Return the offset of the given stencil point
+   *
+   * \param point [in] the index of the stencil point
+   */
+  inline Teuchos::ArrayView< const int > getOffset(int point) const;
+
+  /** \brief Return the coefficient of the given stencil point
+   *
+   * \param point [in] the index of the stencil point
+   */
+  inline Scalar getCoefficient(int point) const;
+
+  /** \brief Expand the footprint of the stencil along the given axis
+   *
+   * \param axis [in] the axis
+   *
+   * \param lower [in] the number of points below the current point
+   *        accessed by the stencil
+   *
+   * \param upper [in] the number of points above the current point
+   *        accessed by the stencil
+   *
+   * The footprint is expanded automatically by <tt>addPoint()</tt>,
+   * so this method is only needed for stencils applied with user
+   * functors.
+   */
+  void setRadius(int axis,
+                 int lower,
+                 int upper);
+
+  /** \brief Return the number of points below the current point
+   *         accessed by the stencil along the given axis
+   */
+  inline int getLowerRadius(int axis) const;
+
+  /** \brief Return the number of points above the current point
+   *         accessed by the stencil along the given axis
+   */
+  inline int getUpperRadius(int axis) const;
+
+  /** \brief Set the number of lines along the second fastest axis in
+   *         each cache block
+   */
+  void setBlockSize(int blockSize);
+
+  /** \brief Return the number of lines along the second fastest axis
+   *         in each cache block
+   */
+  inline int getBlockSize() const;
+
+  //@}
+
+  /** \name Regions */
+  //@{
+
+  /** \brief Return the local loop bounds of the given region of the
+   *         local interior of an MDVector
+   *
+   * \param mdVector [in] the MDVector to which the stencil will be
+   *        applied
+   *
+   * \param region [in] <tt>STENCIL_INTERIOR</tt> or
+   *        <tt>STENCIL_INNER</tt>
+   *
+   * The interior is clipped so that no stencil point falls outside of
+   * the local data, including padding.
+   */
+  Teuchos::Array< Slice > getBounds(const MDVector< Scalar > & mdVector,
+                                    StencilRegion region) const;
+
+  /** \brief Return the local loop bounds of the disjoint boxes that
+   *         make up the boundary region of the local interior of an
+   *         MDVector
+   *
+   * \param mdVector [in] the MDVector to which the stencil will be
+   *        applied
+   *
+   * Together with the inner region, these boxes exactly cover the
+   * local interior.
+   */
+  Teuchos::Array< Teuchos::Array< Slice > >
+  getBoundaryBounds(const MDVector< Scalar > & mdVector) const;
+
+  //@}
+
+  /** \name Application */
+  //@{
+
+  /** \brief Apply the stencil coefficients to an input MDVector
+   *
+   * \param input [in] the input MDVector.  Its communication padding
+   *        should be up to date for the <tt>STENCIL_INTERIOR</tt> and
+   *        <tt>STENCIL_BOUNDARY</tt> regions.
+   *
+   * \param output [out] the output MDVector, which must have the same
+   *        local dimensions and layout as the input MDVector, and may
+   *        not share data with it.  Only the points in the given
+   *        region are set.
+   *
+   * \param region [in] the region of the local interior to compute
+   */
+  void apply(const MDVector< Scalar > & input,
+             MDVector< Scalar > & output,
+             StencilRegion region = STENCIL_INTERIOR) const;
+
+  /** \brief Apply a user functor to an input MDVector
+   *
+   * \param input [in] the input MDVector
+   *
+   * \param output [out] the output MDVector, which must have the same
+   *        local dimensions and layout as the input MDVector, and may
+   *        not share data with it
+   *
+   * \param functor [in] a functor providing <tt>Scalar
+   *        operator()(const StencilNeighborhood< Scalar > &)
+   *        const</tt>, which may only access the neighborhood within
+   *        the footprint of this stencil
+   *
+   * \param region [in] the region of the local interior to compute
+   */
+  template< class FUNCTOR >
+  void apply(const MDVector< Scalar > & input,
+             MDVector< Scalar > & output,
+             const FUNCTOR & functor,
+             StencilRegion region = STENCIL_INTERIOR) const;
+
+  //@}
+
+private:
+
+  // Line operation that applies the stencil coefficients
+  struct CoefficientLineOp
+  {
+    const Scalar *    input;
+    Scalar *          output;
+    const size_type * inStrides;
+    const size_type * outStrides;
+    const size_type * pointOffsets;
+    const Scalar *    coefficients;
+    int               numPoints;
+    int               numDims;
+    int               fastest;
+    dim_type          length;
+    void operator()(const dim_type * index) const;
+  };
+
+  // Line operation that applies a user functor
+  template< class FUNCTOR >
+  struct FunctorLineOp
+  {
+    const FUNCTOR *   functor;
+    const Scalar *    input;
+    Scalar *          output;
+    const size_type * inStrides;
+    const size_type * outStrides;
+    int               numDims;
+    int               fastest;
+    dim_type          length;
+    void operator()(const dim_type * index) const;
+  };
+
+  // Check that the input and output MDVectors are compatible with
+  // this stencil and with each other, and that their data, including
+  // padding, does not overlap
+  void checkVectors(const MDVector< Scalar > & input,
+                    const MDVector< Scalar > & output) const;
+
+  // Return the boxes that make up the given region
+  Teuchos::Array< Teuchos::Array< Slice > >
+  getRegionBoxes(const MDVector< Scalar > & mdVector,
+                 StencilRegion region) const;
+
+  // Call the line operation for every line of the given box, visiting
+  // the lines in cache blocks
+  template< class LINEOP >
+  void forEachLine(const Teuchos::Array< Slice > & bounds,
+                  Layout layout,
+                  const LINEOP & op) const;
+
+  // The number of dimensions
+  int _numDims;
+
+  // The stencil point offsets
+  Teuchos::Array< Teuchos::Array< int > > _offsets;
+
+  // The stencil point coefficients
+  Teuchos::Array< Scalar > _coefficients;
+
+  // The footprint of the stencil below and above the current point
+  Teuchos::Array< int > _lowerRadius;
+  Teuchos::Array< int > _upperRadius;
+
+  // The cache block size along the second fastest axis
+  int _blockSize;
+};
+
+////////////////////////////////////////////////////////////////////////
+// Implementations
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Stencil< Scalar >::
+Stencil(int numDims) :
+  _numDims(numDims),
+  _offsets(),
+  _coefficients(),
+  _lowerRadius(numDims, 0),
+  _upperRadius(numDims, 0),
+  _blockSize(16)
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Stencil< Scalar >::
+~Stencil()
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+Stencil< Scalar >::
+numDims() const
+{
+  return _numDims;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+Stencil< Scalar >::
+addPoint(const Teuchos::ArrayView< const int > & offset,
+         const Scalar & coefficient)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (offset.size() != _numDims),
+    InvalidArgument,
+    "Stencil point offset has " << offset.size() << " components, but "
+    "stencil has " << _numDims << " dimensions");
+  _offsets.push_back(Teuchos::Array< int >(offset.begin(), offset.end()));
+  _coefficients.push_back(coefficient);
+  for (int axis = 0; axis < _numDims; ++axis)
+    setRadius(axis, -offset[axis], offset[axis]);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+Stencil< Scalar >::
+numPoints() const
+{
+  return _offsets.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Teuchos::ArrayView< const int >
+Stencil< Scalar >::
+getOffset(int point) const
+{
+  return _offsets[point]();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Scalar
+Stencil< Scalar >::
+getCoefficient(int point) const
+{
+  return _coefficients[point];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+Stencil< Scalar >::
+setRadius(int axis,
+          int lower,
+          int upper)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ((axis < 0) || (axis >= _numDims)),
+    RangeError,
+    "axis = " << axis << " is invalid for stencil with " << _numDims
+    << " dimensions");
+  _lowerRadius[axis] = std::max(_lowerRadius[axis], lower);
+  _upperRadius[axis] = std::max(_upperRadius[axis], upper);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+Stencil< Scalar >::
+getLowerRadius(int axis) const
+{
+  return _lowerRadius[axis];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+Stencil< Scalar >::
+getUpperRadius(int axis) const
+{
+  return _upperRadius[axis];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+Stencil< Scalar >::
+setBlockSize(int blockSize)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (blockSize < 1),
+    InvalidArgument,
+    "Stencil block size = " << blockSize << " must be positive");
+  _blockSize = blockSize;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+Stencil< Scalar >::
+getBlockSize() const
+{
+  return _blockSize;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Teuchos::Array< Slice >
+Stencil< Scalar >::
+getBounds(const MDVector< Scalar > & mdVector,
+          StencilRegion region) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (region == STENCIL_BOUNDARY),
+    InvalidArgument,
+    "The boundary region is not a single box; use getBoundaryBounds()");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (mdVector.numDims() != _numDims),
+    InvalidArgument,
+    "MDVector has " << mdVector.numDims() << " dimensions, but stencil "
+    "has " << _numDims << " dimensions");
+  MDArrayView< const Scalar > data = mdVector.getData();
+  Teuchos::Array< Slice > bounds(_numDims);
+  for (int axis = 0; axis < _numDims; ++axis)
+  {
+    // Clip the interior so that the stencil stays within the data
+    Slice interior = mdVector.getLocalInteriorBounds(axis);
+    dim_type start = std::max(interior.start(), dim_type(_lowerRadius[axis]));
+    dim_type stop  = std::min(interior.stop(),
+                              data.dimension(axis) - _upperRadius[axis]);
+    if (stop < start) stop = start;
+    // The inner region excludes the points whose stencil reaches into
+    // communication padding received from a neighbor
+    if (region == STENCIL_INNER)
+    {
+      dim_type lowerLimit = mdVector.getLowerPadSize(axis) + _lowerRadius[axis];
+      dim_type upperLimit = data.dimension(axis) -
+                            mdVector.getUpperPadSize(axis) -
+                            _upperRadius[axis];
+      if (mdVector.getLowerNeighbor(axis) >= 0)
+        start = std::max(start, lowerLimit);
+      if (mdVector.getUpperNeighbor(axis) >= 0)
+        stop = std::min(stop, upperLimit);
+      start = std::min(start, interior.stop());
+      if (stop < start) stop = start;
+    }
+    bounds[axis] = ConcreteSlice(start, stop);
+  }
+  return bounds;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Teuchos::Array< Teuchos::Array< Slice > >
+Stencil< Scalar >::
+getBoundaryBounds(const MDVector< Scalar > & mdVector) const
+{
+  Teuchos::Array< Slice > interior = getBounds(mdVector, STENCIL_INTERIOR);
+  Teuchos::Array< Slice > inner    = getBounds(mdVector, STENCIL_INNER);
+  return computeShellBounds(interior(), inner());
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+Teuchos::Array< Teuchos::Array< Slice > >
+Stencil< Scalar >::
+getRegionBoxes(const MDVector< Scalar > & mdVector,
+               StencilRegion region) const
+{
+  if (region == STENCIL_BOUNDARY) return getBoundaryBounds(mdVector);
+  return Teuchos::Array< Teuchos::Array< Slice > >(1,
+                                                   getBounds(mdVector,
+                                                             region));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+Stencil< Scalar >::
+checkVectors(const MDVector< Scalar > & input,
+             const MDVector< Scalar > & output) const
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (input.numDims() != _numDims) || (output.numDims() != _numDims),
+    InvalidArgument,
+    "Input and output MDVectors must have " << _numDims << " dimensions");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    (input.getData().dimensions() != output.getData().dimensions()) ||
+    (input.getLayout() != output.getLayout()),
+    InvalidArgument,
+    "Input and output MDVectors have different local dimensions or "
+    "layouts");
+
+  // Compute the range of addresses spanned by the input and output
+  // data, including padding, and check that they are disjoint
+  MDArrayView< const Scalar > inData  = input.getData(true);
+  MDArrayView< const Scalar > outData = output.getData(true);
+  const Scalar * inFirst  = inData.getRawPtr();
+  const Scalar * outFirst = outData.getRawPtr();
+  const Scalar * inLast   = inFirst;
+  const Scalar * outLast  = outFirst;
+  for (int axis = 0; axis < _numDims; ++axis)
+  {
+    inLast  += (inData.dimension(axis)  - 1) * inData.strides()[axis];
+    outLast += (outData.dimension(axis) - 1) * outData.strides()[axis];
+  }
+  std::less< const Scalar * > before;
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! (before(inLast, outFirst) || before(outLast, inFirst)),
+    InvalidArgument,
+    "Input and output MDVectors share data, which is not supported by "
+    "Stencil::apply()");
+  for (int axis = 0; axis < _numDims; ++axis)
+  {
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      ((input.getLowerNeighbor(axis) >= 0) &&
+       (input.getLowerPadSize(axis) < _lowerRadius[axis])) ||
+      ((input.getUpperNeighbor(axis) >= 0) &&
+       (input.getUpperPadSize(axis) < _upperRadius[axis])),
+      InvalidArgument,
+      "Communication pad of input MDVector along axis " << axis
+      << " is narrower than the stencil");
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+Stencil< Scalar >::
+apply(const MDVector< Scalar > & input,
+      MDVector< Scalar > & output,
+      StencilRegion region) const
+{
+  checkVectors(input, output);
+  MDArrayView< const Scalar > inData  = input.getData();
+  MDArrayView< Scalar >       outData = output.getDataNonConst();
+
+  // Convert the stencil point offsets to memory offsets
+  Teuchos::Array< size_type > pointOffsets(numPoints(), 0);
+  for (int point = 0; point < numPoints(); ++point)
+    for (int axis = 0; axis < _numDims; ++axis)
+      pointOffsets[point] += _offsets[point][axis] * inData.strides()[axis];
+
+  CoefficientLineOp op;
+  op.input        = inData.getRawPtr();
+  op.output       = outData.getRawPtr();
+  op.inStrides    = inData.strides().getRawPtr();
+  op.outStrides   = outData.strides().getRawPtr();
+  op.pointOffsets = pointOffsets.getRawPtr();
+  op.coefficients = _coefficients.getRawPtr();
+  op.numPoints    = numPoints();
+  op.numDims      = _numDims;
+  op.fastest      = (input.getLayout() == LAST_INDEX_FASTEST) ?
+                    _numDims - 1 : 0;
+
+  Teuchos::Array< Teuchos::Array< Slice > > boxes =
+    getRegionBoxes(input, region);
+  for (int box = 0; box < boxes.size(); ++box)
+  {
+    op.length = boxes[box][op.fastest].stop() - boxes[box][op.fastest].start();
+    forEachLine(boxes[box], input.getLayout(), op);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+template< class FUNCTOR >
+void
+Stencil< Scalar >::
+apply(const MDVector< Scalar > & input,
+      MDVector< Scalar > & output,
+      const FUNCTOR & functor,
+      StencilRegion region) const
+{
+  checkVectors(input, output);
+  MDArrayView< const Scalar > inData  = input.getData();
+  MDArrayView< Scalar >       outData = output.getDataNonConst();
+
+  FunctorLineOp< FUNCTOR > op;
+  op.functor    = &functor;
+  op.input      = inData.getRawPtr();
+  op.output     = outData.getRawPtr();
+  op.inStrides  = inData.strides().getRawPtr();
+  op.outStrides = outData.strides().getRawPtr();
+  op.numDims    = _numDims;
+  op.fastest    = (input.getLayout() == LAST_INDEX_FASTEST) ?
+                  _numDims - 1 : 0;
+
+  Teuchos::Array< Teuchos::Array< Slice > > boxes =
+    getRegionBoxes(input, region);
+  for (int box = 0; box < boxes.size(); ++box)
+  {
+    op.length = boxes[box][op.fastest].stop() - boxes[box][op.fastest].start();
+    forEachLine(boxes[box], input.getLayout(), op);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+Stencil< Scalar >::CoefficientLineOp::
+operator()(const dim_type * index) const
+{
+  size_type inBase  = 0;
+  size_type outBase = 0;
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    inBase  += index[axis] * inStrides[axis];
+    outBase += index[axis] * outStrides[axis];
+  }
+  const Scalar * src = input + inBase;
+  Scalar * dst = output + outBase;
+  size_type si = inStrides[fastest];
+  size_type so = outStrides[fastest];
+
+  if (numPoints == 0)
+  {
+    for (dim_type i = 0; i < length; ++i)
+      dst[i*so] = Teuchos::ScalarTraits< Scalar >::zero();
+    return;
+  }
+
+  // Apply one stencil point at a time to the whole line, so that the
+  // inner loops are simple, unit stride when possible, and free of
+  // loop-carried dependencies
+  if (si == 1 && so == 1)
+  {
+    const Scalar * p = src + pointOffsets[0];
+    Scalar c = coefficients[0];
+    for (dim_type i = 0; i < length; ++i)
+      dst[i] = c * p[i];
+    for (int point = 1; point < numPoints; ++point)
+    {
+      p = src + pointOffsets[point];
+      c = coefficients[point];
+      for (dim_type i = 0; i < length; ++i)
+        dst[i] += c * p[i];
+    }
+  }
+  else
+  {
+    const Scalar * p = src + pointOffsets[0];
+    Scalar c = coefficients[0];
+    for (dim_type i = 0; i < length; ++i)
+      dst[i*so] = c * p[i*si];
+    for (int point = 1; point < numPoints; ++point)
+    {
+      p = src + pointOffsets[point];
+      c = coefficients[point];
+      for (dim_type i = 0; i < length; ++i)
+        dst[i*so] += c * p[i*si];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+template< class FUNCTOR >
+void
+Stencil< Scalar >::FunctorLineOp< FUNCTOR >::
+operator()(const dim_type * index) const
+{
+  size_type inBase  = 0;
+  size_type outBase = 0;
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    inBase  += index[axis] * inStrides[axis];
+    outBase += index[axis] * outStrides[axis];
+  }
+  const Scalar * src = input + inBase;
+  Scalar * dst = output + outBase;
+  size_type si = inStrides[fastest];
+  size_type so = outStrides[fastest];
+  dim_type start = index[fastest];
+  for (dim_type i = 0; i < length; ++i)
+  {
+    StencilNeighborhood< Scalar > neighborhood(src + i*si, inStrides, index,
+                                               fastest, start + i);
+    dst[i*so] = (*functor)(neighborhood);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+template< class LINEOP >
+void
+Stencil< Scalar >::
+forEachLine(const Teuchos::Array< Slice > & bounds,
+            Layout layout,
+            const LINEOP & op) const
+{
+  // Return if the box is empty
+  for (int axis = 0; axis < _numDims; ++axis)
+    if (bounds[axis].stop() <= bounds[axis].start()) return;
+
+  // A single line
+  if (_numDims == 1)
+  {
+    dim_type index = bounds[0].start();
+    op(&index);
+    return;
+  }
+
+  // Determine the axes, from fastest to slowest
+  int step    = (layout == LAST_INDEX_FASTEST) ? -1 : 1;
+  int fastest = (layout == LAST_INDEX_FASTEST) ? _numDims - 1 : 0;
+  int second  = fastest + step;
+  int slowest = (layout == LAST_INDEX_FASTEST) ? 0 : _numDims - 1;
+
+  // The lines are visited in blocks along the second fastest axis,
+  // and within each block, the remaining axes are walked from the
+  // fastest to the slowest, so that neighboring lines of a block are
+  // visited together
+  dim_type secondStart = bounds[second].start();
+  dim_type secondStop  = bounds[second].stop();
+  int numBlocks = (secondStop - secondStart + _blockSize - 1) / _blockSize;
+
+  // Copy the box bounds into a plain array before entering the
+  // parallel region, so that the threads use no Teuchos objects
+  std::vector< dim_type > starts(_numDims);
+  std::vector< dim_type > stops(_numDims);
+  for (int axis = 0; axis < _numDims; ++axis)
+  {
+    starts[axis] = bounds[axis].start();
+    stops[axis]  = bounds[axis].stop();
+  }
+
+#ifdef HAVE_DOMI_OPENMP
+  size_type size = 1;
+  for (int axis = 0; axis < _numDims; ++axis)
+    size *= stops[axis] - starts[axis];
+  int numThreads = (size < threadMinSize) ? 1 :
+                   std::min(getNumThreads(), numBlocks);
+#pragma omp parallel for schedule(static) num_threads(numThreads)
+#endif
+  for (int block = 0; block < numBlocks; ++block)
+  {
+    std::vector< dim_type > index(starts);
+    dim_type blockStart = secondStart + block * _blockSize;
+    dim_type blockStop  = std::min(blockStart + _blockSize, secondStop);
+    bool done = false;
+    while (! done)
+    {
+      for (index[second] = blockStart; index[second] < blockStop;
+           ++index[second])
+        op(&index[0]);
+      // Advance the remaining axes
+      done = true;
+      for (int axis = second + step; axis != slowest + step; axis += step)
+      {
+        if (++index[axis] < stops[axis])
+        {
+          done = false;
+          break;
+        }
+        index[axis] = starts[axis];
+      }
+    }
+  }
+}
+
+}  // namespace Domi
+
+#endif
@@ -0,0 +1,375 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+// System includes
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+// Teuchos includes
+#include "Teuchos_CommHelpers.hpp"
+
+// Domi includes
+#include "Domi_Subfiling.hpp"
+#include "Domi_ChunkedFile.hpp"
+#include "Domi_Exceptions.hpp"
+
+namespace Domi
+{
+
+// The subfile manifest format identifier and version
+static const char subfileMagic[8]  = { 'D','O','M','I','S','U','B','F' };
+static const int  subfileVersion   = 1;
+static const int  subfileByteOrder = 0x01020304;
+
+////////////////////////////////////////////////////////////////////////
+
+SubfileManifest::
+SubfileManifest(int typeCode,
+                int scalarSize,
+                Layout layout,
+                bool includesBndryPad,
+                const Teuchos::ArrayView< const dim_type > & fileDims,
+                int numSubfiles) :
+  _typeCode(typeCode),
+  _scalarSize(scalarSize),
+  _swapBytes(false),
+  _layout(layout),
+  _includesBndryPad(includesBndryPad),
+  _fileDims(fileDims.begin(), fileDims.end()),
+  _numSubfiles(numSubfiles),
+  _blocks()
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+SubfileManifest
+SubfileManifest::
+read(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+     const std::string & filename)
+{
+  // The first processor reads the whole manifest
+  Teuchos::Array< char > buffer;
+  int size = 0;
+  if (teuchosComm->getRank() == 0)
+  {
+    FILE * datafile = fopen(filename.c_str(), "r");
+    if (datafile)
+    {
+      fseek(datafile, 0, SEEK_END);
+      size_type fileSize = ftell(datafile);
+      fseek(datafile, 0, SEEK_SET);
+      if (fileSize > 8)
+      {
+        buffer.resize(fileSize);
+        if (fread(buffer.getRawPtr(), 1, fileSize, datafile) ==
+            (std::size_t) fileSize &&
+            std::memcmp(buffer.getRawPtr(), subfileMagic, 8) == 0)
+          size = fileSize;
+      }
+      fclose(datafile);
+    }
+  }
+
+  // Broadcast the manifest to the other processors
+  Teuchos::broadcast(*teuchosComm, 0, 1, &size);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    size == 0,
+    FileError,
+    "File '" << filename << "' cannot be read or is not a Domi subfile "
+    "manifest");
+  buffer.resize(size);
+  Teuchos::broadcast(*teuchosComm, 0, size, buffer.getRawPtr());
+
+  SubfileManifest result;
+  result.unpack(buffer(), filename);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+SubfileManifest::write(const std::string & filename) const
+{
+  Teuchos::Array< char > buffer = pack();
+  FILE * datafile = fopen(filename.c_str(), "w");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    datafile == 0,
+    FileError,
+    "Cannot open file '" << filename << "' for writing");
+  fwrite(buffer.getRawPtr(), 1, buffer.size(), datafile);
+  fclose(datafile);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+std::string
+SubfileManifest::subfileName(const std::string & filename,
+                             int subfile)
+{
+  std::ostringstream os;
+  os << filename << "." << subfile;
+  return os.str();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+SubfileManifest::
+addBlock(int subfile,
+         size_type offset,
+         const Teuchos::ArrayView< const dim_type > & start,
+         const Teuchos::ArrayView< const dim_type > & shape)
+{
+  Block block;
+  block.subfile = subfile;
+  block.offset  = offset;
+  block.start.assign(start.begin(), start.end());
+  block.shape.assign(shape.begin(), shape.end());
+  _blocks.push_back(block);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+SubfileManifest::typeCode() const
+{
+  return _typeCode;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+SubfileManifest::scalarSize() const
+{
+  return _scalarSize;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+bool
+SubfileManifest::swapBytes() const
+{
+  return _swapBytes;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Layout
+SubfileManifest::layout() const
+{
+  return _layout;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+bool
+SubfileManifest::includesBndryPad() const
+{
+  return _includesBndryPad;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const Teuchos::Array< dim_type > &
+SubfileManifest::fileDims() const
+{
+  return _fileDims;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+SubfileManifest::numSubfiles() const
+{
+  return _numSubfiles;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_type
+SubfileManifest::numBlocks() const
+{
+  return _blocks.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const SubfileManifest::Block &
+SubfileManifest::getBlock(size_type block) const
+{
+  return _blocks[block];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Teuchos::Array< char >
+SubfileManifest::pack() const
+{
+  int numDims = _fileDims.size();
+  Teuchos::Array< char > buffer(subfileMagic, subfileMagic + 8);
+  appendBytes< int >(buffer, subfileVersion);
+  appendBytes< int >(buffer, subfileByteOrder);
+  appendBytes< int >(buffer, _typeCode);
+  appendBytes< int >(buffer, _scalarSize);
+  appendBytes< int >(buffer, numDims);
+  appendBytes< int >(buffer, _layout);
+  appendBytes< int >(buffer, _includesBndryPad);
+  appendBytes< int >(buffer, _numSubfiles);
+  appendBytes< long long >(buffer, _blocks.size());
+  for (int axis = 0; axis < numDims; ++axis)
+    appendBytes< long long >(buffer, _fileDims[axis]);
+  for (size_type block = 0; block < _blocks.size(); ++block)
+  {
+    const Block & b = _blocks[block];
+    appendBytes< int >(buffer, b.subfile);
+    appendBytes< long long >(buffer, b.offset);
+    for (int axis = 0; axis < numDims; ++axis)
+      appendBytes< long long >(buffer, b.start[axis]);
+    for (int axis = 0; axis < numDims; ++axis)
+      appendBytes< long long >(buffer, b.shape[axis]);
+  }
+  return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+SubfileManifest::unpack(const Teuchos::ArrayView< const char > & buffer,
+                        const std::string & filename)
+{
+  // The fixed part of the manifest: the identifier, eight ints and
+  // the number of blocks
+  size_type fixedSize = 8 + 8 * sizeof(int) + sizeof(long long);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    buffer.size() < fixedSize,
+    FileError,
+    "Subfile manifest '" << filename << "' is truncated");
+  size_type position = 8;
+  int version = extractBytes< int >(buffer, position, false);
+  int byteOrder = extractBytes< int >(buffer, position, false);
+  _swapBytes = (byteOrder != subfileByteOrder);
+  if (_swapBytes) Domi::swapBytes(&version, 1, sizeof(int));
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    version > subfileVersion,
+    FileError,
+    "Subfile manifest '" << filename << "' has format version " << version
+    << ", but only versions up to " << subfileVersion << " are supported");
+
+  _typeCode         = extractBytes< int >(buffer, position, _swapBytes);
+  _scalarSize       = extractBytes< int >(buffer, position, _swapBytes);
+  int numDims       = extractBytes< int >(buffer, position, _swapBytes);
+  _layout           = (Layout) extractBytes< int >(buffer, position,
+                                                   _swapBytes);
+  _includesBndryPad = extractBytes< int >(buffer, position, _swapBytes);
+  _numSubfiles      = extractBytes< int >(buffer, position, _swapBytes);
+  size_type numBlocks = extractBytes< long long >(buffer, position,
+                                                  _swapBytes);
+
+  // Check that the manifest holds all of the blocks it claims
+  size_type blockSize = sizeof(int) + (1 + 2*numDims) * sizeof(long long);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    numDims < 0 || numBlocks < 0 ||
+    buffer.size() < position + numDims * (size_type) sizeof(long long) +
+                    numBlocks * blockSize,
+    FileError,
+    "Subfile manifest '" << filename << "' is truncated or corrupt");
+
+  _fileDims.resize(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    _fileDims[axis] = extractBytes< long long >(buffer, position, _swapBytes);
+  _blocks.resize(numBlocks);
+  for (size_type block = 0; block < numBlocks; ++block)
+  {
+    Block & b = _blocks[block];
+    b.subfile = extractBytes< int >(buffer, position, _swapBytes);
+    b.offset  = extractBytes< long long >(buffer, position, _swapBytes);
+    b.start.resize(numDims);
+    b.shape.resize(numDims);
+    for (int axis = 0; axis < numDims; ++axis)
+      b.start[axis] = extractBytes< long long >(buffer, position, _swapBytes);
+    for (int axis = 0; axis < numDims; ++axis)
+      b.shape[axis] = extractBytes< long long >(buffer, position, _swapBytes);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_MPI
+
+void splitByNode(MPI_Comm comm,
+                 MPI_Comm & nodeComm,
+                 int & subfile,
+                 int & numSubfiles)
+{
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+#if MPI_VERSION >= 3
+  MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL,
+                      &nodeComm);
+#else
+  MPI_Comm_split(comm, rank, 0, &nodeComm);
+#endif
+
+  // The aggregators, which are the first processors of each node,
+  // number the subfiles in the order of their ranks
+  int nodeRank;
+  MPI_Comm_rank(nodeComm, &nodeRank);
+  MPI_Comm aggregatorComm;
+  MPI_Comm_split(comm, nodeRank == 0 ? 0 : MPI_UNDEFINED, rank,
+                 &aggregatorComm);
+  int counts[2] = { 0, 0 };
+  if (nodeRank == 0)
+  {
+    MPI_Comm_rank(aggregatorComm, &counts[0]);
+    MPI_Comm_size(aggregatorComm, &counts[1]);
+    MPI_Comm_free(&aggregatorComm);
+  }
+  MPI_Bcast(counts, 2, MPI_INT, 0, nodeComm);
+  subfile     = counts[0];
+  numSubfiles = counts[1];
+}
+
+#endif
+
+}  // namespace Domi
@@ -0,0 +1,259 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_SUBFILING_HPP
+#define DOMI_SUBFILING_HPP
+
+// System includes
+#include <string>
+
+// Teuchos includes
+#include "Teuchos_Array.hpp"
+#include "Teuchos_Comm.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+
+namespace Domi
+{
+
+/** \brief The manifest of a subfiled array
+ *
+ * Writing a single shared file from many thousands of processors
+ * suffers from lock contention in the parallel file system.  A
+ * subfiled array is instead written as one subfile per node, by an
+ * aggregator processor to which the other processors of the node
+ * send their blocks, and a small manifest that describes the blocks.
+ * Each block is the local data of one processor, stored contiguously
+ * in the layout of the array, and the blocks of a subfile are stored
+ * in the order of the processors of the node.  The array can then be
+ * read back with any decomposition, by reading the parts of the
+ * blocks that each processor's data intersects.
+ *
+ * The manifest is written to the given filename, and the subfiles
+ * to the names returned by <tt>subfileName()</tt>, which append a
+ * period and the subfile index.  It contains, in this order and in
+ * the byte order of the writer:
+ *
+ * - the eight characters "DOMISUBF"
+ * - eight 32-bit integers: the format version, the value 0x01020304
+ *   (from which the reader determines the byte order), the scalar
+ *   type code given by <tt>fileTypeCode()</tt>, the scalar size in
+ *   bytes, the number of dimensions, the layout, a flag indicating
+ *   whether the boundary padding is included in the array, and the
+ *   number of subfiles
+ * - a 64-bit integer: the number of blocks
+ * - a 64-bit integer array of length equal to the number of
+ *   dimensions: the dimensions of the array
+ * - for each block, a 32-bit integer, the index of its subfile, and
+ *   64-bit integers: its byte offset in the subfile, and the index of
+ *   its first element and its shape along each axis
+ */
+class SubfileManifest
+{
+public:
+
+  /** \brief A block of the array, stored contiguously in a subfile
+   */
+  struct Block
+  {
+    /** \brief The index of the subfile */
+    int                        subfile;
+    /** \brief The byte offset of the block in the subfile */
+    size_type                  offset;
+    /** \brief The index of the first element of the block */
+    Teuchos::Array< dim_type > start;
+    /** \brief The shape of the block */
+    Teuchos::Array< dim_type > shape;
+  };
+
+  /** \brief Constructor
+   *
+   * \param typeCode [in] the scalar type code
+   *
+   * \param scalarSize [in] the size of the scalar type, in bytes
+   *
+   * \param layout [in] the layout of the array and of the blocks
+   *
+   * \param includesBndryPad [in] whether the array includes the
+   *        boundary padding
+   *
+   * \param fileDims [in] the dimensions of the array
+   *
+   * \param numSubfiles [in] the number of subfiles
+   */
+  SubfileManifest(int typeCode = 0,
+                  int scalarSize = 0,
+                  Layout layout = DEFAULT_ORDER,
+                  bool includesBndryPad = false,
+                  const Teuchos::ArrayView< const dim_type > & fileDims =
+                    Teuchos::null,
+                  int numSubfiles = 0);
+
+  /** \brief Read a manifest
+   *
+   * \param teuchosComm [in] the communicator of the processors that
+   *        read the manifest.  The manifest is read by the first
+   *        processor and broadcast to the others.
+   *
+   * \param filename [in] name of the manifest
+   */
+  static SubfileManifest
+  read(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+       const std::string & filename);
+
+  /** \brief Write the manifest
+   *
+   * \param filename [in] name of the manifest
+   */
+  void write(const std::string & filename) const;
+
+  /** \brief Return the name of a subfile
+   *
+   * \param filename [in] name of the manifest
+   *
+   * \param subfile [in] the index of the subfile
+   */
+  static std::string subfileName(const std::string & filename,
+                                 int subfile);
+
+  /** \brief Add a block
+   *
+   * \param subfile [in] the index of the subfile
+   *
+   * \param offset [in] the byte offset of the block in the subfile
+   *
+   * \param start [in] the index of the first element of the block
+   *
+   * \param shape [in] the shape of the block
+   */
+  void addBlock(int subfile,
+                size_type offset,
+                const Teuchos::ArrayView< const dim_type > & start,
+                const Teuchos::ArrayView< const dim_type > & shape);
+
+  /** \brief Return the scalar type code */
+  int typeCode() const;
+
+  /** \brief Return the scalar size, in bytes */
+  int scalarSize() const;
+
+  /** \brief Return true if the manifest and subfiles were written
+   *         with the opposite byte order
+   */
+  bool swapBytes() const;
+
+  /** \brief Return the layout */
+  Layout layout() const;
+
+  /** \brief Return true if the array includes the boundary padding */
+  bool includesBndryPad() const;
+
+  /** \brief Return the dimensions of the array */
+  const Teuchos::Array< dim_type > & fileDims() const;
+
+  /** \brief Return the number of subfiles */
+  int numSubfiles() const;
+
+  /** \brief Return the number of blocks */
+  size_type numBlocks() const;
+
+  /** \brief Return a block
+   *
+   * \param block [in] the index of the block
+   */
+  const Block & getBlock(size_type block) const;
+
+private:
+
+  // Serialize the manifest
+  Teuchos::Array< char > pack() const;
+
+  // Deserialize the manifest
+  void unpack(const Teuchos::ArrayView< const char > & buffer,
+              const std::string & filename);
+
+  int                        _typeCode;
+  int                        _scalarSize;
+  bool                       _swapBytes;
+  Layout                     _layout;
+  bool                       _includesBndryPad;
+  Teuchos::Array< dim_type > _fileDims;
+  int                        _numSubfiles;
+  Teuchos::Array< Block >    _blocks;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_MPI
+
+/** \brief Group the processors of a communicator by node, for writing
+ *         subfiles
+ *
+ * \param comm [in] the communicator
+ *
+ * \param nodeComm [out] a new communicator of the processors of
+ *        <tt>comm</tt> that share this processor's node, in the
+ *        order of their ranks in <tt>comm</tt>.  Its first processor
+ *        is the aggregator of the node.  It must be freed with
+ *        <tt>MPI_Comm_free()</tt>.
+ *
+ * \param subfile [out] the index of the subfile of this processor's
+ *        node
+ *
+ * \param numSubfiles [out] the number of nodes, and so of subfiles
+ *
+ * The nodes are determined with <tt>MPI_Comm_split_type()</tt>.  With
+ * MPI implementations older than MPI-3, every processor is its own
+ * node.
+ */
+void splitByNode(MPI_Comm comm,
+                 MPI_Comm & nodeComm,
+                 int & subfile,
+                 int & numSubfiles);
+
+#endif
+
+}  // namespace Domi
+
+#endif
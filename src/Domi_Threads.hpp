@@ -0,0 +1,628 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_THREADS_HPP
+#define DOMI_THREADS_HPP
+
+// Standard includes
+#include <algorithm>
+
+// Teuchos includes
+#include "Teuchos_Array.hpp"
+#include "Teuchos_ArrayView.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+
+namespace Domi
+{
+
+/** \file Domi_Threads.hpp
+ *
+ * \brief Support for thread-parallel local kernels
+ *
+ * When Domi is configured with OpenMP (<tt>HAVE_DOMI_OPENMP</tt>),
+ * the local kernels of <tt>MDArray</tt>, <tt>MDArrayRCP</tt>,
+ * <tt>MDArrayView</tt> and <tt>MDVector</tt> that fill, copy and
+ * reduce data partition that data along its outermost (slowest
+ * varying) axis with a dimension greater than one, and process the
+ * partitions in parallel.  Arrays smaller than
+ * <tt>threadMinSize</tt> elements are processed by a single thread.
+ *
+ * The partial results of reductions are always combined in partition
+ * order.  By default, the number of partitions equals the number of
+ * threads, so reduction results can change, within round-off, with
+ * the number of threads.  If deterministic reductions are requested
+ * with <tt>setDeterministicReductions(true)</tt>, reductions instead
+ * use a fixed number of partitions, <tt>deterministicReductionParts</tt>,
+ * that depends only on the shape of the data, so that the results are
+ * bitwise reproducible regardless of the number of threads, including
+ * in builds without OpenMP.
+ *
+ * The kernels operate on raw pointers, dimensions and strides.  The
+ * dimensions of the partitions are computed before entering the
+ * parallel region, so that the threads construct, copy and share no
+ * Teuchos objects, which are tracked by a global, unsynchronized node
+ * tracer in debug builds.
+ */
+
+/** \brief The minimum number of elements for which a local kernel is
+ *         run in parallel
+ */
+const size_type threadMinSize = 16384;
+
+/** \brief The number of partitions used by deterministic reductions
+ */
+const int deterministicReductionParts = 64;
+
+/** \brief Set the number of threads used by Domi local kernels
+ *
+ * \param numThreads [in] the number of threads.  If less than one,
+ *        the OpenMP default number of threads is used.
+ *
+ * This function has no effect in builds without OpenMP.
+ */
+void setNumThreads(int numThreads);
+
+/** \brief Return the number of threads used by Domi local kernels
+ *
+ * Returns 1 in builds without OpenMP.
+ */
+int getNumThreads();
+
+/** \brief Set whether local reductions are computed in an order that
+ *         is independent of the number of threads
+ *
+ * \param deterministic [in] if true, use a fixed partitioning of the
+ *        data for reductions.  The default is false.
+ */
+void setDeterministicReductions(bool deterministic);
+
+/** \brief Return true if local reductions are computed in an order
+ *         that is independent of the number of threads
+ */
+bool getDeterministicReductions();
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Return the axis along which data is partitioned among
+ *         threads
+ *
+ * \param dims [in] the dimensions of the data
+ *
+ * \param layout [in] the memory layout of the data
+ *
+ * Returns the outermost axis with a dimension greater than one, or
+ * -1 if there is no such axis.
+ */
+inline int getPartitionAxis(const Teuchos::ArrayView< const dim_type > & dims,
+                            Layout layout)
+{
+  int numDims = dims.size();
+  if (layout == LAST_INDEX_FASTEST)
+  {
+    for (int axis = 0; axis < numDims; ++axis)
+      if (dims[axis] > 1) return axis;
+  }
+  else
+  {
+    for (int axis = numDims - 1; axis >= 0; --axis)
+      if (dims[axis] > 1) return axis;
+  }
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Return the number of partitions to use for a thread-parallel
+ *         kernel
+ *
+ * \param dims [in] the dimensions of the data
+ *
+ * \param axis [in] the partition axis, as returned by
+ *        <tt>getPartitionAxis()</tt>
+ *
+ * \param reduction [in] true if the kernel is a reduction, in which
+ *        case deterministic reductions, if requested, determine the
+ *        number of partitions
+ */
+inline int getNumPartitions(const Teuchos::ArrayView< const dim_type > & dims,
+                            int axis,
+                            bool reduction = false)
+{
+  if (axis < 0) return 1;
+  if (reduction && getDeterministicReductions())
+    return std::min(deterministicReductionParts, int(dims[axis]));
+  if (computeSize(dims) < threadMinSize) return 1;
+  return std::min(getNumThreads(), int(dims[axis]));
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Compute the bounds of one partition of an axis
+ *
+ * \param dim [in] the dimension of the partitioned axis
+ *
+ * \param numParts [in] the number of partitions
+ *
+ * \param part [in] the partition index
+ *
+ * \param start [out] the first index of the partition
+ *
+ * \param stop [out] one past the last index of the partition
+ */
+inline void getPartitionBounds(dim_type dim,
+                               int numParts,
+                               int part,
+                               dim_type & start,
+                               dim_type & stop)
+{
+  dim_type base  = dim / numParts;
+  dim_type extra = dim % numParts;
+  start = part * base + std::min(dim_type(part), extra);
+  stop  = start + base + (part < extra ? 1 : 0);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Compute the dimensions and starting indexes of all of the
+ *         partitions of strided data
+ *
+ * \param dims [in] the dimensions of the data
+ *
+ * \param axis [in] the partition axis
+ *
+ * \param numParts [in] the number of partitions
+ *
+ * \param partDims [out] the dimensions of partition p are stored in
+ *        elements <tt>p*dims.size()</tt> through
+ *        <tt>(p+1)*dims.size()-1</tt>
+ *
+ * \param partStarts [out] the starting index of each partition along
+ *        the partition axis
+ *
+ * The thread-parallel kernels call this before entering the parallel
+ * region and pass raw pointers into the results to the threads.
+ */
+inline void
+getPartitions(const Teuchos::ArrayView< const dim_type > & dims,
+              int axis,
+              int numParts,
+              Teuchos::Array< dim_type > & partDims,
+              Teuchos::Array< dim_type > & partStarts)
+{
+  int numDims = dims.size();
+  partDims.resize(numParts * numDims);
+  partStarts.resize(numParts);
+  for (int part = 0; part < numParts; ++part)
+  {
+    dim_type start, stop;
+    getPartitionBounds(dims[axis], numParts, part, start, stop);
+    for (int i = 0; i < numDims; ++i) partDims[part*numDims+i] = dims[i];
+    partDims[part*numDims+axis] = stop - start;
+    partStarts[part] = start;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line functor for <tt>walkLines()</tt> that assigns a value
+ *         to each element of a line
+ */
+template< class T >
+struct AssignLineFunctor
+{
+  AssignLineFunctor(T * ptr,
+                    size_type stride,
+                    size_type length,
+                    const T & value) :
+    _ptr(ptr), _stride(stride), _length(length), _value(value) { }
+  void operator()(const dim_type *, const size_type * offsets)
+  {
+    T * a = _ptr + offsets[0];
+    if (_stride == 1)
+      std::fill(a, a + _length, _value);
+    else
+      for (size_type i = 0; i < _length; ++i)
+        a[i*_stride] = _value;
+  }
+  T *       _ptr;
+  size_type _stride;
+  size_type _length;
+  const T & _value;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line functor for <tt>walkLines()</tt> that copies a line of
+ *         source data to a line of target data
+ */
+template< class T >
+struct CopyLineFunctor
+{
+  CopyLineFunctor(const T * source,
+                  size_type sourceStride,
+                  T * target,
+                  size_type targetStride,
+                  size_type length) :
+    _source(source), _sourceStride(sourceStride), _target(target),
+    _targetStride(targetStride), _length(length) { }
+  void operator()(const dim_type *, const size_type * offsets)
+  {
+    const T * a = _source + offsets[0];
+    T * b = _target + offsets[1];
+    if (_sourceStride == 1 && _targetStride == 1)
+      std::copy(a, a + _length, b);
+    else
+      for (size_type i = 0; i < _length; ++i)
+        b[i*_targetStride] = a[i*_sourceStride];
+  }
+  const T * _source;
+  size_type _sourceStride;
+  T *       _target;
+  size_type _targetStride;
+  size_type _length;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Line functor for <tt>walkLines()</tt> that assigns to each
+ *         element of a line the value of a functor of its index
+ *
+ * The index is written into storage owned by the caller, which is
+ * viewed by an <tt>ArrayView</tt> built before any parallel region,
+ * so that no Teuchos object is constructed or copied by a thread.
+ */
+template< class T, class FUNCTOR >
+struct InitializeLineFunctor
+{
+  InitializeLineFunctor(T * ptr,
+                        size_type stride,
+                        size_type length,
+                        int numDims,
+                        int fast,
+                        dim_type * index,
+                        const Teuchos::ArrayView< const dim_type > & indexView,
+                        const FUNCTOR & init) :
+    _ptr(ptr), _stride(stride), _length(length), _numDims(numDims),
+    _fast(fast), _index(index), _indexView(indexView), _init(init) { }
+  void operator()(const dim_type * index, const size_type * offsets)
+  {
+    T * a = _ptr + offsets[0];
+    std::copy(index, index + _numDims, _index);
+    for (size_type i = 0; i < _length; ++i)
+    {
+      _index[_fast] = index[_fast] + i;
+      a[i*_stride] = _init(_indexView);
+    }
+  }
+  T *             _ptr;
+  size_type       _stride;
+  size_type       _length;
+  int             _numDims;
+  int             _fast;
+  dim_type *      _index;
+  const Teuchos::ArrayView< const dim_type > & _indexView;
+  const FUNCTOR & _init;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Assign a value to every element of strided data
+ *
+ * \param ptr [in] pointer to the first element of the data
+ *
+ * \param numDims [in] the number of dimensions of the data
+ *
+ * \param dims [in] pointer to the dimensions of the data
+ *
+ * \param strides [in] pointer to the strides of the data
+ *
+ * \param layout [in] the memory layout of the data
+ *
+ * \param value [in] the value to be assigned
+ */
+template< class T >
+void assignLocal(T * ptr,
+                 int numDims,
+                 const dim_type * dims,
+                 const size_type * strides,
+                 Layout layout,
+                 const T & value)
+{
+  if (numDims == 0) return;
+  size_type size = 1;
+  for (int axis = 0; axis < numDims; ++axis) size *= dims[axis];
+  if (size == 0) return;
+
+  // Contiguous data is a single block
+  if (isContiguous(numDims, dims, strides, layout))
+  {
+    std::fill(ptr, ptr + size, value);
+    return;
+  }
+
+  // Assign the value to each line along the fastest axis
+  int first = (layout == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+  AssignLineFunctor< T > functor(ptr, strides[first], dims[first], value);
+  walkLines(numDims, 0, dims, layout, 1, &strides, functor);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Copy strided data to strided data with the same dimensions
+ *         and layout
+ *
+ * \param source [in] pointer to the first element of the source data
+ *
+ * \param sourceStrides [in] pointer to the strides of the source data
+ *
+ * \param target [in] pointer to the first element of the target data
+ *
+ * \param targetStrides [in] pointer to the strides of the target data
+ *
+ * \param numDims [in] the number of dimensions of the data
+ *
+ * \param dims [in] pointer to the dimensions of the source and target
+ *        data
+ *
+ * \param layout [in] the memory layout of the source and target data
+ */
+template< class T >
+void copyLocal(const T * source,
+               const size_type * sourceStrides,
+               T * target,
+               const size_type * targetStrides,
+               int numDims,
+               const dim_type * dims,
+               Layout layout)
+{
+  if (numDims == 0) return;
+  size_type size = 1;
+  for (int axis = 0; axis < numDims; ++axis) size *= dims[axis];
+  if (size == 0) return;
+
+  // Contiguous data is a single block
+  if (isContiguous(numDims, dims, sourceStrides, layout) &&
+      isContiguous(numDims, dims, targetStrides, layout))
+  {
+    std::copy(source, source + size, target);
+    return;
+  }
+
+  // Copy each line along the fastest axis
+  int first = (layout == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+  CopyLineFunctor< T > functor(source, sourceStrides[first],
+                               target, targetStrides[first],
+                               dims[first]);
+  const size_type * strides[2] = { sourceStrides, targetStrides };
+  walkLines(numDims, 0, dims, layout, 2, strides, functor);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Assign a value to every element of strided data, using
+ *         multiple threads if available
+ *
+ * \param ptr [in] pointer to the first element of the data
+ *
+ * \param dims [in] the dimensions of the data
+ *
+ * \param strides [in] the strides of the data
+ *
+ * \param layout [in] the memory layout of the data
+ *
+ * \param value [in] the value to be assigned
+ */
+template< class T >
+void threadedAssign(T * ptr,
+                    const Teuchos::ArrayView< const dim_type > & dims,
+                    const Teuchos::ArrayView< const size_type > & strides,
+                    Layout layout,
+                    const T & value)
+{
+  int numDims = dims.size();
+  const size_type * stridePtr = strides.getRawPtr();
+  int axis     = getPartitionAxis(dims, layout);
+  int numParts = getNumPartitions(dims, axis);
+  if (numParts == 1)
+  {
+    assignLocal(ptr, numDims, dims.getRawPtr(), stridePtr, layout, value);
+    return;
+  }
+  Teuchos::Array< dim_type > partDims;
+  Teuchos::Array< dim_type > partStarts;
+  getPartitions(dims, axis, numParts, partDims, partStarts);
+  const dim_type * partDimPtr   = partDims.getRawPtr();
+  const dim_type * partStartPtr = partStarts.getRawPtr();
+#ifdef HAVE_DOMI_OPENMP
+#pragma omp parallel for schedule(static) num_threads(numParts)
+#endif
+  for (int part = 0; part < numParts; ++part)
+    assignLocal(ptr + partStartPtr[part] * stridePtr[axis], numDims,
+                partDimPtr + part * numDims, stridePtr, layout, value);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Copy strided data to strided data with the same dimensions
+ *         and layout, using multiple threads if available
+ *
+ * \param source [in] pointer to the first element of the source data
+ *
+ * \param sourceStrides [in] the strides of the source data
+ *
+ * \param target [in] pointer to the first element of the target data
+ *
+ * \param targetStrides [in] the strides of the target data
+ *
+ * \param dims [in] the dimensions of the source and target data
+ *
+ * \param layout [in] the memory layout of the source and target data
+ */
+template< class T >
+void threadedCopy(const T * source,
+                  const Teuchos::ArrayView< const size_type > & sourceStrides,
+                  T * target,
+                  const Teuchos::ArrayView< const size_type > & targetStrides,
+                  const Teuchos::ArrayView< const dim_type > & dims,
+                  Layout layout)
+{
+  int numDims = dims.size();
+  const size_type * sourceStridePtr = sourceStrides.getRawPtr();
+  const size_type * targetStridePtr = targetStrides.getRawPtr();
+  int axis     = getPartitionAxis(dims, layout);
+  int numParts = getNumPartitions(dims, axis);
+  if (numParts == 1)
+  {
+    copyLocal(source, sourceStridePtr, target, targetStridePtr, numDims,
+              dims.getRawPtr(), layout);
+    return;
+  }
+  Teuchos::Array< dim_type > partDims;
+  Teuchos::Array< dim_type > partStarts;
+  getPartitions(dims, axis, numParts, partDims, partStarts);
+  const dim_type * partDimPtr   = partDims.getRawPtr();
+  const dim_type * partStartPtr = partStarts.getRawPtr();
+#ifdef HAVE_DOMI_OPENMP
+#pragma omp parallel for schedule(static) num_threads(numParts)
+#endif
+  for (int part = 0; part < numParts; ++part)
+    copyLocal(source + partStartPtr[part] * sourceStridePtr[axis],
+              sourceStridePtr,
+              target + partStartPtr[part] * targetStridePtr[axis],
+              targetStridePtr,
+              numDims,
+              partDimPtr + part * numDims,
+              layout);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Assign to every element of strided data the value of a
+ *         functor of its index, using multiple threads if available
+ *
+ * \param ptr [in] pointer to the first element of the data
+ *
+ * \param dims [in] the dimensions of the data
+ *
+ * \param strides [in] the strides of the data
+ *
+ * \param layout [in] the memory layout of the data
+ *
+ * \param init [in] a functor with the signature <tt>T
+ *        operator()(const Teuchos::ArrayView< const dim_type > &
+ *        index) const</tt>, which returns the value of the element at
+ *        the given index.  It is called concurrently from multiple
+ *        threads, and must take the index by reference and not copy
+ *        it, since copying a <tt>Teuchos::ArrayView</tt> is not
+ *        thread-safe in debug builds.
+ *
+ * The data is partitioned among the threads in the same way as by
+ * <tt>threadedAssign()</tt> and the other local kernels.  When this
+ * is the first write to newly allocated memory, each page is
+ * therefore placed on the memory of the thread that later processes
+ * it.
+ */
+template< class T, class FUNCTOR >
+void threadedInitialize(T * ptr,
+                        const Teuchos::ArrayView< const dim_type > & dims,
+                        const Teuchos::ArrayView< const size_type > & strides,
+                        Layout layout,
+                        const FUNCTOR & init)
+{
+  int numDims = dims.size();
+  if (numDims == 0 || computeSize(dims) == 0) return;
+  const size_type * stridePtr = strides.getRawPtr();
+  int axis     = getPartitionAxis(dims, layout);
+  int numParts = getNumPartitions(dims, axis);
+  int first = (layout == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+
+  // Compute the bounds of every partition, and the index and its view
+  // used by each partition, before entering the parallel region
+  Teuchos::Array< dim_type > starts(numParts * numDims, 0);
+  Teuchos::Array< dim_type > shapes(numParts * numDims);
+  Teuchos::Array< dim_type > indexes(numParts * numDims);
+  Teuchos::Array< Teuchos::ArrayView< const dim_type > > indexViews(numParts);
+  for (int part = 0; part < numParts; ++part)
+  {
+    for (int i = 0; i < numDims; ++i) shapes[part*numDims+i] = dims[i];
+    if (axis >= 0)
+    {
+      dim_type stop;
+      getPartitionBounds(dims[axis], numParts, part,
+                         starts[part*numDims+axis], stop);
+      shapes[part*numDims+axis] = stop - starts[part*numDims+axis];
+    }
+    indexViews[part] = indexes(part*numDims, numDims);
+  }
+  const dim_type * startPtr = starts.getRawPtr();
+  const dim_type * shapePtr = shapes.getRawPtr();
+  dim_type * indexPtr       = indexes.getRawPtr();
+  const Teuchos::ArrayView< const dim_type > * indexViewPtr =
+    indexViews.getRawPtr();
+
+#ifdef HAVE_DOMI_OPENMP
+#pragma omp parallel for schedule(static) num_threads(numParts)
+#endif
+  for (int part = 0; part < numParts; ++part)
+  {
+    const dim_type * start = startPtr + part * numDims;
+    const dim_type * shape = shapePtr + part * numDims;
+    size_type offset = 0;
+    for (int i = 0; i < numDims; ++i) offset += start[i] * stridePtr[i];
+    InitializeLineFunctor< T, FUNCTOR > functor(ptr + offset,
+                                                stridePtr[first],
+                                                shape[first],
+                                                numDims,
+                                                first,
+                                                indexPtr + part * numDims,
+                                                indexViewPtr[part],
+                                                init);
+    walkLines(numDims, start, shape, layout, 1, &stridePtr, functor);
+  }
+}
+
+}  // namespace Domi
+
+#endif
@@ -0,0 +1,338 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+// System includes
+#include <cstdio>
+#include <cstring>
+
+// Teuchos includes
+#include "Teuchos_CommHelpers.hpp"
+
+// Domi includes
+#include "Domi_TimeSeries.hpp"
+#include "Domi_Exceptions.hpp"
+
+namespace Domi
+{
+
+// The time-series file format identifier and version
+static const char timeSeriesMagic[8]  = { 'D','O','M','I',
+                                          'T','S','E','R' };
+static const int  timeSeriesVersion   = 1;
+static const int  timeSeriesByteOrder = 0x01020304;
+
+const size_type TimeSeriesIndex::headerSize;
+
+////////////////////////////////////////////////////////////////////////
+
+TimeSeriesIndex::TimeSeriesIndex(int typeCode,
+                                 int scalarSize) :
+  _typeCode(typeCode),
+  _scalarSize(scalarSize),
+  _swapBytes(false),
+  _fields(),
+  _times(),
+  _stepSize(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+TimeSeriesIndex
+TimeSeriesIndex::
+read(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+     const std::string & filename)
+{
+  // The first processor reads the header, which gives the offset of
+  // the index, and then the index, which extends to the end of the
+  // file
+  Teuchos::Array< char > buffer;
+  int size = 0;
+  if (teuchosComm->getRank() == 0)
+  {
+    FILE * datafile = fopen(filename.c_str(), "r");
+    if (datafile)
+    {
+      char header[headerSize];
+      if (fread(header, 1, headerSize, datafile) == (std::size_t) headerSize &&
+          std::memcmp(header, timeSeriesMagic, 8) == 0)
+      {
+        Teuchos::ArrayView< const char > headerView(header, headerSize);
+        size_type position = 8;
+        int version = extractBytes< int >(headerView, position, false);
+        int byteOrder = extractBytes< int >(headerView, position, false);
+        bool swap = (byteOrder != timeSeriesByteOrder);
+        if (swap) Domi::swapBytes(&version, 1, sizeof(int));
+        size_type indexOffset =
+          extractBytes< long long >(headerView, position, swap);
+        fseek(datafile, 0, SEEK_END);
+        size_type fileSize = ftell(datafile);
+        if (version <= timeSeriesVersion && indexOffset >= headerSize &&
+            indexOffset < fileSize)
+        {
+          // Prepend the byte order marker to the index, so that it
+          // can be unpacked by every processor
+          buffer.resize(sizeof(int) + fileSize - indexOffset);
+          std::memcpy(buffer.getRawPtr(), &byteOrder, sizeof(int));
+          fseek(datafile, indexOffset, SEEK_SET);
+          if (fread(buffer.getRawPtr() + sizeof(int), 1,
+                    fileSize - indexOffset, datafile) ==
+              (std::size_t) (fileSize - indexOffset))
+            size = buffer.size();
+        }
+      }
+      fclose(datafile);
+    }
+  }
+
+  // Broadcast the index to the other processors
+  Teuchos::broadcast(*teuchosComm, 0, 1, &size);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    size == 0,
+    FileError,
+    "File '" << filename << "' cannot be read, is not a Domi time-series "
+    "file, or has no index");
+  buffer.resize(size);
+  Teuchos::broadcast(*teuchosComm, 0, size, buffer.getRawPtr());
+
+  TimeSeriesIndex result;
+  result.unpack(buffer(), filename);
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+TimeSeriesIndex::addField(const std::string & name,
+                          Layout layout,
+                          bool includesBndryPad,
+                          const Teuchos::ArrayView< const dim_type > & dims)
+{
+  Field field;
+  field.name             = name;
+  field.layout           = layout;
+  field.includesBndryPad = includesBndryPad;
+  field.dims.assign(dims.begin(), dims.end());
+  field.offset           = _stepSize;
+  _fields.push_back(field);
+  _stepSize += computeSize(field.dims) * _scalarSize;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+TimeSeriesIndex::addStep(double time)
+{
+  _times.push_back(time);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+TimeSeriesIndex::typeCode() const
+{
+  return _typeCode;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+TimeSeriesIndex::scalarSize() const
+{
+  return _scalarSize;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+bool
+TimeSeriesIndex::swapBytes() const
+{
+  return _swapBytes;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+TimeSeriesIndex::numFields() const
+{
+  return _fields.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+const TimeSeriesIndex::Field &
+TimeSeriesIndex::getField(int field) const
+{
+  return _fields[field];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+TimeSeriesIndex::findField(const std::string & name) const
+{
+  for (int field = 0; field < _fields.size(); ++field)
+    if (_fields[field].name == name) return field;
+  return -1;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+int
+TimeSeriesIndex::numSteps() const
+{
+  return _times.size();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+double
+TimeSeriesIndex::getTime(int step) const
+{
+  return _times[step];
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_type
+TimeSeriesIndex::stepSize() const
+{
+  return _stepSize;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_type
+TimeSeriesIndex::getOffset(int step,
+                           int field) const
+{
+  return headerSize + step * _stepSize + _fields[field].offset;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+size_type
+TimeSeriesIndex::indexOffset() const
+{
+  return headerSize + _times.size() * _stepSize;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Teuchos::Array< char >
+TimeSeriesIndex::packHeader(bool withIndexOffset) const
+{
+  Teuchos::Array< char > buffer(timeSeriesMagic, timeSeriesMagic + 8);
+  appendBytes< int >(buffer, timeSeriesVersion);
+  appendBytes< int >(buffer, timeSeriesByteOrder);
+  appendBytes< long long >(buffer, withIndexOffset ? indexOffset() : 0);
+  buffer.resize(headerSize, 0);
+  return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+Teuchos::Array< char >
+TimeSeriesIndex::pack() const
+{
+  Teuchos::Array< char > buffer;
+  appendBytes< int >(buffer, _typeCode);
+  appendBytes< int >(buffer, _scalarSize);
+  appendBytes< int >(buffer, _fields.size());
+  appendBytes< int >(buffer, _times.size());
+  for (int field = 0; field < _fields.size(); ++field)
+  {
+    const Field & f = _fields[field];
+    appendBytes< int >(buffer, f.name.size());
+    buffer.insert(buffer.end(), f.name.begin(), f.name.end());
+    appendBytes< int >(buffer, f.layout);
+    appendBytes< int >(buffer, f.includesBndryPad);
+    appendBytes< int >(buffer, f.dims.size());
+    for (int axis = 0; axis < f.dims.size(); ++axis)
+      appendBytes< long long >(buffer, f.dims[axis]);
+  }
+  for (int step = 0; step < _times.size(); ++step)
+    appendBytes< double >(buffer, _times[step]);
+  return buffer;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+void
+TimeSeriesIndex::unpack(const Teuchos::ArrayView< const char > & buffer,
+                        const std::string & filename)
+{
+  // The buffer starts with the byte order marker of the header
+  size_type position = 0;
+  _swapBytes = (extractBytes< int >(buffer, position, false) !=
+                timeSeriesByteOrder);
+  _typeCode   = extractBytes< int >(buffer, position, _swapBytes);
+  _scalarSize = extractBytes< int >(buffer, position, _swapBytes);
+  int numFields = extractBytes< int >(buffer, position, _swapBytes);
+  int numSteps  = extractBytes< int >(buffer, position, _swapBytes);
+  _fields.clear();
+  _times.clear();
+  _stepSize = 0;
+  for (int field = 0; field < numFields; ++field)
+  {
+    int length = extractBytes< int >(buffer, position, _swapBytes);
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      length < 0 || position + length > buffer.size(),
+      FileError,
+      "Time-series file '" << filename << "' has a corrupt index");
+    std::string name(&buffer[position], length);
+    position += length;
+    Layout layout = (Layout) extractBytes< int >(buffer, position,
+                                                 _swapBytes);
+    bool includesBndryPad = extractBytes< int >(buffer, position,
+                                                _swapBytes);
+    int numDims = extractBytes< int >(buffer, position, _swapBytes);
+    Teuchos::Array< dim_type > dims(numDims);
+    for (int axis = 0; axis < numDims; ++axis)
+      dims[axis] = extractBytes< long long >(buffer, position, _swapBytes);
+    addField(name, layout, includesBndryPad, dims());
+  }
+  for (int step = 0; step < numSteps; ++step)
+    addStep(extractBytes< double >(buffer, position, _swapBytes));
+}
+
+}  // namespace Domi
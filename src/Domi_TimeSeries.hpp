@@ -0,0 +1,850 @@
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+
+#ifndef DOMI_TIMESERIES_HPP
+#define DOMI_TIMESERIES_HPP
+
+// System includes
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// Teuchos includes
+#include "Teuchos_Array.hpp"
+#include "Teuchos_Comm.hpp"
+#ifdef HAVE_MPI
+#include "Teuchos_DefaultMpiComm.hpp"
+#endif
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+#include "Domi_Exceptions.hpp"
+#include "Domi_ChunkedFile.hpp"
+#include "Domi_IOConfig.hpp"
+#include "Domi_MDVector.hpp"
+
+namespace Domi
+{
+
+/** \brief The index of a time-series file
+ *
+ * A time-series file stores successive snapshots of one or more
+ * fields, such as the <tt>MDVector</tt>s of a simulation, in a single
+ * file.  It consists of a fixed header, the snapshots, and an index
+ * that describes the fields and the steps.  Every snapshot stores
+ * every field, each in the format written by
+ * <tt>MDVector::writeBinary()</tt>, so the offset of any field at any
+ * step can be computed from the index, and the snapshots can be read
+ * in any order.
+ *
+ * The header is 64 bytes long, and contains the eight characters
+ * "DOMITSER", two 32-bit integers (the format version and the value
+ * 0x01020304, from which the reader determines the byte order) and
+ * the 64-bit byte offset of the index, which is zero until the index
+ * is first written.  The index follows the last snapshot, and
+ * contains, in the byte order of the writer:
+ *
+ * - four 32-bit integers: the scalar type code given by
+ *   <tt>fileTypeCode()</tt>, the scalar size in bytes, the number of
+ *   fields and the number of steps
+ * - for each field, a 32-bit integer giving the length of its name,
+ *   the characters of the name, three 32-bit integers (the layout, a
+ *   flag indicating whether the boundary padding is included, and
+ *   the number of dimensions) and the 64-bit dimensions of the field
+ *   in the file
+ * - the 64-bit floating point time of each step
+ *
+ * Appending a step overwrites the index, which is rewritten when the
+ * file is flushed or closed.
+ */
+class TimeSeriesIndex
+{
+public:
+
+  /** \brief The description of a field in a time-series file
+   */
+  struct Field
+  {
+    /** \brief The name of the field */
+    std::string                name;
+    /** \brief The layout of the field */
+    Layout                     layout;
+    /** \brief Whether the boundary padding is stored */
+    bool                       includesBndryPad;
+    /** \brief The dimensions of the field in the file */
+    Teuchos::Array< dim_type > dims;
+    /** \brief The byte offset of the field within a snapshot */
+    size_type                  offset;
+  };
+
+  /** \brief The size, in bytes, of the header of a time-series file
+   */
+  static const size_type headerSize = 64;
+
+  /** \brief Constructor
+   *
+   * \param typeCode [in] the scalar type code, as given by
+   *        <tt>fileTypeCode()</tt>
+   *
+   * \param scalarSize [in] the size of the scalar type, in bytes
+   */
+  TimeSeriesIndex(int typeCode = 0,
+                  int scalarSize = 0);
+
+  /** \brief Read the index of a time-series file
+   *
+   * \param teuchosComm [in] the communicator over which the index is
+   *        shared.  The first processor reads the file and
+   *        broadcasts the index.
+   *
+   * \param filename [in] name of the file
+   */
+  static TimeSeriesIndex
+  read(const Teuchos::RCP< const Teuchos::Comm< int > > teuchosComm,
+       const std::string & filename);
+
+  /** \brief Add a field to the end of every snapshot
+   *
+   * \param name [in] name of the field
+   *
+   * \param layout [in] layout of the field
+   *
+   * \param includesBndryPad [in] whether the boundary padding is
+   *        stored
+   *
+   * \param dims [in] dimensions of the field in the file
+   */
+  void addField(const std::string & name,
+                Layout layout,
+                bool includesBndryPad,
+                const Teuchos::ArrayView< const dim_type > & dims);
+
+  /** \brief Add a step, at the end of the snapshots
+   *
+   * \param time [in] the time of the step
+   */
+  void addStep(double time);
+
+  /** \brief Return the scalar type code */
+  int typeCode() const;
+
+  /** \brief Return the scalar size, in bytes */
+  int scalarSize() const;
+
+  /** \brief Return true if the file was written with the opposite
+   *         byte order
+   */
+  bool swapBytes() const;
+
+  /** \brief Return the number of fields */
+  int numFields() const;
+
+  /** \brief Return the description of a field
+   *
+   * \param field [in] the index of the field
+   */
+  const Field & getField(int field) const;
+
+  /** \brief Return the index of a field, given its name, or -1 if
+   *         there is no such field
+   *
+   * \param name [in] the name of the field
+   */
+  int findField(const std::string & name) const;
+
+  /** \brief Return the number of steps */
+  int numSteps() const;
+
+  /** \brief Return the time of a step
+   *
+   * \param step [in] the index of the step
+   */
+  double getTime(int step) const;
+
+  /** \brief Return the size, in bytes, of a snapshot */
+  size_type stepSize() const;
+
+  /** \brief Return the byte offset of a field at a step
+   *
+   * \param step [in] the index of the step
+   *
+   * \param field [in] the index of the field
+   */
+  size_type getOffset(int step,
+                      int field) const;
+
+  /** \brief Return the byte offset of the index, which follows the
+   *         last snapshot
+   */
+  size_type indexOffset() const;
+
+  /** \brief Return the header of the file, as an array of bytes
+   *
+   * \param withIndexOffset [in] if true, the header gives the offset
+   *        of the index; otherwise the offset is zero
+   */
+  Teuchos::Array< char > packHeader(bool withIndexOffset) const;
+
+  /** \brief Return the index, as an array of bytes
+   */
+  Teuchos::Array< char > pack() const;
+
+private:
+
+  // Unpack the index from an array of bytes
+  void unpack(const Teuchos::ArrayView< const char > & buffer,
+              const std::string & filename);
+
+  int                    _typeCode;
+  int                    _scalarSize;
+  bool                   _swapBytes;
+  Teuchos::Array< Field > _fields;
+  Teuchos::Array< double > _times;
+  size_type              _stepSize;
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Write successive snapshots of MDVectors to a single
+ *         time-series file
+ *
+ * A <tt>TimeSeriesWriter</tt> keeps its file open from the first
+ * snapshot until it is closed, and writes each snapshot of each
+ * field at its computed offset in the file, using the MPI data types
+ * that the <tt>MDVector</tt> caches for <tt>writeBinary()</tt>.  The
+ * format of the file is described by <tt>TimeSeriesIndex</tt>, and
+ * it can be read with a <tt>TimeSeriesReader</tt>.
+ *
+ * All of the methods except the constructor and
+ * <tt>numSteps()</tt> are collective over the communicator of the
+ * fields, which must all share it.  The file is opened with the
+ * MPI-IO hints of the <tt>IOConfig</tt> of the first field, and each
+ * snapshot is timed as the "TimeSeriesWriter::write" operation of
+ * that <tt>IOConfig</tt>.
+ */
+template< class Scalar >
+class TimeSeriesWriter
+{
+public:
+
+  /** \brief Constructor
+   *
+   * \param filename [in] name of the time-series file
+   *
+   * \param append [in] if true, and the file exists, the snapshots
+   *        are appended to those already in it, whose fields must
+   *        match those of this writer.  Otherwise, an existing file
+   *        is overwritten.
+   *
+   * The file is opened when the first snapshot is written.
+   */
+  TimeSeriesWriter(const std::string & filename,
+                   bool append = false);
+
+  /** \brief Destructor, which closes the file
+   */
+  ~TimeSeriesWriter();
+
+  /** \brief Add a field to the snapshots
+   *
+   * \param name [in] name of the field
+   *
+   * \param mdVector [in] the MDVector whose data is written at each
+   *        step
+   *
+   * \param includeBndryPad [in] if true, include the boundary pad
+   *        with the output data
+   *
+   * Fields must be added before the first snapshot is written.
+   */
+  void addField(const std::string & name,
+                const Teuchos::RCP< const MDVector< Scalar > > & mdVector,
+                bool includeBndryPad = false);
+
+  /** \brief Write a snapshot of every field, and return the index of
+   *         its step
+   *
+   * \param time [in] the time of the step
+   */
+  int write(double time);
+
+  /** \brief Write the index, so that the file is complete, and flush
+   *         the file
+   */
+  void flush();
+
+  /** \brief Write the index and close the file
+   */
+  void close();
+
+  /** \brief Return the number of steps in the file
+   */
+  int numSteps() const;
+
+private:
+
+  // Open the file, and in append mode read its index
+  void open();
+
+  std::string                                       _filename;
+  bool                                              _append;
+  bool                                              _open;
+  Teuchos::RCP< const Teuchos::Comm< int > >        _teuchosComm;
+  Teuchos::Array< Teuchos::RCP< const MDVector< Scalar > > > _fields;
+  Teuchos::Array< bool >                            _includeBndryPad;
+  TimeSeriesIndex                                   _index;
+
+#ifdef HAVE_MPI
+  MPI_File _file;
+#else
+  FILE *   _file;
+#endif
+
+  // Not copyable
+  TimeSeriesWriter(const TimeSeriesWriter & source);
+  TimeSeriesWriter & operator=(const TimeSeriesWriter & source);
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Read snapshots of MDVectors from a time-series file
+ *
+ * A <tt>TimeSeriesReader</tt> reads the index of a file written by a
+ * <tt>TimeSeriesWriter</tt> when it is constructed, and keeps the
+ * file open until it is destroyed.  Any field can then be read at any
+ * step, directly from its offset in the file.
+ */
+template< class Scalar >
+class TimeSeriesReader
+{
+public:
+
+  /** \brief Constructor
+   *
+   * \param teuchosComm [in] the communicator of the MDVectors that
+   *        are read
+   *
+   * \param filename [in] name of the time-series file
+   *
+   * \param ioConfig [in] the MPI-IO hints with which the file is
+   *        opened, and in which the reads are timed as the
+   *        "TimeSeriesReader::read" operation.  If null, the default
+   *        <tt>IOConfig</tt> is used.
+   */
+  TimeSeriesReader(const Teuchos::RCP< const Teuchos::Comm< int > >
+                     teuchosComm,
+                   const std::string & filename,
+                   const Teuchos::RCP< IOConfig > & ioConfig =
+                     Teuchos::null);
+
+  /** \brief Destructor, which closes the file
+   */
+  ~TimeSeriesReader();
+
+  /** \brief Return the index of the file
+   */
+  const TimeSeriesIndex & getIndex() const;
+
+  /** \brief Return the number of steps in the file
+   */
+  int numSteps() const;
+
+  /** \brief Return the time of a step
+   *
+   * \param step [in] the index of the step
+   */
+  double getTime(int step) const;
+
+  /** \brief Read a field at a step into an MDVector
+   *
+   * \param step [in] the index of the step
+   *
+   * \param name [in] the name of the field
+   *
+   * \param mdVector [out] the MDVector, whose dimensions and layout
+   *        must match those of the field
+   *
+   * This is collective over the communicator.
+   */
+  void read(int step,
+            const std::string & name,
+            MDVector< Scalar > & mdVector) const;
+
+private:
+
+  std::string                                _filename;
+  Teuchos::RCP< const Teuchos::Comm< int > > _teuchosComm;
+  Teuchos::RCP< IOConfig >                   _ioConfig;
+  TimeSeriesIndex                            _index;
+
+#ifdef HAVE_MPI
+  MPI_File _file;
+#else
+  FILE *   _file;
+#endif
+
+  // Not copyable
+  TimeSeriesReader(const TimeSeriesReader & source);
+  TimeSeriesReader & operator=(const TimeSeriesReader & source);
+};
+
+////////////////////////////////////////////////////////////////////////
+// Implementations
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+TimeSeriesWriter< Scalar >::
+TimeSeriesWriter(const std::string & filename,
+                 bool append) :
+  _filename(filename),
+  _append(append),
+  _open(false),
+  _teuchosComm(),
+  _fields(),
+  _includeBndryPad(),
+  _index(fileTypeCode< Scalar >(), sizeof(Scalar))
+{
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+TimeSeriesWriter< Scalar >::
+~TimeSeriesWriter()
+{
+  // A destructor must not throw, so errors from the final flush are
+  // lost; call close() explicitly to see them
+  try
+  {
+    close();
+  }
+  catch (...)
+  {
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+TimeSeriesWriter< Scalar >::
+addField(const std::string & name,
+         const Teuchos::RCP< const MDVector< Scalar > > & mdVector,
+         bool includeBndryPad)
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    _open,
+    InvalidArgument,
+    "Cannot add field '" << name << "' to time-series file '" << _filename
+    << "' after the first snapshot has been written");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    _index.findField(name) >= 0,
+    InvalidArgument,
+    "Time-series file '" << _filename << "' already has a field named '"
+    << name << "'");
+  if (_teuchosComm.is_null()) _teuchosComm = mdVector->getTeuchosComm();
+  _fields.push_back(mdVector);
+  _includeBndryPad.push_back(includeBndryPad);
+  _index.addField(name,
+                  mdVector->getLayout(),
+                  includeBndryPad,
+                  mdVector->computeFileInfo(includeBndryPad)->fileShape());
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+TimeSeriesWriter< Scalar >::
+open()
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    _fields.size() == 0,
+    InvalidArgument,
+    "Time-series file '" << _filename << "' has no fields");
+
+  // In append mode, continue after the steps already in an existing
+  // file, whose fields must match
+  bool exists = false;
+  if (_append)
+  {
+    int flag = 0;
+    if (_teuchosComm->getRank() == 0)
+    {
+      FILE * datafile = fopen(_filename.c_str(), "r");
+      if (datafile)
+      {
+        flag = 1;
+        fclose(datafile);
+      }
+    }
+    Teuchos::broadcast(*_teuchosComm, 0, 1, &flag);
+    exists = (flag != 0);
+  }
+  if (exists)
+  {
+    TimeSeriesIndex index = TimeSeriesIndex::read(_teuchosComm, _filename);
+    bool match = (! index.swapBytes()                    &&
+                  index.typeCode()   == _index.typeCode()   &&
+                  index.scalarSize() == _index.scalarSize() &&
+                  index.numFields()  == _index.numFields());
+    for (int field = 0; match && field < _index.numFields(); ++field)
+    {
+      const TimeSeriesIndex::Field & a = index.getField(field);
+      const TimeSeriesIndex::Field & b = _index.getField(field);
+      match = (a.name == b.name && a.layout == b.layout &&
+               a.includesBndryPad == b.includesBndryPad && a.dims == b.dims);
+    }
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      ! match,
+      FileError,
+      "Cannot append to time-series file '" << _filename << "', whose "
+      "fields or scalar type do not match");
+    _index = index;
+  }
+
+  // Open the file, and if it is new, write the header
+#ifdef HAVE_MPI
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+  char * cstr = new char[_filename.size()+1];
+  std::strcpy(cstr, _filename.c_str());
+  int error = MPI_File_open(communicator(), cstr,
+                            MPI_MODE_WRONLY | MPI_MODE_CREATE,
+                            _fields[0]->getIOConfig()->getInfo(), &_file);
+  delete [] cstr;
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    error != MPI_SUCCESS,
+    FileError,
+    "Cannot open time-series file '" << _filename << "' for writing");
+  if (! exists)
+  {
+    MPI_File_set_size(_file, 0);
+    if (_teuchosComm->getRank() == 0)
+    {
+      Teuchos::Array< char > header = _index.packHeader(false);
+      MPI_File_write_at(_file, 0, header.getRawPtr(), header.size(),
+                        MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+  }
+#else
+  _file = fopen(_filename.c_str(), exists ? "r+" : "w+");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    _file == 0,
+    FileError,
+    "Cannot open time-series file '" << _filename << "' for writing");
+  if (! exists)
+  {
+    Teuchos::Array< char > header = _index.packHeader(false);
+    fwrite(header.getRawPtr(), 1, header.size(), _file);
+  }
+#endif
+  _open = true;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+TimeSeriesWriter< Scalar >::
+write(double time)
+{
+  if (! _open) open();
+  int step = _index.numSteps();
+  Teuchos::RCP< IOConfig > ioConfig = _fields[0]->getIOConfig();
+  size_type bytes = 0;
+  for (int field = 0; field < _fields.size(); ++field)
+    bytes += computeSize(_fields[field]->computeFileInfo(
+               _includeBndryPad[field])->dataShape) * sizeof(Scalar);
+  IOTimer timer(ioConfig, "TimeSeriesWriter::write", bytes);
+
+  // Write each field at its offset, with the data types cached by the
+  // MDVector
+  for (int field = 0; field < _fields.size(); ++field)
+  {
+    const MDVector< Scalar > & mdVector = *(_fields[field]);
+    bool includeBndryPad = _includeBndryPad[field];
+    size_type offset = _index.getOffset(step, field);
+#ifdef HAVE_MPI
+    Teuchos::RCP< typename MDVector< Scalar >::FileInfo > & fileInfo =
+      mdVector.computeFileInfo(includeBndryPad);
+    char datarep[7] = "native";
+    MPI_File_set_view(_file, offset, mpiType< Scalar >(),
+                      *(fileInfo->filetype), datarep,
+                      ioConfig->getInfo());
+    MPI_File_write_all(_file, (void*) mdVector.getData(true).getRawPtr(),
+                       1, *(fileInfo->datatype), MPI_STATUS_IGNORE);
+#else
+    fseek(_file, offset, SEEK_SET);
+    TEUCHOS_TEST_FOR_EXCEPTION(
+      ! MDVector< Scalar >::writeLocal(_file,
+                                       mdVector.getData(includeBndryPad)),
+      FileError,
+      "Incomplete write to file '" << _filename << "'");
+#endif
+  }
+
+  // Record the step only once its fields have been written
+  _index.addStep(time);
+  return step;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+TimeSeriesWriter< Scalar >::
+flush()
+{
+  if (! _open) return;
+
+  // Write the index after the last snapshot, and then its offset to
+  // the header
+  Teuchos::Array< char > index  = _index.pack();
+  Teuchos::Array< char > header = _index.packHeader(true);
+  size_type indexOffset = _index.indexOffset();
+#ifdef HAVE_MPI
+  char datarep[7] = "native";
+  MPI_File_set_view(_file, 0, MPI_BYTE, MPI_BYTE, datarep,
+                    _fields[0]->getIOConfig()->getInfo());
+  if (_teuchosComm->getRank() == 0)
+  {
+    MPI_File_write_at(_file, indexOffset, index.getRawPtr(), index.size(),
+                      MPI_BYTE, MPI_STATUS_IGNORE);
+    MPI_File_write_at(_file, 0, header.getRawPtr(), header.size(),
+                      MPI_BYTE, MPI_STATUS_IGNORE);
+  }
+  MPI_File_set_size(_file, indexOffset + index.size());
+  MPI_File_sync(_file);
+#else
+  fseek(_file, indexOffset, SEEK_SET);
+  fwrite(index.getRawPtr(), 1, index.size(), _file);
+  fseek(_file, 0, SEEK_SET);
+  fwrite(header.getRawPtr(), 1, header.size(), _file);
+  fflush(_file);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+TimeSeriesWriter< Scalar >::
+close()
+{
+  if (! _open) return;
+  flush();
+#ifdef HAVE_MPI
+  MPI_File_close(&_file);
+#else
+  fclose(_file);
+#endif
+  _open = false;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+TimeSeriesWriter< Scalar >::
+numSteps() const
+{
+  return _index.numSteps();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+TimeSeriesReader< Scalar >::
+TimeSeriesReader(const Teuchos::RCP< const Teuchos::Comm< int > >
+                   teuchosComm,
+                 const std::string & filename,
+                 const Teuchos::RCP< IOConfig > & ioConfig) :
+  _filename(filename),
+  _teuchosComm(teuchosComm),
+  _ioConfig(ioConfig.is_null() ? IOConfig::getDefault() : ioConfig),
+  _index(TimeSeriesIndex::read(teuchosComm, filename))
+{
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    _index.scalarSize() != (int) sizeof(Scalar) ||
+    _index.typeCode() != fileTypeCode< Scalar >(),
+    TypeError,
+    "Time-series file '" << filename << "' has scalar type code "
+    << _index.typeCode() << " of size " << _index.scalarSize()
+    << ", but the reader has scalar type code " << fileTypeCode< Scalar >()
+    << " of size " << sizeof(Scalar));
+#ifdef HAVE_MPI
+  Teuchos::RCP< const Teuchos::MpiComm< int > > mpiComm =
+    Teuchos::rcp_dynamic_cast< const Teuchos::MpiComm< int > >(_teuchosComm);
+  const Teuchos::OpaqueWrapper< MPI_Comm > & communicator =
+    *(mpiComm->getRawMpiComm());
+  char * cstr = new char[_filename.size()+1];
+  std::strcpy(cstr, _filename.c_str());
+  int error = MPI_File_open(communicator(), cstr, MPI_MODE_RDONLY,
+                            _ioConfig->getInfo(), &_file);
+  delete [] cstr;
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    error != MPI_SUCCESS,
+    FileError,
+    "Cannot open time-series file '" << _filename << "' for reading");
+#else
+  _file = fopen(_filename.c_str(), "r");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    _file == 0,
+    FileError,
+    "Cannot open time-series file '" << _filename << "' for reading");
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+TimeSeriesReader< Scalar >::
+~TimeSeriesReader()
+{
+#ifdef HAVE_MPI
+  MPI_File_close(&_file);
+#else
+  fclose(_file);
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+const TimeSeriesIndex &
+TimeSeriesReader< Scalar >::
+getIndex() const
+{
+  return _index;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+int
+TimeSeriesReader< Scalar >::
+numSteps() const
+{
+  return _index.numSteps();
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+double
+TimeSeriesReader< Scalar >::
+getTime(int step) const
+{
+  return _index.getTime(step);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+template< class Scalar >
+void
+TimeSeriesReader< Scalar >::
+read(int step,
+     const std::string & name,
+     MDVector< Scalar > & mdVector) const
+{
+  int field = _index.findField(name);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    field < 0,
+    InvalidArgument,
+    "Time-series file '" << _filename << "' has no field named '" << name
+    << "'");
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    step < 0 || step >= _index.numSteps(),
+    RangeError,
+    "Step " << step << " is out of range for time-series file '"
+    << _filename << "' with " << _index.numSteps() << " steps");
+  const TimeSeriesIndex::Field & info = _index.getField(field);
+  bool includeBndryPad = info.includesBndryPad;
+  Teuchos::RCP< typename MDVector< Scalar >::FileInfo > & fileInfo =
+    mdVector.computeFileInfo(includeBndryPad);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    info.dims != fileInfo->fileShape || info.layout != mdVector.getLayout(),
+    MDMapError,
+    "Field '" << name << "' of time-series file '" << _filename << "' has "
+    "dimensions " << info.dims << ", which do not match the MDVector "
+    "dimensions " << fileInfo->fileShape << " or layout");
+  size_type offset = _index.getOffset(step, field);
+  IOTimer timer(_ioConfig, "TimeSeriesReader::read",
+                computeSize(fileInfo->dataShape) * sizeof(Scalar));
+
+#ifdef HAVE_MPI
+  char datarep[7] = "native";
+  MPI_File_set_view(_file, offset, mpiType< Scalar >(),
+                    *(fileInfo->filetype), datarep, _ioConfig->getInfo());
+  MPI_File_read_all(_file, (void*) mdVector.getDataNonConst(true).getRawPtr(),
+                    1, *(fileInfo->datatype), MPI_STATUS_IGNORE);
+#else
+  fseek(_file, offset, SEEK_SET);
+  TEUCHOS_TEST_FOR_EXCEPTION(
+    ! MDVector< Scalar >::readLocal(_file,
+                                    mdVector.getDataNonConst(includeBndryPad)),
+    FileError,
+    "Incomplete read from file '" << _filename << "'");
+#endif
+
+  // Convert data written with the opposite byte order.  Only the
+  // elements that were read from the file are converted.
+  if (_index.swapBytes())
+  {
+    MDArrayView< Scalar > data = mdVector.getDataNonConst(true);
+    for (int axis = 0; axis < data.numDims(); ++axis)
+      data = MDArrayView< Scalar >(data, axis,
+        Slice(fileInfo->dataStart[axis],
+              fileInfo->dataStart[axis] + fileInfo->dataShape[axis]));
+    typedef typename MDArrayView< Scalar >::iterator iterator;
+    for (iterator it = data.begin(); it != data.end(); ++it)
+      Domi::swapBytes(&(*it), 1, sizeof(Scalar));
+  }
+}
+
+}  // namespace Domi
+
+#endif
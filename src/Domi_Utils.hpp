@@ -43,6 +43,9 @@
 #ifndef DOMI_UTILS_HPP
 #define DOMI_UTILS_HPP
 
+// Standard includes
+#include <vector>
+
 // Domi includes
 #include "Domi_ConfigDefs.hpp"
 
@@ -129,6 +132,39 @@ enum Layout
   DEFAULT_ORDER       = 1
 };
 
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Communication padding strategy enumeration, used to specify
+ *         how an MDVector updates its communication padding.
+ */
+enum CommPadStrategy
+{
+  /** \brief Update the communication padding one axis at a time,
+   *         completing each axis before starting the next.  Edge and
+   *         corner regions are updated because the messages along
+   *         each axis include the padding of the previous axes. */
+  AXIS_BY_AXIS  = 0,
+  /** \brief Update the communication padding of all faces at once.
+   *         Edge and corner regions are not updated. */
+  ALL_FACES     = 1,
+  /** \brief Update the communication padding of all faces, edges
+   *         and corners at once, using messages to and from diagonal
+   *         neighbors */
+  ALL_NEIGHBORS = 2
+};
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief The alignment, in bytes, of the base pointer of aligned
+ *         MDArrayRCP storage.
+ *
+ * Aligned storage also pads the stride of the fastest-varying
+ * dimension to a multiple of this many bytes, so that every line of
+ * data along that dimension starts on an aligned address.  Sixty-four
+ * bytes covers both a cache line and the widest common SIMD register.
+ */
+const size_type ALIGNED_STORAGE_BYTES = 64;
+
 //@}
 
 ////////////////////////////////////////////////////////////////////////
@@ -225,6 +261,60 @@ computeStrides(const Teuchos::ArrayView< DIM_TYPE > & dimensions,
 
 ////////////////////////////////////////////////////////////////////////
 
+/** \brief Compute the allocated length of the fastest-varying
+ *         dimension of aligned storage, which is the given dimension
+ *         rounded up to a multiple of the vector width.
+ *
+ * \param dim [in] the length of the fastest-varying dimension
+ *
+ * \param typeSize [in] the size, in bytes, of a data element
+ */
+template< class DIM_TYPE >
+DIM_TYPE computeAlignedDimension(const DIM_TYPE dim,
+                                 const size_type typeSize)
+{
+  size_type width = ALIGNED_STORAGE_BYTES / typeSize;
+  if (width < 2 || ALIGNED_STORAGE_BYTES % typeSize) return dim;
+  return ((dim + width - 1) / width) * width;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Compute the strides of aligned storage, given the
+ *         dimensions, the storage order and the size of a data
+ *         element.
+ *
+ * The strides are those of an array whose fastest-varying dimension
+ * has been padded by <tt>computeAlignedDimension()</tt>.  The
+ * padding is not part of the data; it only separates consecutive
+ * lines of data.
+ *
+ * \param dimensions [in] an array of dimensions
+ *
+ * \param layout [in] the memory storage order
+ *
+ * \param typeSize [in] the size, in bytes, of a data element
+ */
+template< class SIZE_TYPE, class DIM_TYPE >
+Teuchos::Array< SIZE_TYPE >
+computeAlignedStrides(const Teuchos::ArrayView< DIM_TYPE > & dimensions,
+                      const Layout layout,
+                      const size_type typeSize)
+{
+  typedef typename remove_const< DIM_TYPE >::type dim_t;
+  Teuchos::Array< dim_t > allocDims(0);
+  allocDims.insert(allocDims.begin(),
+                   dimensions.begin(),
+                   dimensions.end());
+  int n = allocDims.size();
+  if (n == 0) return Teuchos::Array< SIZE_TYPE >(0);
+  int fastest = (layout == FIRST_INDEX_FASTEST) ? 0 : n-1;
+  allocDims[fastest] = computeAlignedDimension(allocDims[fastest], typeSize);
+  return computeStrides< SIZE_TYPE, dim_t >(allocDims, layout);
+}
+
+////////////////////////////////////////////////////////////////////////
+
 /** \brief Compute the minimum size required for an <tt>MDArray</tt>,
  *         <tt>MDArrayView</tt>, or <tt>MDArrayRCP</tt>, given its
  *         dimensions as an Arrayview.
@@ -287,6 +377,121 @@ SIZE_TYPE computeSize(const Teuchos::ArrayView< DIM_TYPE > & dimensions,
 
 ////////////////////////////////////////////////////////////////////////
 
+/** \brief Return true if strided data is contiguous in memory
+ *
+ * \param numDims [in] the number of dimensions of the data
+ *
+ * \param dims [in] pointer to the dimensions of the data
+ *
+ * \param strides [in] pointer to the strides of the data
+ *
+ * \param layout [in] the memory layout of the data
+ */
+inline bool isContiguous(int numDims,
+                         const dim_type * dims,
+                         const size_type * strides,
+                         Layout layout)
+{
+  size_type contigStride = 1;
+  for (int i = 0; i < numDims; ++i)
+  {
+    int axis = (layout == LAST_INDEX_FASTEST) ? numDims - 1 - i : i;
+    if (strides[axis] != contigStride) return false;
+    contigStride *= dims[axis];
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Return true if strided data is contiguous in memory
+ *
+ * \param dims [in] the dimensions of the data
+ *
+ * \param strides [in] the strides of the data
+ *
+ * \param layout [in] the memory layout of the data
+ */
+inline bool isContiguous(const Teuchos::ArrayView< const dim_type > & dims,
+                         const Teuchos::ArrayView< const size_type > & strides,
+                         Layout layout)
+{
+  return isContiguous(dims.size(), dims.getRawPtr(), strides.getRawPtr(),
+                      layout);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/** \brief Call a functor for every line along the fastest axis of a
+ *         box of strided data, in layout order
+ *
+ * \param numDims [in] the number of dimensions of the box
+ *
+ * \param start [in] pointer to the index of the first element of the
+ *        box, or null if the box starts at the origin
+ *
+ * \param dims [in] pointer to the dimensions of the box
+ *
+ * \param layout [in] the memory layout, which determines the fastest
+ *        axis and the order in which the lines are visited
+ *
+ * \param numArrays [in] the number of strided arrays, at least one,
+ *        that are walked together
+ *
+ * \param strides [in] pointer to <tt>numArrays</tt> pointers to the
+ *        strides of each array
+ *
+ * \param functor [in/out] a functor with the signature
+ *        <tt>operator()(const dim_type * index, const size_type *
+ *        offsets)</tt>, called once per line.  <tt>index</tt> is the
+ *        index of the first element of the line, and
+ *        <tt>offsets[k]</tt> is the offset of that element within
+ *        array <tt>k</tt>, relative to the first element of the box.
+ *        The functor is responsible for the elements along the line.
+ *
+ * The index and offsets are kept in <tt>std::vector</tt> storage and
+ * updated incrementally, so this function may be called concurrently
+ * from multiple threads.
+ */
+template< class FUNCTOR >
+void walkLines(int numDims,
+               const dim_type * start,
+               const dim_type * dims,
+               Layout layout,
+               int numArrays,
+               const size_type * const * strides,
+               FUNCTOR & functor)
+{
+  if (numDims == 0) return;
+  size_type size = 1;
+  for (int axis = 0; axis < numDims; ++axis) size *= dims[axis];
+  if (size == 0) return;
+
+  int first = (layout == LAST_INDEX_FASTEST) ? numDims - 1 : 0;
+  int last  = (layout == LAST_INDEX_FASTEST) ? 0 : numDims - 1;
+  int step  = (layout == LAST_INDEX_FASTEST) ? -1 : 1;
+  size_type numLines = size / dims[first];
+  std::vector< dim_type > lower(numDims, 0);
+  if (start) lower.assign(start, start + numDims);
+  std::vector< dim_type > index(lower);
+  std::vector< size_type > offsets(numArrays, 0);
+  for (size_type line = 0; line < numLines; ++line)
+  {
+    functor(&index[0], &offsets[0]);
+    for (int axis = first + step; axis != last + step; axis += step)
+    {
+      ++index[axis];
+      for (int k = 0; k < numArrays; ++k) offsets[k] += strides[k][axis];
+      if (index[axis] < lower[axis] + dims[axis]) break;
+      for (int k = 0; k < numArrays; ++k)
+        offsets[k] -= (index[axis] - lower[axis]) * strides[k][axis];
+      index[axis] = lower[axis];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
 /** \brief Return and array of integers that represent the prime
  *         factors of the input argument
  *
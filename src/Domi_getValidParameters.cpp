@@ -305,6 +305,135 @@ RCP< const ParameterList > getValidParameters()
                "freedom are accessed with the last index.",
                padNumberValidator);
 
+    ////////////////////////////////////////////////////////////////
+    // "aligned storage" parameter applies to MDVector
+    ////////////////////////////////////////////////////////////////
+    plist->set("aligned storage",
+               false,
+               "A bool that specifies whether the MDVector data is stored "
+               "with its base pointer aligned to a 64-byte boundary and "
+               "the fastest-varying dimension padded to a multiple of the "
+               "vector width.  The padding is not part of the data.");
+
+    ////////////////////////////////////////////////////////////////
+    // "huge pages" parameter applies to MDVector
+    ////////////////////////////////////////////////////////////////
+    string hugePages = "None";
+
+    Array< string >
+      hugePagesOpts(tuple(string("None"),
+                          string("Transparent"),
+                          string("Explicit")));
+
+    Array< string >
+      hugePagesDocs(tuple(string("Standard pages"),
+                          string("Transparent huge pages, falling back to "
+                                 "standard pages"),
+                          string("Explicit huge pages from the reserved "
+                                 "pool, falling back to transparent huge "
+                                 "pages and then standard pages")));
+
+    Array< int > hugePagesVals(tuple(0, 1, 2));
+
+    RCP< const ParameterEntryValidator > hugePagesValidator =
+      rcp(new StringToIntegralParameterEntryValidator< int >
+                   (hugePagesOpts(),
+                    hugePagesDocs(),
+                    hugePagesVals(),
+                    string("None"),
+                    false));
+
+    plist->set("huge pages",
+               hugePages,
+               "A string indicating whether the MDVector data is backed by "
+               "huge pages.  Huge pages are only used for local data of "
+               "at least 2 MB.",
+               hugePagesValidator);
+
+    ////////////////////////////////////////////////////////////////
+    // "I/O" sublist applies to MDVector
+    ////////////////////////////////////////////////////////////////
+    ParameterList & ioList =
+      plist->sublist("I/O",
+                     false,
+                     "MPI-IO hints used by the binary input and output "
+                     "of an MDVector");
+
+    RCP< EnhancedNumberValidator< int > > ioHintNumber =
+      rcp(new EnhancedNumberValidator< int >());
+    ioHintNumber->setMin(0);
+
+    RCP< const ParameterEntryValidator > ioHintValidator = ioHintNumber;
+
+    ioList.set("striping factor",
+               int(0),
+               "The number of storage targets over which a new file is "
+               "striped (MPI-IO hint 'striping_factor').  Zero leaves "
+               "the choice to the MPI implementation.",
+               ioHintValidator);
+
+    ioList.set("striping unit",
+               int(0),
+               "The size in bytes of the stripes of a new file (MPI-IO "
+               "hint 'striping_unit').  Zero leaves the choice to the "
+               "MPI implementation.",
+               ioHintValidator);
+
+    ioList.set("collective buffering nodes",
+               int(0),
+               "The number of aggregators used for collective buffering "
+               "(MPI-IO hint 'cb_nodes').  Zero leaves the choice to the "
+               "MPI implementation.",
+               ioHintValidator);
+
+    ioList.set("collective buffer size",
+               int(0),
+               "The size in bytes of the buffer of each aggregator "
+               "(MPI-IO hint 'cb_buffer_size').  Zero leaves the choice "
+               "to the MPI implementation.",
+               ioHintValidator);
+
+    string ioSwitch = "Automatic";
+
+    Array< string >
+      ioSwitchOpts(tuple(string("Automatic"),
+                         string("Enable"),
+                         string("Disable")));
+
+    Array< string >
+      ioSwitchDocs(tuple(string("Leave the choice to the MPI implementation"),
+                         string("Always enable"),
+                         string("Always disable")));
+
+    Array< int > ioSwitchVals(tuple(0, 1, 2));
+
+    RCP< const ParameterEntryValidator > ioSwitchValidator =
+      rcp(new StringToIntegralParameterEntryValidator< int >
+                   (ioSwitchOpts(),
+                    ioSwitchDocs(),
+                    ioSwitchVals(),
+                    string("Automatic"),
+                    false));
+
+    ioList.set("collective buffering",
+               ioSwitch,
+               "A string indicating whether collective buffering is used "
+               "for reads and writes (ROMIO hints 'romio_cb_read' and "
+               "'romio_cb_write').",
+               ioSwitchValidator);
+
+    ioList.set("data sieving",
+               ioSwitch,
+               "A string indicating whether data sieving is used for "
+               "independent reads and writes (ROMIO hints "
+               "'romio_ds_read' and 'romio_ds_write').",
+               ioSwitchValidator);
+
+    ioList.sublist("hints",
+                   false,
+                   "Any other MPI-IO hints, which are passed verbatim to "
+                   "the MPI implementation").disableRecursiveValidation();
+
     // ParameterList construction is done, so wrap it with an RCP<
     // const ParameterList >
     result.reset(plist);
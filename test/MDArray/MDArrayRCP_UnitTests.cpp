@@ -169,6 +169,47 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDArrayRCP, copyConstructor, T )
   TEST_EQUALITY(mdar1(1,2),         mdar2(1,2)        );
 }
 
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDArrayRCP, alignedConstructor, T )
+{
+  typedef typename Domi::dim_type dim_type;
+  typedef typename Domi::size_type size_type;
+  MDArrayRCP< T > mdar(tuple< dim_type >(3,4), 12, Domi::DEFAULT_ORDER, true);
+  dim_type width = Domi::ALIGNED_STORAGE_BYTES / sizeof(T);
+  TEST_ASSERT(mdar.isAligned());
+  TEST_EQUALITY(mdar.numDims()   ,  2);
+  TEST_EQUALITY(mdar.dimension(0),  3);
+  TEST_EQUALITY(mdar.dimension(1),  4);
+  TEST_EQUALITY(mdar.allocatedDimension(0), width);
+  TEST_EQUALITY(mdar.allocatedDimension(1), 4);
+  TEST_EQUALITY(mdar.strides()[0],  1);
+  TEST_EQUALITY(mdar.strides()[1], width);
+  TEST_EQUALITY(reinterpret_cast< size_t >(mdar.getRawPtr()) %
+                Domi::ALIGNED_STORAGE_BYTES, 0);
+  for (dim_type j = 0; j < 4; ++j)
+    for (dim_type i = 0; i < 3; ++i)
+      TEST_EQUALITY(mdar(i,j), 12);
+
+  // The size, views, iterators and comparisons skip the alignment
+  // padding
+  TEST_EQUALITY(mdar.size(), 12);
+  MDArrayRCP< T > packed(tuple< dim_type >(3,4), 12);
+  TEST_EQUALITY(mdar, packed);
+  size_type count = 0;
+  for (typename MDArrayRCP< T >::iterator it = mdar.begin();
+       it != mdar.end(); ++it)
+    ++count;
+  TEST_EQUALITY(count, 12);
+
+  // Resizing keeps the storage aligned
+  mdar.resize(tuple< dim_type >(5,2,3));
+  TEST_ASSERT(mdar.isAligned());
+  TEST_EQUALITY(mdar.size(), 30);
+  TEST_EQUALITY(mdar.strides()[1], width);
+  TEST_EQUALITY(mdar.strides()[2], 2*width);
+  TEST_EQUALITY(reinterpret_cast< size_t >(mdar.getRawPtr()) %
+                Domi::ALIGNED_STORAGE_BYTES, 0);
+}
+
 TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDArrayRCP, equalOperator, T )
 {
   MDArrayRCP< T > a = generateMDArrayRCP< T >(3,4);
@@ -548,6 +589,7 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDArrayRCP, toString3D, T )
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayRCP, dimsConstructor, T ) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayRCP, dimsValConstructor, T ) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayRCP, copyConstructor, T ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayRCP, alignedConstructor, T ) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayRCP, equalOperator, T ) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayRCP, equalOperatorMDArray, T ) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayRCP, equalOperatorMDArrayView, T ) \
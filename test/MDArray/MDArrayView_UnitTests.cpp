@@ -43,6 +43,7 @@
 */
 
 #include "MDArray_UnitTest_helpers.hpp"
+#include "Domi_PackUnpack.hpp"
 
 typedef long long long_long_type;
 
@@ -359,6 +360,26 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDArrayView, assign, T )
         TEST_EQUALITY_CONST(av(i,j,k), -1);
 }
 
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDArrayView, packUnpack, T )
+{
+  typedef Domi::Ordinal ord;
+  MDArray< T > a = generateMDArray< T >(3,4,5);
+  MDArrayView< T > av = a()[Slice(1,3)][Slice(4)][Slice(1,5,2)];
+  Array< T > buffer(2*4*2);
+  TEST_EQUALITY_CONST(Domi::packMDArrayView(av, buffer.getRawPtr()), 16);
+  ord n = 0;
+  for (typename MDArrayView< T >::iterator it = av.begin();
+       it != av.end(); ++it, ++n)
+    TEST_EQUALITY(buffer[n], *it);
+  av.assign(-1);
+  TEST_EQUALITY_CONST(Domi::unpackMDArrayView(buffer.getRawPtr(), av), 16);
+  MDArray< T > b = generateMDArray< T >(3,4,5);
+  for (ord k = 0; k < 5; ++k)
+    for (ord j = 0; j < 4; ++j)
+      for (ord i = 0; i < 3; ++i)
+        TEST_EQUALITY(a(i,j,k), b(i,j,k));
+}
+
 TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDArrayView, legalAt, T )
 {
   MDArray< T > a = generateMDArray< T >(2,3);
@@ -457,6 +478,7 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDArrayView, toString3D, T )
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayView, rangeError, T) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayView, rangeErrorCOrder, T) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayView, assign, T) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayView, packUnpack, T) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayView, legalAt, T) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayView, illegalAt, T) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDArrayView, equality, T) \
@@ -44,11 +44,17 @@
 #include "Teuchos_TabularOutputter.hpp"
 #include "Domi_MDArray.hpp"
 
+// Standard includes
+#include <sstream>
+
 namespace
 {
 
 using Domi::MDArray;
+using Domi::MDArrayView;
 using Domi::Ordinal;
+using Domi::Slice;
+using Teuchos::Array;
 using Teuchos::tuple;
 
 int numLoops = 100;
@@ -58,6 +64,8 @@ int MDAdim1 = 10;
 int MDAdim2 = 8;
 int MDAdim3 = 6;
 int MDAdim4 = 4;
+int MDAdim5 = 3;
+int MDAdim6 = 2;
 
 TEUCHOS_STATIC_SETUP()
 {
@@ -264,4 +272,123 @@ TEUCHOS_UNIT_TEST( MDArray, parenOperator4D )
   }
 }
 
+////////////////////////////////////////////////////////////////////////
+
+// Compare the time to traverse an MDArray of the given base
+// dimensions, scaled by each of the given scale factors, using a raw
+// loop over its data buffer, its iterator, and the iterator of a
+// strided (non-contiguous) view that excludes the first and last
+// indexes along the first axis
+void iteratorTimings(Teuchos::FancyOStream & out,
+                     const Array< Ordinal > & baseDims,
+                     const Array< int > & scales)
+{
+  typedef Teuchos::TabularOutputter TO;
+
+  TO outputter(out);
+  outputter.setFieldTypePrecision(TO::DOUBLE, dblPrec);
+  outputter.setFieldTypePrecision(TO::INT,    intPrec);
+
+  outputter.pushFieldSpec("dims"           , TO::STRING);
+  outputter.pushFieldSpec("num loops"      , TO::INT   );
+  outputter.pushFieldSpec("raw loop"       , TO::DOUBLE);
+  outputter.pushFieldSpec("iterator"       , TO::DOUBLE);
+  outputter.pushFieldSpec("strided iterator", TO::DOUBLE);
+
+  outputter.outputHeader();
+
+  for (int test_case_k = 0; test_case_k < scales.size(); ++test_case_k)
+  {
+    Array< Ordinal > dims(baseDims);
+    std::stringstream dimString;
+    for (int axis = 0; axis < dims.size(); ++axis)
+    {
+      dims[axis] *= scales[test_case_k];
+      if (axis > 0) dimString << "x";
+      dimString << dims[axis];
+    }
+
+    // dims
+    outputter.outputField(dimString.str());
+
+    // num loops
+    outputter.outputField(numLoops);
+
+    MDArray< double > mda(dims());
+    Ordinal size = mda.size();
+
+    // raw loop
+    TEUCHOS_START_PERF_OUTPUT_TIMER_INNERLOOP(outputter, numLoops, size)
+    {
+      double * ptr = mda.getRawPtr();
+      for (Ordinal ii=0; ii < size; ++ii)
+        ptr[ii] = 0;
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, rawTime);
+
+    // iterator
+    MDArray< double >::iterator end = mda.end();
+    TEUCHOS_START_PERF_OUTPUT_TIMER_INNERLOOP(outputter, numLoops, size)
+    {
+      for (MDArray< double >::iterator it = mda.begin(); it != end; ++it)
+        *it = 0;
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, iterTime);
+
+    // strided iterator
+    MDArrayView< double > mdav = mda[Slice(1,-1)];
+    MDArrayView< double >::iterator vend = mdav.end();
+    TEUCHOS_START_PERF_OUTPUT_TIMER_INNERLOOP(outputter, numLoops, mdav.size())
+    {
+      for (MDArrayView< double >::iterator it = mdav.begin(); it != vend; ++it)
+        *it = 0;
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, stridedTime);
+
+    outputter.nextRow();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+TEUCHOS_UNIT_TEST( MDArray, iterator1D )
+{
+  iteratorTimings(out, tuple< Ordinal >(MDAdim1),
+                  tuple< int >(10, 100, 1000, 10000));
+}
+
+TEUCHOS_UNIT_TEST( MDArray, iterator2D )
+{
+  iteratorTimings(out, tuple< Ordinal >(MDAdim1, MDAdim2),
+                  tuple< int >(1, 2, 5, 10));
+}
+
+TEUCHOS_UNIT_TEST( MDArray, iterator3D )
+{
+  iteratorTimings(out, tuple< Ordinal >(MDAdim1, MDAdim2, MDAdim3),
+                  tuple< int >(1, 2, 3, 4));
+}
+
+TEUCHOS_UNIT_TEST( MDArray, iterator4D )
+{
+  iteratorTimings(out, tuple< Ordinal >(MDAdim1, MDAdim2, MDAdim3, MDAdim4),
+                  tuple< int >(1, 2, 3));
+}
+
+TEUCHOS_UNIT_TEST( MDArray, iterator5D )
+{
+  iteratorTimings(out,
+                  tuple< Ordinal >(MDAdim1, MDAdim2, MDAdim3, MDAdim4,
+                                   MDAdim5),
+                  tuple< int >(1, 2));
+}
+
+TEUCHOS_UNIT_TEST( MDArray, iterator6D )
+{
+  iteratorTimings(out,
+                  tuple< Ordinal >(MDAdim1, MDAdim2, MDAdim3, MDAdim4,
+                                   MDAdim5, MDAdim6),
+                  tuple< int >(1, 2));
+}
+
 }
@@ -2678,4 +2678,50 @@ TEUCHOS_UNIT_TEST( MDMap, contiguous )
     TEST_EQUALITY(slicedMap.isContiguous(), (num_dims==1));
 }
 
+TEUCHOS_UNIT_TEST( MDMap, compatibility )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, num_dims, commDims));
+  Teuchos::RCP< const Domi::MDComm > otherMdComm =
+    Teuchos::rcp(new MDComm(comm, num_dims, commDims));
+
+  // Ensure that the commDims are completely specified
+  commDims.resize(num_dims);
+  for (int axis = 0; axis < num_dims; ++axis)
+    commDims[axis] = mdComm->getCommDim(axis);
+
+  // Construct MDMaps with the same and different global structure
+  Array< dim_type > dimensions(num_dims);
+  Array< dim_type > otherDimensions(num_dims);
+  Array< int >      commPad(num_dims,2);
+  for (int axis = 0; axis < num_dims; ++axis)
+  {
+    dimensions[axis]      = 8 * commDims[axis];
+    otherDimensions[axis] = 8 * commDims[axis] + 1;
+  }
+  MDMap mdMap(mdComm, dimensions);
+  MDMap paddedMap(mdComm, dimensions, commPad);
+  MDMap otherCommMap(otherMdComm, dimensions);
+  MDMap otherDimsMap(mdComm, otherDimensions);
+  MDMap copyMap(mdMap);
+
+  // The fingerprints depend only on the global structure
+  TEST_EQUALITY(mdMap.getFingerprint(), paddedMap.getFingerprint()   );
+  TEST_EQUALITY(mdMap.getFingerprint(), otherCommMap.getFingerprint());
+  TEST_EQUALITY(mdMap.getFingerprint(), copyMap.getFingerprint()     );
+  TEST_INEQUALITY(mdMap.getFingerprint(), otherDimsMap.getFingerprint());
+
+  // Test compatibility, twice for the MDMap on a different MDComm so
+  // that the cached result is used
+  TEST_ASSERT(mdMap.isCompatible(mdMap));
+  TEST_ASSERT(mdMap.isCompatible(paddedMap));
+  TEST_ASSERT(mdMap.isCompatible(copyMap));
+  TEST_ASSERT(mdMap.isCompatible(otherCommMap));
+  TEST_ASSERT(mdMap.isCompatible(otherCommMap));
+  TEST_ASSERT(! mdMap.isCompatible(otherDimsMap));
+}
+
 }  // namespace
@@ -0,0 +1,402 @@
+/*
+// @HEADER
+// ***********************************************************************
+//
+//     Domi: Multi-dimensional Distributed Linear Algebra Services
+//                 Copyright (2014) Sandia Corporation
+//
+// Under the terms of Contract DE-AC04-94AL85000 with Sandia
+// Corporation, the U.S. Government retains certain rights in this
+// software.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// 3. Neither the name of the Corporation nor the names of the
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY SANDIA CORPORATION "AS IS" AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SANDIA CORPORATION OR THE
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Questions? Contact William F. Spotz (wfspotz@sandia.gov)
+//
+// ***********************************************************************
+// @HEADER
+*/
+
+// Teuchos includes
+#include "Teuchos_UnitTestHarness.hpp"
+#include "Teuchos_TabularOutputter.hpp"
+#include "Teuchos_DefaultComm.hpp"
+#include "Teuchos_Array.hpp"
+
+// Domi includes
+#include "Domi_ConfigDefs.hpp"
+#include "Domi_Utils.hpp"
+#include "Domi_MDVector.hpp"
+#include "Domi_Threads.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+using std::string;
+using Teuchos::Array;
+using Domi::MDArrayView;
+using Domi::MDMap;
+using Domi::MDVector;
+typedef Domi::dim_type dim_type;
+typedef Domi::size_type size_type;
+using Domi::splitStringOfIntsWithCommas;
+
+string dims     = "64,64,64";
+string commDims = "-1";
+int    commPad  = 2;
+string periodic = "1,1,1";
+int    numLoops = 100;
+int    intPrec  = 8;
+int    dblPrec  = 6;
+
+////////////////////////////////////////////////////////////////////////
+
+TEUCHOS_STATIC_SETUP()
+{
+  Teuchos::CommandLineProcessor &clp = Teuchos::UnitTestRepository::getCLP();
+  clp.addOutputSetupOptions(true);
+  clp.setOption("dims"    , &dims,
+                "Comma-separated global dimensions of MDVector");
+  clp.setOption("commDims", &commDims,
+                "Comma-separated number of processors along each axis");
+  clp.setOption("commPad" , &commPad,
+                "CommPad size along every axis");
+  clp.setOption("periodic", &periodic,
+                "Comma-separated list of axis periodicity flags (use 0,1)");
+  clp.setOption("numLoops", &numLoops,
+                "Number of timing loops");
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Compare the cost of updating the communication padding along each
+// axis using MPI subarray data types against the cost of using packed
+// contiguous buffers.  For the packed messages, the pack and unpack
+// times are measured separately, using the communication pad regions
+// (which have the same shapes and strides as the send regions), and
+// the transfer time is the remainder of the packed update time.
+TEUCHOS_UNIT_TEST( MDVector, commPadPerAxis )
+{
+  typedef Teuchos::TabularOutputter TO;
+
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+
+  // Construct the MDVector
+  Array< dim_type > dimVals     = splitStringOfIntsWithCommas(dims);
+  Array< int >      commDimVals = splitStringOfIntsWithCommas(commDims);
+  Array< int >      periodicVals = splitStringOfIntsWithCommas(periodic);
+  periodicVals.resize(dimVals.size(), 0);
+  Teuchos::ParameterList plist;
+  plist.set("comm dimensions"       , commDimVals );
+  plist.set("periodic"              , periodicVals);
+  plist.set("dimensions"            , dimVals     );
+  plist.set("communication pad size", commPad     );
+  MDVector< double > mdVector(comm, plist);
+  mdVector.putScalar(1.0);
+  int numDims = mdVector.numDims();
+
+  TO outputter(out);
+  outputter.setFieldTypePrecision(TO::DOUBLE, dblPrec);
+  outputter.setFieldTypePrecision(TO::INT,    intPrec);
+
+  outputter.pushFieldSpec("axis"       , TO::INT   );
+  outputter.pushFieldSpec("pad size"   , TO::INT   );
+  outputter.pushFieldSpec("num loops"  , TO::INT   );
+  outputter.pushFieldSpec("datatype"   , TO::DOUBLE);
+  outputter.pushFieldSpec("pack"       , TO::DOUBLE);
+  outputter.pushFieldSpec("unpack"     , TO::DOUBLE);
+  outputter.pushFieldSpec("packed"     , TO::DOUBLE);
+  outputter.pushFieldSpec("transfer"   , TO::DOUBLE);
+
+  outputter.outputHeader();
+
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    MDArrayView< double > lowerPad = mdVector.getLowerPadDataNonConst(axis);
+    MDArrayView< double > upperPad = mdVector.getUpperPadDataNonConst(axis);
+    size_type lowerSize = Domi::computeSize(lowerPad.dimensions());
+    size_type upperSize = Domi::computeSize(upperPad.dimensions());
+    Array< double > buffer(lowerSize + upperSize);
+
+    // axis
+    outputter.outputField(axis);
+
+    // pad size
+    outputter.outputField(int(lowerSize + upperSize));
+
+    // num loops
+    outputter.outputField(numLoops);
+
+    // datatype
+    mdVector.setPackedCommPad(axis, false);
+    comm->barrier();
+    TEUCHOS_START_PERF_OUTPUT_TIMER(outputter, numLoops)
+    {
+      mdVector.updateCommPad(axis);
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, datatypeTime);
+
+    // pack
+    TEUCHOS_START_PERF_OUTPUT_TIMER(outputter, numLoops)
+    {
+      Domi::packMDArrayView(lowerPad, buffer.getRawPtr());
+      Domi::packMDArrayView(upperPad, buffer.getRawPtr() + lowerSize);
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, packTime);
+
+    // unpack
+    TEUCHOS_START_PERF_OUTPUT_TIMER(outputter, numLoops)
+    {
+      Domi::unpackMDArrayView(buffer.getRawPtr(), lowerPad);
+      Domi::unpackMDArrayView(buffer.getRawPtr() + lowerSize, upperPad);
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, unpackTime);
+
+    // packed
+    mdVector.setPackedCommPad(axis, true);
+    comm->barrier();
+    TEUCHOS_START_PERF_OUTPUT_TIMER(outputter, numLoops)
+    {
+      mdVector.updateCommPad(axis);
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, packedTime);
+
+    // transfer
+    outputter.outputField(packedTime - packTime - unpackTime);
+
+    outputter.nextRow();
+  }
+
+  // The packed and unpacked updates must produce the same result
+  TEST_EQUALITY_CONST(mdVector.normInf(), 1.0);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Touch every element of an MDVector on the calling thread only, the
+// way a zero fill at allocation does
+void serialTouch(MDVector< double > & mdVector)
+{
+  MDArrayView< double > data = mdVector.getDataNonConst();
+  for (MDArrayView< double >::iterator it = data.begin();
+       it != data.end(); ++it)
+    *it = 1.0;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Compare the bandwidth of threaded putScalar() and dot() on
+// MDVectors whose memory was first touched serially by the
+// allocating thread against MDVectors whose memory was first touched
+// by a threaded putScalar(), with the same thread partitioning as the
+// kernels being timed.  The difference is only expected on
+// multi-socket nodes with more than one NUMA domain, in builds with
+// OpenMP.
+TEUCHOS_UNIT_TEST( MDVector, firstTouch )
+{
+  typedef Teuchos::TabularOutputter TO;
+
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+
+  // Construct the MDMap
+  Array< dim_type > dimVals     = splitStringOfIntsWithCommas(dims);
+  Array< int >      commDimVals = splitStringOfIntsWithCommas(commDims);
+  Array< int >      periodicVals = splitStringOfIntsWithCommas(periodic);
+  periodicVals.resize(dimVals.size(), 0);
+  Teuchos::ParameterList plist;
+  plist.set("comm dimensions"       , commDimVals );
+  plist.set("periodic"              , periodicVals);
+  plist.set("dimensions"            , dimVals     );
+  plist.set("communication pad size", commPad     );
+  Teuchos::RCP< const MDMap > mdMap = Teuchos::rcp(new MDMap(comm, plist));
+
+  // Compute the number of bytes moved by each kernel
+  double putBytes = sizeof(double);
+  double dotBytes = 2 * sizeof(double);
+  double globalSize = 1.0;
+  for (int axis = 0; axis < mdMap->numDims(); ++axis)
+  {
+    putBytes   *= mdMap->getLocalDim(axis,true );
+    dotBytes   *= mdMap->getLocalDim(axis,false);
+    globalSize *= mdMap->getGlobalDim(axis);
+  }
+
+  TO outputter(out);
+  outputter.setFieldTypePrecision(TO::DOUBLE, dblPrec);
+  outputter.setFieldTypePrecision(TO::INT,    intPrec);
+
+  outputter.pushFieldSpec("first touch", TO::STRING);
+  outputter.pushFieldSpec("num threads", TO::INT   );
+  outputter.pushFieldSpec("num loops"  , TO::INT   );
+  outputter.pushFieldSpec("putScalar"  , TO::DOUBLE);
+  outputter.pushFieldSpec("dot"        , TO::DOUBLE);
+  outputter.pushFieldSpec("put GB/s"   , TO::DOUBLE);
+  outputter.pushFieldSpec("dot GB/s"   , TO::DOUBLE);
+
+  outputter.outputHeader();
+
+  for (int threaded = 0; threaded < 2; ++threaded)
+  {
+    // Construct the MDVectors without initializing them, and then
+    // touch their memory either serially or with threads
+    MDVector< double > u(mdMap, false);
+    MDVector< double > v(mdMap, false);
+    if (threaded)
+    {
+      u.putScalar(1.0);
+      v.putScalar(1.0);
+    }
+    else
+    {
+      serialTouch(u);
+      serialTouch(v);
+    }
+
+    // first touch
+    outputter.outputField(string(threaded ? "threaded" : "serial"));
+
+    // num threads
+    outputter.outputField(Domi::getNumThreads());
+
+    // num loops
+    outputter.outputField(numLoops);
+
+    // putScalar
+    comm->barrier();
+    TEUCHOS_START_PERF_OUTPUT_TIMER(outputter, numLoops)
+    {
+      u.putScalar(1.0);
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, putTime);
+
+    // dot
+    double result = 0.0;
+    comm->barrier();
+    TEUCHOS_START_PERF_OUTPUT_TIMER(outputter, numLoops)
+    {
+      result = u.dot(v);
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, dotTime);
+
+    // put GB/s
+    outputter.outputField(putBytes / putTime * 1.0e-9);
+
+    // dot GB/s
+    outputter.outputField(dotBytes / dotTime * 1.0e-9);
+
+    outputter.nextRow();
+
+    TEST_EQUALITY(result, globalSize);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Measure the bandwidth of writeBinary() and readBinary(), for
+// MDVectors without communication padding, whose local data is
+// contiguous, and with communication padding, whose local data is
+// transferred one contiguous run at a time in serial builds.  The
+// bandwidth is the global data size divided by the transfer time.
+TEUCHOS_UNIT_TEST( MDVector, binaryIO )
+{
+  typedef Teuchos::TabularOutputter TO;
+
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+
+  Array< dim_type > dimVals     = splitStringOfIntsWithCommas(dims);
+  Array< int >      commDimVals = splitStringOfIntsWithCommas(commDims);
+  std::string filename = "MDVector_binaryIO.bin";
+
+  TO outputter(out);
+  outputter.setFieldTypePrecision(TO::DOUBLE, dblPrec);
+  outputter.setFieldTypePrecision(TO::INT,    intPrec);
+
+  outputter.pushFieldSpec("comm pad"   , TO::INT   );
+  outputter.pushFieldSpec("num loops"  , TO::INT   );
+  outputter.pushFieldSpec("write"      , TO::DOUBLE);
+  outputter.pushFieldSpec("read"       , TO::DOUBLE);
+  outputter.pushFieldSpec("write GB/s" , TO::DOUBLE);
+  outputter.pushFieldSpec("read GB/s"  , TO::DOUBLE);
+
+  outputter.outputHeader();
+
+  for (int padded = 0; padded < 2; ++padded)
+  {
+    // Construct the MDMap and the MDVectors
+    Teuchos::ParameterList plist;
+    plist.set("comm dimensions"       , commDimVals );
+    plist.set("dimensions"            , dimVals     );
+    plist.set("communication pad size", padded ? commPad : 0);
+    Teuchos::RCP< const MDMap > mdMap = Teuchos::rcp(new MDMap(comm, plist));
+    MDVector< double > u(mdMap);
+    MDVector< double > v(mdMap);
+    u.putScalar(1.0);
+    double globalBytes = sizeof(double);
+    for (int axis = 0; axis < mdMap->numDims(); ++axis)
+      globalBytes *= mdMap->getGlobalDim(axis);
+
+    // comm pad
+    outputter.outputField(padded ? commPad : 0);
+
+    // num loops
+    outputter.outputField(numLoops);
+
+    // write
+    comm->barrier();
+    TEUCHOS_START_PERF_OUTPUT_TIMER(outputter, numLoops)
+    {
+      u.writeBinary(filename);
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, writeTime);
+
+    // read
+    comm->barrier();
+    TEUCHOS_START_PERF_OUTPUT_TIMER(outputter, numLoops)
+    {
+      v.readBinary(filename);
+    }
+    TEUCHOS_END_PERF_OUTPUT_TIMER(outputter, readTime);
+
+    // write GB/s
+    outputter.outputField(globalBytes / writeTime * 1.0e-9);
+
+    // read GB/s
+    outputter.outputField(globalBytes / readTime * 1.0e-9);
+
+    outputter.nextRow();
+
+    TEST_EQUALITY(v.dot(u), globalBytes / sizeof(double));
+  }
+}
+
+}
@@ -43,7 +43,10 @@
 */
 
 // System include
+#include <cstdio>
 #include <cstdlib>
+#include <limits>
+#include <sstream>
 
 // Teuchos includes
 #include "Teuchos_UnitTestHarness.hpp"
@@ -54,6 +57,12 @@
 #include "Domi_ConfigDefs.hpp"
 #include "Domi_Utils.hpp"
 #include "Domi_MDVector.hpp"
+#include "Domi_ReductionBatch.hpp"
+#include "Domi_Redistributor.hpp"
+#include "Domi_Threads.hpp"
+#include "Domi_Stencil.hpp"
+#include "Domi_IOConfig.hpp"
+#include "Domi_TimeSeries.hpp"
 
 typedef long long long_long_type;
 
@@ -198,6 +207,15 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, dimensionsConstructor, Sca )
     TEST_COMPARE(std::abs(mdVector.normWeighted(mdVector) -
                           std::pow(scalar, 3./2.)        ), <, tolerance);
     TEST_COMPARE(std::abs(mdVector.meanValue()   - scalar), <, tolerance);
+
+    // Test compensated summation and the fused norms
+    TEST_COMPARE(std::abs(mdVector.dot(mdVector, true) - dot), <, tolerance);
+    TEST_COMPARE(std::abs(mdVector.norm2(true) - norm2), <, tolerance);
+    typename Teuchos::ScalarTraits< Sca >::magnitudeType n1, n2, nInf;
+    mdVector.norms(n1, n2, nInf);
+    TEST_COMPARE(std::abs(n1   - norm1 ), <, tolerance);
+    TEST_COMPARE(std::abs(n2   - norm2 ), <, tolerance);
+    TEST_COMPARE(std::abs(nInf - scalar), <, tolerance);
   }
 
 #ifdef HAVE_EPETRA
@@ -943,6 +961,1630 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, randomize, Sca )
   
 }
 
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, reductionBatch, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct dimensions
+  dim_type localDim = 10;
+  Array< dim_type > dims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+
+  // Construct an MDMap and two MDVectors
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims()));
+  MDVector< Sca > mdVector1(mdMap);
+  MDVector< Sca > mdVector2(mdMap);
+  mdVector1.putScalar(3);
+  mdVector2.putScalar(2);
+
+  // Enqueue several reductions and perform a blocking reduction
+  Domi::ReductionBatch< Sca > batch(comm);
+  int dot12  = batch.addDot(mdVector1, mdVector2);
+  int norm1  = batch.addNorm1(mdVector1);
+  int norm2  = batch.addNorm2(mdVector2);
+  int normI  = batch.addNormInf(mdVector1);
+  int mean2  = batch.addMeanValue(mdVector2);
+  TEST_EQUALITY_CONST(batch.size(), 5);
+  batch.reduce();
+
+  // The batched sums may be accumulated in a different order than
+  // the individual reductions, so compare them with a tolerance
+  typedef typename Teuchos::ScalarTraits< Sca >::magnitudeType mag;
+  mag tol = 1.0e-12;
+  TEST_FLOATING_EQUALITY(batch.getScalar(dot12), mdVector1.dot(mdVector2), tol);
+  TEST_FLOATING_EQUALITY(batch.getNorm(norm1)  , mdVector1.norm1()       , tol);
+  TEST_FLOATING_EQUALITY(batch.getNorm(norm2)  , mdVector2.norm2()       , tol);
+  TEST_EQUALITY(batch.getNorm(normI), mdVector1.normInf());
+  TEST_FLOATING_EQUALITY(batch.getScalar(mean2), mdVector2.meanValue()   , tol);
+  TEST_THROW(batch.getNorm(dot12), Domi::InvalidArgument);
+  TEST_THROW(batch.getScalar(5)  , Domi::RangeError     );
+
+  // Reuse the batch for a non-blocking reduction
+  batch.clear();
+  int dot11 = batch.addDot(mdVector1, mdVector1);
+  int normW = batch.addNormWeighted(mdVector1, mdVector2);
+  batch.startReduce();
+#ifdef DOMI_HAVE_MPI_IALLREDUCE
+  TEST_THROW(batch.addNorm1(mdVector1), Domi::InvalidArgument);
+#endif
+  batch.endReduce();
+  TEST_ASSERT(batch.isComplete());
+  TEST_FLOATING_EQUALITY(batch.getScalar(dot11),
+                         mdVector1.dot(mdVector1), tol);
+  TEST_FLOATING_EQUALITY(batch.getNorm(normW),
+                         mdVector1.normWeighted(mdVector2), tol);
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, threadedKernels, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct dimensions large enough that the local kernels are
+  // partitioned among threads
+  dim_type localDim = 20000;
+  if (numDims == 2) localDim = 150;
+  if (numDims >= 3) localDim = 30;
+  Array< dim_type > dims(numDims);
+  size_type globalSize = 1;
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+    globalSize *= dims[axis];
+  }
+
+  // Construct an MDMap and an MDVector, and fill and copy it
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims()));
+  MDVector< Sca > mdVector(mdMap);
+  mdVector.putScalar(2);
+  MDVector< Sca > mdVectorCopy(mdVector, Teuchos::Copy);
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  MDArrayView< const Sca > view = mdVectorCopy.getData();
+  for (const_iterator it = view.cbegin(); it != view.cend(); ++it)
+    TEST_EQUALITY_CONST(*it, 2);
+
+  // The reductions are exact for these values, so they must not
+  // depend on the partitioning of the data
+  typedef typename Teuchos::ScalarTraits< Sca >::magnitudeType mag;
+  TEST_EQUALITY(mdVector.norm1()  , mag(2*globalSize));
+  TEST_EQUALITY(mdVector.normInf(), mag(2)           );
+  TEST_EQUALITY(mdVector.dot(mdVectorCopy), Sca(4*globalSize));
+  Domi::setDeterministicReductions(true);
+  TEST_ASSERT(Domi::getDeterministicReductions());
+  TEST_EQUALITY(mdVector.norm1()  , mag(2*globalSize));
+  TEST_EQUALITY(mdVector.normInf(), mag(2)           );
+  TEST_EQUALITY(mdVector.dot(mdVectorCopy), Sca(4*globalSize));
+  Domi::setDeterministicReductions(false);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Functor that computes the Laplacian of a neighborhood of any
+// dimension.  The offsets of the stencil points, and views of them,
+// are built by the constructor, so that applying the functor in
+// parallel constructs no Teuchos objects.
+template< class Sca >
+struct LaplacianFunctor
+{
+  LaplacianFunctor(int nd) :
+    numDims(nd),
+    offsets((2*nd+1)*nd, 0),
+    views(2*nd+1)
+  {
+    for (int axis = 0; axis < numDims; ++axis)
+    {
+      offsets[(2*axis+1)*numDims+axis] = -1;
+      offsets[(2*axis+2)*numDims+axis] =  1;
+    }
+    for (int point = 0; point < views.size(); ++point)
+      views[point] = offsets(point*numDims, numDims);
+  }
+  Sca operator()(const Domi::StencilNeighborhood< Sca > & u) const
+  {
+    Sca result = -2 * numDims * u(views[0]);
+    for (int point = 1; point < views.size(); ++point)
+      result += u(views[point]);
+    return result;
+  }
+  int numDims;
+  Array< int > offsets;
+  Array< Teuchos::ArrayView< const int > > views;
+};
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, stencil, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct dimensions and communication padding
+  dim_type localDim = 10;
+  Array< dim_type > dims(numDims);
+  Array< int > commPad(numDims, 1);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+
+  // Construct an MDMap and MDVectors
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+  MDVector< Sca > u(mdMap);
+  MDVector< Sca > lap(mdMap);
+  MDVector< Sca > lapSplit(mdMap);
+  MDVector< Sca > lapFunctor(mdMap);
+  lap.putScalar(-1);
+  lapSplit.putScalar(-1);
+  lapFunctor.putScalar(-1);
+
+  // Fill u with a linear function of the global indexes, whose
+  // Laplacian is zero
+  Array< dim_type > origin(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    origin[axis] = mdMap->getGlobalRankBounds(axis,false).start() -
+                   mdMap->getLowerPadSize(axis);
+  MDArrayView< Sca > data = u.getDataNonConst();
+  for (typename MDArrayView< Sca >::iterator it = data.begin();
+       it != data.end(); ++it)
+  {
+    Sca value = 0;
+    for (int axis = 0; axis < numDims; ++axis)
+      value += (axis+1) * (origin[axis] + it.index(axis));
+    *it = value;
+  }
+  u.updateCommPad();
+
+  // Construct the Laplacian stencil
+  Domi::Stencil< Sca > stencil(numDims);
+  Array< int > offset(numDims, 0);
+  stencil.addPoint(offset(), -2 * numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    offset[axis] = -1;
+    stencil.addPoint(offset());
+    offset[axis] =  1;
+    stencil.addPoint(offset());
+    offset[axis] =  0;
+  }
+  stencil.setBlockSize(3);
+  TEST_EQUALITY(stencil.numPoints(), 2*numDims+1);
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    TEST_EQUALITY_CONST(stencil.getLowerRadius(axis), 1);
+    TEST_EQUALITY_CONST(stencil.getUpperRadius(axis), 1);
+  }
+
+  // Apply the stencil over the whole interior, over the inner and
+  // boundary regions separately, and with a functor
+  stencil.apply(u, lap);
+  stencil.apply(u, lapSplit, Domi::STENCIL_INNER);
+  stencil.apply(u, lapSplit, Domi::STENCIL_BOUNDARY);
+  LaplacianFunctor< Sca > functor(numDims);
+  stencil.apply(u, lapFunctor, functor);
+
+  // The input and output may not share data
+  TEST_THROW(stencil.apply(u, u), Domi::InvalidArgument);
+
+  // The results are zero over the interior and untouched elsewhere
+  Array< Slice > interior = stencil.getBounds(u, Domi::STENCIL_INTERIOR);
+  MDArrayView< const Sca > lapData        = lap.getData();
+  MDArrayView< const Sca > lapSplitData   = lapSplit.getData();
+  MDArrayView< const Sca > lapFunctorData = lapFunctor.getData();
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  const_iterator sit = lapSplitData.cbegin();
+  const_iterator fit = lapFunctorData.cbegin();
+  for (const_iterator it = lapData.cbegin(); it != lapData.cend();
+       ++it, ++sit, ++fit)
+  {
+    bool inside = true;
+    for (int axis = 0; axis < numDims; ++axis)
+      if (it.index(axis) <  interior[axis].start() ||
+          it.index(axis) >= interior[axis].stop()) inside = false;
+    TEST_EQUALITY(*it, (inside ? Sca(0) : Sca(-1)));
+    TEST_EQUALITY(*sit, *it);
+    TEST_EQUALITY(*fit, *it);
+  }
+
+  // The boundary boxes and the inner region cover the interior
+  Array< Slice > inner = stencil.getBounds(u, Domi::STENCIL_INNER);
+  Array< Array< Slice > > boundary = stencil.getBoundaryBounds(u);
+  size_type interiorSize = 1;
+  size_type coveredSize  = 1;
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    interiorSize *= interior[axis].stop() - interior[axis].start();
+    coveredSize  *= inner[axis].stop() - inner[axis].start();
+  }
+  for (int box = 0; box < boundary.size(); ++box)
+  {
+    size_type boxSize = 1;
+    for (int axis = 0; axis < numDims; ++axis)
+      boxSize *= boundary[box][axis].stop() - boundary[box][axis].start();
+    coveredSize += boxSize;
+  }
+  TEST_EQUALITY(coveredSize, interiorSize);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Kernel that computes the Laplacian of an MDVector over a box and
+// counts the number of times each point is computed
+template< class Sca >
+struct LaplacianKernel
+{
+  const MDVector< Sca > * input;
+  MDVector< Sca > * output;
+  MDVector< Sca > * count;
+  void operator()(const ArrayView< const Slice > & bounds) const
+  {
+    int numDims = input->numDims();
+    MDArrayView< const Sca > in = input->getData();
+    MDArrayView< Sca > out = output->getDataNonConst();
+    MDArrayView< Sca > cnt = count->getDataNonConst();
+    typename MDArrayView< Sca >::iterator cit = cnt.begin();
+    for (typename MDArrayView< Sca >::iterator it = out.begin();
+         it != out.end(); ++it, ++cit)
+    {
+      bool inside = true;
+      size_type offset = 0;
+      for (int axis = 0; axis < numDims; ++axis)
+      {
+        if (it.index(axis) <  bounds[axis].start() ||
+            it.index(axis) >= bounds[axis].stop()) inside = false;
+        offset += it.index(axis) * in.strides()[axis];
+      }
+      if (! inside) continue;
+      const Sca * center = in.getRawPtr() + offset;
+      Sca result = -2 * numDims * center[0];
+      for (int axis = 0; axis < numDims; ++axis)
+        result += center[-in.strides()[axis]] + center[in.strides()[axis]];
+      *it = result;
+      *cit += 1;
+    }
+  }
+};
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, updateCommPadAndApply, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct dimensions and communication padding
+  dim_type localDim = 8;
+  Array< dim_type > dims(numDims);
+  Array< int > commPad(numDims, 1);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+
+  // Construct an MDMap and MDVectors
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+  MDVector< Sca > u(mdMap);
+  MDVector< Sca > lap(mdMap);
+  MDVector< Sca > count(mdMap);
+  lap.putScalar(-1);
+
+  // Fill the owned points of u with a linear function of the global
+  // indexes, whose Laplacian is zero
+  Array< dim_type > origin(numDims);
+  Array< Slice > owned(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    origin[axis] = mdMap->getGlobalRankBounds(axis,false).start() -
+                   mdMap->getLowerPadSize(axis);
+    owned[axis] = mdMap->getLocalBounds(axis);
+  }
+  MDArrayView< Sca > data = u.getDataNonConst();
+  for (typename MDArrayView< Sca >::iterator it = data.begin();
+       it != data.end(); ++it)
+  {
+    Sca value = 0;
+    bool inside = true;
+    for (int axis = 0; axis < numDims; ++axis)
+    {
+      value += (axis+1) * (origin[axis] + it.index(axis));
+      if (it.index(axis) <  owned[axis].start() ||
+          it.index(axis) >= owned[axis].stop()) inside = false;
+    }
+    if (inside) *it = value;
+  }
+
+  // Check the deep interior and the boundary shell
+  Array< Array< Slice > > shell = u.getLocalBoundaryShellBounds();
+  size_type interiorSize = 1;
+  size_type coveredSize  = 1;
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    Slice interior = u.getLocalInteriorBounds(axis);
+    Slice deep     = u.getLocalDeepInteriorBounds(axis);
+    TEST_ASSERT(deep.start() >= interior.start());
+    TEST_ASSERT(deep.stop()  <= interior.stop() );
+    if (u.getLowerNeighbor(axis) >= 0)
+      TEST_ASSERT(deep.start() >= u.getLowerPadSize(axis) + 1);
+    interiorSize *= interior.stop() - interior.start();
+    coveredSize  *= deep.stop() - deep.start();
+  }
+  for (int box = 0; box < shell.size(); ++box)
+  {
+    size_type boxSize = 1;
+    for (int axis = 0; axis < numDims; ++axis)
+      boxSize *= shell[box][axis].stop() - shell[box][axis].start();
+    coveredSize += boxSize;
+  }
+  TEST_EQUALITY(coveredSize, interiorSize);
+
+  // Compute the Laplacian while updating the communication padding.
+  // Every interior point is computed exactly once, and the result is
+  // zero because the communication padding was up to date when the
+  // boundary shell was computed.
+  LaplacianKernel< Sca > kernel;
+  kernel.input  = &u;
+  kernel.output = &lap;
+  kernel.count  = &count;
+  u.updateCommPadAndApply(kernel);
+  Array< Slice > interior(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    interior[axis] = u.getLocalInteriorBounds(axis);
+  MDArrayView< const Sca > lapData   = lap.getData();
+  MDArrayView< const Sca > countData = count.getData();
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  const_iterator cit = countData.cbegin();
+  for (const_iterator it = lapData.cbegin(); it != lapData.cend();
+       ++it, ++cit)
+  {
+    bool inside = true;
+    for (int axis = 0; axis < numDims; ++axis)
+      if (it.index(axis) <  interior[axis].start() ||
+          it.index(axis) >= interior[axis].stop()) inside = false;
+    TEST_EQUALITY(*it , (inside ? Sca(0) : Sca(-1)));
+    TEST_EQUALITY(*cit, (inside ? Sca(1) : Sca(0) ));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Kernel that adds the Laplacian of an MDVector to itself over a box
+template< class Sca >
+struct SmoothKernel
+{
+  const MDVector< Sca > * input;
+  MDVector< Sca > * output;
+  void operator()(const ArrayView< const Slice > & bounds) const
+  {
+    int numDims = input->numDims();
+    MDArrayView< const Sca > in = input->getData();
+    MDArrayView< Sca > out = output->getDataNonConst();
+    for (typename MDArrayView< Sca >::iterator it = out.begin();
+         it != out.end(); ++it)
+    {
+      bool inside = true;
+      size_type offset = 0;
+      for (int axis = 0; axis < numDims; ++axis)
+      {
+        if (it.index(axis) <  bounds[axis].start() ||
+            it.index(axis) >= bounds[axis].stop()) inside = false;
+        offset += it.index(axis) * in.strides()[axis];
+      }
+      if (! inside) continue;
+      const Sca * center = in.getRawPtr() + offset;
+      Sca result = (1 - 2 * numDims) * center[0];
+      for (int axis = 0; axis < numDims; ++axis)
+        result += center[-in.strides()[axis]] + center[in.strides()[axis]];
+      *it = result;
+    }
+  }
+};
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, temporalBlocking, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct dimensions and communication padding wide enough for
+  // two sweeps of a stencil of radius one
+  dim_type localDim = 8;
+  Array< dim_type > dims(numDims);
+  Array< int > commPad(numDims, 2);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+
+  // Construct an MDMap and MDVectors
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+  MDVector< Sca > u(mdMap);
+  MDVector< Sca > w(mdMap);
+
+  // Fill the owned points of u with a linear function of the global
+  // indexes, which is not changed by adding its Laplacian
+  Array< dim_type > origin(numDims);
+  Array< Slice > owned(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    origin[axis] = mdMap->getGlobalRankBounds(axis,false).start() -
+                   mdMap->getLowerPadSize(axis);
+    owned[axis] = mdMap->getLocalBounds(axis);
+  }
+  MDArrayView< Sca > data = u.getDataNonConst();
+  typedef typename MDArrayView< Sca >::iterator iterator;
+  for (iterator it = data.begin(); it != data.end(); ++it)
+  {
+    Sca value = 0;
+    bool inside = true;
+    for (int axis = 0; axis < numDims; ++axis)
+    {
+      value += (axis+1) * (origin[axis] + it.index(axis));
+      if (it.index(axis) <  owned[axis].start() ||
+          it.index(axis) >= owned[axis].stop()) inside = false;
+    }
+    if (inside) *it = value;
+  }
+
+  // Update one layer of the communication padding, and check that
+  // exactly that layer, including edges and corners, has been updated
+  u.updateCommPadWidth(1);
+  for (iterator it = data.begin(); it != data.end(); ++it)
+  {
+    Sca value = 0;
+    bool inside = true;
+    for (int axis = 0; axis < numDims; ++axis)
+    {
+      value += (axis+1) * (origin[axis] + it.index(axis));
+      dim_type start = owned[axis].start();
+      dim_type stop  = owned[axis].stop();
+      if (u.getLowerNeighbor(axis) >= 0) start -= 1;
+      if (u.getUpperNeighbor(axis) >= 0) stop  += 1;
+      if (it.index(axis) < start || it.index(axis) >= stop) inside = false;
+    }
+    TEST_EQUALITY(*it, (inside ? value : Sca(0)));
+  }
+
+  // Check the extended interior bounds
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    Slice interior = u.getLocalInteriorBounds(axis);
+    TEST_EQUALITY(u.getLocalInteriorBounds(axis, 0), interior);
+    Slice extended = u.getLocalInteriorBounds(axis, 3);
+    TEST_EQUALITY(extended.start(), interior.start() -
+                  (u.getLowerNeighbor(axis) >= 0 ? 2 : 0));
+    TEST_EQUALITY(extended.stop() , interior.stop()  +
+                  (u.getUpperNeighbor(axis) >= 0 ? 2 : 0));
+  }
+
+  // Update the full width of the communication padding once, and
+  // perform two sweeps over shrinking regions
+  u.updateCommPadWidth(2);
+  MDVector< Sca > v(u, Teuchos::Copy);
+  Array< Slice > bounds(numDims);
+  SmoothKernel< Sca > kernel;
+  kernel.input  = &u;
+  kernel.output = &v;
+  for (int axis = 0; axis < numDims; ++axis)
+    bounds[axis] = u.getLocalInteriorBounds(axis, 1);
+  kernel(bounds());
+  kernel.input  = &v;
+  kernel.output = &w;
+  for (int axis = 0; axis < numDims; ++axis)
+    bounds[axis] = u.getLocalInteriorBounds(axis, 0);
+  kernel(bounds());
+
+  // The result over the interior is the original linear function
+  MDArrayView< const Sca > wData = w.getData();
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  for (const_iterator it = wData.cbegin(); it != wData.cend(); ++it)
+  {
+    Sca value = 0;
+    bool inside = true;
+    for (int axis = 0; axis < numDims; ++axis)
+    {
+      value += (axis+1) * (origin[axis] + it.index(axis));
+      if (it.index(axis) <  bounds[axis].start() ||
+          it.index(axis) >= bounds[axis].stop()) inside = false;
+    }
+    if (inside) TEST_EQUALITY(*it, value);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, elementWise, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct dimensions and communication padding
+  dim_type localDim = 10;
+  Array< dim_type > dims(numDims);
+  Array< int > commPad(numDims, 1);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+
+  // Construct an MDMap and MDVectors
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+  MDVector< Sca > x(mdMap);
+  MDVector< Sca > y(mdMap);
+  MDVector< Sca > w(mdMap);
+  MDVector< Sca > z(mdMap);
+  x.putScalar(1);
+  y.putScalar(2);
+  w.putScalar(-3);
+  z.putScalar(-1);
+
+  // Evaluate an expression over the owned data only
+  z.assign(2*x + 3*y - w/3 + x*y);
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  MDArrayView< const Sca > owned = z.getData(false);
+  for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+    TEST_EQUALITY_CONST(*it, 11);
+  size_type numPadding = 0;
+  MDArrayView< const Sca > all = z.getData();
+  for (const_iterator it = all.cbegin(); it != all.cend(); ++it)
+    if (*it == -1) ++numPadding;
+  TEST_EQUALITY(numPadding, all.size() - owned.size());
+
+  // Evaluate an expression including the padding
+  z.assign(-x + y, true);
+  for (const_iterator it = all.cbegin(); it != all.cend(); ++it)
+    TEST_EQUALITY_CONST(*it, 1);
+
+  // Test the element-wise methods
+  z.scale(4);
+  for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+    TEST_EQUALITY_CONST(*it, 4);
+  z.update(2, x, -1);
+  for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+    TEST_EQUALITY_CONST(*it, -2);
+  z.update(1, x, 2, y, 3);
+  for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+    TEST_EQUALITY_CONST(*it, -1);
+  z.elementWiseMultiply(2, y, w, 1);
+  for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+    TEST_EQUALITY_CONST(*it, -13);
+  z.abs(w);
+  for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+    TEST_EQUALITY_CONST(*it, 3);
+  z.reciprocal(x);
+  for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+    TEST_EQUALITY_CONST(*it, 1);
+
+  // A zero coefficient of this MDVector means that it is not read, so
+  // a NaN in it does not propagate
+  if (std::numeric_limits< Sca >::has_quiet_NaN)
+  {
+    Sca nan = std::numeric_limits< Sca >::quiet_NaN();
+    z.putScalar(nan);
+    z.scale(0);
+    for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+      TEST_EQUALITY_CONST(*it, 0);
+    z.putScalar(nan);
+    z.update(2, x, 0);
+    for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+      TEST_EQUALITY_CONST(*it, 2);
+    z.putScalar(nan);
+    z.update(1, x, 2, y, 0);
+    for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+      TEST_EQUALITY_CONST(*it, 5);
+    z.putScalar(nan);
+    z.elementWiseMultiply(2, y, w, 0);
+    for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+      TEST_EQUALITY_CONST(*it, -12);
+  }
+
+  // Operands with different padding cannot be combined with the
+  // padding included
+  MDMapRCP otherMdMap = rcp(new MDMap(mdComm, dims()));
+  MDVector< Sca > v(otherMdMap);
+  v.putScalar(5);
+  z.assign(x + v);
+  for (const_iterator it = owned.cbegin(); it != owned.cend(); ++it)
+    TEST_EQUALITY_CONST(*it, 6);
+  if (comm->getSize() > 1)
+    TEST_THROW(z.assign(x + v, true), Domi::InvalidArgument);
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, alignedStorage, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct dimensions whose local extents are not a multiple of
+  // the vector width
+  dim_type localDim = 5;
+  Array< dim_type > dims(numDims);
+  Array< int > commPad(numDims, 1);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+
+  // Construct an MDMap and an MDVector
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+  MDVector< Sca > u(mdMap);
+  TEST_ASSERT(not u.getAlignedStorage());
+
+  // Fill the owned points of u with a linear function of the global
+  // indexes
+  Array< dim_type > origin(numDims);
+  Array< Slice > owned(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    origin[axis] = mdMap->getGlobalRankBounds(axis,false).start() -
+                   mdMap->getLowerPadSize(axis);
+    owned[axis] = mdMap->getLocalBounds(axis);
+  }
+  MDArrayView< Sca > data = u.getDataNonConst();
+  typedef typename MDArrayView< Sca >::iterator iterator;
+  for (iterator it = data.begin(); it != data.end(); ++it)
+  {
+    Sca value = 0;
+    bool inside = true;
+    for (int axis = 0; axis < numDims; ++axis)
+    {
+      value += (axis+1) * (origin[axis] + it.index(axis));
+      if (it.index(axis) <  owned[axis].start() ||
+          it.index(axis) >= owned[axis].stop()) inside = false;
+    }
+    if (inside) *it = value;
+  }
+
+  // Switch to aligned storage, and check the alignment of the data
+  // and of the stride of the second fastest-varying dimension
+  u.setAlignedStorage(true);
+  TEST_ASSERT(u.getAlignedStorage());
+  TEST_ASSERT(not u.isContiguous());
+  data = u.getDataNonConst();
+  size_type width = Domi::ALIGNED_STORAGE_BYTES / sizeof(Sca);
+  TEST_EQUALITY(reinterpret_cast< size_t >(data.getRawPtr()) %
+                Domi::ALIGNED_STORAGE_BYTES, 0);
+  if (numDims > 1)
+  {
+    int axis = (u.getLayout() == Domi::FIRST_INDEX_FASTEST) ? 1 : numDims-2;
+    TEST_EQUALITY(data.strides()[axis] % width, 0);
+  }
+
+  // Update the communication padding, which must skip the alignment
+  // padding, and check that the owned values were preserved and the
+  // communication padding is filled
+  u.updateCommPad();
+  for (iterator it = data.begin(); it != data.end(); ++it)
+  {
+    Sca value = 0;
+    for (int axis = 0; axis < numDims; ++axis)
+      value += (axis+1) * (origin[axis] + it.index(axis));
+    TEST_EQUALITY(*it, value);
+  }
+
+  // A deep copy keeps the aligned storage
+  MDVector< Sca > v(u, Teuchos::Copy);
+  TEST_ASSERT(v.getAlignedStorage());
+  TEST_EQUALITY(reinterpret_cast< size_t >(v.getData().getRawPtr()) %
+                Domi::ALIGNED_STORAGE_BYTES, 0);
+
+  // Aligned storage can also be requested with a ParameterList
+  Teuchos::ParameterList plist;
+  plist.set("comm dimensions", commDims);
+  plist.set("dimensions"     , dims    );
+  plist.set("aligned storage", true    );
+  MDVector< Sca > w(comm, plist);
+  TEST_ASSERT(w.getAlignedStorage());
+  TEST_EQUALITY(reinterpret_cast< size_t >(w.getData().getRawPtr()) %
+                Domi::ALIGNED_STORAGE_BYTES, 0);
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, memoryPool, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct an MDMap
+  dim_type localDim = 6;
+  Array< dim_type > dims(numDims);
+  Array< int > commPad(numDims, 1);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+  size_type localSize = 1;
+  for (int axis = 0; axis < numDims; ++axis)
+    localSize *= mdMap->getLocalDim(axis,true);
+  size_type bytes = localSize * sizeof(Sca);
+
+  // Construct and destroy a work vector on each of several
+  // iterations, within an arena on a pool.  Only the first iteration
+  // should allocate memory, and every work vector should start out
+  // zeroed even though its buffer is recycled.
+  Teuchos::RCP< Domi::MemoryPool< Sca > > pool =
+    Teuchos::rcp(new Domi::MemoryPool< Sca >);
+  int numIters = 4;
+  for (int iter = 0; iter < numIters; ++iter)
+  {
+    Domi::MemoryArena< Sca > arena(pool);
+    MDVector< Sca > work(mdMap);
+    MDArrayView< const Sca > data = work.getData();
+    for (typename MDArrayView< const Sca >::const_iterator it = data.begin();
+         it != data.end(); ++it)
+      TEST_EQUALITY(*it, Sca(0));
+    TEST_EQUALITY(pool->bytesInUse(), bytes);
+    work.putScalar(iter+1, true);
+  }
+  TEST_EQUALITY(pool->numRequests()   , numIters  );
+  TEST_EQUALITY(pool->numAllocations(), 1         );
+  TEST_EQUALITY(pool->numReuses()     , numIters-1);
+  TEST_EQUALITY(pool->bytesInUse()    , 0         );
+  TEST_EQUALITY(pool->peakBytesInUse(), bytes     );
+  TEST_EQUALITY(pool->bytesCached()   , bytes     );
+
+  // Outside of an arena, the pool is not used
+  {
+    MDVector< Sca > work(mdMap);
+  }
+  TEST_EQUALITY(pool->numRequests(), numIters);
+
+  // Nested arenas use the innermost allocator, and a private arena
+  // pool releases its buffers when it goes out of scope
+  {
+    Domi::MemoryArena< Sca > outer(pool);
+    {
+      Domi::MemoryArena< Sca > inner;
+      TEST_ASSERT(Domi::Allocator< Sca >::getCurrent() ==
+                  inner.getAllocator());
+      MDVector< Sca > work(mdMap);
+    }
+    TEST_ASSERT(Domi::Allocator< Sca >::getCurrent() == outer.getAllocator());
+    MDVector< Sca > work(mdMap);
+  }
+  TEST_EQUALITY(pool->numRequests(), numIters+1);
+  TEST_EQUALITY(pool->numReuses()  , numIters  );
+  TEST_ASSERT(Domi::Allocator< Sca >::getCurrent().is_null());
+
+  // Clearing the pool releases the cached buffers
+  pool->clear();
+  TEST_EQUALITY(pool->bytesCached(), 0);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Functor that computes a linear function of a local index
+template< class Sca >
+struct LinearInitializer
+{
+  Sca operator()(const ArrayView< const dim_type > & index) const
+  {
+    Sca result = 0;
+    for (int axis = 0; axis < index.size(); ++axis)
+      result += (axis+1) * index[axis];
+    return result;
+  }
+};
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, firstTouch, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct an MDMap
+  dim_type localDim = 7;
+  Array< dim_type > dims(numDims);
+  Array< int > commPad(numDims, 1);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+
+  // An MDVector constructed with zeroOut = true is zeroed by threads
+  MDVector< Sca > zeros(mdMap);
+  MDArrayView< const Sca > zeroData = zeros.getData();
+  for (typename MDArrayView< const Sca >::const_iterator it =
+         zeroData.begin(); it != zeroData.end(); ++it)
+    TEST_EQUALITY(*it, Sca(0));
+
+  // Construct an MDVector without initializing it, and then
+  // initialize everything, including the padding, with a functor
+  MDVector< Sca > u(mdMap, false);
+  LinearInitializer< Sca > init;
+  u.initialize(init);
+  MDArrayView< const Sca > data = u.getData();
+  for (typename MDArrayView< const Sca >::const_iterator it = data.begin();
+       it != data.end(); ++it)
+  {
+    Sca value = 0;
+    for (int axis = 0; axis < numDims; ++axis)
+      value += (axis+1) * it.index(axis);
+    TEST_EQUALITY(*it, value);
+  }
+
+  // Initialize only the interior, relative to the interior indexes
+  u.putScalar(-1);
+  u.initialize(init, false);
+  MDArrayView< const Sca > interior = u.getData(false);
+  for (typename MDArrayView< const Sca >::const_iterator it =
+         interior.begin(); it != interior.end(); ++it)
+  {
+    Sca value = 0;
+    for (int axis = 0; axis < numDims; ++axis)
+      value += (axis+1) * it.index(axis);
+    TEST_EQUALITY(*it, value);
+  }
+  bool lowerPad = false;
+  for (int axis = 0; axis < numDims; ++axis)
+    if (u.getLowerPadSize(axis) > 0) lowerPad = true;
+  if (lowerPad)
+    TEST_EQUALITY(u.getData(true).getRawPtr()[0], Sca(-1));
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, mdMapLayout, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct an MDMap whose layout is not the default
+  Domi::Layout layout = (Domi::DEFAULT_ORDER == Domi::C_ORDER) ?
+    Domi::FORTRAN_ORDER : Domi::C_ORDER;
+  dim_type localDim = 5;
+  Array< dim_type > dims(numDims);
+  Array< int > commPad(numDims, 1);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims(), commPad(),
+                                 Teuchos::ArrayView< const int >(),
+                                 Teuchos::ArrayView< const int >(),
+                                 layout));
+
+  // MDVectors constructed on the MDMap, with or without zeroing, store
+  // their data in the layout of the MDMap
+  MDVector< Sca > zeros(mdMap);
+  MDVector< Sca > u(mdMap, false);
+  Array< dim_type > localDims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    localDims[axis] = mdMap->getLocalDim(axis, true);
+  Array< size_type > strides =
+    Domi::computeStrides< size_type, dim_type >(localDims, layout);
+  TEST_EQUALITY(zeros.getLayout(), layout);
+  TEST_EQUALITY(zeros.getData(true).layout(), layout);
+  TEST_COMPARE_ARRAYS(zeros.getData(true).strides(), strides);
+  TEST_EQUALITY(u.getData(true).layout(), layout);
+  TEST_COMPARE_ARRAYS(u.getData(true).strides(), strides);
+
+  // So does an MDVector constructed with a ParameterList that gives
+  // the layout
+  Teuchos::ParameterList plist;
+  plist.set("dimensions", dims);
+  plist.set("layout", (layout == Domi::C_ORDER) ? "C Order" :
+                                                  "Fortran Order");
+  MDVector< Sca > v(mdComm, plist);
+  TEST_EQUALITY(v.getLayout(), layout);
+  TEST_EQUALITY(v.getData(true).layout(), layout);
+  Array< dim_type > vDims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    vDims[axis] = v.getLocalDim(axis, true);
+  Array< size_type > vStrides =
+    Domi::computeStrides< size_type, dim_type >(vDims, layout);
+  TEST_COMPARE_ARRAYS(v.getData(true).strides(), vStrides);
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, hugePages, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Allocate a buffer directly from a HugePageAllocator, with no
+  // minimum size.  Whichever page type is obtained, it is reported
+  // consistently.
+  typedef Domi::HugePageAllocator< Sca > HugePageAllocator;
+  HugePageAllocator allocator(Domi::EXPLICIT_HUGE_PAGES, 0);
+  dim_type localDim = 5;
+  Array< dim_type > dims(numDims, localDim);
+  size_type size = Domi::computeSize(dims());
+  Teuchos::ArrayRCP< Sca > buffer = allocator.allocate(size);
+  Domi::PageType pageType = HugePageAllocator::getPageType(buffer);
+  TEST_EQUALITY(allocator.requestedPageType(), Domi::EXPLICIT_HUGE_PAGES);
+  TEST_EQUALITY(allocator.lastPageType(), pageType);
+  TEST_EQUALITY(allocator.numAllocations(pageType), 1);
+#if !defined(__linux__)
+  TEST_EQUALITY(pageType, Domi::STANDARD_PAGES);
+#endif
+
+  // A buffer below the minimum size uses standard pages
+  HugePageAllocator smallAllocator(Domi::TRANSPARENT_HUGE_PAGES);
+  Teuchos::ArrayRCP< Sca > small = smallAllocator.allocate(size);
+  TEST_EQUALITY(HugePageAllocator::getPageType(small),
+                Domi::STANDARD_PAGES);
+  TEST_EQUALITY(smallAllocator.numAllocations(Domi::STANDARD_PAGES), 1);
+
+  // The buffer can be used by a non-owning MDArrayRCP view
+  Domi::MDArrayRCP< Sca > view(buffer(), dims());
+  view.assign(3);
+  for (size_type i = 0; i < size; ++i)
+    TEST_EQUALITY(buffer[i], Sca(3));
+
+  // Choose a local dimension for which the local data of an MDVector
+  // is larger than a huge page
+  dim_type bigDim = localDim;
+  size_type bigSize = 1;
+  while (bigSize * sizeof(Sca) <= Domi::getHugePageBytes())
+  {
+    ++bigDim;
+    bigSize = 1;
+    for (int axis = 0; axis < numDims; ++axis) bigSize *= bigDim;
+  }
+
+  // Allocate a reference buffer of that size with transparent huge
+  // pages, to determine the page type this system provides
+  HugePageAllocator bigAllocator(Domi::TRANSPARENT_HUGE_PAGES);
+  TEST_EQUALITY(bigAllocator.requestedPageType(),
+                Domi::TRANSPARENT_HUGE_PAGES);
+  Teuchos::ArrayRCP< Sca > big = bigAllocator.allocate(bigSize);
+  Domi::PageType bigPageType = HugePageAllocator::getPageType(big);
+  TEST_ASSERT(bigPageType == Domi::STANDARD_PAGES ||
+              bigPageType == Domi::TRANSPARENT_HUGE_PAGES);
+  big = Teuchos::null;
+
+  // Construct a large MDVector that requests transparent huge pages
+  // with a ParameterList.  It obtains the same page type as the
+  // reference buffer, and its data is usable and zeroed.
+  Array< dim_type > globalDims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    globalDims[axis] = bigDim * mdComm->getCommDim(axis);
+  Teuchos::ParameterList plist;
+  plist.set("dimensions", globalDims);
+  plist.set("huge pages", "Transparent");
+  MDVector< Sca > mdVector(mdComm, plist);
+  Domi::PageType vectorPageType = mdVector.getPageType();
+  TEST_EQUALITY(vectorPageType, bigPageType);
+  MDArrayView< const Sca > data = mdVector.getData();
+  TEST_EQUALITY(data.size(), bigSize);
+  size_type numNonZero = 0;
+  for (typename MDArrayView< const Sca >::const_iterator it = data.begin();
+       it != data.end(); ++it)
+    if (*it != Sca(0)) ++numNonZero;
+  TEST_EQUALITY_CONST(numNonZero, 0);
+
+  // A small MDVector that requests huge pages falls back to standard
+  // pages
+  Array< dim_type > smallDims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    smallDims[axis] = localDim * mdComm->getCommDim(axis);
+  Teuchos::ParameterList smallPlist;
+  smallPlist.set("dimensions", smallDims);
+  smallPlist.set("huge pages", "Explicit");
+  MDVector< Sca > smallVector(mdComm, smallPlist);
+  TEST_EQUALITY(smallVector.getPageType(), Domi::STANDARD_PAGES);
+
+  // Aligned storage keeps the page type
+  mdVector.setAlignedStorage(true);
+  TEST_EQUALITY(mdVector.getPageType(), vectorPageType);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+// Functor that computes a linear function of a global index, given
+// the global index of the first local element
+template< class Sca >
+struct GlobalLinearInitializer
+{
+  Array< dim_type > globalStart;
+  Sca operator()(const ArrayView< const dim_type > & index) const
+  {
+    Sca result = 0;
+    for (int axis = 0; axis < index.size(); ++axis)
+      result += (axis+1) * (globalStart[axis] + index[axis]);
+    return result;
+  }
+};
+
+// Remove a file written by a test, once every processor is done
+// with it
+static void removeTestFile(const Teuchos::Comm< int > & comm,
+                           const std::string & filename)
+{
+  comm.barrier();
+  if (comm.getRank() == 0) std::remove(filename.c_str());
+}
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, mapBinary, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct an MDMap with communication padding
+  dim_type localDim = 6;
+  Array< dim_type > dims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+  Array< int > commPad(numDims, 1);
+  Teuchos::RCP< MDMap > mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+
+  // Write an MDVector with values that depend on the global index
+  MDVector< Sca > u(mdMap);
+  GlobalLinearInitializer< Sca > init;
+  init.globalStart.resize(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    init.globalStart[axis] = u.getGlobalRankBounds(axis).start();
+  u.initialize(init, false);
+  std::string filename = "MDVector_mapBinary.bin";
+  u.writeBinary(filename);
+
+  // Map the file read-only, and check the data and the communication
+  // padding
+  MDVector< Sca > v(mdMap, false);
+  v.mapBinary(filename);
+  TEST_ASSERT(v.isFileMapped());
+  if (comm->getSize() == 1)
+    TEST_ASSERT(v.isDirectlyMapped());
+  MDArrayView< const Sca > uData = u.getData(false);
+  MDArrayView< const Sca > vData = v.getData(false);
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  for (const_iterator uit = uData.begin(), vit = vData.begin();
+       uit != uData.end(); ++uit, ++vit)
+    TEST_EQUALITY(*vit, *uit);
+  u.updateCommPad();
+  v.updateCommPad();
+  MDArrayView< const Sca > uAll = u.getData(true);
+  MDArrayView< const Sca > vAll = v.getData(true);
+  for (const_iterator uit = uAll.begin(), vit = vAll.begin();
+       uit != uAll.end(); ++uit, ++vit)
+    TEST_EQUALITY(*vit, *uit);
+  TEST_THROW(v.syncBinary(), Domi::FileError);
+
+  // Map the file writable, change the data and read it back
+  MDVector< Sca > w(mdMap, false);
+  w.mapBinary(filename, false, true);
+  w.putScalar(7, false);
+  w.syncBinary();
+  comm->barrier();
+  MDVector< Sca > x(mdMap);
+  x.readBinary(filename);
+  MDArrayView< const Sca > xData = x.getData(false);
+  for (const_iterator it = xData.begin(); it != xData.end(); ++it)
+    TEST_EQUALITY(*it, Sca(7));
+
+  // Changing the storage detaches the MDVector from the file
+  w.setAlignedStorage(true);
+  TEST_ASSERT(! w.isFileMapped());
+  removeTestFile(*comm, filename);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, chunkedFile, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct an MDMap with boundary padding
+  dim_type localDim = 6;
+  Array< dim_type > dims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+  Array< int > commPad(numDims, 1);
+  Array< int > bndryPad(numDims, 1);
+  Teuchos::RCP< MDMap > mdMap =
+    rcp(new MDMap(mdComm, dims(), commPad(), bndryPad()));
+
+  // Write an MDVector with values that depend on the global index,
+  // using chunks that do not match the decomposition
+  MDVector< Sca > u(mdMap);
+  GlobalLinearInitializer< Sca > init;
+  init.globalStart.resize(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    init.globalStart[axis] = u.getGlobalRankBounds(axis,true).start();
+  u.initialize(init, true);
+  std::string filename = "MDVector_chunkedFile.bin";
+  Array< dim_type > chunkShape(numDims, 4);
+  u.writeChunked(filename, true, chunkShape());
+
+  // Read the file into an MDVector with the same MDMap
+  MDVector< Sca > v(mdMap);
+  v.readChunked(filename);
+  MDArrayView< const Sca > uData = u.getData(false);
+  MDArrayView< const Sca > vData = v.getData(false);
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  for (const_iterator uit = uData.begin(), vit = vData.begin();
+       uit != uData.end(); ++uit, ++vit)
+    TEST_EQUALITY(*vit, *uit);
+
+  // Construct a new MDVector from the file
+  Teuchos::ParameterList plist;
+  plist.set("comm dimensions", commDims);
+  plist.set("communication pad size", 1);
+  Teuchos::RCP< MDVector< Sca > > w =
+    Domi::readMDVector< Sca >(comm, filename, plist);
+  TEST_EQUALITY(w->numDims(), numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+  {
+    TEST_EQUALITY(w->getGlobalDim(axis), dims[axis]);
+    TEST_EQUALITY_CONST(w->getBndryPadSize(axis), 1);
+  }
+  TEST_EQUALITY(w->getLayout(), u.getLayout());
+  u.updateCommPad();
+  w->updateCommPad();
+  MDArrayView< const Sca > uAll = u.getData(true);
+  MDArrayView< const Sca > wAll = w->getData(true);
+  for (const_iterator uit = uAll.begin(), wit = wAll.begin();
+       uit != uAll.end(); ++uit, ++wit)
+    TEST_EQUALITY(*wit, *uit);
+
+  // Reading into an MDVector of another scalar type is an error
+  MDVector< float > x(mdMap);
+  TEST_THROW(x.readChunked(filename), Domi::TypeError);
+  removeTestFile(*comm, filename);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, asyncWrite, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct an MDMap with communication padding
+  dim_type localDim = 6;
+  Array< dim_type > dims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+  Array< int > commPad(numDims, 1);
+  Teuchos::RCP< MDMap > mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+
+  // Start three writes, changing the data after each one is started
+  MDVector< Sca > u(mdMap);
+  Teuchos::Array< std::string > filenames;
+  Teuchos::Array< Teuchos::RCP< Domi::AsyncWrite > > writes;
+  for (int step = 0; step < 3; ++step)
+  {
+    std::ostringstream filename;
+    filename << "MDVector_asyncWrite_" << step << ".bin";
+    filenames.push_back(filename.str());
+    u.putScalar(step+1);
+    writes.push_back(u.startWriteBinary(filenames[step]));
+    u.putScalar(-1);
+  }
+
+  // Starting the third write completed the first one
+  TEST_ASSERT(writes[0]->isComplete());
+  u.endWriteBinary();
+  for (int step = 0; step < 3; ++step)
+  {
+    TEST_ASSERT(writes[step]->isComplete());
+    TEST_EQUALITY(writes[step]->getFilename(), filenames[step]);
+  }
+
+  // Each file holds the data at the time its write was started
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  for (int step = 0; step < 3; ++step)
+  {
+    MDVector< Sca > v(mdMap);
+    v.readBinary(filenames[step]);
+    MDArrayView< const Sca > vData = v.getData(false);
+    for (const_iterator it = vData.begin(); it != vData.end(); ++it)
+      TEST_EQUALITY(*it, Sca(step+1));
+  }
+  for (int step = 0; step < 3; ++step)
+    removeTestFile(*comm, filenames[step]);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, binaryRegion, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct an MDMap with communication padding
+  dim_type localDim = 6;
+  Array< dim_type > dims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+  Array< int > commPad(numDims, 1);
+  Teuchos::RCP< MDMap > mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+
+  // Write an MDVector with values that depend on the global index
+  MDVector< Sca > u(mdMap);
+  GlobalLinearInitializer< Sca > init;
+  init.globalStart.resize(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    init.globalStart[axis] = u.getGlobalRankBounds(axis).start();
+  u.initialize(init, false);
+  std::string filename = "MDVector_binaryRegion.bin";
+  u.writeBinary(filename);
+
+  // The region is the middle plane along the first axis
+  Array< Slice > region(numDims, Slice());
+  dim_type plane = dims[0] / 2;
+  region[0] = Slice(plane, plane+1);
+
+  // Read the region, and check that nothing else is read
+  MDVector< Sca > v(mdMap);
+  v.readBinary(filename, region());
+  MDArrayView< const Sca > vData = v.getData(false);
+  Array< dim_type > index(numDims);
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  for (const_iterator it = vData.begin(); it != vData.end(); ++it)
+  {
+    for (int axis = 0; axis < numDims; ++axis)
+      index[axis] = it.index(axis);
+    if (init.globalStart[0] + index[0] == plane)
+      TEST_EQUALITY(*it, init(index()));
+    else
+      TEST_EQUALITY(*it, Sca(0));
+  }
+
+  // Overwrite the region of the file, and check that nothing else is
+  // written
+  MDVector< Sca > w(mdMap);
+  w.putScalar(9);
+  w.writeBinary(filename, region());
+  MDVector< Sca > x(mdMap);
+  x.readBinary(filename);
+  MDArrayView< const Sca > xData = x.getData(false);
+  for (const_iterator it = xData.begin(); it != xData.end(); ++it)
+  {
+    for (int axis = 0; axis < numDims; ++axis)
+      index[axis] = it.index(axis);
+    if (init.globalStart[0] + index[0] == plane)
+      TEST_EQUALITY(*it, Sca(9));
+    else
+      TEST_EQUALITY(*it, init(index()));
+  }
+
+  // Regions must match the dimensions, have unit steps and lie
+  // within the file
+  if (numDims > 1)
+    TEST_THROW(v.readBinary(filename, region(0,1)), Domi::InvalidArgument);
+  region[0] = Slice(0, plane, 2);
+  TEST_THROW(v.readBinary(filename, region()), Domi::InvalidArgument);
+  region[0] = Slice(plane, dims[0]+1);
+  TEST_THROW(v.readBinary(filename, region()), Domi::RangeError);
+  region[0] = Slice(dims[0]+1, dims[0]+2);
+  TEST_THROW(w.writeBinary(filename, region()), Domi::RangeError);
+  removeTestFile(*comm, filename);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, timeSeries, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct an MDMap with communication and boundary padding
+  dim_type localDim = 6;
+  Array< dim_type > dims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+  Array< int > commPad(numDims, 1);
+  Array< int > bndryPad(numDims, 1);
+  Teuchos::RCP< MDMap > mdMap =
+    rcp(new MDMap(mdComm, dims(), commPad(), bndryPad()));
+
+  // Write three snapshots of two fields, one with its boundary pad
+  typedef Teuchos::RCP< MDVector< Sca > > MDVectorRCP;
+  MDVectorRCP u = rcp(new MDVector< Sca >(mdMap));
+  MDVectorRCP v = rcp(new MDVector< Sca >(mdMap));
+  std::string filename = "MDVector_timeSeries.bin";
+  {
+    Domi::TimeSeriesWriter< Sca > writer(filename);
+    writer.addField("u", u);
+    writer.addField("v", v, true);
+    for (int step = 0; step < 3; ++step)
+    {
+      u->putScalar(step+1, true);
+      v->putScalar(10*(step+1), true);
+      TEST_EQUALITY(writer.write(0.5*step), step);
+    }
+    TEST_THROW(writer.addField("w", u), Domi::InvalidArgument);
+  }
+
+  // Append a fourth snapshot
+  {
+    Domi::TimeSeriesWriter< Sca > writer(filename, true);
+    writer.addField("u", u);
+    writer.addField("v", v, true);
+    u->putScalar(4, true);
+    v->putScalar(40, true);
+    TEST_EQUALITY(writer.write(1.5), 3);
+    TEST_EQUALITY(writer.numSteps(), 4);
+  }
+
+  // Read the snapshots in reverse order
+  {
+    Domi::TimeSeriesReader< Sca > reader(comm, filename);
+    TEST_EQUALITY(reader.numSteps(), 4);
+    TEST_EQUALITY(reader.getIndex().numFields(), 2);
+    TEST_ASSERT(! reader.getIndex().getField(0).includesBndryPad);
+    TEST_ASSERT(reader.getIndex().getField(1).includesBndryPad);
+    MDVector< Sca > w(mdMap);
+    typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+    for (int step = 3; step >= 0; --step)
+    {
+      TEST_EQUALITY(reader.getTime(step), 0.5*step);
+      reader.read(step, "u", w);
+      MDArrayView< const Sca > uData = w.getData(false);
+      for (const_iterator it = uData.begin(); it != uData.end(); ++it)
+        TEST_EQUALITY(*it, Sca(step+1));
+      reader.read(step, "v", w);
+      MDArrayView< const Sca > vData = w.getData(false);
+      for (const_iterator it = vData.begin(); it != vData.end(); ++it)
+        TEST_EQUALITY(*it, Sca(10*(step+1)));
+    }
+    TEST_THROW(reader.read(4, "u", w), Domi::RangeError);
+    TEST_THROW(reader.read(0, "x", w), Domi::InvalidArgument);
+  }
+  removeTestFile(*comm, filename);
+
+  // A missing file cannot be read
+  TEST_THROW(Domi::TimeSeriesReader< Sca > missing(comm, filename),
+             Domi::FileError);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, ioConfig, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+
+  // Construct a ParameterList with an "I/O" sublist
+  Teuchos::ParameterList plist;
+  plist.set("comm dimensions", commDims);
+  Array< int > actualCommDims =
+    Domi::regularizeCommDims(comm->getSize(), plist);
+  dim_type localDim = 8;
+  Array< dim_type > dims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * actualCommDims[axis];
+  plist.set("dimensions", dims);
+  Teuchos::ParameterList & ioList = plist.sublist("I/O");
+  ioList.set("collective buffer size", 1048576);
+  ioList.set("data sieving", "Disable");
+  ioList.sublist("hints").set("cb_config_list", "*:1");
+
+  // Construct an MDVector, and check its hints
+  MDVector< Sca > mdVector(comm, plist);
+  Teuchos::RCP< Domi::IOConfig > ioConfig = mdVector.getIOConfig();
+  TEST_ASSERT(ioConfig != Domi::IOConfig::getDefault());
+  TEST_EQUALITY(ioConfig->getHint("cb_buffer_size"), "1048576");
+  TEST_EQUALITY(ioConfig->getHint("romio_ds_read"  ), "disable");
+  TEST_EQUALITY(ioConfig->getHint("romio_ds_write" ), "disable");
+  TEST_EQUALITY(ioConfig->getHint("cb_config_list" ), "*:1");
+  TEST_EQUALITY(ioConfig->getHint("striping_factor"), "");
+
+  // Write and read the MDVector, and check the timings
+  std::string filename = "MDVector_ioConfig.bin";
+  mdVector.putScalar(3);
+  mdVector.writeBinary(filename);
+  mdVector.putScalar(0);
+  mdVector.readBinary(filename);
+  MDArrayView< const Sca > data = mdVector.getData(false);
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  for (const_iterator it = data.begin(); it != data.end(); ++it)
+    TEST_EQUALITY(*it, Sca(3));
+  Domi::IOConfig::Timing timing = ioConfig->getTiming("writeBinary");
+  TEST_EQUALITY(timing.calls, 1);
+  TEST_EQUALITY(timing.bytes, size_type(data.size() * sizeof(Sca)));
+  TEST_ASSERT(timing.seconds >= 0.0);
+  TEST_EQUALITY(ioConfig->getTiming("readBinary").calls, 1);
+  TEST_EQUALITY(ioConfig->getTiming("writeChunked").calls, 0);
+  ioConfig->resetTimings();
+  TEST_EQUALITY(ioConfig->getTiming("writeBinary").calls, 0);
+
+  // An MDVector without an "I/O" sublist uses the default, and a
+  // copy shares the configuration of its source
+  MDVector< Sca > other(mdVector.getMDMap());
+  TEST_ASSERT(other.getIOConfig() == Domi::IOConfig::getDefault());
+  other = mdVector;
+  TEST_ASSERT(other.getIOConfig() == ioConfig);
+  other.setIOConfig(Teuchos::null);
+  TEST_ASSERT(other.getIOConfig() == Domi::IOConfig::getDefault());
+  removeTestFile(*comm, filename);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, subfiles, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct an MDMap with communication padding
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  dim_type localDim = 6;
+  Array< dim_type > dims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+  Array< int > commPad(numDims, 1);
+  MDMapRCP mdMap = rcp(new MDMap(mdComm, dims(), commPad()));
+
+  // Write an MDVector with values that depend on the global index
+  MDVector< Sca > u(mdMap);
+  GlobalLinearInitializer< Sca > init;
+  init.globalStart.resize(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    init.globalStart[axis] = u.getGlobalRankBounds(axis).start();
+  u.initialize(init, false);
+  std::string filename = "MDVector_subfiles.bin";
+  u.writeSubfiles(filename);
+
+  // Every processor has a block in the manifest
+  Domi::SubfileManifest manifest =
+    Domi::SubfileManifest::read(comm, filename);
+  TEST_EQUALITY(manifest.numBlocks(), comm->getSize());
+  TEST_ASSERT(manifest.numSubfiles() >= 1);
+  TEST_ASSERT(manifest.numSubfiles() <= comm->getSize());
+  TEST_ASSERT(manifest.fileDims() == dims);
+
+  // Read the subfiles with the processor grid reversed, and without
+  // communication padding
+  Array< int > reversedCommDims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    reversedCommDims[axis] = mdComm->getCommDim(numDims-1-axis);
+  Teuchos::RCP< const Domi::MDComm > reversedMdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, reversedCommDims));
+  MDMapRCP reversedMdMap = rcp(new MDMap(reversedMdComm, dims()));
+  MDVector< Sca > v(reversedMdMap);
+  v.readSubfiles(filename);
+  for (int axis = 0; axis < numDims; ++axis)
+    init.globalStart[axis] = v.getGlobalRankBounds(axis).start();
+  MDArrayView< const Sca > vData = v.getData(false);
+  Array< dim_type > index(numDims);
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  for (const_iterator it = vData.begin(); it != vData.end(); ++it)
+  {
+    for (int axis = 0; axis < numDims; ++axis)
+      index[axis] = it.index(axis);
+    TEST_EQUALITY(*it, init(index()));
+  }
+
+  // The dimensions must match
+  Array< dim_type > otherDims(dims);
+  otherDims[0] += 1;
+  MDMapRCP otherMdMap = rcp(new MDMap(mdComm, otherDims()));
+  MDVector< Sca > w(otherMdMap);
+  TEST_THROW(w.readSubfiles(filename), Domi::MDMapError);
+
+  // Remove the subfiles and the manifest
+  for (int subfile = 0; subfile < manifest.numSubfiles(); ++subfile)
+    removeTestFile(*comm, Domi::SubfileManifest::subfileName(filename,
+                                                             subfile));
+  removeTestFile(*comm, filename);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, redistribute, Sca )
+{
+  Teuchos::RCP< const Teuchos::Comm< int > > comm =
+    Teuchos::DefaultComm< int >::getComm();
+  commDims = Domi::splitStringOfIntsWithCommas(commDimsStr);
+  Teuchos::RCP< const Domi::MDComm > mdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, commDims));
+
+  // Construct a source MDMap with communication padding
+  typedef Teuchos::RCP< MDMap > MDMapRCP;
+  dim_type localDim = 6;
+  Array< dim_type > dims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    dims[axis] = localDim * mdComm->getCommDim(axis);
+  Array< int > commPad(numDims, 1);
+  MDMapRCP source = rcp(new MDMap(mdComm, dims(), commPad()));
+
+  // Construct a target MDMap with the processor grid reversed and
+  // wider communication padding
+  Array< int > reversedCommDims(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    reversedCommDims[axis] = mdComm->getCommDim(numDims-1-axis);
+  Teuchos::RCP< const Domi::MDComm > reversedMdComm =
+    Teuchos::rcp(new MDComm(comm, numDims, reversedCommDims));
+  Array< int > targetCommPad(numDims, 2);
+  MDMapRCP target = rcp(new MDMap(reversedMdComm, dims(), targetCommPad()));
+
+  // Initialize a source MDVector with values that depend on the
+  // global index
+  MDVector< Sca > u(source);
+  GlobalLinearInitializer< Sca > init;
+  init.globalStart.resize(numDims);
+  for (int axis = 0; axis < numDims; ++axis)
+    init.globalStart[axis] = u.getGlobalRankBounds(axis).start();
+  u.initialize(init, false);
+
+  // Redistribute to the target MDMap, twice with the same plan, and
+  // check the values
+  Domi::Redistributor< Sca > forward(source, target);
+  MDVector< Sca > v(target);
+  Array< dim_type > index(numDims);
+  typedef typename MDArrayView< const Sca >::const_iterator const_iterator;
+  for (int repeat = 0; repeat < 2; ++repeat)
+  {
+    v.putScalar(-1);
+    forward.redistribute(u, v);
+    for (int axis = 0; axis < numDims; ++axis)
+      init.globalStart[axis] = v.getGlobalRankBounds(axis).start();
+    MDArrayView< const Sca > vData = v.getData(false);
+    for (const_iterator it = vData.begin(); it != vData.end(); ++it)
+    {
+      for (int axis = 0; axis < numDims; ++axis)
+        index[axis] = it.index(axis);
+      TEST_EQUALITY(*it, init(index()));
+    }
+  }
+  TEST_EQUALITY(forward.numSends() == 0, forward.sendSize() == 0);
+  TEST_EQUALITY(forward.numRecvs() == 0, forward.recvSize() == 0);
+
+  // Redistribute back with a non-blocking redistribution
+  Domi::Redistributor< Sca > backward(target, source);
+  MDVector< Sca > w(source);
+  backward.startRedistribute(v, w);
+  TEST_THROW(backward.startRedistribute(v, w), Domi::InvalidArgument);
+  backward.endRedistribute(w);
+  MDArrayView< const Sca > uData = u.getData(false);
+  MDArrayView< const Sca > wData = w.getData(false);
+  const_iterator uIt = uData.begin();
+  for (const_iterator wIt = wData.begin(); wIt != wData.end(); ++wIt, ++uIt)
+    TEST_EQUALITY(*wIt, *uIt);
+
+  // The MDMaps must have the same dimensions, and the MDVectors must
+  // be on MDMaps like those of the plan
+  Array< dim_type > otherDims(dims);
+  otherDims[0] += 1;
+  MDMapRCP other = rcp(new MDMap(reversedMdComm, otherDims()));
+  TEST_THROW(Domi::Redistributor< Sca > bad(source, other),
+             Domi::MDMapError);
+  MDVector< Sca > x(other);
+  TEST_THROW(forward.redistribute(x, v), Domi::MDMapError);
+}
+
 ////////////////////////////////////////////////////////////////////////
 
 #define UNIT_TEST_GROUP( Sca ) \
@@ -954,7 +2596,26 @@ TEUCHOS_UNIT_TEST_TEMPLATE_1_DECL( MDVector, randomize, Sca )
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, pListBndryPadConstructor, Sca ) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, pListPaddingConstructor, Sca ) \
   TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, augmentedConstruction, Sca ) \
-  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, randomize, Sca )
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, randomize, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, reductionBatch, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, threadedKernels, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, stencil, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, updateCommPadAndApply, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, temporalBlocking, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, elementWise, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, alignedStorage, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, memoryPool, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, firstTouch, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, mdMapLayout, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, hugePages, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, mapBinary, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, chunkedFile, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, asyncWrite, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, binaryRegion, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, timeSeries, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, ioConfig, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, subfiles, Sca ) \
+  TEUCHOS_UNIT_TEST_TEMPLATE_1_INSTANT( MDVector, redistribute, Sca )
 
 UNIT_TEST_GROUP(double)
 #if 1